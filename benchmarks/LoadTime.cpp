@@ -0,0 +1,239 @@
+// LoadTime: end-to-end class loading over generated corpora. For each class count it writes a corpus
+// (once per shape; later runs reuse it), then times VM construction and the loading of every class,
+// one at a time, through a bootstrap loader.
+//
+//   LoadTime [--runs 1000,10000,100000] [--dir <corpus root>] [--json] [--cold]
+//            [--preload io_uring|threads] [corpus options]
+//
+// --cold drops the corpus from the page cache before each run (posix_fadvise, no root needed), as on
+// a freshly started machine. --preload has the loader preload the whole corpus, in load order, with
+// the given I/O backend while the classes are loaded.
+//
+// Peak RSS is reset between runs where the kernel allows it (/proc/self/clear_refs).
+
+#include "ClassGenerator.hpp"
+
+#include <tula/VM.hpp>
+#include <ClazzLoader.hpp>
+#include <SymbolTable.hpp>
+
+#include <algorithm>
+#include <chrono>
+#include <fcntl.h>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <stdexcept>
+#include <string>
+#include <unistd.h>
+#include <vector>
+
+using namespace CCW::Tula;
+using Clock = std::chrono::steady_clock;
+
+struct LoadResult {
+    size_t classes = 0;
+    size_t failed = 0;
+    double generateSeconds = 0;
+    double vmMicros = 0;
+    double loadSeconds = 0;
+    double p50Micros = 0;
+    double p99Micros = 0;
+    double maxMicros = 0;
+    size_t peakRssKiB = 0;
+    size_t symbols = 0;
+};
+
+static double microsBetween(Clock::time_point start, Clock::time_point end) {
+    return std::chrono::duration<double, std::micro>(end - start).count();
+}
+
+static void resetPeakRss() {
+    std::ofstream("/proc/self/clear_refs") << "5";
+}
+
+static size_t peakRssKiB() {
+    std::ifstream status("/proc/self/status");
+    std::string line;
+    while (std::getline(status, line)) {
+        if (line.compare(0, 6, "VmHWM:") == 0) {
+            return std::stoull(line.substr(6));
+        }
+    }
+    return 0;
+}
+
+// The corpus directory of a shape; the marker file is written last, so an interrupted generation is
+// redone.
+static std::string corpusOf(const std::string &root, const CorpusSpec &spec, LoadResult &result) {
+    auto dir = root + "/" + std::to_string(spec.classes) + "-c" + std::to_string(spec.constants)
+               + "-f" + std::to_string(spec.fields) + "-m" + std::to_string(spec.methods)
+               + "-b" + std::to_string(spec.codeLength) + "-a" + std::to_string(spec.annotations)
+               + "-n" + std::to_string(spec.nameLength) + "-d" + std::to_string(spec.hierarchyDepth)
+               + "-s" + std::to_string(spec.seed);
+    auto marker = dir + "/.complete";
+    if (!std::filesystem::exists(marker)) {
+        auto start = Clock::now();
+        ClassGenerator(spec).writeDirectory(dir);
+        std::ofstream(marker) << "";
+        result.generateSeconds = microsBetween(start, Clock::now()) / 1e6;
+    }
+    return dir;
+}
+
+struct LoadOptions {
+    bool cold = false;
+    bool preload = false;
+    BatchFileReader::Backend backend = BatchFileReader::Backend::Auto;
+};
+
+static void dropFromPageCache(const std::string &dir) {
+    for (auto &entry : std::filesystem::recursive_directory_iterator(dir)) {
+        if (!entry.is_regular_file()) {
+            continue;
+        }
+        int fd = open(entry.path().c_str(), O_RDONLY);
+        if (fd >= 0) {
+            posix_fadvise(fd, 0, 0, POSIX_FADV_DONTNEED);
+            close(fd);
+        }
+    }
+}
+
+static LoadResult run(const std::string &root, CorpusSpec spec, const LoadOptions &options) {
+    LoadResult result;
+    result.classes = spec.classes;
+    auto dir = corpusOf(root, spec, result);
+    ClassGenerator generator(spec);
+    std::vector<std::string> names;
+    names.reserve(spec.classes);
+    for (size_t i = 0; i < spec.classes; ++i) {
+        names.push_back(generator.className(i));
+    }
+    std::vector<double> latencies;
+    latencies.reserve(spec.classes);
+
+    if (options.cold) {
+        dropFromPageCache(dir);
+    }
+    resetPeakRss();
+    auto vmStart = Clock::now();
+    VM vm(dir, "");
+    result.vmMicros = microsBetween(vmStart, Clock::now());
+    auto symbolsBefore = SymbolTable::size();
+    {
+        BootstrapClassLoader loader(&vm, dir);
+        auto loadStart = Clock::now();
+        if (options.preload) {
+            std::vector<SymbolPtr> order;
+            order.reserve(names.size());
+            for (const auto &name : names) {
+                order.push_back(SymbolTable::intern(name.c_str()));
+            }
+            loader.preload(std::move(order), 0, options.backend);
+        }
+        for (const auto &name : names) {
+            auto start = Clock::now();
+            auto klass = loader.loadClass(SymbolTable::intern(name.c_str()));
+            latencies.push_back(microsBetween(start, Clock::now()));
+            if (klass == nullptr) {
+                result.failed++;
+            }
+        }
+        result.loadSeconds = microsBetween(loadStart, Clock::now()) / 1e6;
+        result.symbols = SymbolTable::size() - symbolsBefore;
+        result.peakRssKiB = peakRssKiB();
+    }
+    std::sort(latencies.begin(), latencies.end());
+    if (!latencies.empty()) {
+        result.p50Micros = latencies[latencies.size() / 2];
+        result.p99Micros = latencies[std::min(latencies.size() - 1, latencies.size() * 99 / 100)];
+        result.maxMicros = latencies.back();
+    }
+    return result;
+}
+
+static int usage() {
+    fprintf(stderr, "usage: LoadTime [--runs N,N,...] [--dir <corpus root>] [--json] [--cold]\n"
+                    "                [--preload io_uring|threads] [options]\n%s",
+            CorpusSpec::usage());
+    return 2;
+}
+
+int main(int argc, char **argv) {
+    CorpusSpec spec;
+    std::vector<size_t> runs{1000, 10000, 100000};
+    std::string root = (std::filesystem::temp_directory_path() / "tula-corpus").string();
+    bool json = false;
+    LoadOptions options;
+    try {
+        for (int i = 1; i < argc; ++i) {
+            std::string option = argv[i];
+            if (option == "--json") {
+                json = true;
+            } else if (option == "--cold") {
+                options.cold = true;
+            } else if (option.compare(0, 2, "--") != 0 || i + 1 >= argc) {
+                return usage();
+            } else if (option == "--runs") {
+                runs.clear();
+                std::string list = argv[++i];
+                for (size_t start = 0; start <= list.size();) {
+                    auto end = std::min(list.find(',', start), list.size());
+                    runs.push_back(std::stoull(list.substr(start, end - start)));
+                    start = end + 1;
+                }
+            } else if (option == "--preload") {
+                std::string backend = argv[++i];
+                if (backend != "io_uring" && backend != "threads") {
+                    return usage();
+                }
+                options.preload = true;
+                options.backend = backend == "io_uring" ? BatchFileReader::Backend::IoUring
+                                                        : BatchFileReader::Backend::Threads;
+            } else if (option == "--dir") {
+                root = argv[++i];
+            } else if (!spec.set(option.substr(2), argv[++i])) {
+                return usage();
+            }
+        }
+    } catch (const std::exception &e) {
+        fprintf(stderr, "LoadTime: %s\n", e.what());
+        return 2;
+    }
+
+    if (json) {
+        printf("[");
+    } else {
+        printf("%8s %8s %10s %10s %12s %9s %9s %9s %10s %9s\n", "classes", "failed", "vm (us)", "load (s)",
+               "classes/s", "p50 (us)", "p99 (us)", "max (us)", "peak (MiB)", "symbols");
+    }
+    for (size_t i = 0; i < runs.size(); ++i) {
+        spec.classes = runs[i];
+        LoadResult result;
+        try {
+            result = run(root, spec, options);
+        } catch (const std::exception &e) {
+            fprintf(stderr, "LoadTime: %s\n", e.what());
+            return 1;
+        }
+        auto rate = result.loadSeconds > 0 ? static_cast<double>(result.classes) / result.loadSeconds : 0;
+        if (json) {
+            printf("%s\n{\"classes\":%zu,\"failed\":%zu,\"generateSeconds\":%.3f,\"vmMicros\":%.1f,"
+                   "\"loadSeconds\":%.6f,\"classesPerSecond\":%.1f,\"p50Micros\":%.2f,\"p99Micros\":%.2f,"
+                   "\"maxMicros\":%.2f,\"peakRssKiB\":%zu,\"symbols\":%zu}", i == 0 ? "" : ",",
+                   result.classes, result.failed, result.generateSeconds, result.vmMicros, result.loadSeconds,
+                   rate, result.p50Micros, result.p99Micros, result.maxMicros, result.peakRssKiB, result.symbols);
+        } else {
+            printf("%8zu %8zu %10.1f %10.3f %12.0f %9.2f %9.2f %9.2f %10.1f %9zu\n", result.classes,
+                   result.failed, result.vmMicros, result.loadSeconds, rate, result.p50Micros, result.p99Micros,
+                   result.maxMicros, static_cast<double>(result.peakRssKiB) / 1024.0, result.symbols);
+        }
+        fflush(stdout);
+    }
+    if (json) {
+        printf("\n]\n");
+    }
+    return 0;
+}
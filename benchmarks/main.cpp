@@ -0,0 +1,16 @@
+#include <benchmark/benchmark.h>
+#include <tula/VM.hpp>
+
+using namespace CCW::Tula;
+
+int main(int argc, char **argv) {
+    // The symbol and string tables live as long as a VM does.
+    VM vm("", "");
+    ::benchmark::Initialize(&argc, argv);
+    if (::benchmark::ReportUnrecognizedArguments(argc, argv)) {
+        return 1;
+    }
+    ::benchmark::RunSpecifiedBenchmarks();
+    ::benchmark::Shutdown();
+    return 0;
+}
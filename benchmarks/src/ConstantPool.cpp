@@ -0,0 +1,164 @@
+#include <benchmark/benchmark.h>
+
+#include <ConstantPool.hpp>
+
+namespace CCW::Tula {
+
+    static constexpr uint16_t PoolSize = 256;
+
+    // Fills a fresh pool per round with `put(pool, index)` at every index `step` apart; the pool's
+    // construction is not measured.
+    template<typename Put>
+    static void fillPools(benchmark::State &state, Put put, uint16_t step = 1) {
+        int64_t puts = 0;
+        for (auto _ : state) {
+            state.PauseTiming();
+            auto pool = std::make_unique<ConstantPool>(PoolSize);
+            state.ResumeTiming();
+            for (uint16_t index = 1; index + step <= PoolSize; index += step) {
+                put(*pool, index);
+                ++puts;
+            }
+            benchmark::ClobberMemory();
+            state.PauseTiming();
+            pool.reset();
+            state.ResumeTiming();
+        }
+        state.SetItemsProcessed(puts);
+    }
+
+    // Reads every entry of a pool filled once.
+    template<typename Put, typename Get>
+    static void readPool(benchmark::State &state, Put put, Get get, uint16_t step = 1) {
+        ConstantPool pool(PoolSize);
+        for (uint16_t index = 1; index + step <= PoolSize; index += step) {
+            put(pool, index);
+        }
+        int64_t gets = 0;
+        for (auto _ : state) {
+            for (uint16_t index = 1; index + step <= PoolSize; index += step) {
+                benchmark::DoNotOptimize(get(pool, index));
+                ++gets;
+            }
+        }
+        state.SetItemsProcessed(gets);
+    }
+
+    static SymbolPtr benchSymbol() {
+        static auto symbol = Symbol::create("com/tula/bench/Constant");
+        return symbol;
+    }
+
+    // One put and one get function per kind of entry; Long and Double take two slots, a String the
+    // Utf8 entry it refers to as well.
+    static void putClassIndex(ConstantPool &pool, uint16_t index) { pool.putClassIndexAt(index, index); }
+    static uint16_t getClassIndex(ConstantPool &pool, uint16_t index) { return pool.getClassIndexAt(index); }
+
+    static void putFieldRef(ConstantPool &pool, uint16_t index) { pool.putFieldRefAt(index, index, index); }
+    static uint32_t getFieldRef(ConstantPool &pool, uint16_t index) {
+        return pool.getRefClassIndexAt(index) + pool.getRefNameAndTypeIndexAt(index);
+    }
+
+    static void putMethodRef(ConstantPool &pool, uint16_t index) { pool.putMethodRefAt(index, index, index); }
+    static uint16_t getMethodRef(ConstantPool &pool, uint16_t index) { return pool.getRefNameAndTypeIndexAt(index); }
+
+    static void putInterfaceMethodRef(ConstantPool &pool, uint16_t index) {
+        pool.putInterfaceMethodRefAt(index, index, index);
+    }
+    static uint16_t getInterfaceMethodRef(ConstantPool &pool, uint16_t index) { return pool.getRefClassIndexAt(index); }
+
+    static void putStringIndex(ConstantPool &pool, uint16_t index) { pool.putStringIndexAt(index, index); }
+    static uint16_t getStringIndex(ConstantPool &pool, uint16_t index) { return pool.getStringIndexAt(index); }
+
+    static void putString(ConstantPool &pool, uint16_t index) {
+        pool.putSymbolAt(index, benchSymbol());
+        pool.putStringAt(index + 1, index);
+    }
+    static Symbol *getString(ConstantPool &pool, uint16_t index) { return pool.getStringSymbolAt(index + 1).get(); }
+
+    // ldc of a String: the first resolution of an entry interns it, later ones load the cached string.
+    static JavaString *resolveString(ConstantPool &pool, uint16_t index) { return pool.resolveStringAt(index + 1); }
+
+    static void resolveStringsFirstTime(benchmark::State &state) {
+        int64_t resolves = 0;
+        for (auto _ : state) {
+            state.PauseTiming();
+            auto pool = std::make_unique<ConstantPool>(PoolSize);
+            for (uint16_t index = 1; index + 2 <= PoolSize; index += 2) {
+                putString(*pool, index);
+            }
+            state.ResumeTiming();
+            for (uint16_t index = 1; index + 2 <= PoolSize; index += 2) {
+                benchmark::DoNotOptimize(resolveString(*pool, index));
+                ++resolves;
+            }
+            state.PauseTiming();
+            pool.reset();
+            state.ResumeTiming();
+        }
+        state.SetItemsProcessed(resolves);
+    }
+
+    static void putInteger(ConstantPool &pool, uint16_t index) { pool.putIntegerAt(index, index); }
+    static int32_t getInteger(ConstantPool &pool, uint16_t index) { return pool.getIntegerAt(index); }
+
+    static void putFloat(ConstantPool &pool, uint16_t index) { pool.putFloatAt(index, static_cast<jfloat>(index)); }
+    static jfloat getFloat(ConstantPool &pool, uint16_t index) { return pool.getFloatAt(index); }
+
+    static void putLong(ConstantPool &pool, uint16_t index) { pool.putLongAt(index, index); }
+    static jlong getLong(ConstantPool &pool, uint16_t index) { return pool.getLongAt(index); }
+
+    static void putDouble(ConstantPool &pool, uint16_t index) { pool.putDoubleAt(index, index); }
+    static jdouble getDouble(ConstantPool &pool, uint16_t index) { return pool.getDoubleAt(index); }
+
+    static void putNameAndType(ConstantPool &pool, uint16_t index) { pool.putNameAndTypeAt(index, index, index); }
+    static uint32_t getNameAndType(ConstantPool &pool, uint16_t index) {
+        return pool.getNameAndTypeNameIndexAt(index) + pool.getNameAndTypeDescriptorIndexAt(index);
+    }
+
+    static void putSymbol(ConstantPool &pool, uint16_t index) { pool.putSymbolAt(index, benchSymbol()); }
+    static Symbol *getSymbol(ConstantPool &pool, uint16_t index) { return pool.getSymbolAt(index).get(); }
+
+    static void putMethodHandle(ConstantPool &pool, uint16_t index) { pool.putMethodHandleAt(index, 5, index); }
+    static uint32_t getMethodHandle(ConstantPool &pool, uint16_t index) {
+        return pool.getMethodHandleReferenceKindAt(index) + pool.getMethodHandleReferenceIndexAt(index);
+    }
+
+    static void putMethodType(ConstantPool &pool, uint16_t index) { pool.putMethodTypeAt(index, index); }
+    static uint16_t getMethodType(ConstantPool &pool, uint16_t index) { return pool.getMethodTypeDescriptorIndex(index); }
+
+    static void putInvokeDynamic(ConstantPool &pool, uint16_t index) { pool.putInvokeDynamicAt(index, index, index); }
+    static uint32_t getInvokeDynamic(ConstantPool &pool, uint16_t index) {
+        return pool.getInvokeDynamicBootstrapMethodAttrIndexAt(index) + pool.getInvokeDynamicNameAndTypeIndexAt(index);
+    }
+
+    static void putUnresolvedClass(ConstantPool &pool, uint16_t index) {
+        pool.putUnresolvedClassAt(index, benchSymbol());
+    }
+    static bool getUnresolvedClass(ConstantPool &pool, uint16_t index) { return pool.getClassAt(index).isUnresolved(); }
+
+#define TULA_CP_BENCHMARK(kind, step)                                    \
+    BENCHMARK_CAPTURE(fillPools, put##kind, put##kind, step);            \
+    BENCHMARK_CAPTURE(readPool, get##kind, put##kind, get##kind, step)
+
+    TULA_CP_BENCHMARK(ClassIndex, 1);
+    TULA_CP_BENCHMARK(FieldRef, 1);
+    TULA_CP_BENCHMARK(MethodRef, 1);
+    TULA_CP_BENCHMARK(InterfaceMethodRef, 1);
+    TULA_CP_BENCHMARK(StringIndex, 1);
+    TULA_CP_BENCHMARK(String, 2);
+    BENCHMARK_CAPTURE(readPool, resolveString, putString, resolveString, 2);
+    BENCHMARK(resolveStringsFirstTime);
+    TULA_CP_BENCHMARK(Integer, 1);
+    TULA_CP_BENCHMARK(Float, 1);
+    TULA_CP_BENCHMARK(Long, 2);
+    TULA_CP_BENCHMARK(Double, 2);
+    TULA_CP_BENCHMARK(NameAndType, 1);
+    TULA_CP_BENCHMARK(Symbol, 1);
+    TULA_CP_BENCHMARK(MethodHandle, 1);
+    TULA_CP_BENCHMARK(MethodType, 1);
+    TULA_CP_BENCHMARK(InvokeDynamic, 1);
+    TULA_CP_BENCHMARK(UnresolvedClass, 1);
+
+#undef TULA_CP_BENCHMARK
+}
@@ -0,0 +1,32 @@
+#include <benchmark/benchmark.h>
+
+#include <Symbol.hpp>
+
+#include <string>
+
+namespace CCW::Tula {
+
+    static void BM_SymbolBytesHash(benchmark::State &state) {
+        std::string bytes(state.range(0), 'a');
+        for (size_t i = 0; i < bytes.size(); ++i) {
+            bytes[i] = static_cast<char>('a' + i % 26);
+        }
+        for (auto _ : state) {
+            benchmark::DoNotOptimize(Symbol::bytesHash(reinterpret_cast<const uint8_t *>(bytes.data()),
+                                                       static_cast<int>(bytes.size())));
+        }
+        state.SetBytesProcessed(static_cast<int64_t>(state.iterations()) * state.range(0));
+    }
+
+    BENCHMARK(BM_SymbolBytesHash)->RangeMultiplier(4)->Range(4, 1024);
+
+    static void BM_SymbolEquals(benchmark::State &state) {
+        auto a = Symbol::create("java/util/concurrent/ConcurrentHashMap");
+        auto b = Symbol::create("java/util/concurrent/ConcurrentHashMap");
+        for (auto _ : state) {
+            benchmark::DoNotOptimize(a->equals(b));
+        }
+    }
+
+    BENCHMARK(BM_SymbolEquals);
+}
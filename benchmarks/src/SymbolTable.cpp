@@ -0,0 +1,97 @@
+#include <benchmark/benchmark.h>
+
+#include <SymbolTable.hpp>
+
+#include <string>
+#include <vector>
+
+namespace CCW::Tula {
+
+    static constexpr size_t SymbolCount = 4096;
+
+    // Names shaped like those of a class library, created once and shared by all threads.
+    static const std::vector<SymbolPtr> &symbols() {
+        static auto *symbols = [] {
+            auto *symbols = new std::vector<SymbolPtr>();
+            for (size_t i = 0; i < SymbolCount; ++i) {
+                symbols->push_back(Symbol::create(("com/tula/bench/Class" + std::to_string(i)).c_str()));
+            }
+            return symbols;
+        }();
+        return *symbols;
+    }
+
+    // Threads start at different symbols, so they contend on the table, not on one bucket.
+    static size_t startOf(const benchmark::State &state) {
+        return static_cast<size_t>(state.thread_index()) * 97;
+    }
+
+    static void BM_SymbolTablePutSymbol(benchmark::State &state) {
+        const auto &names = symbols();
+        auto i = startOf(state);
+        for (auto _ : state) {
+            // After the first round every put finds its symbol: the lookup path under the table lock.
+            benchmark::DoNotOptimize(SymbolTable::putSymbol(names[i++ % SymbolCount]));
+        }
+        state.SetItemsProcessed(state.iterations());
+    }
+
+    BENCHMARK(BM_SymbolTablePutSymbol)->ThreadRange(1, 64)->UseRealTime();
+
+    static void BM_SymbolTableContains(benchmark::State &state) {
+        const auto &names = symbols();
+        if (state.thread_index() == 0) {
+            for (const auto &name : names) {
+                SymbolTable::putSymbol(name);
+            }
+        }
+        auto i = startOf(state);
+        for (auto _ : state) {
+            benchmark::DoNotOptimize(SymbolTable::contains(names[i++ % SymbolCount]));
+        }
+        state.SetItemsProcessed(state.iterations());
+    }
+
+    BENCHMARK(BM_SymbolTableContains)->ThreadRange(1, 64)->UseRealTime();
+
+    static void BM_SymbolTableInternExisting(benchmark::State &state) {
+        std::vector<std::string> names;
+        for (const auto &symbol : symbols()) {
+            names.push_back(symbol->toString());
+            SymbolTable::putSymbol(symbol);
+        }
+        auto i = startOf(state);
+        for (auto _ : state) {
+            const auto &name = names[i++ % SymbolCount];
+            benchmark::DoNotOptimize(SymbolTable::intern(reinterpret_cast<const uint8_t *>(name.data()),
+                                                         name.size()));
+        }
+        state.SetItemsProcessed(state.iterations());
+    }
+
+    BENCHMARK(BM_SymbolTableInternExisting)->ThreadRange(1, 64)->UseRealTime();
+
+    // Creation of new symbols; the batch is swept out of the table between rounds.
+    static void BM_SymbolTableInternNew(benchmark::State &state) {
+        std::vector<std::string> names;
+        for (size_t i = 0; i < SymbolCount; ++i) {
+            names.push_back("com/tula/bench/New" + std::to_string(i));
+        }
+        size_t i = 0;
+        for (auto _ : state) {
+            if (i == SymbolCount) {
+                state.PauseTiming();
+                SymbolTable::sweep();
+                i = 0;
+                state.ResumeTiming();
+            }
+            const auto &name = names[i++];
+            benchmark::DoNotOptimize(SymbolTable::intern(reinterpret_cast<const uint8_t *>(name.data()),
+                                                         name.size()));
+        }
+        SymbolTable::sweep();
+        state.SetItemsProcessed(state.iterations());
+    }
+
+    BENCHMARK(BM_SymbolTableInternNew);
+}
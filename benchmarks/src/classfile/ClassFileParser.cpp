@@ -0,0 +1,109 @@
+#include <benchmark/benchmark.h>
+#include "ClassFileBuilder.hpp"
+
+#include <classfile/ClassFileParser.hpp>
+
+#include <string>
+
+namespace CCW::Tula {
+
+    static ClassFileBuilder::MethodSpec method(const std::string &name, size_t codeLength) {
+        ClassFileBuilder::MethodSpec method;
+        method.name = name;
+        method.descriptor = "(IJLjava/lang/String;)I";
+        method.maxStack = 2;
+        method.maxLocals = 5;
+        method.code.assign(codeLength - 2, 0x00);    // nop ...
+        method.code.push_back(0x03);                // iconst_0
+        method.code.push_back(0xAC);                // ireturn
+        for (uint16_t pc = 0; pc < codeLength; pc += 8) {
+            method.lineNumbers.emplace_back(pc, pc / 8 + 1);
+        }
+        return method;
+    }
+
+    // Class shapes: members count as the argument.
+    static std::vector<uint8_t> emptyClass(int64_t) {
+        return ClassFileBuilder("com/tula/bench/Empty").build();
+    }
+
+    static std::vector<uint8_t> fieldsClass(int64_t count) {
+        ClassFileBuilder builder("com/tula/bench/Fields");
+        for (int64_t i = 0; i < count; ++i) {
+            builder.addField(0x0002, "field" + std::to_string(i), i % 2 == 0 ? "I" : "Ljava/lang/String;");
+        }
+        return builder.build();
+    }
+
+    static std::vector<uint8_t> methodsClass(int64_t count) {
+        ClassFileBuilder builder("com/tula/bench/Methods");
+        for (int64_t i = 0; i < count; ++i) {
+            builder.addMethod(method("method" + std::to_string(i), 16));
+        }
+        return builder.build();
+    }
+
+    static std::vector<uint8_t> constantsClass(int64_t count) {
+        ClassFileBuilder builder("com/tula/bench/Constants");
+        for (int64_t i = 0; i < count; ++i) {
+            builder.string("constant " + std::to_string(i));
+            builder.integer(static_cast<int32_t>(i));
+            builder.methodRef("com/tula/bench/Callee" + std::to_string(i % 16), "call" + std::to_string(i), "()V");
+        }
+        return builder.build();
+    }
+
+    static std::vector<uint8_t> codeClass(int64_t length) {
+        ClassFileBuilder builder("com/tula/bench/Code");
+        builder.addMethod(method("run", static_cast<size_t>(length)));
+        return builder.build();
+    }
+
+    template<typename Shape>
+    static void parseClass(benchmark::State &state, Shape shape) {
+        auto bytes = shape(state.range(0));
+        for (auto _ : state) {
+            benchmark::DoNotOptimize(ClassFileParser::parse(bytes.data(), static_cast<uint32_t>(bytes.size())));
+        }
+        state.SetBytesProcessed(static_cast<int64_t>(state.iterations() * bytes.size()));
+        state.counters["classBytes"] = static_cast<double>(bytes.size());
+    }
+
+    // A class rejected at its first method: a scan of mixed jars meets many.
+    static std::vector<uint8_t> malformedClass() {
+        ClassFileBuilder builder("com/tula/bench/Malformed");
+        auto invalid = method("run", 16);
+        invalid.descriptor = "(Ljava/lang/String)V";
+        builder.addMethod(invalid);
+        return builder.build();
+    }
+
+    static void parseMalformed(benchmark::State &state) {
+        auto bytes = malformedClass();
+        for (auto _ : state) {
+            try {
+                benchmark::DoNotOptimize(ClassFileParser::parse(bytes.data(), static_cast<uint32_t>(bytes.size())));
+            } catch (const ClassFormatError &e) {
+                benchmark::DoNotOptimize(e.what());
+            }
+        }
+    }
+
+    static void tryParseMalformed(benchmark::State &state) {
+        auto bytes = malformedClass();
+        ParseError error;
+        for (auto _ : state) {
+            benchmark::DoNotOptimize(ClassFileParser::tryParse(bytes.data(), static_cast<uint32_t>(bytes.size()),
+                                                               error));
+            benchmark::DoNotOptimize(error.getCode());
+        }
+    }
+
+    BENCHMARK_CAPTURE(parseClass, empty, emptyClass)->Arg(0);
+    BENCHMARK_CAPTURE(parseClass, fields, fieldsClass)->RangeMultiplier(8)->Range(8, 512);
+    BENCHMARK_CAPTURE(parseClass, methods, methodsClass)->RangeMultiplier(8)->Range(8, 512);
+    BENCHMARK_CAPTURE(parseClass, constants, constantsClass)->RangeMultiplier(8)->Range(8, 4096);
+    BENCHMARK_CAPTURE(parseClass, code, codeClass)->RangeMultiplier(8)->Range(64, 32768);
+    BENCHMARK(parseMalformed);
+    BENCHMARK(tryParseMalformed);
+}
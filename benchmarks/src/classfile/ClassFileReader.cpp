@@ -0,0 +1,51 @@
+#include <benchmark/benchmark.h>
+
+#include <classfile/ClassFileReader.hpp>
+
+#include <vector>
+
+namespace CCW::Tula {
+
+    static constexpr uint32_t BufferSize = 64 * 1024;
+
+    static const std::vector<uint8_t> &buffer() {
+        static std::vector<uint8_t> bytes = [] {
+            std::vector<uint8_t> bytes(BufferSize);
+            for (uint32_t i = 0; i < BufferSize; ++i) {
+                bytes[i] = static_cast<uint8_t>(i * 31u);
+            }
+            return bytes;
+        }();
+        return bytes;
+    }
+
+    // Reads the whole buffer with `read`, `width` bytes at a time.
+    template<typename Read>
+    static void readBuffer(benchmark::State &state, Read read, uint32_t width) {
+        const auto &bytes = buffer();
+        for (auto _ : state) {
+            ClassFileReader reader(bytes.data(), BufferSize);
+            uint64_t sum = 0;
+            for (uint32_t i = 0; i < BufferSize / width; ++i) {
+                sum += read(reader);
+            }
+            benchmark::DoNotOptimize(sum);
+        }
+        state.SetBytesProcessed(static_cast<int64_t>(state.iterations()) * BufferSize);
+    }
+
+    BENCHMARK_CAPTURE(readBuffer, readU8, [](ClassFileReader &reader) { return reader.readU8(); }, 1);
+    BENCHMARK_CAPTURE(readBuffer, readU8Unchecked,
+                      [](ClassFileReader &reader) { return reader.readU8Unchecked(); }, 1);
+    BENCHMARK_CAPTURE(readBuffer, readU16, [](ClassFileReader &reader) { return reader.readU16(); }, 2);
+    BENCHMARK_CAPTURE(readBuffer, readU16Unchecked,
+                      [](ClassFileReader &reader) { return reader.readU16Unchecked(); }, 2);
+    BENCHMARK_CAPTURE(readBuffer, readU32, [](ClassFileReader &reader) { return reader.readU32(); }, 4);
+    BENCHMARK_CAPTURE(readBuffer, readU32Unchecked,
+                      [](ClassFileReader &reader) { return reader.readU32Unchecked(); }, 4);
+    BENCHMARK_CAPTURE(readBuffer, readU64, [](ClassFileReader &reader) { return reader.readU64(); }, 8);
+    BENCHMARK_CAPTURE(readBuffer, readU64Unchecked,
+                      [](ClassFileReader &reader) { return reader.readU64Unchecked(); }, 8);
+    // Skips over attribute-sized blocks, as the parser does with attributes it ignores.
+    BENCHMARK_CAPTURE(readBuffer, skip, [](ClassFileReader &reader) { reader.skip(32); return 0; }, 32);
+}
@@ -0,0 +1,26 @@
+#pragma once
+
+#include <cstdint>
+
+namespace CCW::Tula {
+
+    // How a VM's class path lookups fared. A miss is a lookup that searched the class path and found
+    // nothing; a hit is one the VM answered as absent without searching, because the name missed before.
+    struct ClassLookupStats {
+        uint64_t lookups = 0;
+        uint64_t hits = 0;
+        uint64_t misses = 0;
+        uint64_t evictions = 0;     // absences forgotten to stay within the cache capacity
+        uint64_t invalidations = 0; // absences forgotten because the class path changed
+        uint64_t size = 0;          // names currently known to be absent
+        double seconds = 0;         // since the VM started counting
+
+        [[nodiscard]] inline double hitRate() const {
+            return lookups == 0 ? 0 : static_cast<double>(hits) / static_cast<double>(lookups);
+        }
+
+        [[nodiscard]] inline double missesPerSecond() const {
+            return seconds <= 0 ? 0 : static_cast<double>(misses) / seconds;
+        }
+    };
+}
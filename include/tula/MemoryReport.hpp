@@ -0,0 +1,41 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace CCW::Tula {
+
+    // Metadata memory of the whole process by subsystem, plus the largest classes and constant pools of
+    // one VM. The categories and totals are process-wide: every VM of the process reports the same ones,
+    // and memory shared between VMs is counted once. `used` is what a subsystem asked for, `reserved`
+    // what it holds from the system.
+    struct MemoryReport {
+        struct Category {
+            std::string name;
+            int64_t used = 0;
+            int64_t reserved = 0;
+            int64_t count = 0;
+        };
+
+        struct Item {
+            std::string name;
+            size_t bytes = 0;
+        };
+
+        std::vector<Category> processCategories;
+        int64_t processUsed = 0;
+        int64_t processReserved = 0;
+        std::vector<Item> largestClasses;           // of the reporting VM
+        std::vector<Item> largestConstantPools;     // of the reporting VM
+
+        // A table for people.
+        [[nodiscard]] std::string toText() const;
+
+        // {"processUsed":..,"processReserved":..,
+        //  "processCategories":[{"name":..,"used":..,"reserved":..,"count":..}],
+        //  "largestClasses":[{"name":..,"bytes":..}],"largestConstantPools":[..]}
+        [[nodiscard]] std::string toJson() const;
+    };
+}
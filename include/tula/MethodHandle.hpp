@@ -0,0 +1,170 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <type_traits>
+#include <utility>
+
+namespace CCW::Tula {
+    class VM;
+    class Method;
+    class InstanceKlass;
+    struct NativeEntry;
+
+    // The descriptor character of a C++ argument or result type.
+    template<typename T, typename = void>
+    struct JavaType;
+
+    template<> struct JavaType<void> { static constexpr char code = 'V'; };
+    template<> struct JavaType<bool> { static constexpr char code = 'Z'; };
+    template<> struct JavaType<int8_t> { static constexpr char code = 'B'; };
+    template<> struct JavaType<char16_t> { static constexpr char code = 'C'; };
+    template<> struct JavaType<int16_t> { static constexpr char code = 'S'; };
+    template<> struct JavaType<int32_t> { static constexpr char code = 'I'; };
+    template<> struct JavaType<int64_t> { static constexpr char code = 'J'; };
+    template<> struct JavaType<float> { static constexpr char code = 'F'; };
+    template<> struct JavaType<double> { static constexpr char code = 'D'; };
+    template<typename T> struct JavaType<T *> { static constexpr char code = 'L'; };
+
+    // A static method resolved once by VM::resolveStatic() and callable any number of times from threads
+    // attached to its VM. Copies are cheap and share the resolution.
+    //
+    // Arguments travel as 64-bit Java frame slots: call() packs typed arguments, invoke() takes slots
+    // as they are, and the batch variants make many calls for a single attach and signature check.
+    class MethodHandle {
+    public:
+        using Slot = uint64_t;
+
+        MethodHandle() = default;
+
+        [[nodiscard]] inline bool isValid() const {
+            return method != nullptr;
+        }
+
+        // One character per parameter, 'L' for references and arrays.
+        [[nodiscard]] inline const std::string &getParameterTypes() const {
+            return parameterTypes;
+        }
+
+        [[nodiscard]] inline char getReturnType() const {
+            return returnType;
+        }
+
+        // Frame slots one call takes; long and double parameters count twice.
+        [[nodiscard]] inline size_t getArgumentSlots() const {
+            return argumentSlots;
+        }
+
+        // Calls with typed arguments. Throws when the C++ types do not match the descriptor.
+        template<typename R = void, typename... Args>
+        R call(Args... args) const {
+            checkSignature<R, Args...>();
+            Slot slots[sizeof...(Args) * 2 + 1];
+            [[maybe_unused]] size_t slot = 0;
+            (pack(slots, slot, args), ...);
+            return unpack<R>(invoke(slots));
+        }
+
+        // Calls `count` times; argument i of call n is arguments_i[n], and results[n] receives the result
+        // unless R is void.
+        template<typename R, typename... Args>
+        void callBatch(size_t count, R *results, const Args *... arguments) const {
+            checkSignature<R, Args...>();
+            auto context = enter();
+            Slot slots[sizeof...(Args) * 2 + 1];
+            for (size_t n = 0; n < count; ++n) {
+                [[maybe_unused]] size_t slot = 0;
+                (pack(slots, slot, arguments[n]), ...);
+                auto result = invokeEntered(context, slots);
+                if constexpr (!std::is_void_v<R>) {
+                    results[n] = unpack<R>(result);
+                }
+            }
+        }
+
+        // Calls with raw frame slots and returns the raw result slot.
+        Slot invoke(const Slot *slots) const;
+
+        // Makes `count` calls over consecutive groups of getArgumentSlots() slots.
+        void invokeBatch(const Slot *slots, size_t count, Slot *results) const;
+
+    private:
+        friend class VM;
+
+        MethodHandle(VM *vm, Method *method, InstanceKlass *holder, const NativeEntry *entry,
+                     std::string parameterTypes, char returnType, size_t argumentSlots) :
+            vm(vm), method(method), holder(holder), entry(entry), parameterTypes(std::move(parameterTypes)),
+            returnType(returnType), argumentSlots(argumentSlots) {}
+
+        template<typename R, typename... Args>
+        inline void checkSignature() const {
+            static constexpr char codes[] = {JavaType<Args>::code..., '\0'};
+            if (returnType != JavaType<R>::code || parameterTypes.size() != sizeof...(Args)
+                || memcmp(parameterTypes.data(), codes, sizeof...(Args)) != 0) {
+                signatureMismatch(std::string(1, JavaType<R>::code) + codes);
+            }
+        }
+
+        [[noreturn]] void signatureMismatch(const std::string &types) const;
+
+        // The native environment of the calling thread; throws unless it is attached to the handle's VM.
+        void *enter() const;
+
+        Slot invokeEntered(void *context, const Slot *slots) const;
+
+        template<typename T>
+        static inline void pack(Slot *slots, size_t &slot, T value) {
+            if constexpr (std::is_pointer_v<T>) {
+                slots[slot++] = reinterpret_cast<uintptr_t>(value);
+            } else if constexpr (std::is_same_v<T, float>) {
+                uint32_t bits;
+                memcpy(&bits, &value, sizeof(bits));
+                slots[slot++] = bits;
+            } else if constexpr (std::is_same_v<T, double>) {
+                memcpy(&slots[slot], &value, sizeof(value));
+                slots[slot + 1] = 0;
+                slot += 2;
+            } else if constexpr (std::is_same_v<T, int64_t>) {
+                slots[slot] = static_cast<Slot>(value);
+                slots[slot + 1] = 0;
+                slot += 2;
+            } else {
+                // Sign-extends signed types, zero-extends bool and char16_t.
+                slots[slot++] = static_cast<Slot>(static_cast<int64_t>(value));
+            }
+        }
+
+        template<typename R>
+        static inline R unpack(Slot result) {
+            if constexpr (std::is_void_v<R>) {
+                return;
+            } else if constexpr (std::is_pointer_v<R>) {
+                return reinterpret_cast<R>(static_cast<uintptr_t>(result));
+            } else if constexpr (std::is_same_v<R, float>) {
+                auto bits = static_cast<uint32_t>(result);
+                float value;
+                memcpy(&value, &bits, sizeof(value));
+                return value;
+            } else if constexpr (std::is_same_v<R, double>) {
+                double value;
+                memcpy(&value, &result, sizeof(value));
+                return value;
+            } else if constexpr (std::is_same_v<R, bool>) {
+                return result != 0;
+            } else {
+                return static_cast<R>(result);
+            }
+        }
+
+    private:
+        VM *vm = nullptr;
+        Method *method = nullptr;
+        InstanceKlass *holder = nullptr;
+        const NativeEntry *entry = nullptr;
+        std::string parameterTypes;
+        char returnType = 'V';
+        size_t argumentSlots = 0;
+    };
+}
@@ -0,0 +1,12 @@
+#pragma once
+
+namespace CCW::Tula {
+
+    // A native method implementation registered by embedding code, as in JNI RegisterNatives.
+    // `function` takes the JNI environment and the receiver (or class) before the Java arguments.
+    struct NativeMethod {
+        const char *name;
+        const char *descriptor;
+        void *function;
+    };
+}
@@ -1,25 +1,130 @@
 #pragma once
 
+#include "ClassLookupStats.hpp"
+#include "MemoryReport.hpp"
+#include "MethodHandle.hpp"
+#include "Native.hpp"
+
 #include <CCW/Base.hpp>
+#include <chrono>
+#include <cstdint>
+#include <memory>
 #include <string>
 
 namespace CCW::Tula {
     class BootstrapClassLoader;
+    class NativeLinker;
+    class StringDeduplication;
 
+    // A process may run several VMs at once. They share immutable metadata (symbols, interned strings,
+    // parsed classes) but nothing a program can observe: each initializes classes and links natives
+    // on its own.
     class VM : public Noncopyable {
     public:
+        // The VM the calling thread last created or attached to, or null.
         static VM* current();
+
+        // Records class loading events (file access, parse phases, symbol creation, linking) of every
+        // VM of the process until stopRecording(), which writes them to `path` as an event file;
+        // tula-trace converts it to a Chrome trace. stopRecording() throws Error when `path` can't be
+        // written.
+        static void startRecording();
+
+        static void stopRecording(const std::string &path);
     public:
 
+        // Makes the new VM current on the calling thread. Throws Error when too many VMs exist, or when a
+        // file of the class path is not a jimage.
+        // `libPath` lists class path directories and jimages (a JDK's lib/modules) separated by ':'; the
+        // first one holding a class wins.
         explicit VM(std::string libPath, std::string initializeClazzPath);
 
+        // Defines the initialize class; throws NoClassDefFoundError when its file is missing. When a class
+        // load order was set, the classes it lists start loading on background threads first.
         void start();
 
+        // Has start() index every class file of the class path, so that finding a class takes no
+        // system call but its read. With a `snapshotPath` the index is saved there, and later runs use it
+        // instead of listing the class path again while none of its directories changed.
+        void setClassPathIndex(const std::string &snapshotPath = "");
+
+        // Profile-guided preloading: save the order in which a run loaded its classes, and have the
+        // next run's start() load them ahead of the program. A missing order file preloads nothing, so
+        // the first run can save the order for the next. `threads` 0 uses all hardware threads but one.
+        void setClassLoadOrder(const std::string &path, size_t threads = 0);
+
+        // Writes the classes this VM loaded, in the order they were first asked for. Throws Error when
+        // `path` can't be written.
+        void saveClassLoadOrder(const std::string &path) const;
+
+        // Drops the preloaded classes the program did not ask for, once its startup is over.
+        void stopPreloading();
+
+        // Has strings created from now on share the backing arrays of equal ones, merged every `interval`
+        // on a background thread. Strings are shared by the VMs of the process and so is the pass: the
+        // first VM enabling it picks the interval, and it runs until every VM that enabled it is gone.
+        void enableStringDeduplication(std::chrono::milliseconds interval);
+
+        // Binds natives of `className` (internal form, e.g. "com/foo/Bar") to functions of the
+        // embedding program; they are never looked up with dlsym.
+        void registerNatives(const std::string &className, const NativeMethod *methods, size_t count);
+
+        // Makes the JNI-named functions of a shared library available to native methods.
+        void loadLibrary(const std::string &path);
+
+        // Loads, links and initializes `className` (internal form) and resolves a static method of it.
+        // Native methods are linked here, so calls through the handle do no lookups. Throws
+        // NoClassDefFoundError, NoSuchMethodError or IncompatibleClassChangeError. Until Tula has an
+        // interpreter, it throws Error for bytecode methods and for classes whose initialization would run
+        // a <clinit>; the class is not initialized then, so it is not erroneous either.
+        MethodHandle resolveStatic(const std::string &className, const std::string &name,
+                                   const std::string &descriptor);
+
+        // Calls through method handles are made from attached threads only. Attaching twice is a
+        // no-op; a thread must detach before the VM is destroyed, unless it destroys the VM itself.
+        // Attaching also makes the VM current on the thread.
+        void attachCurrentThread();
+
+        void detachCurrentThread();
+
+        [[nodiscard]] bool isCurrentThreadAttached() const;
+
+        // Metadata memory of the whole process by subsystem, the same whichever VM is asked, with the
+        // `topN` largest classes and constant pools this VM loaded.
+        [[nodiscard]] MemoryReport memoryReport(size_t topN = 10) const;
+
+        // Class names are remembered as absent when the class path has no file for them, so probing for
+        // a missing class again is cheap. Absences are checked against the class path directories about
+        // once a second; call classPathChanged() after writing class files to have them found right away,
+        // which also indexes the class path again when it is indexed.
+        [[nodiscard]] ClassLookupStats classLookupStats() const;
+
+        void classPathChanged();
+
+        // The index of this VM among the VMs of the process; see Isolate.
+        [[nodiscard]] inline uint32_t getIsolate() const {
+            return isolate;
+        }
+
+        [[nodiscard]] inline NativeLinker &getNativeLinker() const {
+            return *nativeLinker;
+        }
+
         virtual ~VM();
 
+    private:
+        void makeCurrent();
+
     private:
         const std::string libPath;
         const std::string initializeClazzPath;
+        const uint32_t isolate;
+        std::string classLoadOrderPath;
+        size_t preloadThreads = 0;
+        bool indexClassPath = false;
+        std::string classPathSnapshot;
         std::shared_ptr<BootstrapClassLoader> bootstrapClazzLoader;
+        std::shared_ptr<NativeLinker> nativeLinker;
+        std::shared_ptr<StringDeduplication> stringDeduplication;
     };
 }
\ No newline at end of file
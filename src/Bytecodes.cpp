@@ -0,0 +1,60 @@
+#include "Bytecodes.hpp"
+
+namespace CCW::Tula {
+
+    const int8_t Bytecodes::lengths[256] = {
+             1,  1,  1,  1,  1,  1,  1,  1,  1,  1,  1,  1,  1,  1,  1,  1,
+             2,  3,  2,  3,  3,  2,  2,  2,  2,  2,  1,  1,  1,  1,  1,  1,
+             1,  1,  1,  1,  1,  1,  1,  1,  1,  1,  1,  1,  1,  1,  1,  1,
+             1,  1,  1,  1,  1,  1,  2,  2,  2,  2,  2,  1,  1,  1,  1,  1,
+             1,  1,  1,  1,  1,  1,  1,  1,  1,  1,  1,  1,  1,  1,  1,  1,
+             1,  1,  1,  1,  1,  1,  1,  1,  1,  1,  1,  1,  1,  1,  1,  1,
+             1,  1,  1,  1,  1,  1,  1,  1,  1,  1,  1,  1,  1,  1,  1,  1,
+             1,  1,  1,  1,  1,  1,  1,  1,  1,  1,  1,  1,  1,  1,  1,  1,
+             1,  1,  1,  1,  3,  1,  1,  1,  1,  1,  1,  1,  1,  1,  1,  1,
+             1,  1,  1,  1,  1,  1,  1,  1,  1,  3,  3,  3,  3,  3,  3,  3,
+             3,  3,  3,  3,  3,  3,  3,  3,  3,  2,  0,  0,  1,  1,  1,  1,
+             1,  1,  3,  3,  3,  3,  3,  3,  3,  5,  5,  3,  2,  3,  1,  1,
+             3,  3,  1,  1,  0,  4,  3,  3,  5,  5, -1, -1, -1, -1, -1, -1,
+            -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+            -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+            -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+    };
+
+    uint32_t Bytecodes::length(const uint8_t *code, uint32_t bci, uint32_t codeLength) {
+        auto opcode = static_cast<Bytecode>(code[bci]);
+        int fixed = lengths[code[bci]];
+        uint32_t len;
+        if (fixed > 0) {
+            len = fixed;
+        } else if (fixed < 0) {
+            return 0;
+        } else if (opcode == Bytecode::_wide) {
+            if (bci + 1 >= codeLength) {
+                return 0;
+            }
+            len = static_cast<Bytecode>(code[bci + 1]) == Bytecode::_iinc ? 6 : 4;
+        } else {
+            // tableswitch / lookupswitch: operands start at the next 4 byte aligned offset.
+            uint32_t operands = (bci + 4) & ~3u;
+            if (operands + 12 > codeLength) {
+                return 0;
+            }
+            if (opcode == Bytecode::_tableswitch) {
+                int64_t low = readS4(code + operands + 4);
+                int64_t high = readS4(code + operands + 8);
+                if (low > high || high - low + 1 > codeLength) {
+                    return 0;
+                }
+                len = operands - bci + 12 + 4 * static_cast<uint32_t>(high - low + 1);
+            } else {
+                int32_t pairs = readS4(code + operands + 4);
+                if (pairs < 0 || (uint32_t) pairs > codeLength) {
+                    return 0;
+                }
+                len = operands - bci + 8 + 8 * static_cast<uint32_t>(pairs);
+            }
+        }
+        return bci + len <= codeLength ? len : 0;
+    }
+}
@@ -0,0 +1,277 @@
+#include "ClassPathIndex.hpp"
+#include "Error.hpp"
+#include "utils/ThreadPool.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <cstring>
+#include <dirent.h>
+#include <fcntl.h>
+#include <fstream>
+#include <set>
+#include <sys/stat.h>
+#include <sys/syscall.h>
+#include <tuple>
+#include <unistd.h>
+
+namespace CCW::Tula {
+
+    static constexpr char SnapshotMagic[8] = {'T', 'U', 'L', 'A', 'C', 'P', '0', '1'};
+    static constexpr uint64_t MaxSnapshotEntries = 1u << 26u;
+    static constexpr uint32_t MaxSnapshotName = 1u << 16u;
+
+    // What one directory holds, by simple name.
+    struct Listing {
+        ClassFileStamp stamp;
+        std::vector<std::string> classes;       // without ".class"
+        std::vector<std::string> directories;
+    };
+
+    // Lists `path` with as few system calls as the kernel allows: each getdents64 returns as many
+    // entries as fit in the buffer, and their types come with them on most file systems.
+    static bool listDirectory(const std::string &path, Listing &listing) {
+        int fd = open(path.c_str(), O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+        if (fd < 0) {
+            return false;
+        }
+        if (!ClassFileStamp::ofDescriptor(fd, listing.stamp)) {
+            close(fd);
+            return false;
+        }
+        constexpr size_t BufferSize = 64 * 1024;
+        auto buffer = std::make_unique<uint64_t[]>(BufferSize / sizeof(uint64_t));
+        auto bytes = reinterpret_cast<char *>(buffer.get());
+        while (true) {
+            auto n = syscall(SYS_getdents64, fd, bytes, BufferSize);
+            if (n < 0 && errno == EINTR) {
+                continue;
+            }
+            if (n <= 0) {
+                break;
+            }
+            for (long offset = 0; offset < n;) {
+                auto entry = reinterpret_cast<const struct dirent64 *>(bytes + offset);
+                offset += entry->d_reclen;
+                const char *name = entry->d_name;
+                if (name[0] == '.' && (name[1] == '\0' || (name[1] == '.' && name[2] == '\0'))) {
+                    continue;
+                }
+                auto type = entry->d_type;
+                if (type == DT_UNKNOWN || type == DT_LNK) {
+                    struct stat status{};
+                    if (fstatat(fd, name, &status, 0) != 0) {
+                        continue;
+                    }
+                    type = S_ISDIR(status.st_mode) ? DT_DIR : S_ISREG(status.st_mode) ? DT_REG : DT_UNKNOWN;
+                }
+                auto length = strlen(name);
+                if (type == DT_DIR) {
+                    listing.directories.emplace_back(name, length);
+                } else if (type == DT_REG && length > 6 && memcmp(name + length - 6, ".class", 6) == 0) {
+                    listing.classes.emplace_back(name, length - 6);
+                }
+            }
+        }
+        close(fd);
+        return true;
+    }
+
+    static std::string directoryPath(const std::string &root, const std::string &relative) {
+        if (relative.empty()) {
+            return root;
+        }
+        return root.empty() || root.back() == '/' ? root + relative : root + '/' + relative;
+    }
+
+    std::unique_ptr<ClassPathIndex> ClassPathIndex::build(const std::vector<std::string> &roots, size_t threadCount) {
+        if (roots.size() > MaxRoots) {
+            throw Error("Too many class path entries to index: " + std::to_string(roots.size()));
+        }
+        std::unique_ptr<ClassPathIndex> index(new ClassPathIndex(roots));
+        ThreadPool pool(threadCount);
+
+        // Breadth first: the directories of one level are listed in parallel, then merged in order.
+        struct Pending {
+            uint16_t root;
+            std::string relative;   // empty, or ends with '/'
+        };
+        std::vector<Pending> level;
+        for (size_t i = 0; i < roots.size(); ++i) {
+            level.push_back({static_cast<uint16_t>(i), ""});
+        }
+        std::set<std::tuple<uint16_t, uint64_t, uint64_t>> visited;     // symbolic links may loop
+        while (!level.empty()) {
+            std::vector<Listing> listings(level.size());
+            std::unique_ptr<bool[]> listed(new bool[level.size()]);
+            pool.parallelFor(level.size(), [&](size_t i) {
+                listed[i] = listDirectory(directoryPath(roots[level[i].root], level[i].relative), listings[i]);
+            });
+            std::vector<Pending> next;
+            for (size_t i = 0; i < level.size(); ++i) {
+                auto &pending = level[i];
+                auto &listing = listings[i];
+                auto path = directoryPath(roots[pending.root], pending.relative);
+                if (!listed[i]) {
+                    // A root that is missing or a file (a jimage) is remembered with its stamp, so that a
+                    // snapshot is not used once it changes.
+                    if (pending.relative.empty()) {
+                        ClassFileStamp stamp;
+                        if (!ClassFileStamp::of(path, stamp)) {
+                            stamp = {};
+                        }
+                        index->directories.push_back({std::move(path), stamp});
+                    }
+                    continue;
+                }
+                if (!visited.emplace(pending.root, listing.stamp.device, listing.stamp.inode).second) {
+                    continue;
+                }
+                index->directories.push_back({std::move(path), listing.stamp});
+                for (auto &name : listing.classes) {
+                    index->add(pending.relative + name, pending.root);
+                }
+                for (auto &name : listing.directories) {
+                    next.push_back({pending.root, pending.relative + name + '/'});
+                }
+            }
+            level = std::move(next);
+        }
+        return index;
+    }
+
+    void ClassPathIndex::add(std::string_view name, uint16_t root) {
+        auto it = classes.find(name);
+        if (it == classes.end()) {
+            classes.emplace(store(name), root);
+        } else if (root < it->second) {
+            it->second = root;
+        }
+    }
+
+    std::string_view ClassPathIndex::store(std::string_view name) {
+        CCW_ASSERT(!name.empty());
+        if (ChunkSize - chunkUsed < name.size()) {
+            chunks.emplace_back(new char[std::max(ChunkSize, name.size())]);
+            chunkUsed = 0;
+        }
+        auto copy = chunks.back().get() + chunkUsed;
+        memcpy(copy, name.data(), name.size());
+        chunkUsed = std::min(chunkUsed + name.size(), ChunkSize);
+        return {copy, name.size()};
+    }
+
+    int ClassPathIndex::find(std::string_view name) const {
+        auto it = classes.find(name);
+        return it == classes.end() ? NotFound : it->second;
+    }
+
+    bool ClassPathIndex::save(const std::string &path) const {
+        std::ofstream f(path, std::ios::binary | std::ios::trunc);
+        if (!f.is_open()) {
+            return false;
+        }
+        auto writeU32 = [&f](uint32_t value) {
+            f.write(reinterpret_cast<const char *>(&value), sizeof(value));
+        };
+        auto writeString = [&f, &writeU32](std::string_view value) {
+            writeU32(static_cast<uint32_t>(value.size()));
+            f.write(value.data(), static_cast<std::streamsize>(value.size()));
+        };
+        f.write(SnapshotMagic, sizeof(SnapshotMagic));
+        writeU32(static_cast<uint32_t>(roots.size()));
+        for (auto &root : roots) {
+            writeString(root);
+        }
+        writeU32(static_cast<uint32_t>(directories.size()));
+        for (auto &directory : directories) {
+            writeString(directory.path);
+            f.write(reinterpret_cast<const char *>(&directory.stamp), sizeof(directory.stamp));
+        }
+        writeU32(static_cast<uint32_t>(classes.size()));
+        for (auto &entry : classes) {
+            writeU32(entry.second);
+            writeString(entry.first);
+        }
+        return static_cast<bool>(f);
+    }
+
+    std::unique_ptr<ClassPathIndex> ClassPathIndex::load(const std::string &path, const std::vector<std::string> &roots,
+                                                         size_t threadCount) {
+        std::ifstream f(path, std::ios::binary);
+        if (!f.is_open()) {
+            return nullptr;
+        }
+        auto readU32 = [&f]() {
+            uint32_t value = 0;
+            f.read(reinterpret_cast<char *>(&value), sizeof(value));
+            return value;
+        };
+        std::string name;
+        auto readString = [&f, &readU32, &name]() -> bool {
+            auto length = readU32();
+            if (!f || length > MaxSnapshotName) {
+                return false;
+            }
+            name.resize(length);
+            f.read(name.data(), length);
+            return static_cast<bool>(f);
+        };
+
+        char magic[sizeof(SnapshotMagic)];
+        f.read(magic, sizeof(magic));
+        if (!f || memcmp(magic, SnapshotMagic, sizeof(magic)) != 0 || roots.size() > MaxRoots
+            || readU32() != roots.size()) {
+            return nullptr;
+        }
+        for (auto &root : roots) {
+            if (!readString() || name != root) {
+                return nullptr;
+            }
+        }
+        std::unique_ptr<ClassPathIndex> index(new ClassPathIndex(roots));
+        auto count = readU32();
+        if (!f || count > MaxSnapshotEntries) {
+            return nullptr;
+        }
+        index->directories.resize(count);
+        for (auto &directory : index->directories) {
+            if (!readString()) {
+                return nullptr;
+            }
+            directory.path = name;
+            f.read(reinterpret_cast<char *>(&directory.stamp), sizeof(directory.stamp));
+        }
+        count = readU32();
+        if (!f || count > MaxSnapshotEntries) {
+            return nullptr;
+        }
+        index->classes.reserve(count);
+        for (uint32_t i = 0; i < count; ++i) {
+            auto root = readU32();
+            if (!readString() || root >= roots.size() || name.empty()) {
+                return nullptr;
+            }
+            index->add(name, static_cast<uint16_t>(root));
+        }
+
+        // Adding, removing or renaming an entry changes the modification time of its directory.
+        std::atomic<bool> changed{false};
+        ThreadPool pool(threadCount);
+        pool.parallelFor(index->directories.size(), [&](size_t i) {
+            auto &directory = index->directories[i];
+            ClassFileStamp stamp;
+            if (!ClassFileStamp::of(directory.path, stamp)) {
+                stamp = {};
+            }
+            if (!(stamp == directory.stamp)) {
+                changed.store(true, std::memory_order_relaxed);
+            }
+        });
+        if (changed) {
+            return nullptr;
+        }
+        index->fromSnapshot = true;
+        return index;
+    }
+}
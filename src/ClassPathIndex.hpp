@@ -0,0 +1,82 @@
+#pragma once
+
+#include "SharedClassTable.hpp"
+
+#include <CCW/Base.hpp>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+namespace CCW::Tula {
+
+    // Every class file under a list of class path directories, by class name. Built once by listing
+    // the directories, in parallel and with large getdents64 batches, so that finding a class is a
+    // hash lookup and a missing class costs no system call at all.
+    //
+    // The index is a snapshot of the directories: classes added later are not in it. It can be saved
+    // and loaded again while none of its directories changed, which stat() tells by their stamps.
+    class ClassPathIndex : public Noncopyable {
+    public:
+        static constexpr int NotFound = -1;
+        static constexpr size_t MaxRoots = size_t(UINT16_MAX) + 1;
+
+        // Lists `roots` and everything below them with `threadCount` threads, 0 meaning one per
+        // hardware thread. Directories that can't be read are left out. Throws Error with more than
+        // MaxRoots roots.
+        static std::unique_ptr<ClassPathIndex> build(const std::vector<std::string> &roots, size_t threadCount = 0);
+
+        // The index saved at `path`, when it was built for `roots` and none of its directories changed
+        // since; null otherwise, and for snapshots that are malformed.
+        static std::unique_ptr<ClassPathIndex> load(const std::string &path, const std::vector<std::string> &roots,
+                                                    size_t threadCount = 0);
+
+        bool save(const std::string &path) const;
+
+        // The index in getRoots() of the first root holding class `name` (internal form), or NotFound.
+        [[nodiscard]] int find(std::string_view name) const;
+
+        [[nodiscard]] inline const std::vector<std::string> &getRoots() const {
+            return roots;
+        }
+
+        [[nodiscard]] inline size_t getClassCount() const {
+            return classes.size();
+        }
+
+        [[nodiscard]] inline size_t getDirectoryCount() const {
+            return directories.size();
+        }
+
+        [[nodiscard]] inline bool isLoadedFromSnapshot() const {
+            return fromSnapshot;
+        }
+
+    private:
+        struct Directory {
+            std::string path;
+            ClassFileStamp stamp;
+        };
+
+        explicit ClassPathIndex(std::vector<std::string> roots) : roots(std::move(roots)) {
+        }
+
+        // Adds `name` unless an earlier root has it.
+        void add(std::string_view name, uint16_t root);
+
+        // A copy of `name` that lives as long as the index; `name` is not empty.
+        std::string_view store(std::string_view name);
+
+    private:
+        static constexpr size_t ChunkSize = 64 * 1024;
+
+        std::vector<std::string> roots;
+        std::vector<Directory> directories;
+        std::unordered_map<std::string_view, uint16_t> classes;
+        std::vector<std::unique_ptr<char[]>> chunks;
+        size_t chunkUsed = ChunkSize;
+        bool fromSnapshot = false;
+    };
+}
@@ -0,0 +1,174 @@
+#include "ClassPreloader.hpp"
+#include "ClazzLoader.hpp"
+#include "Error.hpp"
+#include "Isolate.hpp"
+#include "tula/VM.hpp"
+
+#include <algorithm>
+#include <fstream>
+
+namespace CCW::Tula {
+
+    std::vector<std::string> ClassPreloader::readOrder(const std::string &path) {
+        std::vector<std::string> names;
+        std::ifstream in(path);
+        std::string line;
+        while (std::getline(in, line)) {
+            if (!line.empty() && line.back() == '\r') {
+                line.pop_back();
+            }
+            if (!line.empty() && line[0] != '#') {
+                names.push_back(std::move(line));
+            }
+        }
+        return names;
+    }
+
+    void ClassPreloader::writeOrder(const std::string &path, const std::vector<Klass::Ptr> &classes) {
+        std::ofstream out(path, std::ios::trunc);
+        out << "# Class load order, first use first\n";
+        for (auto &klass : classes) {
+            out << klass->name()->toString() << '\n';
+        }
+        if (!out) {
+            throw Error("Can't write class load order " + path);
+        }
+    }
+
+    static std::vector<SymbolPtr> bounded(std::vector<SymbolPtr> names) {
+        if (names.size() > ClassPreloader::MaxClasses) {
+            names.resize(ClassPreloader::MaxClasses);
+        }
+        return names;
+    }
+
+    ClassPreloader::ClassPreloader(BootstrapClassLoader &loader, std::vector<SymbolPtr> names, size_t threadCount,
+                                   BatchFileReader::Backend backend) :
+        loader(loader), isolate(loader.vm != nullptr ? loader.vm->getIsolate() : Isolate::current()),
+        names(bounded(std::move(names))), files(BatchFileReader::create(backend)) {
+        if (files == nullptr) {
+            files = BatchFileReader::create(BatchFileReader::Backend::Threads);
+        }
+        if (threadCount == 0) {
+            threadCount = std::max(2u, std::thread::hardware_concurrency()) - 1;
+        }
+        stats.listed = this->names.size();
+        // Classes in a jimage have no file of their own; the loader maps them from the image on use.
+        size_t kept = 0;
+        paths.reserve(this->names.size());
+        for (auto &name : this->names) {
+            auto path = loader.classFilePath(name);
+            if (path.empty()) {
+                stats.inImages++;
+                continue;
+            }
+            this->names[kept++] = name;
+            paths.push_back(std::move(path));
+        }
+        this->names.resize(kept);
+        if (this->names.empty()) {
+            return;
+        }
+        pool = std::make_unique<ThreadPool>(threadCount);
+        reader = std::thread([this] { read(); });
+    }
+
+    ClassPreloader::~ClassPreloader() {
+        stop();
+    }
+
+    void ClassPreloader::read() {
+        try {
+            files->readAll(paths, [this](FileRead &&read) {
+                if (stopping.load(std::memory_order_relaxed)) {
+                    return;
+                }
+                auto file = std::make_shared<FileRead>(std::move(read));
+                {
+                    std::lock_guard<std::mutex> _{mutex};
+                    parsing++;
+                }
+                pool->submit([this, file] {
+                    // Pool threads have no VM current; the classes are defined for the loader's.
+                    Isolate::Scope isolate(this->isolate);
+                    parse(*file);
+                    std::lock_guard<std::mutex> _{mutex};
+                    if (--parsing == 0) {
+                        parsed.notify_all();
+                    }
+                });
+            });
+        } catch (...) {
+            // The classes not read yet are loaded the usual way.
+        }
+    }
+
+    void ClassPreloader::parse(const FileRead &read) {
+        if (stopping.load(std::memory_order_relaxed)) {
+            return;
+        }
+        auto &name = names[read.index];
+        if (loader.findDefinedKlass(name) != nullptr) {
+            return;
+        }
+        Klass::Ptr klass;
+        bool verified = loader.verifier != nullptr;
+        if (read.error == 0) {
+            try {
+                klass = loader.defineClass(paths[read.index], read.stamp, read.data.get(), read.size);
+            } catch (...) {
+                // Dropped; loading it the usual way reports the failure to the program.
+                klass = nullptr;
+            }
+        }
+        // The program may have got there first; then this parse was for nothing.
+        bool wanted = klass != nullptr && loader.findDefinedKlass(name) == nullptr;
+        std::lock_guard<std::mutex> _{mutex};
+        if (klass == nullptr) {
+            stats.failed++;
+        } else if (wanted && !stopping.load(std::memory_order_relaxed)) {
+            classes.emplace(name.get(), Preloaded{std::move(klass), verified});
+            stats.preloaded++;
+        }
+    }
+
+    Klass::Ptr ClassPreloader::take(const SymbolPtr &name, bool verified) {
+        std::lock_guard<std::mutex> _{mutex};
+        auto it = classes.find(name.get());
+        if (it == classes.end()) {
+            return nullptr;
+        }
+        auto preloaded = std::move(it->second);
+        classes.erase(it);
+        if (verified && !preloaded.verified) {
+            return nullptr;
+        }
+        stats.taken++;
+        return preloaded.klass;
+    }
+
+    void ClassPreloader::wait() {
+        if (reader.joinable()) {
+            reader.join();
+        }
+        std::unique_lock<std::mutex> lock{mutex};
+        parsed.wait(lock, [this] { return parsing == 0; });
+    }
+
+    void ClassPreloader::stop() {
+        stopping = true;
+        files->cancel();
+        if (reader.joinable()) {
+            reader.join();
+        }
+        // Parsing tasks still queued return right away.
+        pool.reset();
+        std::lock_guard<std::mutex> _{mutex};
+        classes.clear();
+    }
+
+    ClassPreloader::Stats ClassPreloader::getStats() const {
+        std::lock_guard<std::mutex> _{mutex};
+        return stats;
+    }
+}
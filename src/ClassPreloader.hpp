@@ -0,0 +1,105 @@
+#pragma once
+
+#include "Klass.hpp"
+#include "Symbol.hpp"
+#include "io/BatchFileReader.hpp"
+#include "utils/ThreadPool.hpp"
+
+#include <CCW/Base.hpp>
+#include <atomic>
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+namespace CCW::Tula {
+
+    class BootstrapClassLoader;
+
+    // Reads and parses, on background threads, the classes a previous run loaded, in the order it
+    // asked for them, so that the program finds them loaded when it gets there.
+    //
+    // One thread reads the class files in batches through a BatchFileReader, so that on a cold page
+    // cache many reads wait on the disk at once; each file is handed to the parsing threads as soon
+    // as it is in.
+    //
+    // Preloaded classes are held here until the loader takes them over on first use; until then they
+    // are neither linked nor initialized. A class the program never asks for is dropped with its map
+    // entry, but its constant pool and methods stay in the loader's metaspace until the loader goes,
+    // so a stale order costs memory as well as parsing. Only the first MaxClasses names of an order
+    // are preloaded, which bounds that cost.
+    class ClassPreloader : public Noncopyable {
+    public:
+        static constexpr size_t MaxClasses = 16384;
+
+        struct Stats {
+            size_t listed = 0;      // names preloaded from, at most MaxClasses
+            size_t inImages = 0;    // listed names found in a jimage, left to the usual load
+            size_t preloaded = 0;
+            size_t taken = 0;       // preloaded classes the program asked for
+            size_t failed = 0;      // missing or rejected; the program gets the error when it loads them
+        };
+
+        // Reads a class load order written by writeOrder(): one internal class name per line, lines
+        // starting with '#' ignored. Empty when `path` can't be read.
+        static std::vector<std::string> readOrder(const std::string &path);
+
+        // Throws Error when `path` can't be written.
+        static void writeOrder(const std::string &path, const std::vector<Klass::Ptr> &classes);
+
+        // 0 threads means one parsing thread per hardware thread but one, which is left to the program.
+        // Names past MaxClasses are loaded the usual way.
+        ClassPreloader(BootstrapClassLoader &loader, std::vector<SymbolPtr> names, size_t threadCount = 0,
+                       BatchFileReader::Backend backend = BatchFileReader::Backend::Auto);
+
+        // Stops preloading and drops the classes nobody took.
+        ~ClassPreloader();
+
+        // The preloaded class `name`, handed out once, or null. An unverified class is not handed out
+        // when `verified` is requested.
+        Klass::Ptr take(const SymbolPtr &name, bool verified);
+
+        // Waits until the whole list was preloaded.
+        void wait();
+
+        // Skips the classes not preloaded yet, waits for the ones being parsed and drops those nobody
+        // took. take() returns null afterwards.
+        void stop();
+
+        [[nodiscard]] Stats getStats() const;
+
+        [[nodiscard]] inline BatchFileReader::Backend getBackend() const {
+            return files->getBackend();
+        }
+
+    private:
+        void read();
+
+        void parse(const FileRead &read);
+
+        struct Preloaded {
+            Klass::Ptr klass;
+            bool verified;
+        };
+
+    private:
+        BootstrapClassLoader &loader;
+        const uint32_t isolate;
+        std::vector<SymbolPtr> names;  // the listed names read from files, in order
+        std::vector<std::string> paths;
+        std::atomic<bool> stopping{false};
+
+        mutable std::mutex mutex;
+        std::condition_variable parsed;
+        std::unordered_map<const Symbol *, Preloaded> classes;
+        size_t parsing = 0;     // files read and not parsed yet
+        Stats stats;
+
+        std::unique_ptr<BatchFileReader> files;
+        std::unique_ptr<ThreadPool> pool;
+        std::thread reader;
+    };
+}
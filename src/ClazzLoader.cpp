@@ -1,45 +1,460 @@
 #include "ClazzLoader.hpp"
 #include "classfile/ClassFileParser.hpp"
 #include "Error.hpp"
+#include "MemoryTracker.hpp"
+#include "SharedClassTable.hpp"
+#include "SymbolTable.hpp"
+#include "events/EventRecorder.hpp"
 
+#include <algorithm>
 #include <fstream>
+#include <sys/stat.h>
 #include <utility>
 
 namespace CCW::Tula {
 
-    BootstrapClassLoader::BootstrapClassLoader(VM *vm, std::string libPath) : vm(vm), libPath(std::move(libPath)) {}
+    static std::vector<std::string> splitClassPath(const std::string &libPath) {
+        std::vector<std::string> roots;
+        size_t start = 0;
+        while (true) {
+            auto end = libPath.find(':', start);
+            roots.push_back(libPath.substr(start, end - start));
+            if (end == std::string::npos) {
+                return roots;
+            }
+            start = end + 1;
+        }
+    }
+
+    static std::string filePathIn(const std::string &root, std::string_view className) {
+        auto path = root;
+        if (!path.empty() && path.back() != '/') {
+            path += '/';
+        }
+        return path.append(className).append(".class");
+    }
+
+    BootstrapClassLoader::BootstrapClassLoader(VM *vm, std::string libPath) : vm(vm), libPath(std::move(libPath)),
+                                                                              classPath(splitClassPath(this->libPath)),
+                                                                              negativeCache(classPath) {
+        MemoryTracker::allocate(MemoryTag::ClassLoaders, sizeof(BootstrapClassLoader));
+        for (auto &root : classPath) {
+            struct stat status{};
+            if (stat(root.c_str(), &status) == 0 && S_ISREG(status.st_mode)) {
+                images.push_back(std::make_unique<JImage>(root));
+            } else {
+                images.emplace_back();
+                hasDirectories = true;
+            }
+        }
+    }
+
+    // A node of the name index, roughly.
+    static constexpr size_t LoadedEntrySize = sizeof(void *) * 2 + sizeof(std::pair<const Symbol *, Klass::Ptr>);
+
+    BootstrapClassLoader::~BootstrapClassLoader() {
+        stopPreloading();
+        MemoryTracker::release(MemoryTag::ClassLoaders,
+                               sizeof(BootstrapClassLoader) + loadedClazzs.capacity() * sizeof(Klass::Ptr)
+                               + loadedByName.size() * LoadedEntrySize);
+    }
+
+    std::vector<Klass::Ptr> BootstrapClassLoader::getLoadedClasses() {
+        std::shared_lock<std::shared_timed_mutex> _{clazzMutex};
+        return loadedClazzs;
+    }
 
     Klass::Ptr BootstrapClassLoader::defineClass(const std::string &clazzPath) {
-        std::fstream f(clazzPath);
-        if (!f.is_open()) {
-            // TODO throw class not found
-            return nullptr;
+        auto klass = defineIfPresent(clazzPath);
+        if (klass == nullptr) {
+            throw NoClassDefFoundError("No class file at " + clazzPath);
+        }
+        return klass;
+    }
+
+    Klass::Ptr BootstrapClassLoader::defineIfPresent(const std::string &clazzPath, bool share) {
+        EventScope event(EventType::DefineClass, [&clazzPath] { return clazzPath; });
+        ClassFileStamp stamp;
+        std::fstream f;
+        {
+            EventScope openEvent(EventType::FileOpen);
+            if (!ClassFileStamp::of(clazzPath, stamp)) {
+                return nullptr;
+            }
+            // Another VM of the process may have parsed the same file already.
+            if (share) {
+                if (auto shared = SharedClassTable::find(clazzPath, stamp, verifier != nullptr)) {
+                    return shared;
+                }
+            }
+            f.open(clazzPath, std::ios::in | std::ios::binary);
+            if (!f.is_open()) {
+                return nullptr;
+            }
+        }
+        size_t size;
+        std::unique_ptr<uint8_t[]> buffer;
+        {
+            EventScope readEvent(EventType::FileRead);
+            f.seekg(0, std::ios::end);
+            size = f.tellg();
+            buffer = std::make_unique<uint8_t[]>(size);
+            f.seekg(0);
+            f.read(reinterpret_cast<char *>(buffer.get()), size);
+            readEvent.setValue(size);
+        }
+        event.setValue(size);
+        return defineParsed(clazzPath, stamp, buffer.get(), size, share);
+    }
+
+    Klass::Ptr BootstrapClassLoader::defineClass(const std::string &clazzPath, const ClassFileStamp &stamp,
+                                                 const uint8_t *bytes, size_t size) {
+        EventScope event(EventType::DefineClass, [&clazzPath] { return clazzPath; });
+        event.setValue(size);
+        if (auto shared = SharedClassTable::find(clazzPath, stamp, verifier != nullptr)) {
+            return shared;
         }
-        f.seekg(0, std::ios::end);
-        size_t size = f.tellg();
-        uint8_t buffer[size];
-        f.seekg(0);
-        f.read(reinterpret_cast<char *>(buffer), size);
-        return ClassFileParser::parse(buffer, size);
+        return defineParsed(clazzPath, stamp, bytes, size);
+    }
+
+    Klass::Ptr BootstrapClassLoader::defineParsed(const std::string &clazzPath, const ClassFileStamp &stamp,
+                                                  const uint8_t *bytes, size_t size, bool share) {
+        auto klass = ClassFileParser::parse(bytes, size, metaspace);
+        if (verifier != nullptr) {
+            EventScope verifyEvent(EventType::Verify);
+            verifier->verify(*std::static_pointer_cast<InstanceKlass>(klass), bytes, size,
+                             [this](const Symbol *target, const Symbol *source) {
+                                 return isAssignable(target, source);
+                             });
+        }
+        std::call_once(intrinsicsOnce, [this] { intrinsics = std::make_unique<IntrinsicRegistry>(); });
+        intrinsics->annotate(*std::static_pointer_cast<InstanceKlass>(klass));
+        return share ? SharedClassTable::insert(clazzPath, stamp, verifier != nullptr, klass) : klass;
+    }
+
+    // Deeper hierarchies are cyclic ones of malformed class files.
+    static constexpr size_t MaxHierarchyDepth = 1024;
+
+    bool BootstrapClassLoader::isAssignable(const Symbol *target, const Symbol *source) {
+        try {
+            auto targetKlass = hierarchyKlass(std::const_pointer_cast<Symbol>(target->shared_from_this()));
+            if (targetKlass == nullptr) {
+                return false;
+            }
+            if (targetKlass->isInterface()) {
+                return true;
+            }
+            auto klass = hierarchyKlass(std::const_pointer_cast<Symbol>(source->shared_from_this()));
+            for (size_t depth = 0; klass != nullptr && depth < MaxHierarchyDepth; ++depth) {
+                const auto &super = klass->getSuperClassName();
+                if (super == nullptr) {
+                    return false;
+                }
+                if (super.get() == target) {
+                    return true;
+                }
+                klass = hierarchyKlass(super);
+            }
+        } catch (const Error &) {
+            // A malformed class file on the way proves nothing.
+        }
+        return false;
+    }
+
+    InstanceKlass::Ptr BootstrapClassLoader::hierarchyKlass(const SymbolPtr &name) {
+        {
+            std::lock_guard<std::mutex> _{hierarchyMutex};
+            auto it = hierarchyKlasses.find(name);
+            if (it != hierarchyKlasses.end()) {
+                return it->second;
+            }
+        }
+        std::string path;
+        JImage::Location location;
+        auto root = locateClass(std::string_view(reinterpret_cast<const char *>(name->getBytes()), name->getLength()),
+                                path, location);
+        Klass::Ptr klass;
+        if (root != ClassPathIndex::NotFound && images[root] != nullptr) {
+            const auto &image = *images[root];
+            klass = SharedClassTable::find(image.getPath() + "!" + image.nameOf(location), image.getStamp(), false);
+            if (klass == nullptr) {
+                auto resource = image.read(location);
+                klass = ClassFileParser::parse(resource.data, resource.size, metaspace);
+            }
+        } else if (root != ClassPathIndex::NotFound) {
+            ClassFileStamp stamp;
+            if (ClassFileStamp::of(path, stamp)) {
+                klass = SharedClassTable::find(path, stamp, false);
+                if (klass == nullptr) {
+                    std::ifstream f(path, std::ios::binary);
+                    std::vector<uint8_t> bytes(stamp.size);
+                    if (f.read(reinterpret_cast<char *>(bytes.data()), bytes.size())) {
+                        klass = ClassFileParser::parse(bytes.data(), bytes.size(), metaspace);
+                    }
+                }
+            }
+        }
+        auto instanceKlass = std::static_pointer_cast<InstanceKlass>(klass);
+        std::lock_guard<std::mutex> _{hierarchyMutex};
+        return hierarchyKlasses.emplace(name, instanceKlass).first->second;
     }
 
     Klass::Ptr BootstrapClassLoader::loadClass(const SymbolPtr &clazz) {
-        return Tula::Klass::Ptr();
+        if (auto loaded = findLoadedKlass(clazz)) {
+            return loaded;
+        }
+        // Probes for missing optional classes are answered here, without waiting for the exclusive lock.
+        if (negativeCache.isAbsent(clazz)) {
+            return nullptr;
+        }
+        // Defining under the exclusive lock keeps a class from being defined twice by racing threads.
+        std::unique_lock<std::shared_timed_mutex> _{clazzMutex};
+        return loadClassLocked(clazz);
+    }
+
+    Klass::Ptr BootstrapClassLoader::loadClassLocked(const SymbolPtr &clazz) {
+        auto it = loadedByName.find(clazz.get());
+        if (it != loadedByName.end()) {
+            return it->second;
+        }
+        auto klass = takePreloaded(clazz);
+        if (klass == nullptr) {
+            klass = findClass(clazz);
+        }
+        if (klass == nullptr && clazz->equals("java/lang/Object")) {
+            // Known by name, but not a class of the class path, so it is left out of the load order.
+            klass = builtinObject();
+            loadedByName.emplace(clazz.get(), klass);
+            MemoryTracker::allocate(MemoryTag::ClassLoaders, LoadedEntrySize, 0);
+            return klass;
+        }
+        return klass == nullptr ? nullptr : addResolved(clazz, klass);
+    }
+
+    Klass::Ptr BootstrapClassLoader::addResolved(const SymbolPtr &clazz, Klass::Ptr klass) {
+        if (!resolveSupers(*std::static_pointer_cast<InstanceKlass>(klass))) {
+            // Shared, but linked against super classes of another class path: this VM gets its own copy.
+            klass = searchClassPath(clazz, false);
+            if (klass == nullptr) {
+                return nullptr;
+            }
+            resolveSupers(*std::static_pointer_cast<InstanceKlass>(klass));
+        }
+        addLoaded(klass);
+        return klass;
+    }
+
+    bool BootstrapClassLoader::resolveSupers(InstanceKlass &klass) {
+        const auto &name = klass.getName();
+        if (std::find(resolving.begin(), resolving.end(), name.get()) != resolving.end()) {
+            throw ClassCircularityError(name->toString());
+        }
+        resolving.push_back(name.get());
+        bool consistent;
+        try {
+            InstanceKlass::Ptr super;
+            if (const auto &superName = klass.getSuperClassName()) {
+                super = std::static_pointer_cast<InstanceKlass>(loadClassLocked(superName));
+                if (super == nullptr) {
+                    throw NoClassDefFoundError(superName->toString());
+                }
+                if (super->isInterface()) {
+                    throw IncompatibleClassChangeError("Class " + name->toString() + " has interface "
+                                                       + superName->toString() + " as super class");
+                }
+            }
+            std::vector<InstanceKlass::Ptr> interfaces;
+            for (const auto &interfaceName : klass.getInterfaceNames()) {
+                auto interface = std::static_pointer_cast<InstanceKlass>(loadClassLocked(interfaceName));
+                if (interface == nullptr) {
+                    throw NoClassDefFoundError(interfaceName->toString());
+                }
+                if (!interface->isInterface()) {
+                    throw IncompatibleClassChangeError("Class " + name->toString() + " implements class "
+                                                       + interfaceName->toString());
+                }
+                interfaces.push_back(std::move(interface));
+            }
+            // Another VM resolved the supers of a shared class first.
+            consistent = klass.resolveSupers(super, interfaces)
+                         || (klass.getSuperKlass() == super && klass.getLocalInterfaces() == interfaces);
+        } catch (...) {
+            resolving.pop_back();
+            throw;
+        }
+        resolving.pop_back();
+        return consistent;
+    }
+
+    Klass::Ptr BootstrapClassLoader::builtinObject() {
+        static std::mutex mutex;
+        static std::weak_ptr<InstanceKlass> shared;
+        std::lock_guard<std::mutex> _{mutex};
+        auto object = shared.lock();
+        if (object == nullptr) {
+            object = std::make_shared<InstanceKlass>(SymbolTable::intern("java/lang/Object"),
+                                                     std::make_shared<ConstantPool>(1),
+                                                     ClassAccessFlags::Public | ClassAccessFlags::Super);
+            object->resolveSupers(nullptr, {});
+            shared = object;
+        }
+        return object;
+    }
+
+    int BootstrapClassLoader::locateClass(std::string_view name, std::string &path, JImage::Location &location) const {
+        auto index = std::atomic_load(&classPathIndex);
+        auto indexed = index == nullptr ? ClassPathIndex::NotFound : index->find(name);
+        for (size_t root = 0; root < classPath.size(); ++root) {
+            if (images[root] != nullptr) {
+                if (images[root]->findClass(name, location)) {
+                    return static_cast<int>(root);
+                }
+                continue;
+            }
+            if (index != nullptr && indexed != static_cast<int>(root)) {
+                continue;
+            }
+            path = filePathIn(classPath[root], name);
+            // The last root is not probed: defining the class stats the file anyway.
+            ClassFileStamp stamp;
+            if (index != nullptr || root + 1 == classPath.size() || ClassFileStamp::of(path, stamp)) {
+                return static_cast<int>(root);
+            }
+        }
+        path.clear();
+        return ClassPathIndex::NotFound;
+    }
+
+    std::string BootstrapClassLoader::classFilePath(const SymbolPtr &clazz) const {
+        std::string path;
+        JImage::Location location;
+        locateClass(std::string_view(reinterpret_cast<const char *>(clazz->getBytes()), clazz->getLength()), path,
+                    location);
+        return path;
     }
 
     Klass::Ptr BootstrapClassLoader::findClass(const SymbolPtr &clazz) {
-        return Tula::Klass::Ptr();
+        return searchClassPath(clazz, true);
+    }
+
+    Klass::Ptr BootstrapClassLoader::searchClassPath(const SymbolPtr &clazz, bool share) {
+        std::string path;
+        JImage::Location location;
+        auto root = locateClass(std::string_view(reinterpret_cast<const char *>(clazz->getBytes()),
+                                                 clazz->getLength()), path, location);
+        Klass::Ptr klass;
+        if (root != ClassPathIndex::NotFound) {
+            klass = images[root] != nullptr ? defineClass(*images[root], location, share)
+                                            : defineIfPresent(path, share);
+        }
+        if (klass != nullptr) {
+            return klass;
+        }
+        if (std::atomic_load(&classPathIndex) != nullptr || !hasDirectories) {
+            // Answered without a system call; remembering the absence would stat directories.
+            negativeCache.countMiss(clazz);
+        } else {
+            negativeCache.recordAbsent(clazz);
+        }
+        return nullptr;
+    }
+
+    Klass::Ptr BootstrapClassLoader::defineClass(const JImage &image, const JImage::Location &location, bool share) {
+        // Named like a jar entry, so classes of the same image are shared by the VMs of the process.
+        auto clazzPath = image.getPath() + "!" + image.nameOf(location);
+        EventScope event(EventType::DefineClass, [&clazzPath] { return clazzPath; });
+        if (share) {
+            if (auto shared = SharedClassTable::find(clazzPath, image.getStamp(), verifier != nullptr)) {
+                return shared;
+            }
+        }
+        JImageResource resource;
+        {
+            EventScope readEvent(EventType::FileRead);
+            resource = image.read(location);
+            readEvent.setValue(resource.size);
+        }
+        event.setValue(resource.size);
+        return defineParsed(clazzPath, image.getStamp(), resource.data, resource.size, share);
+    }
+
+    void BootstrapClassLoader::indexClassPath(const std::string &snapshotPath) {
+        std::shared_ptr<const ClassPathIndex> index;
+        if (!snapshotPath.empty()) {
+            index = ClassPathIndex::load(snapshotPath, classPath);
+        }
+        if (index == nullptr) {
+            auto built = ClassPathIndex::build(classPath);
+            if (!snapshotPath.empty()) {
+                built->save(snapshotPath);
+            }
+            index = std::move(built);
+        }
+        classPathSnapshot = snapshotPath;
+        std::atomic_store(&classPathIndex, index);
+    }
+
+    void BootstrapClassLoader::classPathChanged() {
+        if (std::atomic_load(&classPathIndex) != nullptr) {
+            indexClassPath(classPathSnapshot);
+        }
+        negativeCache.invalidate();
     }
 
     Klass::Ptr BootstrapClassLoader::findLoadedKlass(const SymbolPtr &clazz) {
+        {
+            std::shared_lock<std::shared_timed_mutex> _{clazzMutex};
+            auto it = loadedByName.find(clazz.get());
+            if (it != loadedByName.end()) {
+                return it->second;
+            }
+            if (preloader == nullptr) {
+                return nullptr;
+            }
+        }
+        std::unique_lock<std::shared_timed_mutex> _{clazzMutex};
+        auto it = loadedByName.find(clazz.get());
+        if (it != loadedByName.end()) {
+            return it->second;
+        }
+        auto klass = takePreloaded(clazz);
+        return klass == nullptr ? nullptr : addResolved(clazz, klass);
+    }
+
+    Klass::Ptr BootstrapClassLoader::findDefinedKlass(const SymbolPtr &clazz) {
         std::shared_lock<std::shared_timed_mutex> _{clazzMutex};
-        auto it = std::find_if(std::begin(loadedClazzs), std::end(loadedClazzs),
-                               [&clazz](const Klass::Ptr &it) { return it->name() == clazz; });
-        if (it == std::end(loadedClazzs)) {
-            return nullptr;
-        } else {
-            return *it;
+        auto it = loadedByName.find(clazz.get());
+        return it == loadedByName.end() ? nullptr : it->second;
+    }
+
+    Klass::Ptr BootstrapClassLoader::takePreloaded(const SymbolPtr &clazz) {
+        return preloader == nullptr ? nullptr : preloader->take(clazz, verifier != nullptr);
+    }
+
+    void BootstrapClassLoader::addLoaded(const Klass::Ptr &klass) {
+        auto capacity = loadedClazzs.capacity();
+        loadedClazzs.push_back(klass);
+        loadedByName.emplace(klass->name().get(), klass);
+        MemoryTracker::allocate(MemoryTag::ClassLoaders,
+                                (loadedClazzs.capacity() - capacity) * sizeof(Klass::Ptr) + LoadedEntrySize, 0);
+    }
+
+    void BootstrapClassLoader::preload(std::vector<SymbolPtr> names, size_t threadCount,
+                                       BatchFileReader::Backend backend) {
+        stopPreloading();
+        auto started = std::make_unique<ClassPreloader>(*this, std::move(names), threadCount, backend);
+        std::unique_lock<std::shared_timed_mutex> _{clazzMutex};
+        preloader = std::move(started);
+    }
+
+    void BootstrapClassLoader::stopPreloading() {
+        std::unique_ptr<ClassPreloader> stopped;
+        {
+            std::unique_lock<std::shared_timed_mutex> _{clazzMutex};
+            stopped = std::move(preloader);
         }
+        // Outside the lock, which the preloading threads take.
+        stopped.reset();
     }
 
 }
\ No newline at end of file
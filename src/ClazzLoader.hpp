@@ -1,11 +1,19 @@
 #pragma once
 
+#include "ClassPathIndex.hpp"
+#include "ClassPreloader.hpp"
 #include "Klass.hpp"
+#include "Metaspace.hpp"
+#include "NegativeClassCache.hpp"
 #include "Symbol.hpp"
+#include "intrinsics/Intrinsics.hpp"
+#include "io/JImage.hpp"
+#include "verifier/Verifier.hpp"
 
 #include <memory>
 #include <mutex>
 #include <shared_mutex>
+#include <unordered_map>
 #include <vector>
 
 namespace CCW::Tula {
@@ -27,21 +35,156 @@ namespace CCW::Tula {
     public:
         friend class VM;
 
+        // `libPath` lists class path directories and jimages separated by ':'; the first one holding a
+        // class wins. Throws Error when a file of it is not a jimage.
         BootstrapClassLoader(VM *vm, std::string libPath);
 
+        ~BootstrapClassLoader() override;
+
+        // Throws NoClassDefFoundError when there is no class file at `clazzPath`.
         Klass::Ptr defineClass(const std::string &clazzPath) override;
 
+        // Defines the class in `bytes`, read elsewhere from `clazzPath`, whose file had `stamp`.
+        Klass::Ptr defineClass(const std::string &clazzPath, const ClassFileStamp &stamp, const uint8_t *bytes,
+                               size_t size);
+
         Klass::Ptr loadClass(const SymbolPtr &clazz) override;
 
         Klass::Ptr findClass(const SymbolPtr &clazz) override;
 
+        // Loaded classes include preloaded ones, which the loader takes over here.
         Klass::Ptr findLoadedKlass(const SymbolPtr &clazz);
 
+        // A snapshot of the classes loaded so far, in the order they were first asked for.
+        std::vector<Klass::Ptr> getLoadedClasses();
+
+        // Starts loading `names` on background threads; see ClassPreloader. Replaces the preloading
+        // in progress, if any.
+        void preload(std::vector<SymbolPtr> names, size_t threadCount = 0,
+                     BatchFileReader::Backend backend = BatchFileReader::Backend::Auto);
+
+        // Stops preloading and drops the preloaded classes nobody asked for.
+        void stopPreloading();
+
+        // Finds classes through a ClassPathIndex of the class path from now on. With a `snapshotPath`,
+        // the index saved there is used while its directories are unchanged, and saved again otherwise.
+        void indexClassPath(const std::string &snapshotPath = "");
+
+        // Null until indexClassPath().
+        [[nodiscard]] inline std::shared_ptr<const ClassPathIndex> getClassPathIndex() const {
+            return std::atomic_load(&classPathIndex);
+        }
+
+        // Makes classes added to the class path directories visible: forgets the absences and indexes
+        // the class path again when it was indexed.
+        void classPathChanged();
+
+        // Null when not preloading.
+        [[nodiscard]] inline ClassPreloader *getPreloader() const {
+            return preloader.get();
+        }
+
+        // The arena of the classes this loader parses. Each class keeps it alive, so it is freed once
+        // the loader and all of its classes are unreachable.
+        [[nodiscard]] inline const std::shared_ptr<Metaspace> &getMetaspace() const {
+            return metaspace;
+        }
+
+        // Names this loader searched the class path for in vain. Loading one of them again fails without
+        // touching the file system.
+        [[nodiscard]] inline NegativeClassCache &getNegativeCache() {
+            return negativeCache;
+        }
+
+        // Classes defined after this call are verified by `verifier`; null disables verification. Class
+        // types are checked against the hierarchy of the class path, see isAssignable().
+        inline void setVerifier(std::shared_ptr<Verifier> classVerifier) {
+            verifier = std::move(classVerifier);
+        }
+
+    private:
+        friend class ClassPreloader;
+
+        // The first root of the class path holding class `name`, or ClassPathIndex::NotFound. Sets `path`
+        // to its class file when the root is a directory, and `location` when it is a jimage.
+        int locateClass(std::string_view name, std::string &path, JImage::Location &location) const;
+
+        // The file `clazz` is loaded from; empty when there is no such file, or the class is in a jimage.
+        std::string classFilePath(const SymbolPtr &clazz) const;
+
+        // findClass(), taking classes other VMs defined from the same files only when `share` is set.
+        Klass::Ptr searchClassPath(const SymbolPtr &clazz, bool share);
+
+        Klass::Ptr defineClass(const JImage &image, const JImage::Location &location, bool share = true);
+
+        // defineClass() of a file, or null when it is gone, such as one a stale class path index lists.
+        Klass::Ptr defineIfPresent(const std::string &clazzPath, bool share = true);
+
+        // Parses and verifies a class no VM defined from this file yet, and publishes it when `share` is set.
+        Klass::Ptr defineParsed(const std::string &clazzPath, const ClassFileStamp &stamp, const uint8_t *bytes,
+                                size_t size, bool share = true);
+
+        // The subtype check of the verifier: whether `target` is an interface, which the type checker treats
+        // like java/lang/Object, or a super class of `source`. Classes that can't be found are assignable
+        // to nothing.
+        bool isAssignable(const Symbol *target, const Symbol *source);
+
+        // Class `name` as far as hierarchy walks need it: parsed, but neither verified nor loaded, so verifying
+        // one class never defines another. Null when it is not on the class path.
+        InstanceKlass::Ptr hierarchyKlass(const SymbolPtr &name);
+
+        // Only the classes the program asked for, not the preloaded ones.
+        Klass::Ptr findDefinedKlass(const SymbolPtr &clazz);
+
+        // The next ones are called with the write lock held.
+        Klass::Ptr takePreloaded(const SymbolPtr &clazz);
+
+        // loadClass() past the lookups without the lock.
+        Klass::Ptr loadClassLocked(const SymbolPtr &clazz);
+
+        // Loads the super class and interfaces of `klass` as JVMS 5.3.5 does before the class is published:
+        // throws NoClassDefFoundError when one is missing, IncompatibleClassChangeError when the super class
+        // is an interface or an interface is not, and ClassCircularityError when `klass` is its own super.
+        // The supers of a class shared with other VMs are loaded too, so this VM owns them like its other
+        // classes; false when they are not the classes the shared one was linked against.
+        bool resolveSupers(InstanceKlass &klass);
+
+        // Resolves the supers of `klass`, defined or preloaded for `clazz`, and records it as loaded. Returns
+        // the class loaded, a copy of `klass` of its own when its shared supers don't match this VM's.
+        Klass::Ptr addResolved(const SymbolPtr &clazz, Klass::Ptr klass);
+
+        // The java/lang/Object of class paths without the JDK's: no members, so embedders' classes still link.
+        // One for the process, as the classes shared between VMs have it as their super class.
+        static Klass::Ptr builtinObject();
+
+        void addLoaded(const Klass::Ptr &klass);
+
     private:
         VM *vm;
         std::string libPath;
+        std::vector<std::string> classPath;
+        std::vector<std::unique_ptr<JImage>> images;    // by root, null for directories
+        bool hasDirectories = false;
+        std::shared_ptr<Verifier> verifier;
+        std::shared_ptr<Metaspace> metaspace = std::make_shared<Metaspace>();
+        NegativeClassCache negativeCache;
+        std::shared_ptr<const ClassPathIndex> classPathIndex;
+        std::string classPathSnapshot;
+
+        // Built on the first definition, so an idle loader interns no JDK names.
+        std::once_flag intrinsicsOnce;
+        std::unique_ptr<IntrinsicRegistry> intrinsics;
 
         std::shared_timed_mutex clazzMutex;
         std::vector<Klass::Ptr> loadedClazzs;
+        std::unordered_map<const Symbol *, Klass::Ptr> loadedByName;
+        std::vector<const Symbol *> resolving;      // classes whose supers are being loaded
+
+        // Not under clazzMutex: classes are verified while it is held.
+        std::mutex hierarchyMutex;
+        std::unordered_map<SymbolPtr, InstanceKlass::Ptr> hierarchyKlasses;
+
+        // Declared last, so it stops before the members its threads use go.
+        std::unique_ptr<ClassPreloader> preloader;
     };
 }
\ No newline at end of file
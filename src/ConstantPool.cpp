@@ -1,6 +1,8 @@
 #include "ConstantPool.hpp"
+#include "StringTable.hpp"
 
 #include <atomic>
+#include <cstring>
 
 namespace CCW::Tula {
 
@@ -8,14 +10,28 @@ namespace CCW::Tula {
         std::atomic_intptr_t ptr;
     };
 
-    ConstantPool::ConstantPool(uint16_t size) : size(size) {
-        tags = new std::atomic<ConstantType>[size];
-        entities = new intptr_t[size];
+    ConstantPool::ConstantPool(uint16_t size, std::shared_ptr<Metaspace> metaspace) :
+        metaspace(metaspace != nullptr ? std::move(metaspace) : std::make_shared<Metaspace>(4 * 1024)),
+        size(size) {
+        // Index `size` is accepted by isValidIndex(), so allocate one slot more.
+        tags = this->metaspace->createArray<std::atomic<ConstantType>>(MemoryTag::ConstantPools, size + 1);
+        entities = this->metaspace->createArray<intptr_t>(MemoryTag::ConstantPools, size + 1);
+        footprint = sizeof(ConstantPool) + (size + 1) * (sizeof(std::atomic<ConstantType>) + sizeof(intptr_t));
+        MemoryTracker::allocate(MemoryTag::ConstantPools, sizeof(ConstantPool));
     }
 
+    // Tags, entities and the symbol references of the entries belong to the metaspace.
     ConstantPool::~ConstantPool() {
-        delete[] entities;
-        delete[] tags;
+        MemoryTracker::release(MemoryTag::ConstantPools, sizeof(ConstantPool));
+        if (resolvedStrings != nullptr) {
+            MemoryTracker::release(MemoryTag::ConstantPools, stringCount * sizeof(ResolvedString), 0);
+        }
+    }
+
+    template<typename T, typename... Args>
+    T *ConstantPool::createEntry(Args &&... args) {
+        footprint.fetch_add(sizeof(T), std::memory_order_relaxed);
+        return metaspace->create<T>(MemoryTag::ConstantPools, std::forward<Args>(args)...);
     }
 
     void ConstantPool::putTagAt(uint16_t index, ConstantType tag) {
@@ -74,9 +90,37 @@ namespace CCW::Tula {
         return entities[index];
     }
 
-    void ConstantPool::putStringAt(uint16_t index, const SymbolPtr &symbol) {
+    void ConstantPool::putStringAt(uint16_t index, uint16_t utf8Index) {
         putTagAt(index, ConstantType::String);
-        entities[index] = reinterpret_cast<intptr_t>(new SymbolPtr(symbol));
+        entities[index] = static_cast<intptr_t>(((uint32_t) stringCount++) << 16u | utf8Index);
+    }
+
+    const SymbolPtr &ConstantPool::getStringSymbolAt(uint16_t index) {
+        CCW_ASSERT(getTagAt(index) == ConstantType::String);
+        return getSymbolAt(static_cast<uint16_t>(entities[index]));
+    }
+
+    JavaString *ConstantPool::resolveStringAt(uint16_t index) {
+        CCW_ASSERT(getTagAt(index) == ConstantType::String);
+        std::call_once(resolvedStringsOnce, [this] {
+            resolvedStrings.reset(new ResolvedString[stringCount]);
+            footprint.fetch_add(stringCount * sizeof(ResolvedString), std::memory_order_relaxed);
+            MemoryTracker::allocate(MemoryTag::ConstantPools, stringCount * sizeof(ResolvedString), 0);
+        });
+        auto &slot = resolvedStrings[((uint32_t) entities[index]) >> 16u];
+        auto resolved = slot.string.load(std::memory_order_acquire);
+        if (resolved == nullptr) {
+            // Racing threads intern the same text and get the same canonical string; the first one keeps it.
+            auto interned = StringTable::intern(getStringSymbolAt(index).get());
+            std::lock_guard<std::mutex> _{resolveMutex};
+            resolved = slot.string.load(std::memory_order_relaxed);
+            if (resolved == nullptr) {
+                slot.owner = std::move(interned);
+                resolved = slot.owner.get();
+                slot.string.store(resolved, std::memory_order_release);
+            }
+        }
+        return resolved;
     }
 
     void ConstantPool::putIntegerAt(uint16_t index, jint value) {
@@ -91,13 +135,17 @@ namespace CCW::Tula {
 
     void ConstantPool::putFloatAt(uint16_t index, jfloat value) {
         putTagAt(index, ConstantType::Float);
-        entities[index] = *reinterpret_cast<intptr_t *>(&value);
-
+        uint32_t bits;
+        memcpy(&bits, &value, sizeof(bits));
+        entities[index] = bits;
     }
 
     jfloat ConstantPool::getFloatAt(uint16_t index) {
         CCW_ASSERT(getTagAt(index) == ConstantType::Float);
-        return *reinterpret_cast<jfloat *>(entities + index);
+        auto bits = static_cast<uint32_t>(entities[index]);
+        jfloat value;
+        memcpy(&value, &bits, sizeof(value));
+        return value;
     }
 
     void ConstantPool::putLongAt(uint16_t index, jlong value) {
@@ -139,7 +187,7 @@ namespace CCW::Tula {
 
     void ConstantPool::putSymbolAt(uint16_t index, const SymbolPtr &symbol) {
         putTagAt(index, ConstantType::Utf8);
-        entities[index] = reinterpret_cast<intptr_t>(new SymbolPtr(symbol));
+        entities[index] = reinterpret_cast<intptr_t>(createEntry<SymbolPtr>(symbol));
     }
 
     const SymbolPtr &ConstantPool::getSymbolAt(uint16_t index) {
@@ -190,10 +238,25 @@ namespace CCW::Tula {
         return entities[index];
     }
 
+    void ConstantPool::putDynamicAt(uint16_t index, uint16_t bootstrapMethodAttrIndex, uint16_t nameAndTypeIndex) {
+        putTagAt(index, ConstantType::Dynamic);
+        entities[index] = ((uint32_t) bootstrapMethodAttrIndex) << 16u | (uint32_t) nameAndTypeIndex;
+    }
+
+    uint16_t ConstantPool::getDynamicBootstrapMethodAttrIndexAt(uint16_t index) {
+        CCW_ASSERT(getTagAt(index) == ConstantType::Dynamic);
+        return ((uint32_t) entities[index]) >> 16u;
+    }
+
+    uint16_t ConstantPool::getDynamicNameAndTypeIndexAt(uint16_t index) {
+        CCW_ASSERT(getTagAt(index) == ConstantType::Dynamic);
+        return entities[index];
+    }
+
     void ConstantPool::putUnresolvedClassAt(uint16_t index, const SymbolPtr &className) {
         putTagAtRelease(index, ConstantType::UnresolvedClass);
-        auto symbol = new SymbolPtr(className);
-        auto *p = new ClassEntityInternal{};
+        auto symbol = createEntry<SymbolPtr>(className);
+        auto *p = createEntry<ClassEntityInternal>();
         p->ptr.store((intptr_t) symbol, std::memory_order_release);
         entities[index] = reinterpret_cast<intptr_t>(p);
     }
@@ -1,9 +1,12 @@
 #pragma once
 
+#include "JavaString.hpp"
 #include "JVM.hpp"
+#include "Metaspace.hpp"
 #include "Symbol.hpp"
 
 #include <cstdint>
+#include <mutex>
 #include <utility>
 #include <variant>
 
@@ -95,9 +98,11 @@ namespace CCW::Tula {
     };
 
 
+    // Entries live in the metaspace of the defining loader, and are freed with it. A pool created
+    // without one gets a small arena of its own.
     class ConstantPool : public Noncopyable {
     public:
-        explicit ConstantPool(uint16_t size);
+        explicit ConstantPool(uint16_t size, std::shared_ptr<Metaspace> metaspace = nullptr);
 
         [[nodiscard]] inline bool isValidIndex(uint16_t index) const {
             return index > 0 && index <= size;
@@ -139,7 +144,15 @@ namespace CCW::Tula {
 
         uint16_t getStringIndexAt(uint16_t index);
 
-        void putStringAt(uint16_t index, const SymbolPtr &symbol);
+        // A string constant whose text is the Utf8 entry at `utf8Index`, resolved on first ldc.
+        void putStringAt(uint16_t index, uint16_t utf8Index);
+
+        const SymbolPtr &getStringSymbolAt(uint16_t index);
+
+        // The interned java.lang.String of a string constant. It is interned on first use and cached, so
+        // later calls are one acquire load. The pool holds a reference to it, so the string lives as long
+        // as the pool even when VMs sharing the pool destroyed the StringTable it came from.
+        JavaString *resolveStringAt(uint16_t index);
 
         void putIntegerAt(uint16_t index, int32_t value);
 
@@ -183,16 +196,49 @@ namespace CCW::Tula {
 
         uint16_t getInvokeDynamicNameAndTypeIndexAt(uint16_t index);
 
+        void putDynamicAt(uint16_t index, uint16_t bootstrapMethodAttrIndex, uint16_t nameAndTypeIndex);
+
+        uint16_t getDynamicBootstrapMethodAttrIndexAt(uint16_t index);
+
+        uint16_t getDynamicNameAndTypeIndexAt(uint16_t index);
+
         void putUnresolvedClassAt(uint16_t index, const SymbolPtr &className);
 
         virtual ~ConstantPool();
 
         ClassEntity getClassAt(uint16_t index);
 
+        [[nodiscard]] inline Metaspace &getMetaspace() const {
+            return *metaspace;
+        }
+
+        // Bytes taken by the pool: its arrays, entries and resolved string slots.
+        [[nodiscard]] inline size_t getFootprint() const {
+            return footprint.load(std::memory_order_relaxed);
+        }
+
     private:
+        template<typename T, typename... Args>
+        T *createEntry(Args &&... args);
+
+    private:
+        std::shared_ptr<Metaspace> metaspace;
         uint16_t size;
         std::atomic<ConstantType> *tags;
         intptr_t *entities;
+
+        // One slot per string constant, numbered in putStringAt order and allocated on first resolution.
+        // `owner` is set under resolveMutex before `string` is published and never changes afterwards.
+        struct ResolvedString {
+            std::atomic<JavaString *> string{nullptr};
+            JavaString::Ptr owner;
+        };
+        uint16_t stringCount = 0;
+        std::once_flag resolvedStringsOnce;
+        std::unique_ptr<ResolvedString[]> resolvedStrings;
+        std::mutex resolveMutex;
+
+        std::atomic<size_t> footprint{0};
     };
 }
 
@@ -33,4 +33,60 @@ namespace CCW::Tula {
 
         explicit ClassFormatError(const std::string &message) : LinkageError(message) {}
     };
+
+    class UnsupportedClassVersionError : public ClassFormatError {
+    public:
+        UnsupportedClassVersionError() : ClassFormatError() {}
+
+        explicit UnsupportedClassVersionError(const std::string &message) : ClassFormatError(message) {}
+    };
+
+    class VerifyError : public LinkageError {
+    public:
+        VerifyError() : LinkageError() {}
+
+        explicit VerifyError(const std::string &message) : LinkageError(message) {}
+    };
+
+    class NoClassDefFoundError : public LinkageError {
+    public:
+        NoClassDefFoundError() : LinkageError() {}
+
+        explicit NoClassDefFoundError(const std::string &message) : LinkageError(message) {}
+    };
+
+    class ClassCircularityError : public LinkageError {
+    public:
+        ClassCircularityError() : LinkageError() {}
+
+        explicit ClassCircularityError(const std::string &message) : LinkageError(message) {}
+    };
+
+    class ExceptionInInitializerError : public LinkageError {
+    public:
+        ExceptionInInitializerError() : LinkageError() {}
+
+        explicit ExceptionInInitializerError(const std::string &message) : LinkageError(message) {}
+    };
+
+    class UnsatisfiedLinkError : public LinkageError {
+    public:
+        UnsatisfiedLinkError() : LinkageError() {}
+
+        explicit UnsatisfiedLinkError(const std::string &message) : LinkageError(message) {}
+    };
+
+    class IncompatibleClassChangeError : public LinkageError {
+    public:
+        IncompatibleClassChangeError() : LinkageError() {}
+
+        explicit IncompatibleClassChangeError(const std::string &message) : LinkageError(message) {}
+    };
+
+    class NoSuchMethodError : public IncompatibleClassChangeError {
+    public:
+        NoSuchMethodError() : IncompatibleClassChangeError() {}
+
+        explicit NoSuchMethodError(const std::string &message) : IncompatibleClassChangeError(message) {}
+    };
 }
@@ -0,0 +1,54 @@
+#include "Exceptions.hpp"
+#include "SymbolTable.hpp"
+
+#include <utility>
+
+namespace CCW::Tula {
+
+    Throwable::Throwable(SymbolPtr className, std::string message, StackTrace::Ptr backtrace) :
+        className(std::move(className)), message(std::move(message)), backtrace(std::move(backtrace)) {
+    }
+
+    const std::vector<StackTraceElement> &Throwable::getStackTrace() const {
+        static const std::vector<StackTraceElement> empty;
+        return backtrace != nullptr ? backtrace->getElements() : empty;
+    }
+
+    const char *ImplicitExceptions::getClassName(ImplicitException kind) {
+        switch (kind) {
+            case ImplicitException::NullPointer:
+                return "java/lang/NullPointerException";
+            case ImplicitException::ArrayIndexOutOfBounds:
+                return "java/lang/ArrayIndexOutOfBoundsException";
+            case ImplicitException::ArrayStore:
+                return "java/lang/ArrayStoreException";
+            case ImplicitException::ClassCast:
+                return "java/lang/ClassCastException";
+            case ImplicitException::Arithmetic:
+                return "java/lang/ArithmeticException";
+            case ImplicitException::NegativeArraySize:
+                return "java/lang/NegativeArraySizeException";
+        }
+        UNREACHABLE();
+    }
+
+    ImplicitExceptions::ImplicitExceptions(bool fastThrow, uint32_t hotThrowThreshold) :
+        fastThrow(fastThrow), hotThrowThreshold(hotThrowThreshold) {
+        for (size_t i = 0; i < ImplicitExceptionCount; ++i) {
+            classNames[i] = SymbolTable::intern(getClassName(static_cast<ImplicitException>(i)));
+            if (fastThrow) {
+                preallocated[i] = std::make_shared<Throwable>(classNames[i], std::string(), nullptr);
+            }
+        }
+    }
+
+    Throwable::Ptr ImplicitExceptions::create(ImplicitException kind, std::string message,
+                                              const StackFrame *frames, size_t count) {
+        if (fastThrow && count > 0
+            && frames[0].method->isHotThrowSite(frames[0].bci, static_cast<uint8_t>(kind), hotThrowThreshold)) {
+            return preallocated[static_cast<size_t>(kind)];
+        }
+        return std::make_shared<Throwable>(classNames[static_cast<size_t>(kind)], std::move(message),
+                                           StackTrace::capture(frames, count));
+    }
+}
@@ -0,0 +1,86 @@
+#pragma once
+
+#include "StackTrace.hpp"
+#include "Symbol.hpp"
+
+#include <CCW/Base.hpp>
+
+#include <array>
+#include <memory>
+#include <string>
+
+namespace CCW::Tula {
+
+    // Exceptions raised by the VM itself while executing bytecode.
+    enum class ImplicitException : uint8_t {
+        NullPointer,
+        ArrayIndexOutOfBounds,
+        ArrayStore,
+        ClassCast,
+        Arithmetic,
+        NegativeArraySize
+    };
+
+    static constexpr size_t ImplicitExceptionCount = 6;
+
+    // A thrown Java exception: its class, detail message and backtrace.
+    class Throwable : public Noncopyable {
+    public:
+        using Ptr = std::shared_ptr<Throwable>;
+
+        Throwable(SymbolPtr className, std::string message, StackTrace::Ptr backtrace);
+
+        [[nodiscard]] inline const SymbolPtr &getClassName() const {
+            return className;
+        }
+
+        [[nodiscard]] inline const std::string &getMessage() const {
+            return message;
+        }
+
+        // Null for throwables created without a stack trace, such as preallocated ones.
+        [[nodiscard]] inline const StackTrace::Ptr &getBacktrace() const {
+            return backtrace;
+        }
+
+        // Materializes the backtrace on first use; empty without one.
+        const std::vector<StackTraceElement> &getStackTrace() const;
+
+    private:
+        SymbolPtr className;
+        std::string message;
+        StackTrace::Ptr backtrace;
+    };
+
+    // Creates implicit exceptions. With fast throw enabled, a throw site that already raised the same
+    // exception `hotThrowThreshold` times gets a shared preallocated instance, without message and stack
+    // trace, like HotSpot's OmitStackTraceInFastThrow. It is opt-in because the omitted traces make
+    // such failures hard to debug. The throw counts live in the throwing Method, so they go when its
+    // class unloads.
+    class ImplicitExceptions : public Noncopyable {
+    public:
+        static constexpr uint32_t DefaultHotThrowThreshold = 128;
+
+        // Interns the exception class names, so the symbol table must be initialized.
+        explicit ImplicitExceptions(bool fastThrow = false, uint32_t hotThrowThreshold = DefaultHotThrowThreshold);
+
+        static const char *getClassName(ImplicitException kind);
+
+        [[nodiscard]] inline bool isFastThrow() const {
+            return fastThrow;
+        }
+
+        [[nodiscard]] inline const Throwable::Ptr &getPreallocated(ImplicitException kind) const {
+            return preallocated[static_cast<size_t>(kind)];
+        }
+
+        // `frames` is the stack at the throw site, innermost frame first.
+        Throwable::Ptr create(ImplicitException kind, std::string message, const StackFrame *frames, size_t count);
+
+    private:
+        bool fastThrow;
+        uint32_t hotThrowThreshold;
+        std::array<SymbolPtr, ImplicitExceptionCount> classNames;
+        std::array<Throwable::Ptr, ImplicitExceptionCount> preallocated;
+    };
+}
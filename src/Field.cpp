@@ -0,0 +1,15 @@
+#include "Field.hpp"
+
+#include <utility>
+
+namespace CCW::Tula {
+
+    Field::Field(InstanceKlass *holder, SymbolPtr name, SymbolPtr descriptor, FieldAccessFlags accessFlags,
+                 uint16_t constantValueIndex) :
+        holder(holder),
+        fieldName(std::move(name)),
+        fieldDescriptor(std::move(descriptor)),
+        accessFlags(accessFlags),
+        constantValueIndex(constantValueIndex) {
+    }
+}
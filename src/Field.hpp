@@ -0,0 +1,47 @@
+#pragma once
+
+#include "JVM.hpp"
+#include "Symbol.hpp"
+
+namespace CCW::Tula {
+
+    class InstanceKlass;
+
+    class Field : public Noncopyable {
+    public:
+        Field(InstanceKlass *holder, SymbolPtr name, SymbolPtr descriptor, FieldAccessFlags accessFlags,
+              uint16_t constantValueIndex);
+
+        [[nodiscard]] inline InstanceKlass *getHolder() const {
+            return holder;
+        }
+
+        [[nodiscard]] inline const SymbolPtr &name() const {
+            return fieldName;
+        }
+
+        [[nodiscard]] inline const SymbolPtr &descriptor() const {
+            return fieldDescriptor;
+        }
+
+        [[nodiscard]] inline FieldAccessFlags getAccessFlags() const {
+            return accessFlags;
+        }
+
+        [[nodiscard]] inline bool isStatic() const {
+            return accessFlags & FieldAccessFlags::Static;
+        }
+
+        // Constant pool index of the ConstantValue attribute, 0 when absent.
+        [[nodiscard]] inline uint16_t getConstantValueIndex() const {
+            return constantValueIndex;
+        }
+
+    private:
+        InstanceKlass *holder;
+        SymbolPtr fieldName;
+        SymbolPtr fieldDescriptor;
+        FieldAccessFlags accessFlags;
+        uint16_t constantValueIndex;
+    };
+}
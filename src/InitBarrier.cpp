@@ -0,0 +1,19 @@
+#include "InitBarrier.hpp"
+
+namespace CCW::Tula {
+
+    InitBarrier::InitBarrier(InstanceKlass *klass) : klass(klass) {
+        klass->addInitBarrier(this);
+    }
+
+    InitBarrier::~InitBarrier() {
+        klass->removeInitBarrier(this);
+    }
+
+    void InitBarrier::enterSlow(const ClinitRunner &runner) {
+        klass->initialize(runner);
+        if (klass->isInitialized()) {
+            patched.fetch_or(Isolate::currentBit(), std::memory_order_release);
+        }
+    }
+}
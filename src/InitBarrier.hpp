@@ -0,0 +1,50 @@
+#pragma once
+
+#include "Klass.hpp"
+
+#include <atomic>
+
+namespace CCW::Tula {
+
+    // Class initialization barrier of one getstatic, putstatic, invokestatic or new site.
+    // The first execution that finds the class initialized marks the site, and later executions test that
+    // mark instead of calling into the klass. The check itself remains: it is one acquire load of a word
+    // owned by the site, as cheap as the klass's own check but never shared with other sites. Eliding it
+    // entirely takes rewriting the bytecode into a quick form, which needs an interpreter.
+    // A site is never marked while the class is only being initialized by the current thread, so other
+    // threads still block in the slow path until <clinit> completes. Sites of classes shared between VMs
+    // are marked per isolate.
+    class InitBarrier : public Noncopyable {
+    public:
+        explicit InitBarrier(InstanceKlass *klass);
+
+        ~InitBarrier();
+
+        [[nodiscard]] inline InstanceKlass *getKlass() const {
+            return klass;
+        }
+
+        [[nodiscard]] inline bool isPatched() const {
+            return (patched.load(std::memory_order_acquire) & Isolate::currentBit()) != 0;
+        }
+
+        inline void enter(const ClinitRunner &runner) {
+            if (!isPatched()) {
+                enterSlow(runner);
+            }
+        }
+
+    private:
+        friend class InstanceKlass;
+
+        void enterSlow(const ClinitRunner &runner);
+
+        inline void forgetIsolate(uint32_t isolate) {
+            patched.fetch_and(~(uint64_t(1) << isolate), std::memory_order_relaxed);
+        }
+
+    private:
+        InstanceKlass *klass;
+        std::atomic<uint64_t> patched{0};
+    };
+}
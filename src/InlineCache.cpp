@@ -0,0 +1,25 @@
+#include "InlineCache.hpp"
+
+namespace CCW::Tula {
+
+    Method *InlineCache::miss(const InstanceKlass *receiver, Method *target) {
+        if (target == nullptr) {
+            // IncompatibleClassChangeError, never cached
+            return nullptr;
+        }
+        auto current = state.load(std::memory_order_acquire);
+        if (current == State::Clean) {
+            if (state.compare_exchange_strong(current, State::Claimed, std::memory_order_acquire)) {
+                cachedKlass = receiver;
+                cachedTarget = target;
+                state.store(State::Monomorphic, std::memory_order_release);
+                return target;
+            }
+        }
+        if (current == State::Monomorphic && cachedKlass != receiver) {
+            state.store(State::Megamorphic, std::memory_order_release);
+        }
+        // Claimed: another thread is installing its receiver, this call just dispatches through the tables.
+        return target;
+    }
+}
@@ -0,0 +1,55 @@
+#pragma once
+
+#include "Klass.hpp"
+
+#include <atomic>
+
+namespace CCW::Tula {
+
+    // Per call site cache for invokevirtual / invokeinterface.
+    // A site starts clean, caches the first receiver klass and its target (monomorphic), and
+    // falls back to vtable / itable dispatch for good once a second receiver klass shows up.
+    // Transitions only go forward, so a published (klass, target) pair never changes.
+    class InlineCache : public Noncopyable {
+    public:
+        enum class State : uint8_t {
+            Clean,
+            Claimed,        // a thread is filling in the monomorphic entry
+            Monomorphic,
+            Megamorphic
+        };
+
+        explicit InlineCache(const Method *resolved) : resolved(resolved) {}
+
+        [[nodiscard]] inline State getState() const {
+            return state.load(std::memory_order_acquire);
+        }
+
+        [[nodiscard]] inline const Method *getResolvedMethod() const {
+            return resolved;
+        }
+
+        inline Method *invokeVirtual(const InstanceKlass *receiver) {
+            if (getState() == State::Monomorphic && cachedKlass == receiver) {
+                return cachedTarget;
+            }
+            return miss(receiver, receiver->selectVirtual(resolved));
+        }
+
+        inline Method *invokeInterface(const InstanceKlass *receiver) {
+            if (getState() == State::Monomorphic && cachedKlass == receiver) {
+                return cachedTarget;
+            }
+            return miss(receiver, receiver->selectInterface(resolved));
+        }
+
+    private:
+        Method *miss(const InstanceKlass *receiver, Method *target);
+
+    private:
+        const Method *resolved;
+        std::atomic<State> state{State::Clean};
+        const InstanceKlass *cachedKlass = nullptr;
+        Method *cachedTarget = nullptr;
+    };
+}
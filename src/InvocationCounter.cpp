@@ -0,0 +1,26 @@
+#include "InvocationCounter.hpp"
+
+#include <algorithm>
+
+namespace CCW::Tula {
+
+    CompilationPolicy::CompilationPolicy(uint32_t invocationThreshold, uint32_t onStackReplacePercentage) :
+        invocationThreshold(invocationThreshold),
+        backedgeThreshold(static_cast<uint32_t>(
+                              std::min<uint64_t>((uint64_t) invocationThreshold * onStackReplacePercentage / 100,
+                                                 InvocationCounter::CountLimit))) {
+    }
+
+    CompileKind CompilationPolicy::onInvocation(const InvocationCounter &invocations,
+                                                const InvocationCounter &backedges) const {
+        // Loops count towards the method as a whole, so a method with a hot loop compiles sooner.
+        uint64_t total = (uint64_t) invocations.getCount() + backedges.getCount();
+        return total >= invocationThreshold ? CompileKind::Standard : CompileKind::None;
+    }
+
+    CompileKind CompilationPolicy::onBackedge(const InvocationCounter &backedges) const {
+        // Code compiled for the whole method is only entered on the next invocation, which may never come
+        // for a method stuck in its loop; the loop is compiled on its own instead.
+        return backedges.getCount() >= backedgeThreshold ? CompileKind::OSR : CompileKind::None;
+    }
+}
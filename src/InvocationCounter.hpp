@@ -0,0 +1,88 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+
+namespace CCW::Tula {
+
+    // Saturating per-method counter, for the interpreter to bump on method entry and on backward branches.
+    // Increments are racy on purpose (relaxed load + store, no lock prefix): losing a few counts
+    // under contention only delays tiering a little and keeps the hot path cheap.
+    class InvocationCounter {
+    public:
+        static constexpr uint32_t CountLimit = UINT32_MAX >> 1u;
+
+        InvocationCounter() = default;
+
+        InvocationCounter(const InvocationCounter &other) : count(other.getCount()) {}
+
+        InvocationCounter &operator=(const InvocationCounter &other) {
+            count.store(other.getCount(), std::memory_order_relaxed);
+            return *this;
+        }
+
+        [[nodiscard]] inline uint32_t getCount() const {
+            return count.load(std::memory_order_relaxed);
+        }
+
+        // Returns the new count so the caller can compare against its threshold without a second load.
+        inline uint32_t increment() {
+            auto value = count.load(std::memory_order_relaxed);
+            if (value < CountLimit) {
+                count.store(++value, std::memory_order_relaxed);
+            }
+            return value;
+        }
+
+        inline void reset() {
+            count.store(0, std::memory_order_relaxed);
+        }
+
+        // Halves the count, used after a compile request so that a method that cooled down is not retried at once.
+        inline void decay() {
+            count.store(getCount() >> 1u, std::memory_order_relaxed);
+        }
+
+    private:
+        std::atomic<uint32_t> count{0};
+    };
+
+    enum class CompileKind : uint8_t {
+        None,
+        Standard,   // compile the whole method, entered on the next invocation
+        OSR         // compile a loop body, entered mid-execution at a backward branch target
+    };
+
+    // Decides when counters are hot enough to request compilation.
+    // The OSR threshold is expressed as a percentage of the invocation threshold like HotSpot's
+    // OnStackReplacePercentage, so a loop that runs inside a method entered exactly once
+    // (a batch `main`) still gets compiled.
+    class CompilationPolicy {
+    public:
+        static constexpr uint32_t DefaultInvocationThreshold = 10000;
+        static constexpr uint32_t DefaultOnStackReplacePercentage = 140;
+
+        explicit CompilationPolicy(uint32_t invocationThreshold = DefaultInvocationThreshold,
+                                   uint32_t onStackReplacePercentage = DefaultOnStackReplacePercentage);
+
+        [[nodiscard]] uint32_t getInvocationThreshold() const {
+            return invocationThreshold;
+        }
+
+        [[nodiscard]] uint32_t getBackedgeThreshold() const {
+            return backedgeThreshold;
+        }
+
+        // Called on method entry, after `invocations` was incremented.
+        [[nodiscard]] CompileKind onInvocation(const InvocationCounter &invocations,
+                                               const InvocationCounter &backedges) const;
+
+        // Called on a taken backward branch, after `backedges` was incremented. Only ever requests OSR: the
+        // standard compile is left to the next invocation, the first point its code can be entered at.
+        [[nodiscard]] CompileKind onBackedge(const InvocationCounter &backedges) const;
+
+    private:
+        uint32_t invocationThreshold;
+        uint32_t backedgeThreshold;
+    };
+}
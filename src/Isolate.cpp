@@ -0,0 +1,26 @@
+#include "Isolate.hpp"
+#include "Error.hpp"
+
+#include <mutex>
+#include <string>
+
+namespace CCW::Tula {
+
+    static std::mutex gIsolatesLock;
+    static uint64_t gIsolates;
+
+    uint32_t Isolate::allocate() {
+        std::lock_guard<std::mutex> _{gIsolatesLock};
+        if (~gIsolates == 0) {
+            throw Error("Too many VMs: at most " + std::to_string(MaxIsolates) + " can exist at once");
+        }
+        auto isolate = static_cast<uint32_t>(__builtin_ctzll(~gIsolates));
+        gIsolates |= uint64_t(1) << isolate;
+        return isolate;
+    }
+
+    void Isolate::free(uint32_t isolate) {
+        std::lock_guard<std::mutex> _{gIsolatesLock};
+        gIsolates &= ~(uint64_t(1) << isolate);
+    }
+}
@@ -0,0 +1,60 @@
+#pragma once
+
+#include <CCW/Base.hpp>
+
+#include <cstdint>
+
+namespace CCW::Tula {
+
+    // Every VM of the process is an isolate with a small index of its own. Metadata shared between VMs
+    // keeps its per-VM state (class initialization, patched init barriers) in bit sets indexed by it.
+    class Isolate {
+    public:
+        static constexpr uint32_t MaxIsolates = 64;
+        static constexpr uint32_t None = UINT32_MAX;
+
+        // Makes `isolate` current on the calling thread for its lifetime, for threads that work for a VM
+        // without being attached to it, such as those of thread pools.
+        class Scope : public Noncopyable {
+        public:
+            explicit Scope(uint32_t isolate) : previous(tCurrent) {
+                setCurrent(isolate);
+            }
+
+            ~Scope() {
+                setCurrent(previous);
+            }
+
+        private:
+            uint32_t previous;
+        };
+
+        // The index of the VM current on the calling thread, or None on threads no VM was made current
+        // on and that have no Scope.
+        static inline uint32_t current() {
+            return tCurrent;
+        }
+
+        // The bit of current() in per-VM bit sets; 0 for None, so such a thread finds no state of its own.
+        static inline uint64_t currentBit() {
+            return tCurrentBit;
+        }
+
+    private:
+        friend class VM;
+
+        // Returns the lowest free index; throws Error when MaxIsolates VMs exist already.
+        static uint32_t allocate();
+
+        static void free(uint32_t isolate);
+
+        static inline void setCurrent(uint32_t isolate) {
+            tCurrent = isolate;
+            tCurrentBit = isolate < MaxIsolates ? uint64_t(1) << isolate : 0;
+        }
+
+    private:
+        static inline thread_local uint32_t tCurrent = None;
+        static inline thread_local uint64_t tCurrentBit = 0;
+    };
+}
@@ -6,6 +6,7 @@
 namespace CCW::Tula {
 
     typedef unsigned char jboolean;
+    typedef signed char jbyte;
     typedef unsigned short jchar;
     typedef short jshort;
     typedef float jfloat;
@@ -31,7 +32,7 @@ namespace CCW::Tula {
         NameAndType,
         MethodHandle = 15,  // JSR 292
         MethodType = 16,  // JSR 292
-        // (unused)             = 17,  // JSR 292 early drafts only
+        Dynamic = 17,  // JDK 11
                 InvokeDynamic = 18,  // JSR 292
 
 
@@ -76,6 +77,21 @@ namespace CCW::Tula {
         Enum = 0x4000
     };
 
+    enum class MethodAccessFlags : uint32_t {
+        Public = 0x0001,
+        Private = 0x0002,
+        Protected = 0x0004,
+        Static = 0x0008,
+        Final = 0x0010,
+        Synchronized = 0x0020,
+        Bridge = 0x0040,
+        Varargs = 0x0080,
+        Native = 0x0100,
+        Abstract = 0x0400,
+        Strict = 0x0800,
+        Synthetic = 0x1000
+    };
+
     enum class ElementValueTag : char {
         Byte = 'B',
         Char = 'C',
@@ -95,3 +111,4 @@ namespace CCW::Tula {
 
 ENABLE_BITMASK_OPERATORS(CCW::Tula::ClassAccessFlags);
 ENABLE_BITMASK_OPERATORS(CCW::Tula::FieldAccessFlags);
+ENABLE_BITMASK_OPERATORS(CCW::Tula::MethodAccessFlags);
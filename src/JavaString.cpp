@@ -0,0 +1,135 @@
+#include "JavaString.hpp"
+#include "StringDeduplication.hpp"
+#include "intrinsics/Kernels.hpp"
+
+#include <algorithm>
+#include <utility>
+
+namespace CCW::Tula {
+
+    static constexpr jchar ReplacementChar = 0xFFFD;
+
+    JavaString::JavaString(Coder coder, size_t length, Value value) :
+        coder(coder), len(length), value(std::move(value)) {
+    }
+
+    JavaString::Ptr JavaString::make(Coder coder, size_t length, Value value) {
+        Ptr string(new JavaString(coder, length, std::move(value)));
+        StringDeduplication::offer(string);
+        return string;
+    }
+
+    JavaString::Ptr JavaString::fromLatin1(const uint8_t *chars, size_t length) {
+        auto value = std::make_shared<const std::vector<uint8_t>>(chars, chars + length);
+        return make(Coder::Latin1, length, std::move(value));
+    }
+
+    JavaString::Ptr JavaString::fromUtf16(const jchar *chars, size_t length) {
+        bool latin1 = std::all_of(chars, chars + length, [](jchar c) { return c < 0x100; });
+        std::vector<uint8_t> bytes;
+        if (latin1) {
+            bytes.assign(chars, chars + length);
+        } else {
+            bytes.resize(length * 2);
+            memcpy(bytes.data(), chars, length * 2);
+        }
+        auto value = std::make_shared<const std::vector<uint8_t>>(std::move(bytes));
+        return make(latin1 ? Coder::Latin1 : Coder::UTF16, length, std::move(value));
+    }
+
+    JavaString::Ptr JavaString::fromChars(const std::vector<jchar> &chars) {
+        return fromUtf16(chars.data(), chars.size());
+    }
+
+    JavaString::Ptr JavaString::fromModifiedUtf8(const uint8_t *bytes, size_t len) {
+        // Pure ASCII, the common case for class file constants, is already Latin-1.
+        if (std::all_of(bytes, bytes + len, [](uint8_t b) { return b != 0 && b < 0x80; })) {
+            return fromLatin1(bytes, len);
+        }
+        std::vector<jchar> chars;
+        chars.reserve(len);
+        for (size_t i = 0; i < len;) {
+            uint8_t b = bytes[i];
+            if (b < 0x80 && b != 0) {
+                chars.push_back(b);
+                i += 1;
+            } else if ((b & 0xE0u) == 0xC0 && i + 1 < len && (bytes[i + 1] & 0xC0u) == 0x80) {
+                chars.push_back(static_cast<jchar>(((b & 0x1Fu) << 6u) | (bytes[i + 1] & 0x3Fu)));
+                i += 2;
+            } else if ((b & 0xF0u) == 0xE0 && i + 2 < len
+                       && (bytes[i + 1] & 0xC0u) == 0x80 && (bytes[i + 2] & 0xC0u) == 0x80) {
+                chars.push_back(static_cast<jchar>(((b & 0x0Fu) << 12u) | ((bytes[i + 1] & 0x3Fu) << 6u)
+                                                   | (bytes[i + 2] & 0x3Fu)));
+                i += 3;
+            } else {
+                chars.push_back(ReplacementChar);
+                i += 1;
+            }
+        }
+        return fromChars(chars);
+    }
+
+    JavaString::Value JavaString::getValue() const {
+        return std::atomic_load(&value);
+    }
+
+    jchar JavaString::charAt(size_t index) const {
+        CCW_ASSERT(index < len);
+        auto bytes = getValue();
+        if (isLatin1()) {
+            return (*bytes)[index];
+        }
+        jchar c;
+        memcpy(&c, bytes->data() + index * 2, sizeof(c));
+        return c;
+    }
+
+    std::u16string JavaString::toUtf16() const {
+        auto bytes = getValue();
+        std::u16string result(len, u'\0');
+        if (isLatin1()) {
+            std::copy(bytes->begin(), bytes->end(), result.begin());
+        } else {
+            memcpy(&result[0], bytes->data(), len * 2);
+        }
+        return result;
+    }
+
+    jint JavaString::hashCode() const {
+        if (hashComputed.load(std::memory_order_acquire)) {
+            return hash.load(std::memory_order_relaxed);
+        }
+        auto bytes = getValue();
+        auto &kernels = Kernels::get();
+        jint h = isLatin1() ? kernels.hashLatin1(bytes->data(), len)
+                            : kernels.hashUtf16(reinterpret_cast<const jchar *>(bytes->data()), len);
+        // Racing threads compute the same value.
+        hash.store(h, std::memory_order_relaxed);
+        hashComputed.store(true, std::memory_order_release);
+        return h;
+    }
+
+    bool JavaString::equals(const JavaString &other) const {
+        if (this == &other) {
+            return true;
+        }
+        if (coder != other.coder || len != other.len) {
+            return false;
+        }
+        auto lhs = getValue();
+        auto rhs = other.getValue();
+        return lhs == rhs || Kernels::get().equals(lhs->data(), rhs->data(), lhs->size());
+    }
+
+    bool JavaString::replaceValue(const Value &identical) {
+        auto current = getValue();
+        if (current == identical) {
+            return true;
+        }
+        if (*current != *identical) {
+            return false;
+        }
+        std::atomic_store(&value, identical);
+        return true;
+    }
+}
@@ -0,0 +1,85 @@
+#pragma once
+
+#include "JVM.hpp"
+
+#include <CCW/Base.hpp>
+
+#include <atomic>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace CCW::Tula {
+
+    // A java.lang.String value. Unlike Symbol, which holds VM-internal names in modified UTF-8, it holds
+    // Java text with Java identity and equality.
+    //
+    // Text is stored compactly as in JEP 254: one byte per char (Latin-1) when every char is below 0x100,
+    // two bytes per char (UTF-16) otherwise. The coder only depends on the contents, so equal strings
+    // always have equal coders and backing arrays.
+    class JavaString : public Noncopyable {
+    public:
+        enum class Coder : uint8_t {
+            Latin1,
+            UTF16
+        };
+
+        using Ptr = std::shared_ptr<JavaString>;
+
+        // Backing array, shared between strings after deduplication.
+        using Value = std::shared_ptr<const std::vector<uint8_t>>;
+
+        static Ptr fromUtf16(const jchar *chars, size_t length);
+
+        static Ptr fromLatin1(const uint8_t *chars, size_t length);
+
+        // Decodes class file (modified UTF-8) text. Malformed sequences become U+FFFD.
+        static Ptr fromModifiedUtf8(const uint8_t *bytes, size_t len);
+
+        static Ptr fromModifiedUtf8(const char *cstr) {
+            return fromModifiedUtf8(reinterpret_cast<const uint8_t *>(cstr), strlen(cstr));
+        }
+
+        [[nodiscard]] inline Coder getCoder() const {
+            return coder;
+        }
+
+        [[nodiscard]] inline bool isLatin1() const {
+            return coder == Coder::Latin1;
+        }
+
+        // Length in chars.
+        [[nodiscard]] inline size_t length() const {
+            return len;
+        }
+
+        [[nodiscard]] Value getValue() const;
+
+        [[nodiscard]] jchar charAt(size_t index) const;
+
+        [[nodiscard]] std::u16string toUtf16() const;
+
+        // String.hashCode(), computed once.
+        [[nodiscard]] jint hashCode() const;
+
+        [[nodiscard]] bool equals(const JavaString &other) const;
+
+        // Switches to an identical backing array. Returns false, keeping the current one, when it differs.
+        bool replaceValue(const Value &identical);
+
+    private:
+        JavaString(Coder coder, size_t length, Value value);
+
+        static Ptr fromChars(const std::vector<jchar> &chars);
+
+        // Every string is made here, and offered to the deduplication pass of the process.
+        static Ptr make(Coder coder, size_t length, Value value);
+
+    private:
+        Coder coder;
+        size_t len;
+        Value value;    // accessed through std::atomic_load / std::atomic_store
+        mutable std::atomic<jint> hash{0};
+        mutable std::atomic<bool> hashComputed{false};
+    };
+}
@@ -0,0 +1,52 @@
+#include "JavaThread.hpp"
+
+#include <array>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <memory>
+
+namespace CCW::Tula {
+
+    // Slots of the JNI function table up to the last function of current JDKs; the first four are reserved.
+    static constexpr size_t NativeFunctionCount = 240;
+    static constexpr size_t GetVersionIndex = 4;
+    static constexpr int32_t NativeInterfaceVersion = 0x00150000;   // JNI_VERSION_21
+
+    static int32_t getVersion(void *) {
+        return NativeInterfaceVersion;
+    }
+
+    // The JNI functions are not implemented yet. Natives calling one stop the process, rather than jump
+    // through a table that is not there.
+    static void unsupportedFunction() {
+        fprintf(stderr, "A native method called a JNI function Tula does not implement yet\n");
+        abort();
+    }
+
+    const void *const *JavaThread::nativeFunctions() {
+        static const auto functions = [] {
+            std::array<const void *, NativeFunctionCount> table{};
+            for (size_t i = GetVersionIndex; i < table.size(); ++i) {
+                table[i] = reinterpret_cast<const void *>(unsupportedFunction);
+            }
+            table[GetVersionIndex] = reinterpret_cast<const void *>(getVersion);
+            return table;
+        }();
+        return functions.data();
+    }
+
+    static thread_local std::unique_ptr<JavaThread> tCurrentThread;
+
+    JavaThread *JavaThread::current() {
+        return tCurrentThread.get();
+    }
+
+    void JavaThread::attach(VM *vm) {
+        tCurrentThread.reset(new JavaThread(vm));
+    }
+
+    void JavaThread::detach() {
+        tCurrentThread.reset();
+    }
+}
@@ -0,0 +1,47 @@
+#pragma once
+
+#include <CCW/Base.hpp>
+
+namespace CCW::Tula {
+
+    class VM;
+    class JavaThread;
+
+    // What native methods get as their JNIEnv *: the JNI function table first, as natives dereference it.
+    struct NativeEnv {
+        const void *const *functions;
+        JavaThread *thread;
+    };
+
+    // The VM side of a native thread attached with VM::attachCurrentThread(). Calls into Java are only
+    // made from attached threads; the record lives in thread-local storage until the thread detaches.
+    class JavaThread : public Noncopyable {
+    public:
+        // The record of the calling thread, or null when it is not attached to any VM.
+        static JavaThread *current();
+
+        [[nodiscard]] inline VM *getVM() const {
+            return vm;
+        }
+
+        // Passed to native methods as their JNIEnv *.
+        [[nodiscard]] inline void *getEnv() {
+            return &env;
+        }
+
+    private:
+        friend class VM;
+
+        explicit JavaThread(VM *vm) : vm(vm), env{nativeFunctions(), this} {}
+
+        static const void *const *nativeFunctions();
+
+        static void attach(VM *vm);
+
+        static void detach();
+
+    private:
+        VM *vm;
+        NativeEnv env;
+    };
+}
@@ -1,5 +1,661 @@
 #include "Klass.hpp"
+#include "Error.hpp"
+#include "InitBarrier.hpp"
+#include "MemoryTracker.hpp"
+#include "events/EventRecorder.hpp"
+
+#include <algorithm>
+#include <mutex>
+#include <utility>
 
 namespace CCW::Tula {
 
-}
\ No newline at end of file
+    InstanceKlass::InstanceKlass(SymbolPtr name, std::shared_ptr<ConstantPool> cp, ClassAccessFlags accessFlags) :
+        klassName(std::move(name)), cp(std::move(cp)), accessFlags(accessFlags) {
+        account(sizeof(InstanceKlass));
+        MemoryTracker::record(MemoryTag::Classes, 0, 0, 1);
+    }
+
+    InstanceKlass::~InstanceKlass() {
+        auto bytes = accountedBytes.load(std::memory_order_relaxed);
+        MemoryTracker::record(MemoryTag::Classes, -bytes, -bytes, -1);
+    }
+
+    void InstanceKlass::account(size_t bytes) {
+        accountedBytes.fetch_add(static_cast<int64_t>(bytes), std::memory_order_relaxed);
+        MemoryTracker::allocate(MemoryTag::Classes, bytes, 0);
+    }
+
+    size_t InstanceKlass::getFootprint() const {
+        auto footprint = static_cast<size_t>(accountedBytes.load(std::memory_order_relaxed));
+        for (const auto &method : methods) {
+            footprint += method->getSize();
+        }
+        return footprint;
+    }
+
+    const SymbolPtr &InstanceKlass::name() {
+        return klassName;
+    }
+
+    void InstanceKlass::setSuperKlass(Ptr super) {
+        CCW_ASSERT(!isLinked());
+        superKlass = std::move(super);
+    }
+
+    void InstanceKlass::addLocalInterface(Ptr interface) {
+        CCW_ASSERT(!isLinked() && interface->isInterface());
+        localInterfaces.push_back(std::move(interface));
+    }
+
+    bool InstanceKlass::resolveSupers(Ptr super, std::vector<Ptr> interfaces) {
+        std::lock_guard<std::mutex> _{initMutex};
+        if (supersResolved.load(std::memory_order_relaxed)) {
+            return false;
+        }
+        CCW_ASSERT(!isLinked());
+        superKlass = std::move(super);
+        for (auto &interface : interfaces) {
+            CCW_ASSERT(interface->isInterface());
+            localInterfaces.push_back(std::move(interface));
+        }
+        supersResolved.store(true, std::memory_order_release);
+        return true;
+    }
+
+    Method *InstanceKlass::addMethod(const SymbolPtr &methodName, const SymbolPtr &descriptor,
+                                     MethodAccessFlags flags) {
+        return addMethod(Method::create(this, methodName, descriptor, flags));
+    }
+
+    Method *InstanceKlass::addMethod(Method::Ptr method) {
+        CCW_ASSERT(!isLinked() && method->getHolder() == this);
+        methods.push_back(std::move(method));
+        return methods.back().get();
+    }
+
+    Field *InstanceKlass::addField(const SymbolPtr &fieldName, const SymbolPtr &descriptor, FieldAccessFlags flags,
+                                   uint16_t constantValueIndex) {
+        CCW_ASSERT(!isLinked());
+        fields.push_back(std::make_unique<Field>(this, fieldName, descriptor, flags, constantValueIndex));
+        account(sizeof(Field));
+        return fields.back().get();
+    }
+
+    template<typename T, typename Deleter>
+    static T *findMember(const MemberTable<T> &table, const std::vector<std::unique_ptr<T, Deleter>> &members,
+                         const Symbol *name, const Symbol *descriptor) {
+        if (table.isBuilt()) {
+            return table.find(name, descriptor);
+        }
+        // Not linked yet, members may still be added.
+        for (const auto &member : members) {
+            if (member->name().get() == name && member->descriptor().get() == descriptor) {
+                return member.get();
+            }
+        }
+        return nullptr;
+    }
+
+    Method *InstanceKlass::findLocalMethod(const Symbol *methodName, const Symbol *descriptor) const {
+        return findMember(methodTable, methods, methodName, descriptor);
+    }
+
+    Field *InstanceKlass::findLocalField(const Symbol *fieldName, const Symbol *descriptor) const {
+        return findMember(fieldTable, fields, fieldName, descriptor);
+    }
+
+    size_t InstanceKlass::missingSlotOf(const MemberLookup &lookup) {
+        auto hash = reinterpret_cast<uintptr_t>(lookup.first) * 31 + reinterpret_cast<uintptr_t>(lookup.second);
+        return (hash >> 4u) % MissingSlots;
+    }
+
+    bool InstanceKlass::isKnownMissing(const MissingMembers &missing, const MemberLookup &lookup) const {
+        if (!isLinked()) {
+            return false;
+        }
+        // The caller holds both symbols, so a slot with their addresses remembers these very symbols.
+        std::shared_lock<std::shared_timed_mutex> _{missingMutex};
+        return missing != nullptr && (*missing)[missingSlotOf(lookup)].lookup == lookup;
+    }
+
+    void InstanceKlass::rememberMissing(MissingMembers &missing, const MemberLookup &lookup) const {
+        if (!isLinked()) {
+            return;
+        }
+        std::unique_lock<std::shared_timed_mutex> _{missingMutex};
+        if (missing == nullptr) {
+            missing = std::make_unique<std::array<MissingMember, MissingSlots>>();
+        }
+        // Symbols are created by make_shared, so their owners can be recovered from the addresses.
+        (*missing)[missingSlotOf(lookup)] = {lookup, lookup.first->shared_from_this(),
+                                             lookup.second->shared_from_this()};
+    }
+
+    size_t InstanceKlass::rememberedMisses() const {
+        std::shared_lock<std::shared_timed_mutex> _{missingMutex};
+        size_t count = 0;
+        for (const auto *missing : {&missingMethods, &missingFields}) {
+            if (*missing != nullptr) {
+                for (const auto &member : **missing) {
+                    count += member.lookup.first != nullptr && !member.name.expired()
+                             && !member.descriptor.expired();
+                }
+            }
+        }
+        return count;
+    }
+
+    Method *InstanceKlass::findMethod(const Symbol *methodName, const Symbol *descriptor) const {
+        MemberLookup key{methodName, descriptor};
+        if (isKnownMissing(missingMethods, key)) {
+            return nullptr;
+        }
+        auto method = findMethodInHierarchy(methodName, descriptor);
+        if (method == nullptr) {
+            rememberMissing(missingMethods, key);
+        }
+        return method;
+    }
+
+    Method *InstanceKlass::findMethodInHierarchy(const Symbol *methodName, const Symbol *descriptor) const {
+        for (auto k = this; k != nullptr; k = k->superKlass.get()) {
+            if (auto method = k->findLocalMethod(methodName, descriptor)) {
+                return method;
+            }
+        }
+        return findMaximallySpecific(methodName, descriptor);
+    }
+
+    bool InstanceKlass::isSubInterfaceOf(const InstanceKlass *interface) const {
+        for (const auto &super : localInterfaces) {
+            if (super.get() == interface || super->isSubInterfaceOf(interface)) {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    Method *InstanceKlass::findMaximallySpecific(const Symbol *methodName, const Symbol *descriptor) const {
+        std::vector<InstanceKlass *> interfaces;
+        if (isLinked()) {
+            interfaces = transitiveInterfaces;
+        } else {
+            // Before linking, gather the super interfaces of this class and its super classes.
+            std::vector<InstanceKlass *> pending;
+            for (auto k = this; k != nullptr; k = k->superKlass.get()) {
+                for (const auto &interface : k->localInterfaces) {
+                    pending.push_back(interface.get());
+                }
+            }
+            while (!pending.empty()) {
+                auto interface = pending.back();
+                pending.pop_back();
+                if (std::find(interfaces.begin(), interfaces.end(), interface) == interfaces.end()) {
+                    interfaces.push_back(interface);
+                    for (const auto &super : interface->localInterfaces) {
+                        pending.push_back(super.get());
+                    }
+                }
+            }
+        }
+
+        std::vector<Method *> candidates;
+        for (auto interface : interfaces) {
+            auto method = interface->findLocalMethod(methodName, descriptor);
+            if (method != nullptr && !method->isPrivate() && !method->isStatic()) {
+                candidates.push_back(method);
+            }
+        }
+        // A candidate is maximally specific unless another one is declared in a sub interface of its holder.
+        Method *selected = nullptr;
+        Method *nonAbstract = nullptr;
+        int nonAbstractCount = 0;
+        for (auto method : candidates) {
+            auto overridden = std::any_of(candidates.begin(), candidates.end(), [method](const Method *other) {
+                return other->getHolder()->isSubInterfaceOf(method->getHolder());
+            });
+            if (overridden) {
+                continue;
+            }
+            if (selected == nullptr || (!selected->isAbstract() && method->isAbstract())) {
+                selected = method;
+            }
+            if (!method->isAbstract()) {
+                nonAbstract = method;
+                nonAbstractCount++;
+            }
+        }
+        return nonAbstractCount == 1 ? nonAbstract : selected;
+    }
+
+    Field *InstanceKlass::findField(const Symbol *fieldName, const Symbol *descriptor) const {
+        MemberLookup key{fieldName, descriptor};
+        if (isKnownMissing(missingFields, key)) {
+            return nullptr;
+        }
+        auto field = findFieldInHierarchy(fieldName, descriptor);
+        if (field == nullptr) {
+            rememberMissing(missingFields, key);
+        }
+        return field;
+    }
+
+    Field *InstanceKlass::findFieldInHierarchy(const Symbol *fieldName, const Symbol *descriptor) const {
+        if (auto field = findLocalField(fieldName, descriptor)) {
+            return field;
+        }
+        for (const auto &interface : localInterfaces) {
+            if (auto field = interface->findField(fieldName, descriptor)) {
+                return field;
+            }
+        }
+        if (superKlass != nullptr) {
+            return superKlass->findField(fieldName, descriptor);
+        }
+        return nullptr;
+    }
+
+    bool InstanceKlass::isSubclassOf(const InstanceKlass *klass) const {
+        for (auto k = this; k != nullptr; k = k->superKlass.get()) {
+            if (k == klass) {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    bool InstanceKlass::implements(const InstanceKlass *interface) const {
+        return std::find(transitiveInterfaces.begin(), transitiveInterfaces.end(), interface)
+               != transitiveInterfaces.end();
+    }
+
+    static size_t packageLength(const SymbolPtr &className) {
+        auto bytes = className->getBytes();
+        for (size_t i = className->getLength(); i > 0; --i) {
+            if (bytes[i - 1] == '/') {
+                return i - 1;
+            }
+        }
+        return 0;
+    }
+
+    bool InstanceKlass::isSamePackage(const InstanceKlass *klass) const {
+        // TODO also compare defining loaders once user class loaders exist
+        auto len = packageLength(klassName);
+        return len == packageLength(klass->klassName)
+               && memcmp(klassName->getBytes(), klass->klassName->getBytes(), len) == 0;
+    }
+
+    void InstanceKlass::link() {
+        if (isLinked()) {
+            return;
+        }
+        // Outside the lock: the hierarchy is acyclic, but other classes may share parts of it.
+        if (superKlass != nullptr) {
+            superKlass->link();
+        }
+        for (const auto &interface : localInterfaces) {
+            interface->link();
+        }
+        std::lock_guard<std::mutex> _{initMutex};
+        if (isLinked()) {
+            return;
+        }
+        EventScope event(EventType::LinkClass, [this] { return klassName->toString(); });
+        methodTable.build(methods);
+        fieldTable.build(fields);
+        collectTransitiveInterfaces();
+        layoutVTable();
+        layoutITable();
+        size_t tables = (methods.capacity() + vtable.capacity()) * sizeof(void *)
+                        + fields.capacity() * sizeof(void *)
+                        + transitiveInterfaces.capacity() * sizeof(void *)
+                        + itable.capacity() * sizeof(ITableEntry) + itableSlots.capacity() * sizeof(int32_t);
+        for (const auto &entry : itable) {
+            tables += entry.methods.capacity() * sizeof(Method *);
+        }
+        account(tables);
+        state.store(ClassState::Linked, std::memory_order_release);
+    }
+
+    void InstanceKlass::initializeSlow(const ClinitRunner &runner) {
+        CCW_ASSERT(isLinked());
+        auto isolate = Isolate::current();
+        if (isolate == Isolate::None) {
+            throw Error("Initializing " + klassName->toString() + " on a thread no VM is current on");
+        }
+        auto self = std::this_thread::get_id();
+        {
+            std::unique_lock<std::mutex> lock{initMutex};
+            // Step 2: wait while another thread of this VM initializes the class.
+            initDone.wait(lock, [this, isolate, self] {
+                auto it = isolateInits.find(isolate);
+                return it == isolateInits.end() || it->second.state != ClassState::BeingInitialized
+                       || it->second.thread == self;
+            });
+            if (isInitialized()) {                      // step 4
+                return;
+            }
+            auto it = isolateInits.find(isolate);
+            if (it != isolateInits.end()) {
+                if (it->second.state == ClassState::BeingInitialized) {
+                    return;                             // step 3: recursive request
+                }
+                // Step 5
+                throw NoClassDefFoundError("Could not initialize class " + klassName->toString());
+            }
+            // Step 6
+            isolateInits.emplace(isolate, IsolateInit{ClassState::BeingInitialized, self});
+        }
+
+        try {
+            // Step 7: the super class, then super interfaces that declare default methods.
+            if (!isInterface()) {
+                if (superKlass != nullptr) {
+                    superKlass->initialize(runner);
+                }
+                initializeSuperInterfaces(runner);
+            }
+            // Step 9
+            if (auto clinit = staticInitializer()) {
+                runner(*this, *clinit);
+            }
+        } catch (const Error &) {
+            // Steps 7 and 11: errors propagate as they are.
+            finishInitialization(ClassState::InitializationError);
+            throw;
+        } catch (const std::exception &e) {
+            finishInitialization(ClassState::InitializationError);
+            throw ExceptionInInitializerError(e.what());
+        } catch (...) {
+            finishInitialization(ClassState::InitializationError);
+            throw ExceptionInInitializerError("<clinit> of " + klassName->toString() + " failed");
+        }
+        // Step 10
+        finishInitialization(ClassState::FullyInitialized);
+    }
+
+    void InstanceKlass::initializeSuperInterfaces(const ClinitRunner &runner) {
+        for (const auto &interface : localInterfaces) {
+            interface->initializeSuperInterfaces(runner);
+            if (interface->declaresDefaultMethods()) {
+                interface->initialize(runner);
+            }
+        }
+    }
+
+    bool InstanceKlass::declaresDefaultMethods() const {
+        return std::any_of(methods.begin(), methods.end(), [](const Method::Ptr &method) {
+            return !method->isAbstract() && !method->isStatic();
+        });
+    }
+
+    Method *InstanceKlass::staticInitializer() const {
+        for (const auto &method : methods) {
+            if (method->isStaticInitializer() && method->isStatic()) {
+                return method.get();
+            }
+        }
+        return nullptr;
+    }
+
+    Method *InstanceKlass::pendingStaticInitializer() const {
+        if (isInitialized()) {
+            return nullptr;
+        }
+        // In the order of steps 7 and 9 of initializeSlow().
+        if (!isInterface()) {
+            if (superKlass != nullptr) {
+                if (auto clinit = superKlass->pendingStaticInitializer()) {
+                    return clinit;
+                }
+            }
+            if (auto clinit = pendingInterfaceInitializer()) {
+                return clinit;
+            }
+        }
+        return staticInitializer();
+    }
+
+    Method *InstanceKlass::pendingInterfaceInitializer() const {
+        for (const auto &interface : localInterfaces) {
+            if (auto clinit = interface->pendingInterfaceInitializer()) {
+                return clinit;
+            }
+            if (interface->declaresDefaultMethods()) {
+                if (auto clinit = interface->pendingStaticInitializer()) {
+                    return clinit;
+                }
+            }
+        }
+        return nullptr;
+    }
+
+    void InstanceKlass::finishInitialization(ClassState result) {
+        {
+            std::lock_guard<std::mutex> _{initMutex};
+            auto isolate = Isolate::current();
+            if (result == ClassState::FullyInitialized) {
+                isolateInits.erase(isolate);
+                // Releases the static state written by <clinit> to threads taking the fast path.
+                initializedIsolates.fetch_or(uint64_t(1) << isolate, std::memory_order_release);
+            } else {
+                isolateInits[isolate] = IsolateInit{result, std::thread::id()};
+            }
+        }
+        initDone.notify_all();
+    }
+
+    ClassState InstanceKlass::getInitState() const {
+        std::lock_guard<std::mutex> _{initMutex};
+        if (isInitialized()) {
+            return ClassState::FullyInitialized;
+        }
+        auto it = isolateInits.find(Isolate::current());
+        return it == isolateInits.end() ? ClassState::Linked : it->second.state;
+    }
+
+    void InstanceKlass::forgetIsolate(uint32_t isolate) {
+        std::lock_guard<std::mutex> _{initMutex};
+        isolateInits.erase(isolate);
+        initializedIsolates.fetch_and(~(uint64_t(1) << isolate), std::memory_order_relaxed);
+        for (auto barrier : initBarriers) {
+            barrier->forgetIsolate(isolate);
+        }
+    }
+
+    void InstanceKlass::addInitBarrier(InitBarrier *barrier) {
+        std::lock_guard<std::mutex> _{initMutex};
+        initBarriers.push_back(barrier);
+    }
+
+    void InstanceKlass::removeInitBarrier(InitBarrier *barrier) {
+        std::lock_guard<std::mutex> _{initMutex};
+        initBarriers.erase(std::remove(initBarriers.begin(), initBarriers.end(), barrier), initBarriers.end());
+    }
+
+    void InstanceKlass::collectTransitiveInterfaces() {
+        auto add = [this](InstanceKlass *interface) {
+            if (std::find(transitiveInterfaces.begin(), transitiveInterfaces.end(), interface)
+                == transitiveInterfaces.end()) {
+                transitiveInterfaces.push_back(interface);
+            }
+        };
+        for (const auto &interface : localInterfaces) {
+            CCW_ASSERT(interface->isLinked());
+            add(interface.get());
+            for (auto super : interface->transitiveInterfaces) {
+                add(super);
+            }
+        }
+        if (superKlass != nullptr) {
+            for (auto super : superKlass->transitiveInterfaces) {
+                add(super);
+            }
+        }
+    }
+
+    bool InstanceKlass::canOverride(const Method *method, const Method *superMethod) const {
+        if (!method->hasSameSignature(superMethod)) {
+            return false;
+        }
+        if (superMethod->isPackagePrivate()) {
+            return isSamePackage(superMethod->getHolder());
+        }
+        return true;
+    }
+
+    static bool needsVTableEntry(const Method *method) {
+        return !method->isStatic() && !method->isPrivate() && !method->isInitializer()
+               && !method->isStaticInitializer();
+    }
+
+    int InstanceKlass::findVTableSlot(const Method *method) const {
+        for (int i = 0; i < (int) vtable.size(); ++i) {
+            if (canOverride(method, vtable[i])) {
+                return i;
+            }
+        }
+        return Method::InvalidIndex;
+    }
+
+    void InstanceKlass::layoutVTable() {
+        if (superKlass != nullptr) {
+            vtable = superKlass->vtable;
+        }
+        if (isInterface()) {
+            // Interfaces dispatch through itables; the vtable only mirrors java.lang.Object's.
+            return;
+        }
+
+        for (const auto &method : methods) {
+            if (!needsVTableEntry(method.get())) {
+                continue;
+            }
+            auto slot = findVTableSlot(method.get());
+            if (slot != Method::InvalidIndex) {
+                vtable[slot] = method.get();
+                method->setVTableIndex(slot);
+            } else if (!method->isFinal()) {
+                // Final methods that override nothing are always invoked statically and need no slot.
+                method->setVTableIndex((int) vtable.size());
+                vtable.push_back(method.get());
+            }
+        }
+
+        // Miranda and default methods: interface methods no class of the hierarchy declares select the
+        // maximally-specific super interface method of this class (JVMS 5.4.6). Slots inherited from the
+        // super class are selected again, as this class may add interfaces with more specific defaults.
+        for (auto interface : transitiveInterfaces) {
+            for (const auto &method : interface->methods) {
+                if (method->getITableIndex() == Method::InvalidIndex) {
+                    continue;
+                }
+                auto found = std::find_if(vtable.begin(), vtable.end(), [&method](const Method *it) {
+                    return it->hasSameSignature(method.get());
+                });
+                if (found != vtable.end() && !(*found)->getHolder()->isInterface()) {
+                    continue;
+                }
+                auto selected = findMaximallySpecific(method->name().get(), method->descriptor().get());
+                if (found == vtable.end()) {
+                    vtable.push_back(selected);
+                } else {
+                    *found = selected;
+                }
+            }
+        }
+    }
+
+    // Fibonacci hashing of the interface address, so that allocation alignment does not cluster the slots.
+    static size_t itableSlotOf(const InstanceKlass *interface, size_t mask) {
+        return static_cast<size_t>((reinterpret_cast<uintptr_t>(interface) * 0x9E3779B97F4A7C15ull) >> 32u) & mask;
+    }
+
+    void InstanceKlass::layoutITable() {
+        if (isInterface()) {
+            int selector = 0;
+            for (const auto &method : methods) {
+                if (needsVTableEntry(method.get())) {
+                    method->setITableIndex(selector++);
+                }
+            }
+            return;
+        }
+
+        itable.reserve(transitiveInterfaces.size());
+        for (auto interface : transitiveInterfaces) {
+            ITableEntry entry{interface, {}};
+            for (const auto &method : interface->methods) {
+                auto selector = method->getITableIndex();
+                if (selector == Method::InvalidIndex) {
+                    continue;
+                }
+                if (selector >= (int) entry.methods.size()) {
+                    entry.methods.resize(selector + 1, nullptr);
+                }
+                // Interface methods are always public, so selection is a signature match in the vtable.
+                auto found = std::find_if(vtable.begin(), vtable.end(), [&method](const Method *it) {
+                    return it->hasSameSignature(method.get());
+                });
+                entry.methods[selector] = found != vtable.end() ? *found : method.get();
+            }
+            itable.push_back(std::move(entry));
+        }
+
+        // At most half full, so probes end at a free slot after a step or two.
+        size_t slots = 1;
+        while (slots < 2 * itable.size()) {
+            slots *= 2;
+        }
+        itableSlots.assign(itable.empty() ? 0 : slots, -1);
+        for (size_t i = 0; i < itable.size(); ++i) {
+            auto mask = itableSlots.size() - 1;
+            auto slot = itableSlotOf(itable[i].interface, mask);
+            while (itableSlots[slot] >= 0) {
+                slot = (slot + 1) & mask;
+            }
+            itableSlots[slot] = static_cast<int32_t>(i);
+        }
+    }
+
+    Method *InstanceKlass::itableMethod(const InstanceKlass *interface, int selector) const {
+        if (itableSlots.empty()) {
+            return nullptr;
+        }
+        auto mask = itableSlots.size() - 1;
+        for (auto slot = itableSlotOf(interface, mask);; slot = (slot + 1) & mask) {
+            auto position = itableSlots[slot];
+            if (position < 0) {
+                return nullptr;
+            }
+            const auto &entry = itable[position];
+            if (entry.interface == interface) {
+                CCW_ASSERT(selector >= 0 && selector < (int) entry.methods.size());
+                return entry.methods[selector];
+            }
+        }
+    }
+
+    Method *InstanceKlass::selectVirtual(const Method *resolved) const {
+        auto index = resolved->getVTableIndex();
+        if (index == Method::InvalidIndex) {
+            if (resolved->getHolder()->isInterface() && !resolved->isPrivate() && !resolved->isStatic()) {
+                // A default method resolved through a class: its slot is per class, so select by the itable.
+                return itableMethod(resolved->getHolder(), resolved->getITableIndex());
+            }
+            return const_cast<Method *>(resolved);
+        }
+        return vtableMethodAt(index);
+    }
+
+    Method *InstanceKlass::selectInterface(const Method *resolved) const {
+        auto holder = resolved->getHolder();
+        if (!holder->isInterface()) {
+            // invokeinterface of a java.lang.Object method, e.g. toString(), dispatches like invokevirtual.
+            return selectVirtual(resolved);
+        }
+        return itableMethod(holder, resolved->getITableIndex());
+    }
+}
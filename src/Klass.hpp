@@ -1,10 +1,28 @@
 #pragma once
 
+#include "ConstantPool.hpp"
+#include "Field.hpp"
+#include "Isolate.hpp"
+#include "MemberTable.hpp"
+#include "Method.hpp"
 #include "Symbol.hpp"
 
+#include <array>
+#include <atomic>
+#include <condition_variable>
+#include <functional>
+#include <map>
 #include <memory>
+#include <mutex>
+#include <shared_mutex>
+#include <thread>
+#include <utility>
+#include <vector>
 
 namespace CCW::Tula {
+    class InstanceKlass;
+    class InitBarrier;
+
     class Klass : public Interface {
     public:
         using Ptr = std::shared_ptr<Klass>;
@@ -14,4 +32,326 @@ namespace CCW::Tula {
     private:
 
     };
+
+    // The itable block of one implemented interface: methods[selector] is the implementation
+    // selected for the interface method whose itable index is `selector`.
+    struct ITableEntry {
+        InstanceKlass *interface;
+        std::vector<Method *> methods;
+    };
+
+    enum class ClassState : uint8_t {
+        Loaded,                 // parsed, members may still be added
+        Linked,                 // vtable and itable laid out
+        BeingInitialized,       // <clinit> running on the initializing thread
+        FullyInitialized,
+        InitializationError
+    };
+
+    // Executes the <clinit> of `klass`. Whatever it throws fails the initialization.
+    using ClinitRunner = std::function<void(InstanceKlass &klass, Method &clinit)>;
+
+    class InstanceKlass : public Klass, public std::enable_shared_from_this<InstanceKlass> {
+    public:
+        using Ptr = std::shared_ptr<InstanceKlass>;
+
+        InstanceKlass(SymbolPtr name, std::shared_ptr<ConstantPool> cp, ClassAccessFlags accessFlags);
+
+        ~InstanceKlass();
+
+        const SymbolPtr &name() override;
+
+        [[nodiscard]] inline const SymbolPtr &getName() const {
+            return klassName;
+        }
+
+        [[nodiscard]] inline const std::shared_ptr<ConstantPool> &getConstantPool() const {
+            return cp;
+        }
+
+        // Bytes of the class and its methods, fields and dispatch tables; the constant pool is
+        // accounted on its own.
+        [[nodiscard]] size_t getFootprint() const;
+
+        [[nodiscard]] inline ClassAccessFlags getAccessFlags() const {
+            return accessFlags;
+        }
+
+        [[nodiscard]] inline bool isInterface() const {
+            return accessFlags & ClassAccessFlags::Interface;
+        }
+
+        [[nodiscard]] inline uint16_t getMajorVersion() const {
+            return majorVersion;
+        }
+
+        inline void setMajorVersion(uint16_t version) {
+            majorVersion = version;
+        }
+
+        // Name of the direct super class, null for java/lang/Object.
+        [[nodiscard]] inline const SymbolPtr &getSuperClassName() const {
+            return superClassName;
+        }
+
+        inline void setSuperClassName(SymbolPtr className) {
+            superClassName = std::move(className);
+        }
+
+        // Value of the SourceFile attribute, null when absent.
+        [[nodiscard]] inline const SymbolPtr &getSourceFile() const {
+            return sourceFile;
+        }
+
+        inline void setSourceFile(SymbolPtr file) {
+            sourceFile = std::move(file);
+        }
+
+        [[nodiscard]] inline const Ptr &getSuperKlass() const {
+            return superKlass;
+        }
+
+        void setSuperKlass(Ptr super);
+
+        [[nodiscard]] inline const std::vector<Ptr> &getLocalInterfaces() const {
+            return localInterfaces;
+        }
+
+        void addLocalInterface(Ptr interface);
+
+        // Names of the direct super interfaces, in class file order.
+        [[nodiscard]] inline const std::vector<SymbolPtr> &getInterfaceNames() const {
+            return interfaceNames;
+        }
+
+        inline void addInterfaceName(SymbolPtr interfaceName) {
+            interfaceNames.push_back(std::move(interfaceName));
+        }
+
+        // Whether a class loader resolved the super class and interface names yet.
+        [[nodiscard]] inline bool hasResolvedSupers() const {
+            return supersResolved.load(std::memory_order_acquire);
+        }
+
+        // Sets the classes the super class and interface names resolved to. A class shared between VMs keeps
+        // the supers of the first VM resolving it; the others get false.
+        bool resolveSupers(Ptr super, std::vector<Ptr> interfaces);
+
+        Method *addMethod(const SymbolPtr &methodName, const SymbolPtr &descriptor, MethodAccessFlags flags);
+
+        Method *addMethod(Method::Ptr method);
+
+        [[nodiscard]] inline const std::vector<Method::Ptr> &getMethods() const {
+            return methods;
+        }
+
+        Field *addField(const SymbolPtr &fieldName, const SymbolPtr &descriptor, FieldAccessFlags flags,
+                        uint16_t constantValueIndex = 0);
+
+        [[nodiscard]] inline const std::vector<std::unique_ptr<Field>> &getFields() const {
+            return fields;
+        }
+
+        // Member lookups take interned symbols and compare them by identity.
+
+        [[nodiscard]] Method *findLocalMethod(const Symbol *methodName, const Symbol *descriptor) const;
+
+        [[nodiscard]] Field *findLocalField(const Symbol *fieldName, const Symbol *descriptor) const;
+
+        // Method resolution order of JVMS 5.4.3.3: this class, its super classes, then super interfaces.
+        [[nodiscard]] Method *findMethod(const Symbol *methodName, const Symbol *descriptor) const;
+
+        // Field resolution order of JVMS 5.4.3.2: this class, its super interfaces, then its super class.
+        [[nodiscard]] Field *findField(const Symbol *fieldName, const Symbol *descriptor) const;
+
+        [[nodiscard]] bool isSubclassOf(const InstanceKlass *klass) const;
+
+        [[nodiscard]] bool implements(const InstanceKlass *interface) const;
+
+        [[nodiscard]] bool isSamePackage(const InstanceKlass *klass) const;
+
+        // Failed method lookups and failed field lookups are each remembered in this many slots.
+        static constexpr size_t MissingSlots = 8;
+
+        // Method and field misses currently remembered, at most 2 * MissingSlots.
+        [[nodiscard]] size_t rememberedMisses() const;
+
+        // Lays out the vtable and itable, linking the super class and interfaces first. Classes shared
+        // between VMs may be linked by several at once; the first one does the work.
+        void link();
+
+        [[nodiscard]] inline bool isLinked() const {
+            return state.load(std::memory_order_acquire) >= ClassState::Linked;
+        }
+
+        // The state in the current isolate: loading and linking are shared by every VM using the class,
+        // initialization is per VM since each has its own statics.
+        [[nodiscard]] inline ClassState getState() const {
+            if (isInitialized()) {
+                return ClassState::FullyInitialized;
+            }
+            auto linkState = state.load(std::memory_order_acquire);
+            return linkState < ClassState::Linked ? linkState : getInitState();
+        }
+
+        // Initialization check of getstatic, putstatic, invokestatic and new: one acquire load once the
+        // class is initialized, so threads never serialize on an initialized class.
+        [[nodiscard]] inline bool isInitialized() const {
+            return (initializedIsolates.load(std::memory_order_acquire) & Isolate::currentBit()) != 0;
+        }
+
+        // Drops the initialization state of a VM that is going away, barriers included, so the next VM
+        // reusing its isolate index starts over.
+        void forgetIsolate(uint32_t isolate);
+
+        void addInitBarrier(InitBarrier *barrier);
+
+        void removeInitBarrier(InitBarrier *barrier);
+
+        // Initializes the class as in JLS 12.4.2, running <clinit> through `runner`. Returns at once when
+        // the class is initialized or the current thread is initializing it already (a recursive request).
+        // Throws NoClassDefFoundError when an earlier initialization failed, rethrows Errors from <clinit>
+        // and wraps anything else in ExceptionInInitializerError.
+        inline void initialize(const ClinitRunner &runner) {
+            if (!isInitialized()) {
+                initializeSlow(runner);
+            }
+        }
+
+        // The first <clinit> initialize() would run in the current isolate: of a super class, of a super
+        // interface declaring default methods or of the class itself. Null when it would run none.
+        [[nodiscard]] Method *pendingStaticInitializer() const;
+
+        [[nodiscard]] inline const std::vector<Method *> &getVTable() const {
+            return vtable;
+        }
+
+        [[nodiscard]] inline Method *vtableMethodAt(int index) const {
+            CCW_ASSERT(index >= 0 && index < (int) vtable.size());
+            return vtable[index];
+        }
+
+        [[nodiscard]] inline const std::vector<ITableEntry> &getITable() const {
+            return itable;
+        }
+
+        // Selects the implementation of the `selector`-th method of `interface` for a receiver of this class.
+        // Returns nullptr when this class does not implement the interface (IncompatibleClassChangeError).
+        [[nodiscard]] Method *itableMethod(const InstanceKlass *interface, int selector) const;
+
+        // invokevirtual target selection for `resolved` on a receiver of this class.
+        [[nodiscard]] Method *selectVirtual(const Method *resolved) const;
+
+        // invokeinterface target selection for `resolved` on a receiver of this class.
+        [[nodiscard]] Method *selectInterface(const Method *resolved) const;
+
+        // Every interface implemented directly or indirectly, super interfaces after their sub interfaces.
+        [[nodiscard]] inline const std::vector<InstanceKlass *> &getTransitiveInterfaces() const {
+            return transitiveInterfaces;
+        }
+
+    private:
+        void initializeSlow(const ClinitRunner &runner);
+
+        void initializeSuperInterfaces(const ClinitRunner &runner);
+
+        [[nodiscard]] Method *pendingInterfaceInitializer() const;
+
+        [[nodiscard]] bool declaresDefaultMethods() const;
+
+        [[nodiscard]] Method *staticInitializer() const;
+
+        void finishInitialization(ClassState result);
+
+        [[nodiscard]] ClassState getInitState() const;
+
+        void account(size_t bytes);
+
+        void collectTransitiveInterfaces();
+
+        void layoutVTable();
+
+        void layoutITable();
+
+        [[nodiscard]] int findVTableSlot(const Method *method) const;
+
+        [[nodiscard]] bool canOverride(const Method *method, const Method *superMethod) const;
+
+        [[nodiscard]] Method *findMethodInHierarchy(const Symbol *methodName, const Symbol *descriptor) const;
+
+        // The maximally-specific super interface method of JVMS 5.4.3.3: the only non-abstract one when there
+        // is exactly one, otherwise one of them, abstract ones first since conflicting defaults select nothing.
+        // nullptr when no super interface declares the method.
+        [[nodiscard]] Method *findMaximallySpecific(const Symbol *methodName, const Symbol *descriptor) const;
+
+        // Whether this interface extends `interface`, directly or indirectly. Works before linking.
+        [[nodiscard]] bool isSubInterfaceOf(const InstanceKlass *interface) const;
+
+        [[nodiscard]] Field *findFieldInHierarchy(const Symbol *fieldName, const Symbol *descriptor) const;
+
+        using MemberLookup = std::pair<const Symbol *, const Symbol *>;
+
+        // A member found missing. The weak references let the symbol table sweep the names, while keeping
+        // the storage of make_shared symbols allocated: no other name can take a remembered address.
+        struct MissingMember {
+            MemberLookup lookup{nullptr, nullptr};
+            std::weak_ptr<const Symbol> name;
+            std::weak_ptr<const Symbol> descriptor;
+        };
+
+        // Direct-mapped by the symbol addresses, so a new miss evicts the one in its slot. Allocated on
+        // the first miss; most classes never have one.
+        using MissingMembers = std::unique_ptr<std::array<MissingMember, MissingSlots>>;
+
+        [[nodiscard]] static size_t missingSlotOf(const MemberLookup &lookup);
+
+        [[nodiscard]] bool isKnownMissing(const MissingMembers &missing, const MemberLookup &lookup) const;
+
+        void rememberMissing(MissingMembers &missing, const MemberLookup &lookup) const;
+
+    private:
+        SymbolPtr klassName;
+        std::shared_ptr<ConstantPool> cp;
+        std::atomic<int64_t> accountedBytes{0};     // under MemoryTag::Classes
+        ClassAccessFlags accessFlags;
+        uint16_t majorVersion = 0;
+        SymbolPtr superClassName;
+        SymbolPtr sourceFile;
+
+        std::vector<SymbolPtr> interfaceNames;
+        std::atomic<bool> supersResolved{false};
+        Ptr superKlass;
+        std::vector<Ptr> localInterfaces;
+        std::vector<InstanceKlass *> transitiveInterfaces;
+        std::vector<Method::Ptr> methods;
+        std::vector<std::unique_ptr<Field>> fields;
+
+        MemberTable<Method> methodTable;
+        MemberTable<Field> fieldTable;
+
+        // Recent hierarchy walks that found nothing. The hierarchy is fixed once linked, so misses never go
+        // stale.
+        mutable std::shared_timed_mutex missingMutex;
+        mutable MissingMembers missingMethods;
+        mutable MissingMembers missingFields;
+
+        // Loaded or Linked; the initialization states live per isolate.
+        std::atomic<ClassState> state{ClassState::Loaded};
+        std::atomic<uint64_t> initializedIsolates{0};
+
+        // Isolates initializing the class or having failed to, with the initializing thread.
+        struct IsolateInit {
+            ClassState state;
+            std::thread::id thread;
+        };
+        mutable std::mutex initMutex;
+        std::condition_variable initDone;
+        std::map<uint32_t, IsolateInit> isolateInits;
+        std::vector<InitBarrier *> initBarriers;
+
+        std::vector<Method *> vtable;
+        std::vector<ITableEntry> itable;
+        // Open-addressed by interface address: positions in the itable, -1 for free slots.
+        std::vector<int32_t> itableSlots;
+    };
 }
@@ -0,0 +1,69 @@
+#include "LineNumberStream.hpp"
+
+#include <utility>
+
+namespace CCW::Tula {
+
+    static constexpr uint8_t Escape = 0xFF;
+
+    void LineNumberStreamWriter::write(uint16_t bci, uint16_t line) {
+        int32_t bciDelta = (int32_t) bci - lastBci;
+        int32_t lineDelta = (int32_t) line - lastLine;
+        lastBci = bci;
+        lastLine = line;
+        if (bciDelta == 0 && lineDelta == 0) {
+            // Carries no information and would read back as the terminator.
+            return;
+        }
+        // A bci delta of 31 with a line delta of 7 would collide with the escape byte.
+        if (bciDelta >= 0 && bciDelta < 0x1F && lineDelta >= 0 && lineDelta < 0x08) {
+            bytes.push_back(static_cast<uint8_t>(bciDelta << 3u | lineDelta));
+        } else {
+            bytes.push_back(Escape);
+            writeSigned(bciDelta);
+            writeSigned(lineDelta);
+        }
+    }
+
+    void LineNumberStreamWriter::writeSigned(int32_t value) {
+        auto zigzag = (static_cast<uint32_t>(value) << 1u) ^ static_cast<uint32_t>(value >> 31);
+        while (zigzag >= 0x80) {
+            bytes.push_back(static_cast<uint8_t>(zigzag | 0x80u));
+            zigzag >>= 7u;
+        }
+        bytes.push_back(static_cast<uint8_t>(zigzag));
+    }
+
+    std::vector<uint8_t> LineNumberStreamWriter::finish() {
+        bytes.push_back(0);
+        return std::move(bytes);
+    }
+
+    bool LineNumberStreamReader::next() {
+        uint8_t value = *ptr++;
+        if (value == 0) {
+            ptr--;
+            return false;
+        }
+        if (value == Escape) {
+            bci += readSigned();
+            line += readSigned();
+        } else {
+            bci += value >> 3u;
+            line += value & 0x07u;
+        }
+        return true;
+    }
+
+    int32_t LineNumberStreamReader::readSigned() {
+        uint32_t zigzag = 0;
+        uint32_t shift = 0;
+        uint8_t value;
+        do {
+            value = *ptr++;
+            zigzag |= (uint32_t) (value & 0x7Fu) << shift;
+            shift += 7;
+        } while (value & 0x80u);
+        return static_cast<int32_t>(zigzag >> 1u) ^ -static_cast<int32_t>(zigzag & 1u);
+    }
+}
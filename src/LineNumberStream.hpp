@@ -0,0 +1,54 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+namespace CCW::Tula {
+
+    // Compressed LineNumberTable: each (bci, line) entry is stored as deltas from the previous one.
+    // Small forward deltas fit in one byte (5 bit bci delta, 3 bit line delta); anything else is an
+    // escape byte followed by two zig-zag varints. A zero byte terminates the stream.
+    class LineNumberStreamWriter {
+    public:
+        void write(uint16_t bci, uint16_t line);
+
+        // Appends the terminator and returns the encoded bytes.
+        std::vector<uint8_t> finish();
+
+        [[nodiscard]] inline bool isEmpty() const {
+            return bytes.empty();
+        }
+
+    private:
+        void writeSigned(int32_t value);
+
+    private:
+        std::vector<uint8_t> bytes;
+        int32_t lastBci = 0;
+        int32_t lastLine = 0;
+    };
+
+    class LineNumberStreamReader {
+    public:
+        explicit LineNumberStreamReader(const uint8_t *stream) : ptr(stream) {}
+
+        // Advances to the next entry, false at the end of the stream.
+        bool next();
+
+        [[nodiscard]] inline uint16_t getBci() const {
+            return bci;
+        }
+
+        [[nodiscard]] inline uint16_t getLine() const {
+            return line;
+        }
+
+    private:
+        int32_t readSigned();
+
+    private:
+        const uint8_t *ptr;
+        int32_t bci = 0;
+        int32_t line = 0;
+    };
+}
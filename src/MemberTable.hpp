@@ -0,0 +1,84 @@
+#pragma once
+
+#include "Symbol.hpp"
+
+#include <memory>
+#include <vector>
+
+namespace CCW::Tula {
+
+    // Immutable open-addressed table from (name, descriptor) to a member of one klass.
+    // Keys are interned symbols, so a probe compares two pointers and never touches symbol bytes.
+    // The table is built once at link time and is read without locks afterwards.
+    template<typename T>
+    class MemberTable : public Noncopyable {
+    public:
+        MemberTable() = default;
+
+        template<typename Members>
+        void build(const Members &members) {
+            uint32_t capacity = 4;
+            // Keep the load factor at or below 1/2 so unsuccessful probes stay short.
+            while (capacity < members.size() * 2) {
+                capacity <<= 1u;
+            }
+            mask = capacity - 1;
+            entries = std::make_unique<Entry[]>(capacity);
+            for (const auto &member : members) {
+                insert(member->name().get(), member->descriptor().get(), member.get());
+            }
+        }
+
+        [[nodiscard]] inline bool isBuilt() const {
+            return entries != nullptr;
+        }
+
+        [[nodiscard]] inline T *find(const Symbol *name, const Symbol *descriptor) const {
+            CCW_ASSERT(isBuilt());
+            for (uint32_t i = slotOf(name, descriptor);; i = (i + 1) & mask) {
+                const Entry &entry = entries[i];
+                if (entry.name == name && entry.descriptor == descriptor) {
+                    return entry.member;
+                }
+                if (entry.member == nullptr) {
+                    return nullptr;
+                }
+            }
+        }
+
+    private:
+        struct Entry {
+            const Symbol *name;
+            const Symbol *descriptor;
+            T *member;
+        };
+
+        static inline uint32_t slotHash(const Symbol *name, const Symbol *descriptor) {
+            auto a = reinterpret_cast<uintptr_t>(name);
+            auto b = reinterpret_cast<uintptr_t>(descriptor);
+            // Symbols are heap allocated and at least 16 byte aligned, drop the always-zero bits.
+            uint64_t h = (a >> 4u) * 0x9E3779B97F4A7C15ull ^ (b >> 4u) * 0xC2B2AE3D27D4EB4Full;
+            return static_cast<uint32_t>(h ^ (h >> 32u));
+        }
+
+        [[nodiscard]] inline uint32_t slotOf(const Symbol *name, const Symbol *descriptor) const {
+            return slotHash(name, descriptor) & mask;
+        }
+
+        void insert(const Symbol *name, const Symbol *descriptor, T *member) {
+            uint32_t i = slotOf(name, descriptor);
+            while (entries[i].member != nullptr) {
+                if (entries[i].name == name && entries[i].descriptor == descriptor) {
+                    // Duplicate members are a ClassFormatError, keep the first one.
+                    return;
+                }
+                i = (i + 1) & mask;
+            }
+            entries[i] = Entry{name, descriptor, member};
+        }
+
+    private:
+        std::unique_ptr<Entry[]> entries;
+        uint32_t mask = 0;
+    };
+}
@@ -0,0 +1,62 @@
+#include "tula/MemoryReport.hpp"
+#include "utils/Json.hpp"
+
+#include <iomanip>
+#include <sstream>
+
+namespace CCW::Tula {
+
+    static void writeItems(std::ostream &out, const char *title, const std::vector<MemoryReport::Item> &items) {
+        if (items.empty()) {
+            return;
+        }
+        out << '\n' << title << ":\n";
+        for (const auto &item : items) {
+            out << std::setw(12) << item.bytes << "  " << item.name << '\n';
+        }
+    }
+
+    std::string MemoryReport::toText() const {
+        std::ostringstream out;
+        out << std::left << std::setw(16) << "process" << std::right << std::setw(12) << "used"
+            << std::setw(12) << "reserved" << std::setw(10) << "count" << '\n';
+        for (const auto &category : processCategories) {
+            out << std::left << std::setw(16) << category.name << std::right << std::setw(12) << category.used
+                << std::setw(12) << category.reserved << std::setw(10) << category.count << '\n';
+        }
+        out << std::left << std::setw(16) << "total" << std::right << std::setw(12) << processUsed
+            << std::setw(12) << processReserved << '\n';
+        writeItems(out, "largest classes", largestClasses);
+        writeItems(out, "largest constant pools", largestConstantPools);
+        return out.str();
+    }
+
+    static void writeJsonItems(std::ostream &out, const std::vector<MemoryReport::Item> &items) {
+        out << '[';
+        for (size_t i = 0; i < items.size(); ++i) {
+            out << (i == 0 ? "" : ",") << "{\"name\":";
+            writeJsonString(out, items[i].name);
+            out << ",\"bytes\":" << items[i].bytes << '}';
+        }
+        out << ']';
+    }
+
+    std::string MemoryReport::toJson() const {
+        std::ostringstream out;
+        out << "{\"processUsed\":" << processUsed << ",\"processReserved\":" << processReserved
+            << ",\"processCategories\":[";
+        for (size_t i = 0; i < processCategories.size(); ++i) {
+            const auto &category = processCategories[i];
+            out << (i == 0 ? "" : ",") << "{\"name\":";
+            writeJsonString(out, category.name);
+            out << ",\"used\":" << category.used << ",\"reserved\":" << category.reserved
+                << ",\"count\":" << category.count << '}';
+        }
+        out << "],\"largestClasses\":";
+        writeJsonItems(out, largestClasses);
+        out << ",\"largestConstantPools\":";
+        writeJsonItems(out, largestConstantPools);
+        out << '}';
+        return out.str();
+    }
+}
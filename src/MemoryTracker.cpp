@@ -0,0 +1,20 @@
+#include "MemoryTracker.hpp"
+
+namespace CCW::Tula {
+
+    MemoryUsage MemoryTracker::usage(MemoryTag tag) {
+        auto &counter = counters[static_cast<size_t>(tag)];
+        return MemoryUsage{counter.used.load(std::memory_order_relaxed),
+                           counter.reserved.load(std::memory_order_relaxed),
+                           counter.count.load(std::memory_order_relaxed)};
+    }
+
+    const char *MemoryTracker::nameOf(MemoryTag tag) {
+        static const char *const names[] = {
+#define TULA_MEMORY_TAG_NAME(id, name) name,
+            TULA_MEMORY_TAGS(TULA_MEMORY_TAG_NAME)
+#undef TULA_MEMORY_TAG_NAME
+        };
+        return tag < MemoryTag::Count ? names[static_cast<size_t>(tag)] : "unknown";
+    }
+}
@@ -0,0 +1,73 @@
+#pragma once
+
+#include <CCW/Base.hpp>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+namespace CCW::Tula {
+
+    // Metadata memory categories: (id, report name).
+#define TULA_MEMORY_TAGS(do_tag)                      \
+    do_tag(Symbols, "symbols")                         \
+    do_tag(SymbolTable, "symbol table")                \
+    do_tag(ConstantPools, "constant pools")            \
+    do_tag(Methods, "methods")                         \
+    do_tag(Classes, "classes")                         \
+    do_tag(Metaspace, "metaspace")                     \
+    do_tag(ClassLoaders, "class loaders")
+
+    enum class MemoryTag : uint8_t {
+#define TULA_MEMORY_TAG_ID(id, name) id,
+        TULA_MEMORY_TAGS(TULA_MEMORY_TAG_ID)
+#undef TULA_MEMORY_TAG_ID
+        Count
+    };
+
+    struct MemoryUsage {
+        int64_t used = 0;
+        int64_t reserved = 0;
+        int64_t count = 0;
+    };
+
+    // Process-wide metadata accounting, always on: an update is two or three relaxed atomic adds on the
+    // tag's own cache line, made where the memory is allocated or released, never per access.
+    //
+    // `used` is what the subsystem asked for, `reserved` what it holds from the system: arena chunks
+    // are reserved by Metaspace and used by the categories allocating from them.
+    class MemoryTracker {
+    public:
+        static inline void record(MemoryTag tag, int64_t used, int64_t reserved, int64_t count = 0) {
+            auto &counter = counters[static_cast<size_t>(tag)];
+            counter.used.fetch_add(used, std::memory_order_relaxed);
+            counter.reserved.fetch_add(reserved, std::memory_order_relaxed);
+            if (count != 0) {
+                counter.count.fetch_add(count, std::memory_order_relaxed);
+            }
+        }
+
+        // Heap memory: used and reserved alike.
+        static inline void allocate(MemoryTag tag, size_t bytes, int64_t count = 1) {
+            record(tag, static_cast<int64_t>(bytes), static_cast<int64_t>(bytes), count);
+        }
+
+        static inline void release(MemoryTag tag, size_t bytes, int64_t count = 1) {
+            record(tag, -static_cast<int64_t>(bytes), -static_cast<int64_t>(bytes), -count);
+        }
+
+        static MemoryUsage usage(MemoryTag tag);
+
+        static const char *nameOf(MemoryTag tag);
+
+    private:
+        struct alignas(64) Counter {
+            std::atomic<int64_t> used{0};
+            std::atomic<int64_t> reserved{0};
+            std::atomic<int64_t> count{0};
+        };
+
+        static Counter counters[static_cast<size_t>(MemoryTag::Count)];
+    };
+
+    inline MemoryTracker::Counter MemoryTracker::counters[static_cast<size_t>(MemoryTag::Count)];
+}
@@ -0,0 +1,85 @@
+#include "Metaspace.hpp"
+
+#include <cstdlib>
+
+namespace CCW::Tula {
+
+    static std::atomic<size_t> gTotalReserved{0};
+
+    Metaspace::Metaspace(size_t chunkSize) : chunkSize(chunkSize) {
+        MemoryTracker::record(MemoryTag::Metaspace, 0, 0, 1);
+    }
+
+    Metaspace::~Metaspace() {
+        for (auto it = finalizers.rbegin(); it != finalizers.rend(); ++it) {
+            it->second(it->first);
+        }
+        for (auto chunk : chunks) {
+            std::free(chunk);
+        }
+        gTotalReserved.fetch_sub(reserved, std::memory_order_relaxed);
+        for (size_t tag = 0; tag < usedByTag.size(); ++tag) {
+            if (usedByTag[tag] != 0) {
+                MemoryTracker::record(static_cast<MemoryTag>(tag), -static_cast<int64_t>(usedByTag[tag]), 0);
+            }
+        }
+        MemoryTracker::record(MemoryTag::Metaspace, 0, -static_cast<int64_t>(reserved), -1);
+    }
+
+    void *Metaspace::allocate(size_t size, size_t alignment, MemoryTag tag) {
+        std::lock_guard<std::mutex> _{mutex};
+        auto aligned = reinterpret_cast<uint8_t *>(
+            (reinterpret_cast<uintptr_t>(top) + alignment - 1) & ~(uintptr_t(alignment) - 1));
+        if (top != nullptr && aligned + size <= end) {
+            account(tag, aligned + size - top);
+            top = aligned + size;
+            return aligned;
+        }
+
+        auto dedicated = size + alignment > chunkSize / 4;
+        auto chunkBytes = dedicated ? size + alignment : chunkSize;
+        auto chunk = static_cast<uint8_t *>(std::malloc(chunkBytes));
+        if (chunk == nullptr) {
+            throw std::bad_alloc();
+        }
+        chunks.push_back(chunk);
+        reserved += chunkBytes;
+        gTotalReserved.fetch_add(chunkBytes, std::memory_order_relaxed);
+        MemoryTracker::record(MemoryTag::Metaspace, 0, static_cast<int64_t>(chunkBytes));
+
+        aligned = reinterpret_cast<uint8_t *>(
+            (reinterpret_cast<uintptr_t>(chunk) + alignment - 1) & ~(uintptr_t(alignment) - 1));
+        account(tag, aligned + size - chunk);
+        // A dedicated chunk leaves the current chunk open for the small requests that follow.
+        if (!dedicated) {
+            top = aligned + size;
+            end = chunk + chunkBytes;
+        }
+        return aligned;
+    }
+
+    void Metaspace::account(MemoryTag tag, size_t bytes) {
+        used += bytes;
+        usedByTag[static_cast<size_t>(tag)] += bytes;
+        MemoryTracker::record(tag, static_cast<int64_t>(bytes), 0);
+    }
+
+    void Metaspace::addFinalizer(void *object, Finalizer finalizer) {
+        std::lock_guard<std::mutex> _{mutex};
+        finalizers.emplace_back(object, finalizer);
+    }
+
+    size_t Metaspace::getUsed() const {
+        std::lock_guard<std::mutex> _{mutex};
+        return used;
+    }
+
+    size_t Metaspace::getReserved() const {
+        std::lock_guard<std::mutex> _{mutex};
+        return reserved;
+    }
+
+    size_t Metaspace::totalReserved() {
+        return gTotalReserved.load(std::memory_order_relaxed);
+    }
+}
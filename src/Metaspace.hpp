@@ -0,0 +1,85 @@
+#pragma once
+
+#include "MemoryTracker.hpp"
+
+#include <CCW/Base.hpp>
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <new>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace CCW::Tula {
+
+    // A bump-pointer arena for the metadata of the classes of one class loader: constant pools,
+    // their entries and method blocks. Nothing is freed one by one; the arena releases everything
+    // at once when the loader and all its classes are gone, which is when the classes unload.
+    //
+    // Objects with destructors (symbol references, mostly) are destroyed in reverse creation order
+    // before the memory goes back, so the symbols they hold can leave the SymbolTable.
+    class Metaspace : public Noncopyable {
+    public:
+        static constexpr size_t DefaultChunkSize = 64 * 1024;
+
+        explicit Metaspace(size_t chunkSize = DefaultChunkSize);
+
+        ~Metaspace();
+
+        // Uninitialized memory living as long as the arena, accounted as used by `tag`. Requests larger
+        // than a quarter of a chunk get a chunk of their own.
+        void *allocate(size_t size, size_t alignment = alignof(std::max_align_t),
+                       MemoryTag tag = MemoryTag::Metaspace);
+
+        template<typename T, typename... Args>
+        T *create(MemoryTag tag, Args &&... args) {
+            auto object = new(allocate(sizeof(T), alignof(T), tag)) T(std::forward<Args>(args)...);
+            if constexpr (!std::is_trivially_destructible_v<T>) {
+                addFinalizer(object, [](void *p) { static_cast<T *>(p)->~T(); });
+            }
+            return object;
+        }
+
+        // A value-initialized array; T must be trivially destructible.
+        template<typename T>
+        T *createArray(MemoryTag tag, size_t count) {
+            static_assert(std::is_trivially_destructible_v<T>);
+            auto array = static_cast<T *>(allocate(sizeof(T) * count, alignof(T), tag));
+            for (size_t i = 0; i < count; ++i) {
+                new(array + i) T();
+            }
+            return array;
+        }
+
+        // Bytes handed out, including alignment padding.
+        [[nodiscard]] size_t getUsed() const;
+
+        // Bytes taken from the system.
+        [[nodiscard]] size_t getReserved() const;
+
+        // Bytes reserved by every live arena of the process.
+        static size_t totalReserved();
+
+    private:
+        using Finalizer = void (*)(void *);
+
+        void addFinalizer(void *object, Finalizer finalizer);
+
+        // Called with the lock held.
+        void account(MemoryTag tag, size_t bytes);
+
+    private:
+        const size_t chunkSize;
+        mutable std::mutex mutex;
+        std::vector<void *> chunks;
+        uint8_t *top = nullptr;
+        uint8_t *end = nullptr;
+        size_t used = 0;
+        size_t reserved = 0;
+        std::array<size_t, static_cast<size_t>(MemoryTag::Count)> usedByTag{};
+        std::vector<std::pair<void *, Finalizer>> finalizers;
+    };
+}
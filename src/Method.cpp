@@ -0,0 +1,256 @@
+#include "Method.hpp"
+#include "LineNumberStream.hpp"
+#include "Metaspace.hpp"
+#include "classfile/Descriptor.hpp"
+
+#include <algorithm>
+#include <cstdlib>
+#include <new>
+#include <set>
+#include <tuple>
+#include <utility>
+
+namespace CCW::Tula {
+
+    static inline uint32_t alignUp(uint32_t value, uint32_t alignment) {
+        return (value + alignment - 1) & ~(alignment - 1);
+    }
+
+    // Sweeps the start and end pcs of the exception table in order; between two consecutive pcs the set
+    // of covering entries is fixed. Pieces without entries are dropped, so the result is sorted,
+    // disjoint, and holds only covered pcs.
+    static void buildExceptionRanges(const std::vector<ExceptionTableElement> &table,
+                                     std::vector<ExceptionRange> &ranges, std::vector<uint16_t> &handlers) {
+        // (pc, isStart, entry) events; all events at one pc are applied together.
+        std::vector<std::tuple<uint16_t, bool, uint16_t>> events;
+        events.reserve(table.size() * 2);
+        for (size_t entry = 0; entry < table.size(); ++entry) {
+            if (table[entry].startPc < table[entry].endPc) {
+                events.emplace_back(table[entry].startPc, true, static_cast<uint16_t>(entry));
+                events.emplace_back(table[entry].endPc, false, static_cast<uint16_t>(entry));
+            }
+        }
+        std::sort(events.begin(), events.end());
+
+        std::set<uint16_t> active;
+        for (size_t i = 0; i < events.size();) {
+            auto pc = std::get<0>(events[i]);
+            for (; i < events.size() && std::get<0>(events[i]) == pc; ++i) {
+                if (std::get<1>(events[i])) {
+                    active.insert(std::get<2>(events[i]));
+                } else {
+                    active.erase(std::get<2>(events[i]));
+                }
+            }
+            if (active.empty() || i == events.size()) {
+                continue;
+            }
+            ExceptionRange range{static_cast<uint32_t>(handlers.size()), pc, std::get<0>(events[i]),
+                                 static_cast<uint16_t>(active.size())};
+            handlers.insert(handlers.end(), active.begin(), active.end());
+            // Merge with the previous piece when it is adjacent and has the same entries.
+            if (!ranges.empty()) {
+                auto &previous = ranges.back();
+                if (previous.endPc == range.startPc && previous.handlerCount == range.handlerCount
+                    && std::equal(handlers.begin() + previous.firstHandler,
+                                  handlers.begin() + previous.firstHandler + previous.handlerCount,
+                                  handlers.begin() + range.firstHandler)) {
+                    previous.endPc = range.endPc;
+                    handlers.resize(range.firstHandler);
+                    continue;
+                }
+            }
+            ranges.push_back(range);
+        }
+    }
+
+    Method::Ptr Method::create(InstanceKlass *holder, SymbolPtr name, SymbolPtr descriptor,
+                               MethodAccessFlags accessFlags, const MethodCode *code, Metaspace *metaspace) {
+        uint32_t size = sizeof(Method);
+        uint32_t exceptionTableOffset = 0;
+        uint32_t exceptionRangesOffset = 0;
+        uint32_t exceptionRangeHandlersOffset = 0;
+        uint32_t lineNumbersOffset = 0;
+        uint32_t stackMapTableOffset = 0;
+        std::vector<ExceptionRange> exceptionRanges;
+        std::vector<uint16_t> exceptionRangeHandlers;
+        if (code != nullptr) {
+            size += code->codeLength;
+            size = alignUp(size, alignof(ExceptionTableElement));
+            exceptionTableOffset = size;
+            size += code->exceptionTable.size() * sizeof(ExceptionTableElement);
+            if (!code->exceptionTable.empty()) {
+                buildExceptionRanges(code->exceptionTable, exceptionRanges, exceptionRangeHandlers);
+                size = alignUp(size, alignof(ExceptionRange));
+                exceptionRangesOffset = size;
+                size += exceptionRanges.size() * sizeof(ExceptionRange);
+                exceptionRangeHandlersOffset = size;
+                size += exceptionRangeHandlers.size() * sizeof(uint16_t);
+            }
+            if (!code->lineNumbers.empty()) {
+                lineNumbersOffset = size;
+                size += code->lineNumbers.size();
+            }
+            stackMapTableOffset = size;
+            size += code->stackMapTableLength;
+        }
+
+        void *block = metaspace != nullptr ? metaspace->allocate(size, Alignment, MemoryTag::Methods)
+                                           : std::aligned_alloc(Alignment, alignUp(size, Alignment));
+        if (block == nullptr) {
+            throw std::bad_alloc();
+        }
+        if (metaspace != nullptr) {
+            MemoryTracker::record(MemoryTag::Methods, 0, 0, 1);
+        } else {
+            MemoryTracker::allocate(MemoryTag::Methods, alignUp(size, Alignment));
+        }
+        Ptr method(new(block) Method(holder, std::move(name), std::move(descriptor), accessFlags));
+        method->size = size;
+        method->inMetaspace = metaspace != nullptr;
+        auto base = reinterpret_cast<uint8_t *>(block);
+
+        int slots = Descriptor::parameterSlots(method->methodDescriptor->getBytes(),
+                                               method->methodDescriptor->getLength());
+        CCW_ASSERT(slots >= 0);
+        method->argumentSlots = static_cast<uint16_t>(slots + (method->isStatic() ? 0 : 1));
+
+        if (code != nullptr) {
+            method->maxStack = code->maxStack;
+            method->maxLocals = code->maxLocals;
+            method->codeLength = code->codeLength;
+            memcpy(base + sizeof(Method), code->code, code->codeLength);
+
+            method->exceptionTableOffset = exceptionTableOffset;
+            method->exceptionTableLength = static_cast<uint16_t>(code->exceptionTable.size());
+            if (!code->exceptionTable.empty()) {
+                memcpy(base + exceptionTableOffset, code->exceptionTable.data(),
+                       code->exceptionTable.size() * sizeof(ExceptionTableElement));
+                method->exceptionRangesOffset = exceptionRangesOffset;
+                method->exceptionRangeCount = static_cast<uint32_t>(exceptionRanges.size());
+                memcpy(base + exceptionRangesOffset, exceptionRanges.data(),
+                       exceptionRanges.size() * sizeof(ExceptionRange));
+                method->exceptionRangeHandlersOffset = exceptionRangeHandlersOffset;
+                memcpy(base + exceptionRangeHandlersOffset, exceptionRangeHandlers.data(),
+                       exceptionRangeHandlers.size() * sizeof(uint16_t));
+            }
+
+            method->lineNumbersOffset = lineNumbersOffset;
+            if (lineNumbersOffset != 0) {
+                memcpy(base + lineNumbersOffset, code->lineNumbers.data(), code->lineNumbers.size());
+            }
+
+            method->stackMapTableOffset = stackMapTableOffset;
+            method->stackMapTableLength = code->stackMapTableLength;
+            if (code->stackMapTableLength != 0) {
+                memcpy(base + stackMapTableOffset, code->stackMapTable, code->stackMapTableLength);
+            }
+        }
+        return method;
+    }
+
+    void Method::Deleter::operator()(Method *method) const {
+        auto inMetaspace = method->inMetaspace;
+        auto size = method->size;
+        method->~Method();
+        if (inMetaspace) {
+            MemoryTracker::record(MemoryTag::Methods, 0, 0, -1);
+        } else {
+            MemoryTracker::release(MemoryTag::Methods, alignUp(size, Alignment));
+            std::free(method);
+        }
+    }
+
+    Method::Method(InstanceKlass *holder, SymbolPtr name, SymbolPtr descriptor, MethodAccessFlags accessFlags) :
+        accessFlags(accessFlags),
+        holder(holder),
+        methodName(std::move(name)),
+        methodDescriptor(std::move(descriptor)) {
+    }
+
+    // Open addressed by (bci, kind); a key is claimed once and never released, so the table only
+    // fills up. Allocated on the first implicit exception and freed with the method.
+    struct Method::ThrowSites {
+        static constexpr size_t Capacity = 8;
+
+        std::atomic<uint32_t> keys[Capacity] = {};      // (bci << 8 | kind) + 1, zero when free
+        std::atomic<uint32_t> counts[Capacity] = {};
+    };
+
+    Method::~Method() {
+        delete throwSites.load(std::memory_order_relaxed);
+    }
+
+    bool Method::isHotThrowSite(uint16_t bci, uint8_t kind, uint32_t threshold) const {
+        auto sites = throwSites.load(std::memory_order_acquire);
+        if (sites == nullptr) {
+            auto fresh = new ThrowSites();
+            if (throwSites.compare_exchange_strong(sites, fresh, std::memory_order_acq_rel)) {
+                sites = fresh;
+            } else {
+                delete fresh;
+            }
+        }
+        auto key = (uint32_t(bci) << 8u | kind) + 1;
+        for (size_t probe = 0; probe < ThrowSites::Capacity; ++probe) {
+            auto i = (key + probe) % ThrowSites::Capacity;
+            auto current = sites->keys[i].load(std::memory_order_relaxed);
+            if (current == 0 && sites->keys[i].compare_exchange_strong(current, key, std::memory_order_relaxed)) {
+                current = key;
+            }
+            if (current == key) {
+                if (sites->counts[i].load(std::memory_order_relaxed) >= threshold) {
+                    return true;
+                }
+                sites->counts[i].fetch_add(1, std::memory_order_relaxed);
+                return false;
+            }
+        }
+        return false;
+    }
+
+    bool Method::isInitializer() const {
+        return methodName->equals("<init>");
+    }
+
+    bool Method::isStaticInitializer() const {
+        return methodName->equals("<clinit>");
+    }
+
+    bool Method::hasSameSignature(const Method *other) const {
+        return *methodName == *other->methodName && *methodDescriptor == *other->methodDescriptor;
+    }
+
+    const ExceptionRange *Method::findExceptionRange(uint16_t bci) const {
+        auto begin = getExceptionRanges();
+        auto end = begin + exceptionRangeCount;
+        auto it = std::upper_bound(begin, end, bci, [](uint16_t pc, const ExceptionRange &range) {
+            return pc < range.startPc;
+        });
+        if (it == begin || bci >= (it - 1)->endPc) {
+            return nullptr;
+        }
+        return it - 1;
+    }
+
+    int Method::getLineNumber(uint16_t bci) const {
+        if (!hasLineNumbers()) {
+            return -1;
+        }
+        // Entries are in class file order, which javac emits sorted but the spec does not require:
+        // take the closest entry at or before `bci`.
+        int bestBci = -1;
+        int bestLine = -1;
+        LineNumberStreamReader reader(getLineNumbers());
+        while (reader.next()) {
+            if (reader.getBci() == bci) {
+                return reader.getLine();
+            }
+            if (reader.getBci() < bci && reader.getBci() > bestBci) {
+                bestBci = reader.getBci();
+                bestLine = reader.getLine();
+            }
+        }
+        return bestLine;
+    }
+}
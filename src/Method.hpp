@@ -0,0 +1,298 @@
+#pragma once
+
+#include "JVM.hpp"
+#include "Symbol.hpp"
+#include "intrinsics/Intrinsics.hpp"
+
+#include <atomic>
+#include <memory>
+#include <vector>
+
+namespace CCW::Tula {
+
+    class InstanceKlass;
+    class Metaspace;
+
+    struct NativeEntry;
+
+    struct ExceptionTableElement {
+        uint16_t startPc;
+        uint16_t endPc;
+        uint16_t handlerPc;
+        uint16_t catchTypeIndex;
+    };
+
+    // A pc range [startPc, endPc) covered by the same exception table entries. The ranges of a method
+    // are sorted and disjoint, so the handlers of a bci are found by binary search instead of scanning
+    // the whole table; `handlerCount` entry indices starting at `firstHandler` keep the table order.
+    struct ExceptionRange {
+        uint32_t firstHandler;
+        uint16_t startPc;
+        uint16_t endPc;
+        uint16_t handlerCount;
+    };
+
+    // Everything the parser extracted from a Code attribute, copied into the Method block by Method::create.
+    struct MethodCode {
+        uint16_t maxStack = 0;
+        uint16_t maxLocals = 0;
+        const uint8_t *code = nullptr;
+        uint32_t codeLength = 0;
+        std::vector<ExceptionTableElement> exceptionTable;
+        std::vector<uint8_t> lineNumbers;     // compressed, see LineNumberStream
+        const uint8_t *stackMapTable = nullptr;
+        uint32_t stackMapTableLength = 0;
+    };
+
+    // A method is one contiguous, cache line aligned block:
+    //
+    //   [ hot header | bytecode | exception table | exception ranges | line numbers | StackMapTable ]
+    //
+    // The header starts with what the interpreter reads on every call, the bytecode follows right
+    // after it, and metadata only needed for exceptions, stack traces or verification comes last.
+    class Method : public Noncopyable {
+    public:
+        static constexpr int InvalidIndex = -1;
+        static constexpr size_t Alignment = 64;
+
+        // Destroys a method; the block is freed unless it belongs to a metaspace.
+        struct Deleter {
+            void operator()(Method *method) const;
+        };
+
+        using Ptr = std::unique_ptr<Method, Deleter>;
+
+        // Allocates the block in `metaspace` when given, otherwise on the C heap.
+        static Ptr create(InstanceKlass *holder, SymbolPtr name, SymbolPtr descriptor, MethodAccessFlags accessFlags,
+                          const MethodCode *code = nullptr, Metaspace *metaspace = nullptr);
+
+        ~Method();
+
+        [[nodiscard]] inline InstanceKlass *getHolder() const {
+            return holder;
+        }
+
+        [[nodiscard]] inline const SymbolPtr &name() const {
+            return methodName;
+        }
+
+        [[nodiscard]] inline const SymbolPtr &descriptor() const {
+            return methodDescriptor;
+        }
+
+        [[nodiscard]] inline MethodAccessFlags getAccessFlags() const {
+            return accessFlags;
+        }
+
+        [[nodiscard]] inline bool isStatic() const {
+            return accessFlags & MethodAccessFlags::Static;
+        }
+
+        [[nodiscard]] inline bool isPrivate() const {
+            return accessFlags & MethodAccessFlags::Private;
+        }
+
+        [[nodiscard]] inline bool isFinal() const {
+            return accessFlags & MethodAccessFlags::Final;
+        }
+
+        [[nodiscard]] inline bool isAbstract() const {
+            return accessFlags & MethodAccessFlags::Abstract;
+        }
+
+        [[nodiscard]] inline bool isNative() const {
+            return accessFlags & MethodAccessFlags::Native;
+        }
+
+        [[nodiscard]] inline bool isPublic() const {
+            return accessFlags & MethodAccessFlags::Public;
+        }
+
+        [[nodiscard]] inline bool isProtected() const {
+            return accessFlags & MethodAccessFlags::Protected;
+        }
+
+        [[nodiscard]] inline bool isPackagePrivate() const {
+            return !(isPublic() || isProtected() || isPrivate());
+        }
+
+        [[nodiscard]] bool isInitializer() const;
+
+        [[nodiscard]] bool isStaticInitializer() const;
+
+        [[nodiscard]] bool hasSameSignature(const Method *other) const;
+
+        // Slot in the holder's vtable, or InvalidIndex when the method is statically bound.
+        [[nodiscard]] inline int getVTableIndex() const {
+            return vtableIndex;
+        }
+
+        inline void setVTableIndex(int index) {
+            vtableIndex = index;
+        }
+
+        // Selector of an interface method inside the itable block of its interface.
+        [[nodiscard]] inline int getITableIndex() const {
+            return itableIndex;
+        }
+
+        inline void setITableIndex(int index) {
+            itableIndex = index;
+        }
+
+        // The native kernel that replaces this method, or IntrinsicId::None; set when the class is loaded.
+        [[nodiscard]] inline IntrinsicId getIntrinsicId() const {
+            return intrinsicId;
+        }
+
+        inline void setIntrinsicId(IntrinsicId id) {
+            intrinsicId = id;
+        }
+
+        // The call descriptor of a linked native method, or null until NativeLinker::link() binds it.
+        // Methods are shared between VMs, so this caches the entry of the first VM to link it; the
+        // entry's owner tells whose it is.
+        [[nodiscard]] inline const NativeEntry *getNativeEntry() const {
+            return nativeEntry.load(std::memory_order_acquire);
+        }
+
+        inline bool replaceNativeEntry(const NativeEntry *expected, const NativeEntry *entry) {
+            return nativeEntry.compare_exchange_strong(expected, entry, std::memory_order_acq_rel);
+        }
+
+        // Local variable slots taken by the arguments, including `this` for instance methods.
+        [[nodiscard]] inline uint16_t getArgumentSlots() const {
+            return argumentSlots;
+        }
+
+        [[nodiscard]] inline bool hasCode() const {
+            return codeLength != 0;
+        }
+
+        [[nodiscard]] inline uint16_t getMaxStack() const {
+            return maxStack;
+        }
+
+        [[nodiscard]] inline uint16_t getMaxLocals() const {
+            return maxLocals;
+        }
+
+        [[nodiscard]] inline uint32_t getCodeLength() const {
+            return codeLength;
+        }
+
+        [[nodiscard]] inline const uint8_t *getCode() const {
+            return reinterpret_cast<const uint8_t *>(this) + sizeof(Method);
+        }
+
+        [[nodiscard]] inline uint16_t getExceptionTableLength() const {
+            return exceptionTableLength;
+        }
+
+        [[nodiscard]] inline const ExceptionTableElement *getExceptionTable() const {
+            return reinterpret_cast<const ExceptionTableElement *>(
+                reinterpret_cast<const uint8_t *>(this) + exceptionTableOffset);
+        }
+
+        [[nodiscard]] inline uint32_t getExceptionRangeCount() const {
+            return exceptionRangeCount;
+        }
+
+        [[nodiscard]] inline const ExceptionRange *getExceptionRanges() const {
+            return reinterpret_cast<const ExceptionRange *>(
+                reinterpret_cast<const uint8_t *>(this) + exceptionRangesOffset);
+        }
+
+        // The range covering `bci`, or null when no exception table entry covers it.
+        [[nodiscard]] const ExceptionRange *findExceptionRange(uint16_t bci) const;
+
+        // Handler pc for an exception thrown at `bci`: the first exception table entry, in table order,
+        // that covers `bci` and whose catch type is zero or accepted by `matches(catchTypeIndex)`.
+        // Returns -1 when the exception propagates to the caller.
+        template<typename Matches>
+        int findExceptionHandler(uint16_t bci, Matches &&matches) const {
+            auto range = findExceptionRange(bci);
+            if (range == nullptr) {
+                return -1;
+            }
+            auto table = getExceptionTable();
+            auto handlers = getExceptionRangeHandlers() + range->firstHandler;
+            for (uint16_t i = 0; i < range->handlerCount; ++i) {
+                const auto &element = table[handlers[i]];
+                if (element.catchTypeIndex == 0 || matches(element.catchTypeIndex)) {
+                    return element.handlerPc;
+                }
+            }
+            return -1;
+        }
+
+        [[nodiscard]] inline bool hasLineNumbers() const {
+            return lineNumbersOffset != 0;
+        }
+
+        // Start of the compressed line number stream, only valid when hasLineNumbers().
+        [[nodiscard]] inline const uint8_t *getLineNumbers() const {
+            return reinterpret_cast<const uint8_t *>(this) + lineNumbersOffset;
+        }
+
+        // Source line of `bci`, or -1 when unknown.
+        [[nodiscard]] int getLineNumber(uint16_t bci) const;
+
+        [[nodiscard]] inline uint32_t getStackMapTableLength() const {
+            return stackMapTableLength;
+        }
+
+        // Raw StackMapTable attribute body, starting with number_of_entries.
+        [[nodiscard]] inline const uint8_t *getStackMapTable() const {
+            return reinterpret_cast<const uint8_t *>(this) + stackMapTableOffset;
+        }
+
+        // Counts an implicit exception of `kind` thrown at `bci` and tells whether the site already threw it
+        // `threshold` times. Lock-free; the method tracks a few sites and never calls the others hot.
+        bool isHotThrowSite(uint16_t bci, uint8_t kind, uint32_t threshold) const;
+
+        // Total size of the method block in bytes.
+        [[nodiscard]] inline uint32_t getSize() const {
+            return size;
+        }
+
+    private:
+        struct ThrowSites;
+
+        Method(InstanceKlass *holder, SymbolPtr name, SymbolPtr descriptor, MethodAccessFlags accessFlags);
+
+        // Exception table indices referenced by ExceptionRange::firstHandler.
+        [[nodiscard]] inline const uint16_t *getExceptionRangeHandlers() const {
+            return reinterpret_cast<const uint16_t *>(
+                reinterpret_cast<const uint8_t *>(this) + exceptionRangeHandlersOffset);
+        }
+
+    private:
+        // Hot: read on every invocation and while interpreting.
+        MethodAccessFlags accessFlags;
+        uint32_t codeLength = 0;
+        uint16_t maxStack = 0;
+        uint16_t maxLocals = 0;
+        uint16_t argumentSlots = 0;
+        uint16_t exceptionTableLength = 0;
+        IntrinsicId intrinsicId = IntrinsicId::None;
+        int vtableIndex = InvalidIndex;
+        int itableIndex = InvalidIndex;
+        InstanceKlass *holder;
+        std::atomic<const NativeEntry *> nativeEntry{nullptr};
+
+        // Cold: resolution, stack traces and verification.
+        SymbolPtr methodName;
+        SymbolPtr methodDescriptor;
+        uint32_t size = 0;
+        uint32_t exceptionTableOffset = 0;
+        uint32_t exceptionRangesOffset = 0;
+        uint32_t exceptionRangeCount = 0;
+        uint32_t exceptionRangeHandlersOffset = 0;
+        uint32_t lineNumbersOffset = 0;
+        uint32_t stackMapTableOffset = 0;
+        uint32_t stackMapTableLength = 0;
+        bool inMetaspace = false;
+        mutable std::atomic<ThrowSites *> throwSites{nullptr};
+    };
+}
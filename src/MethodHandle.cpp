@@ -0,0 +1,40 @@
+#include "tula/MethodHandle.hpp"
+#include "Error.hpp"
+#include "JavaThread.hpp"
+#include "Klass.hpp"
+#include "native/NativeStubs.hpp"
+
+namespace CCW::Tula {
+
+    void MethodHandle::signatureMismatch(const std::string &types) const {
+        throw Error("Arguments (" + types.substr(1) + ")" + types[0] + " do not match "
+                    + method->getHolder()->getName()->toString() + "." + method->name()->toString()
+                    + method->descriptor()->toString());
+    }
+
+    void *MethodHandle::enter() const {
+        CCW_ASSERT(isValid());
+        auto thread = JavaThread::current();
+        if (thread == nullptr || thread->getVM() != vm) {
+            throw Error("Thread is not attached to the VM of " + method->name()->toString());
+        }
+        return thread->getEnv();
+    }
+
+    MethodHandle::Slot MethodHandle::invokeEntered(void *context, const Slot *slots) const {
+        // VM::resolveStatic() only hands out natives until there is an interpreter.
+        CCW_ASSERT(entry != nullptr);
+        return entry->invoke(context, holder, slots);
+    }
+
+    MethodHandle::Slot MethodHandle::invoke(const Slot *slots) const {
+        return invokeEntered(enter(), slots);
+    }
+
+    void MethodHandle::invokeBatch(const Slot *slots, size_t count, Slot *results) const {
+        auto context = enter();
+        for (size_t n = 0; n < count; ++n, slots += argumentSlots) {
+            results[n] = invokeEntered(context, slots);
+        }
+    }
+}
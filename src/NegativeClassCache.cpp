@@ -0,0 +1,150 @@
+#include "NegativeClassCache.hpp"
+#include "MemoryTracker.hpp"
+
+#include <algorithm>
+
+namespace CCW::Tula {
+
+    NegativeClassCache::NegativeClassCache(std::vector<std::string> classPath, size_t capacity,
+                                           std::chrono::milliseconds revalidateAfter) :
+        classPath(std::move(classPath)),
+        revalidateAfter(std::chrono::duration_cast<std::chrono::nanoseconds>(revalidateAfter).count()),
+        startedAt(now()),
+        slotsPerShard(std::max<size_t>(1, (capacity + ShardCount - 1) / ShardCount)) {
+        for (auto &shard : shards) {
+            shard.slots.resize(slotsPerShard);
+        }
+        MemoryTracker::allocate(MemoryTag::ClassLoaders, ShardCount * slotsPerShard * sizeof(Slot), 0);
+    }
+
+    NegativeClassCache::~NegativeClassCache() {
+        MemoryTracker::release(MemoryTag::ClassLoaders, ShardCount * slotsPerShard * sizeof(Slot), 0);
+    }
+
+    NegativeClassCache::Shard &NegativeClassCache::shardOf(const SymbolPtr &name) {
+        auto hash = name->hash();
+        return shards[(hash ^ (hash >> 16u)) % ShardCount];
+    }
+
+    std::string NegativeClassCache::directoryOf(const std::string &root, const std::string &className) const {
+        auto directory = root.empty() ? std::string("./") : root.back() == '/' ? root : root + '/';
+        auto slash = className.rfind('/');
+        return slash == std::string::npos ? directory : directory + className.substr(0, slash + 1);
+    }
+
+    uint64_t NegativeClassCache::stampDirectories(const std::string &className) const {
+        uint64_t digest = 0xcbf29ce484222325ull;
+        for (auto &root : classPath) {
+            ClassFileStamp stamp;
+            if (!ClassFileStamp::of(directoryOf(root, className), stamp)) {
+                stamp = {};
+            }
+            for (auto value : {stamp.size, static_cast<uint64_t>(stamp.modified), stamp.device, stamp.inode}) {
+                digest = (digest ^ value) * 0x100000001b3ull;
+            }
+        }
+        return digest;
+    }
+
+    int64_t NegativeClassCache::now() {
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now().time_since_epoch()).count();
+    }
+
+    void NegativeClassCache::forget(Shard &shard, size_t index) {
+        auto &slot = shard.slots[index];
+        shard.indexes.erase(slot.name.get());
+        slot.name.reset();
+    }
+
+    bool NegativeClassCache::isAbsent(const SymbolPtr &name) {
+        auto &shard = shardOf(name);
+        std::lock_guard<std::mutex> _{shard.lock};
+        shard.lookups++;
+        auto it = shard.indexes.find(name.get());
+        if (it == shard.indexes.end()) {
+            return false;
+        }
+        auto &slot = shard.slots[it->second];
+        auto time = now();
+        if (time - slot.checkedAt >= revalidateAfter) {
+            // Rare enough to stat under the lock: once per interval and absent name.
+            if (stampDirectories(name->toString()) != slot.directories) {
+                forget(shard, it->second);
+                shard.invalidations++;
+                return false;
+            }
+            slot.checkedAt = time;
+        }
+        shard.hits++;
+        return true;
+    }
+
+    void NegativeClassCache::recordAbsent(const SymbolPtr &name) {
+        auto className = name->toString();
+        // Stamping the directories before looking for the file again makes sure a file created in
+        // between changes the stamps, if it is not found right here.
+        auto stamp = stampDirectories(className);
+        auto simpleName = className.substr(className.rfind('/') + 1) + ".class";
+        bool appeared = std::any_of(classPath.begin(), classPath.end(), [&](const std::string &root) {
+            ClassFileStamp file;
+            return ClassFileStamp::of(directoryOf(root, className) + simpleName, file);
+        });
+
+        auto &shard = shardOf(name);
+        std::lock_guard<std::mutex> _{shard.lock};
+        shard.misses++;
+        if (appeared) {
+            return;
+        }
+        auto time = now();
+        auto it = shard.indexes.find(name.get());
+        if (it != shard.indexes.end()) {
+            auto &slot = shard.slots[it->second];
+            slot.directories = stamp;
+            slot.checkedAt = time;
+            return;
+        }
+        auto index = shard.hand;
+        shard.hand = (shard.hand + 1) % slotsPerShard;
+        if (shard.slots[index].name != nullptr) {
+            forget(shard, index);
+            shard.evictions++;
+        }
+        shard.slots[index] = Slot{name, stamp, time};
+        shard.indexes.emplace(name.get(), index);
+    }
+
+    void NegativeClassCache::countMiss(const SymbolPtr &name) {
+        auto &shard = shardOf(name);
+        std::lock_guard<std::mutex> _{shard.lock};
+        shard.misses++;
+    }
+
+    void NegativeClassCache::invalidate() {
+        for (auto &shard : shards) {
+            std::lock_guard<std::mutex> _{shard.lock};
+            shard.invalidations += shard.indexes.size();
+            for (auto &slot : shard.slots) {
+                slot.name.reset();
+            }
+            shard.indexes.clear();
+            shard.hand = 0;
+        }
+    }
+
+    ClassLookupStats NegativeClassCache::getStats() const {
+        ClassLookupStats stats;
+        for (auto &shard : shards) {
+            std::lock_guard<std::mutex> _{shard.lock};
+            stats.lookups += shard.lookups;
+            stats.hits += shard.hits;
+            stats.misses += shard.misses;
+            stats.evictions += shard.evictions;
+            stats.invalidations += shard.invalidations;
+            stats.size += shard.indexes.size();
+        }
+        stats.seconds = static_cast<double>(now() - startedAt) / 1e9;
+        return stats;
+    }
+}
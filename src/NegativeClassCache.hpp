@@ -0,0 +1,95 @@
+#pragma once
+
+#include "SharedClassTable.hpp"
+#include "Symbol.hpp"
+#include "tula/ClassLookupStats.hpp"
+
+#include <CCW/Base.hpp>
+#include <array>
+#include <chrono>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace CCW::Tula {
+
+    // Names of classes known to be absent from the class path directories, so that code probing for
+    // optional classes over and over fails without touching the file system each time.
+    //
+    // An absence holds while the directories that would contain the class, one per class path root,
+    // are unchanged: adding, removing or renaming a file in a directory changes its modification time.
+    // Hits trust the directories for `revalidateAfter` and stat() them again once that has passed, so a
+    // class added to the class path is found at most that much later; invalidate() forgets every
+    // absence right away.
+    //
+    // The cache holds about `capacity` names and forgets the oldest first. Names are spread over shards
+    // with a lock each, like the symbol table, so concurrent probes rarely wait for each other.
+    class NegativeClassCache : public Noncopyable {
+    public:
+        static constexpr size_t DefaultCapacity = 4096;
+
+        static constexpr std::chrono::milliseconds DefaultRevalidation{1000};
+
+        explicit NegativeClassCache(std::vector<std::string> classPath, size_t capacity = DefaultCapacity,
+                                    std::chrono::milliseconds revalidateAfter = DefaultRevalidation);
+
+        ~NegativeClassCache();
+
+        // True when `name` (interned, internal form) is known to be absent.
+        bool isAbsent(const SymbolPtr &name);
+
+        // Remembers that the class path has no class file for `name`, unless one appeared meanwhile.
+        void recordAbsent(const SymbolPtr &name);
+
+        // Counts a miss of a lookup that did not touch the file system, without remembering the name.
+        void countMiss(const SymbolPtr &name);
+
+        // Forgets every absence, for instance after classes were written to the class path.
+        void invalidate();
+
+        [[nodiscard]] ClassLookupStats getStats() const;
+
+    private:
+        static constexpr size_t ShardCount = 16;
+
+        struct Slot {
+            SymbolPtr name;
+            uint64_t directories = 0;   // digest of the directory stamps
+            int64_t checkedAt = 0;      // nanoseconds, steady clock
+        };
+
+        // Slots are reused in insertion order, so the oldest absence is the one evicted.
+        struct alignas(64) Shard {
+            std::mutex lock;
+            std::vector<Slot> slots;
+            std::unordered_map<const Symbol *, size_t> indexes;
+            size_t hand = 0;
+            uint64_t lookups = 0;
+            uint64_t hits = 0;
+            uint64_t misses = 0;
+            uint64_t evictions = 0;
+            uint64_t invalidations = 0;
+        };
+
+        Shard &shardOf(const SymbolPtr &name);
+
+        // The package directory of `className` in `root`, with a trailing '/'.
+        std::string directoryOf(const std::string &root, const std::string &className) const;
+
+        // A digest of the stamps of the package directories of `className` in every root; missing ones
+        // count as zero stamps.
+        uint64_t stampDirectories(const std::string &className) const;
+
+        static int64_t now();
+
+        static void forget(Shard &shard, size_t index);
+
+    private:
+        const std::vector<std::string> classPath;
+        const int64_t revalidateAfter;
+        const int64_t startedAt;
+        size_t slotsPerShard;
+        mutable std::array<Shard, ShardCount> shards;
+    };
+}
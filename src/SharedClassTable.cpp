@@ -0,0 +1,94 @@
+#include "SharedClassTable.hpp"
+
+#include <algorithm>
+#include <sys/stat.h>
+
+namespace CCW::Tula {
+
+    static std::mutex gSharedClassTableLock;
+    static SharedClassTable *gSharedClassTable;
+    static size_t gSharedClassTableUsers;
+
+    static void stampOf(const struct stat &status, ClassFileStamp &stamp) {
+        stamp.size = static_cast<uint64_t>(status.st_size);
+        stamp.modified = static_cast<int64_t>(status.st_mtim.tv_sec) * 1000000000 + status.st_mtim.tv_nsec;
+        stamp.device = static_cast<uint64_t>(status.st_dev);
+        stamp.inode = static_cast<uint64_t>(status.st_ino);
+    }
+
+    bool ClassFileStamp::of(const std::string &path, ClassFileStamp &stamp) {
+        struct stat status{};
+        if (stat(path.c_str(), &status) != 0) {
+            return false;
+        }
+        stampOf(status, stamp);
+        return true;
+    }
+
+    bool ClassFileStamp::ofDescriptor(int fd, ClassFileStamp &stamp) {
+        struct stat status{};
+        if (fstat(fd, &status) != 0) {
+            return false;
+        }
+        stampOf(status, stamp);
+        return true;
+    }
+
+    void SharedClassTable::init() {
+        std::lock_guard<std::mutex> _{gSharedClassTableLock};
+        if (gSharedClassTableUsers++ == 0) {
+            gSharedClassTable = new SharedClassTable();
+        }
+    }
+
+    void SharedClassTable::release() {
+        std::lock_guard<std::mutex> _{gSharedClassTableLock};
+        if (--gSharedClassTableUsers == 0) {
+            delete gSharedClassTable;
+            gSharedClassTable = nullptr;
+        }
+    }
+
+    Klass::Ptr SharedClassTable::find(const std::string &path, const ClassFileStamp &stamp, bool verified) {
+        std::lock_guard<std::mutex> _{gSharedClassTable->mutex};
+        auto it = gSharedClassTable->classes.find(path);
+        if (it == gSharedClassTable->classes.end() || !(it->second.stamp == stamp)
+            || (verified && !it->second.verified)) {
+            return nullptr;
+        }
+        return it->second.klass.lock();
+    }
+
+    Klass::Ptr SharedClassTable::insert(const std::string &path, const ClassFileStamp &stamp, bool verified,
+                                        const Klass::Ptr &klass) {
+        std::lock_guard<std::mutex> _{gSharedClassTable->mutex};
+        auto &table = *gSharedClassTable;
+        if (table.classes.size() >= table.pruneAt) {
+            table.prune();
+            table.pruneAt = std::max<size_t>(64, table.classes.size() * 2);
+        }
+        auto [it, inserted] = table.classes.try_emplace(path, Entry{stamp, verified, klass});
+        auto &entry = it->second;
+        if (!inserted) {
+            auto existing = entry.klass.lock();
+            if (existing != nullptr && entry.stamp == stamp && (entry.verified || !verified)) {
+                return existing;
+            }
+            // A stale or weaker entry; VMs holding its class keep it alive.
+            entry = Entry{stamp, verified, klass};
+        }
+        return klass;
+    }
+
+    size_t SharedClassTable::size() {
+        std::lock_guard<std::mutex> _{gSharedClassTable->mutex};
+        gSharedClassTable->prune();
+        return gSharedClassTable->classes.size();
+    }
+
+    void SharedClassTable::prune() {
+        for (auto it = classes.begin(); it != classes.end();) {
+            it = it->second.klass.expired() ? classes.erase(it) : std::next(it);
+        }
+    }
+}
@@ -0,0 +1,77 @@
+#pragma once
+
+#include "Klass.hpp"
+
+#include <CCW/Base.hpp>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+
+namespace CCW::Tula {
+
+    // Identifies the contents of a class file without reading it, like a make rule: a file rewritten
+    // in place gets a new modification time and is parsed again.
+    struct ClassFileStamp {
+        uint64_t size = 0;
+        int64_t modified = 0;   // nanoseconds
+        uint64_t device = 0;
+        uint64_t inode = 0;
+
+        // Stamps the file at `path`; false when it cannot be stat()ed.
+        static bool of(const std::string &path, ClassFileStamp &stamp);
+
+        // Stamps the open file `fd`; false when it cannot be fstat()ed.
+        static bool ofDescriptor(int fd, ClassFileStamp &stamp);
+
+        inline bool operator==(const ClassFileStamp &other) const {
+            return size == other.size && modified == other.modified && device == other.device
+                   && inode == other.inode;
+        }
+    };
+
+    // Classes parsed by any VM of the process, by class file path. Parsed metadata (constant pool,
+    // methods, fields, tables) is immutable once linked, so VMs loading the same file share one
+    // InstanceKlass and pay the parse and verification once; what differs per VM (initialization,
+    // patched init barriers, linked natives) is kept per isolate by the class itself.
+    //
+    // The table does not keep classes alive: once no VM's loader refers to a class, it unloads and
+    // its entry goes stale.
+    class SharedClassTable : public Noncopyable {
+    public:
+        // The class defined from `path` when the file still has `stamp`, or null. A class defined
+        // without verification is not returned when `verified` is requested.
+        static Klass::Ptr find(const std::string &path, const ClassFileStamp &stamp, bool verified);
+
+        // Publishes a class parsed from `path` and returns the one to use: a live class another VM
+        // published for the same file meanwhile wins, unless it is unverified and `klass` is not.
+        static Klass::Ptr insert(const std::string &path, const ClassFileStamp &stamp, bool verified,
+                                 const Klass::Ptr &klass);
+
+        // Live entries.
+        static size_t size();
+
+    private:
+        friend class VM;
+
+        // Created by the first VM and destroyed by the last.
+        static void init();
+
+        static void release();
+
+        struct Entry {
+            ClassFileStamp stamp;
+            bool verified;
+            std::weak_ptr<Klass> klass;
+        };
+
+        // Drops the entries of unloaded classes.
+        void prune();
+
+    private:
+        std::mutex mutex;
+        std::unordered_map<std::string, Entry> classes;
+        size_t pruneAt = 64;    // doubles with the live entries, so pruning is amortized over inserts
+    };
+}
@@ -0,0 +1,60 @@
+#include "StackTrace.hpp"
+#include "Klass.hpp"
+
+#include <algorithm>
+#include <utility>
+
+namespace CCW::Tula {
+
+    StackTrace::Ptr StackTrace::capture(const StackFrame *frames, size_t count, size_t maxDepth) {
+        auto depth = std::min(count, maxDepth);
+        return Ptr(new StackTrace(std::vector<StackFrame>(frames, frames + depth)));
+    }
+
+    StackTrace::StackTrace(std::vector<StackFrame> frames) : frames(std::move(frames)) {
+        pinHolders();
+    }
+
+    void StackTrace::pinHolders() {
+        // Deep traces mostly repeat a few classes; the linear search stays cheaper than hashing them.
+        for (const auto &frame : frames) {
+            auto holder = frame.method->getHolder();
+            if (holder == nullptr || std::any_of(holders.begin(), holders.end(),
+                                                 [holder](const auto &pinned) { return pinned.get() == holder; })) {
+                continue;
+            }
+            // Classes not owned by a shared pointer, like those of tests, can't be pinned.
+            if (auto pinned = holder->weak_from_this().lock()) {
+                holders.push_back(std::move(pinned));
+            }
+        }
+    }
+
+    const std::vector<StackTraceElement> &StackTrace::getElements() {
+        std::call_once(materializeOnce, [this] {
+            elements.reserve(frames.size());
+            for (const auto &frame : frames) {
+                elements.push_back(toElement(frame));
+            }
+            materialized.store(true, std::memory_order_release);
+        });
+        return elements;
+    }
+
+    StackTraceElement StackTrace::toElement(const StackFrame &frame) {
+        StackTraceElement element;
+        auto method = frame.method;
+        auto holder = method->getHolder();
+        if (holder != nullptr) {
+            element.declaringClass = holder->getName()->toString();
+            std::replace(element.declaringClass.begin(), element.declaringClass.end(), '/', '.');
+            if (holder->getSourceFile() != nullptr) {
+                element.fileName = holder->getSourceFile()->toString();
+            }
+        }
+        element.methodName = method->name()->toString();
+        element.lineNumber = method->isNative() ? StackTraceElement::NativeLineNumber
+                                                : method->getLineNumber(frame.bci);
+        return element;
+    }
+}
@@ -0,0 +1,69 @@
+#pragma once
+
+#include "Method.hpp"
+
+#include <CCW/Base.hpp>
+
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace CCW::Tula {
+
+    // A frame as recorded at throw time: just the method and the bci it was executing.
+    struct StackFrame {
+        const Method *method;
+        uint16_t bci;
+    };
+
+    // Mirrors the fields of java.lang.StackTraceElement.
+    struct StackTraceElement {
+        static constexpr int NativeLineNumber = -2;
+
+        std::string declaringClass;     // binary name, with dots
+        std::string methodName;
+        std::string fileName;           // empty when unknown
+        int lineNumber;                 // -1 when unknown
+    };
+
+    // The backtrace of a throwable. Capturing only copies (method, bci) pairs and pins the classes
+    // declaring them, so the methods outlive an unload; class names, file names and line numbers are
+    // looked up once, the first time someone reads the elements.
+    class StackTrace : public Noncopyable {
+    public:
+        using Ptr = std::shared_ptr<StackTrace>;
+
+        static constexpr size_t MaxDepth = 1024;
+
+        // `frames` is ordered from the throwing frame outwards; frames beyond `maxDepth` are dropped.
+        static Ptr capture(const StackFrame *frames, size_t count, size_t maxDepth = MaxDepth);
+
+        [[nodiscard]] inline const std::vector<StackFrame> &getFrames() const {
+            return frames;
+        }
+
+        [[nodiscard]] inline bool isMaterialized() const {
+            return materialized.load(std::memory_order_acquire);
+        }
+
+        // Thread safe; elements are built on the first call and cached.
+        const std::vector<StackTraceElement> &getElements();
+
+    private:
+        explicit StackTrace(std::vector<StackFrame> frames);
+
+        // Keeps the holders of `frames` alive, once each.
+        void pinHolders();
+
+        static StackTraceElement toElement(const StackFrame &frame);
+
+    private:
+        std::vector<StackFrame> frames;
+        std::vector<std::shared_ptr<const InstanceKlass>> holders;
+        std::once_flag materializeOnce;
+        std::atomic<bool> materialized{false};
+        std::vector<StackTraceElement> elements;
+    };
+}
@@ -0,0 +1,135 @@
+#include "StringDeduplication.hpp"
+
+#include <atomic>
+
+namespace CCW::Tula {
+
+    static std::mutex gSharedLock;
+    static std::weak_ptr<StringDeduplication> gShared;
+    static std::atomic<bool> gSharedRunning{false};
+
+    StringDeduplication::~StringDeduplication() {
+        stop();
+    }
+
+    std::shared_ptr<StringDeduplication> StringDeduplication::shared(std::chrono::milliseconds interval) {
+        std::lock_guard<std::mutex> _{gSharedLock};
+        auto pass = gShared.lock();
+        if (pass == nullptr) {
+            pass.reset(new StringDeduplication(), [](StringDeduplication *stopped) {
+                {
+                    std::lock_guard<std::mutex> _{gSharedLock};
+                    // Unless another pass took over meanwhile.
+                    if (gShared.expired()) {
+                        gSharedRunning.store(false, std::memory_order_relaxed);
+                    }
+                }
+                delete stopped;
+            });
+            pass->start(interval);
+            gShared = pass;
+            gSharedRunning.store(true, std::memory_order_relaxed);
+        }
+        return pass;
+    }
+
+    void StringDeduplication::offer(const JavaString::Ptr &string) {
+        if (!gSharedRunning.load(std::memory_order_relaxed)) {
+            return;
+        }
+        std::shared_ptr<StringDeduplication> pass;
+        {
+            std::lock_guard<std::mutex> _{gSharedLock};
+            pass = gShared.lock();
+        }
+        if (pass != nullptr) {
+            pass->enqueue(string);
+        }
+    }
+
+    void StringDeduplication::enqueue(const JavaString::Ptr &string) {
+        std::lock_guard<std::mutex> _{queueMutex};
+        queue.emplace_back(string);
+    }
+
+    StringDeduplication::Stats StringDeduplication::deduplicate() {
+        std::vector<std::weak_ptr<JavaString>> candidates;
+        {
+            std::lock_guard<std::mutex> _{queueMutex};
+            candidates.swap(queue);
+        }
+
+        std::lock_guard<std::mutex> _{passMutex};
+        Stats stats;
+        for (const auto &candidate : candidates) {
+            auto string = candidate.lock();
+            if (string == nullptr) {
+                continue;
+            }
+            stats.inspected++;
+            auto value = string->getValue();
+            auto key = (static_cast<uint64_t>(static_cast<uint32_t>(string->hashCode())) << 1u)
+                       | static_cast<uint64_t>(string->getCoder());
+            auto range = arrays.equal_range(key);
+            bool merged = false;
+            for (auto it = range.first; it != range.second;) {
+                auto canonical = it->second.lock();
+                if (canonical == nullptr) {
+                    it = arrays.erase(it);
+                    continue;
+                }
+                if (canonical == value) {
+                    merged = true;
+                    break;
+                }
+                if (*canonical == *value && string->replaceValue(canonical)) {
+                    stats.deduplicated++;
+                    stats.bytesSaved += value->size();
+                    merged = true;
+                    break;
+                }
+                ++it;
+            }
+            if (!merged) {
+                arrays.emplace(key, value);
+            }
+        }
+        total.inspected += stats.inspected;
+        total.deduplicated += stats.deduplicated;
+        total.bytesSaved += stats.bytesSaved;
+        return stats;
+    }
+
+    void StringDeduplication::start(std::chrono::milliseconds interval) {
+        std::lock_guard<std::mutex> _{workerMutex};
+        if (worker.joinable()) {
+            return;
+        }
+        stopping = false;
+        worker = std::thread([this, interval] {
+            std::unique_lock<std::mutex> lock{workerMutex};
+            while (!workerWakeup.wait_for(lock, interval, [this] { return stopping; })) {
+                lock.unlock();
+                deduplicate();
+                lock.lock();
+            }
+        });
+    }
+
+    void StringDeduplication::stop() {
+        {
+            std::lock_guard<std::mutex> _{workerMutex};
+            if (!worker.joinable()) {
+                return;
+            }
+            stopping = true;
+        }
+        workerWakeup.notify_all();
+        worker.join();
+    }
+
+    StringDeduplication::Stats StringDeduplication::getTotalStats() const {
+        std::lock_guard<std::mutex> _{passMutex};
+        return total;
+    }
+}
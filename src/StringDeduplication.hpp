@@ -0,0 +1,68 @@
+#pragma once
+
+#include "JavaString.hpp"
+
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+namespace CCW::Tula {
+
+    // Makes equal strings share one backing array, like G1's string deduplication. Interned strings
+    // are unique already; this targets the many equal strings built at run time.
+    //
+    // Candidates are queued as they are created and held weakly, so queueing never keeps a string
+    // alive. A pass swaps the array of each live candidate for the first identical array it has seen.
+    // Passes run on demand or periodically on a background thread. The pass of the process, see shared(),
+    // gets every string JavaString creates.
+    class StringDeduplication : public Noncopyable {
+    public:
+        struct Stats {
+            size_t inspected = 0;
+            size_t deduplicated = 0;
+            size_t bytesSaved = 0;
+        };
+
+        StringDeduplication() = default;
+
+        ~StringDeduplication();
+
+        // The pass of the process, started with `interval` by the first caller and run as long as somebody
+        // holds it.
+        static std::shared_ptr<StringDeduplication> shared(std::chrono::milliseconds interval);
+
+        // Queues `string` for the pass of the process, if one runs; one relaxed load otherwise.
+        static void offer(const JavaString::Ptr &string);
+
+        void enqueue(const JavaString::Ptr &string);
+
+        // Processes every queued candidate and returns what this pass did.
+        Stats deduplicate();
+
+        // Runs a pass every `interval` until stop() or destruction.
+        void start(std::chrono::milliseconds interval);
+
+        void stop();
+
+        [[nodiscard]] Stats getTotalStats() const;
+
+    private:
+        using Array = JavaString::Value::element_type;
+
+        std::mutex queueMutex;
+        std::vector<std::weak_ptr<JavaString>> queue;
+
+        // Canonical arrays by (hash, coder); weak so arrays no string uses any more are freed.
+        mutable std::mutex passMutex;
+        std::unordered_multimap<uint64_t, std::weak_ptr<Array>> arrays;
+        Stats total;
+
+        std::thread worker;
+        std::mutex workerMutex;
+        std::condition_variable workerWakeup;
+        bool stopping = false;
+    };
+}
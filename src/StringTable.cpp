@@ -0,0 +1,79 @@
+#include "StringTable.hpp"
+
+#include <mutex>
+
+namespace CCW::Tula {
+
+    static std::mutex gStringTableLock;
+    static StringTable *gStringTable;
+    static size_t gStringTableUsers;
+
+    void StringTable::init() {
+        std::lock_guard<std::mutex> _{gStringTableLock};
+        if (gStringTableUsers++ == 0) {
+            gStringTable = new StringTable();
+        }
+    }
+
+    void StringTable::release() {
+        std::lock_guard<std::mutex> _{gStringTableLock};
+        if (--gStringTableUsers == 0) {
+            delete gStringTable;
+            gStringTable = nullptr;
+        }
+    }
+
+    StringTable::Shard &StringTable::shardOf(jint hash) {
+        // String hashes are weak in the low bits for short strings, mix before picking a shard.
+        auto h = static_cast<uint32_t>(hash) * 0x9E3779B1u;
+        return gStringTable->shards[h >> 26u];
+    }
+
+    JavaString::Ptr StringTable::find(const Shard &shard, const JavaString &string, jint hash) {
+        auto range = shard.strings.equal_range(hash);
+        for (auto it = range.first; it != range.second; ++it) {
+            if (it->second->equals(string)) {
+                return it->second;
+            }
+        }
+        return nullptr;
+    }
+
+    JavaString::Ptr StringTable::lookup(const JavaString &string) {
+        auto hash = string.hashCode();
+        auto &shard = shardOf(hash);
+        std::shared_lock<std::shared_timed_mutex> _{shard.mutex};
+        return find(shard, string, hash);
+    }
+
+    JavaString::Ptr StringTable::intern(const JavaString::Ptr &string) {
+        auto hash = string->hashCode();
+        auto &shard = shardOf(hash);
+        {
+            std::shared_lock<std::shared_timed_mutex> _{shard.mutex};
+            if (auto found = find(shard, *string, hash)) {
+                return found;
+            }
+        }
+        std::unique_lock<std::shared_timed_mutex> _{shard.mutex};
+        // Another thread may have interned it between the two locks.
+        if (auto found = find(shard, *string, hash)) {
+            return found;
+        }
+        shard.strings.emplace(hash, string);
+        return string;
+    }
+
+    JavaString::Ptr StringTable::intern(const Symbol *utf8) {
+        return intern(JavaString::fromModifiedUtf8(utf8->getBytes(), utf8->getLength()));
+    }
+
+    size_t StringTable::size() {
+        size_t count = 0;
+        for (const auto &shard : gStringTable->shards) {
+            std::shared_lock<std::shared_timed_mutex> _{shard.mutex};
+            count += shard.strings.size();
+        }
+        return count;
+    }
+}
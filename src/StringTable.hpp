@@ -0,0 +1,53 @@
+#pragma once
+
+#include "JavaString.hpp"
+#include "Symbol.hpp"
+
+#include <array>
+#include <shared_mutex>
+#include <unordered_map>
+
+namespace CCW::Tula {
+
+    // Intern table of Java strings (String.intern() and string constants), kept apart from the
+    // SymbolTable so VM-internal names never gain Java identity.
+    //
+    // The table is split into shards by hash, each behind a reader-writer lock: lookups of strings
+    // that are already interned only take a shared lock, so concurrent ldc resolution does not serialize.
+    class StringTable : public Noncopyable {
+    public:
+        static constexpr size_t ShardCount = 64;
+
+        // Returns the canonical string equal to `string`, which becomes canonical on first use.
+        static JavaString::Ptr intern(const JavaString::Ptr &string);
+
+        // Returns the canonical string for modified UTF-8 text, like a string constant of a class file.
+        static JavaString::Ptr intern(const Symbol *utf8);
+
+        // The canonical string equal to `string`, or null when none was interned.
+        static JavaString::Ptr lookup(const JavaString &string);
+
+        static size_t size();
+
+    private:
+        friend class VM;
+
+        // Shared by every VM of the process, since resolved string constants live in constant pools
+        // that VMs share: the first VM creates the table and the last one destroys it.
+        static void init();
+
+        static void release();
+
+        struct Shard {
+            mutable std::shared_timed_mutex mutex;
+            std::unordered_multimap<jint, JavaString::Ptr> strings;
+        };
+
+        static Shard &shardOf(jint hash);
+
+        static JavaString::Ptr find(const Shard &shard, const JavaString &string, jint hash);
+
+    private:
+        std::array<Shard, ShardCount> shards;
+    };
+}
@@ -1,4 +1,5 @@
 #include "Symbol.hpp"
+#include "MemoryTracker.hpp"
 
 namespace CCW::Tula {
 
@@ -7,10 +8,12 @@ namespace CCW::Tula {
         this->bytes[len] = '\0';
         memcpy(this->bytes, bytes, len);
         hashValue = bytesHash(bytes, len);
+        MemoryTracker::allocate(MemoryTag::Symbols, sizeof(Symbol) + len + 1);
     }
 
     Symbol::~Symbol() {
-        delete bytes;
+        MemoryTracker::release(MemoryTag::Symbols, sizeof(Symbol) + len + 1);
+        free(bytes);
     }
 
     bool Symbol::equals(const Symbol *rhs) const {
@@ -18,6 +21,9 @@ namespace CCW::Tula {
     }
 
     bool Symbol::operator==(const Symbol &rhs) const {
+        if (this == &rhs) {
+            return true;
+        }
         if (len != rhs.len) {
             return false;
         }
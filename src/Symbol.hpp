@@ -2,6 +2,7 @@
 
 #include <CCW/Base.hpp>
 #include <memory>
+#include <string>
 
 namespace CCW::Tula {
 
@@ -28,6 +29,9 @@ namespace CCW::Tula {
         }
 
         bool equals(const uint8_t *bytes, size_t len) {
+            if (this->len != len) {
+                return false;
+            }
             return memcmp(this->bytes, bytes, len) == 0;
         }
 
@@ -44,6 +48,18 @@ namespace CCW::Tula {
 
         Hash hash();
 
+        [[nodiscard]] inline const uint8_t *getBytes() const {
+            return bytes;
+        }
+
+        [[nodiscard]] inline size_t getLength() const {
+            return len;
+        }
+
+        [[nodiscard]] inline std::string toString() const {
+            return std::string(reinterpret_cast<const char *>(bytes), len);
+        }
+
         static Hash bytesHash(const uint8_t *bytes, int len);
 
     private:
@@ -1,5 +1,7 @@
+#include <algorithm>
 #include <mutex>
 #include "SymbolTable.hpp"
+#include "MemoryTracker.hpp"
 
 using namespace std;
 
@@ -7,13 +9,43 @@ namespace CCW::Tula {
 
     static mutex gSymbolTableLock;
     static SymbolTable* gSymbolTable;
+    static size_t gSymbolTableUsers;
+    static thread_local uint64_t tSymbolsCreated;
 
 
+    // A table node with its map entry; symbols are counted here while in the table, their own bytes
+    // under MemoryTag::Symbols.
+    static constexpr size_t BucketBytes = sizeof(SymbolTable::BucketPtr) + sizeof(SymbolHash) + 4 * sizeof(void *);
+
     class SymbolTable::Bucket : public Noncopyable {
     public:
+        Bucket() {
+            MemoryTracker::allocate(MemoryTag::SymbolTable, sizeof(Bucket) + BucketBytes, 0);
+        }
+
+        ~Bucket() {
+            MemoryTracker::record(MemoryTag::SymbolTable,
+                                  -static_cast<int64_t>(sizeof(Bucket) + BucketBytes + capacityBytes()),
+                                  -static_cast<int64_t>(sizeof(Bucket) + BucketBytes + capacityBytes()),
+                                  -static_cast<int64_t>(symbols.size()));
+        }
+
         void push(const SymbolPtr &symbol) {
             lock_guard<mutex> _(lock);
-            symbols.push_back(symbol);
+            append(symbol);
+        }
+
+        SymbolPtr findOrPush(const uint8_t *bytes, size_t len) {
+            lock_guard<mutex> _(lock);
+            for (const auto &sym : symbols) {
+                if (sym->equals(bytes, len)) {
+                    return sym;
+                }
+            }
+            tSymbolsCreated++;
+            auto symbol = Symbol::create(bytes, len);
+            append(symbol);
+            return symbol;
         }
 
         bool contains(const SymbolPtr &symbol) {
@@ -23,36 +55,123 @@ namespace CCW::Tula {
             }) != symbols.end();
         }
 
+        // Drops the symbols only the table refers to. New references are only taken under the bucket
+        // lock or from an existing reference, so a count of one can't grow while we hold the lock.
+        size_t sweep() {
+            lock_guard<mutex> _(lock);
+            auto live = remove_if(symbols.begin(), symbols.end(), [](const SymbolPtr &sym) {
+                return sym.use_count() == 1;
+            });
+            auto swept = static_cast<size_t>(symbols.end() - live);
+            symbols.erase(live, symbols.end());
+            MemoryTracker::record(MemoryTag::SymbolTable, 0, 0, -static_cast<int64_t>(swept));
+            return swept;
+        }
+
+        size_t size() {
+            lock_guard<mutex> _(lock);
+            return symbols.size();
+        }
+
+    private:
+        size_t capacityBytes() const {
+            return symbols.capacity() * sizeof(SymbolPtr);
+        }
+
+        void append(const SymbolPtr &symbol) {
+            auto before = capacityBytes();
+            symbols.push_back(symbol);
+            auto grown = static_cast<int64_t>(capacityBytes() - before);
+            MemoryTracker::record(MemoryTag::SymbolTable, grown, grown, 1);
+        }
+
     private:
         mutex lock;
         vector<SymbolPtr> symbols;
     };
 
     void SymbolTable::init() {
-        gSymbolTable = new SymbolTable();
+        lock_guard<mutex> _(gSymbolTableLock);
+        if (gSymbolTableUsers++ == 0) {
+            gSymbolTable = new SymbolTable();
+        }
     }
 
     void SymbolTable::release() {
-        delete gSymbolTable;
+        lock_guard<mutex> _(gSymbolTableLock);
+        if (--gSymbolTableUsers == 0) {
+            delete gSymbolTable;
+            gSymbolTable = nullptr;
+        }
+    }
+
+    SymbolTable::Shard &SymbolTable::shardOf(Symbol::Hash hash) {
+        // The low bits of the multiplicative hash mix poorly; fold the high ones in.
+        return gSymbolTable->shards[(hash ^ (hash >> 16u)) % ShardCount];
     }
 
     bool SymbolTable::putSymbol(const SymbolPtr &symbol) {
         if (contains(symbol)) {
             return false;
         }
-        lock_guard<mutex> _(gSymbolTableLock);
         Symbol::Hash hash = symbol->hash();
-        auto found = gSymbolTable->table.find(hash);
-        if (found == gSymbolTable->table.end()) {
-            auto bucket = make_shared<SymbolTable::Bucket>();
-            bucket->push(symbol);
-            gSymbolTable->table[hash] = bucket;
-        } else {
-            found->second->push(symbol);
+        auto &shard = shardOf(hash);
+        lock_guard<mutex> _(shard.lock);
+        auto &bucket = shard.buckets[hash];
+        if (bucket == nullptr) {
+            bucket = make_shared<SymbolTable::Bucket>();
         }
+        bucket->push(symbol);
         return true;
     }
 
+    SymbolPtr SymbolTable::intern(const uint8_t *bytes, size_t len) {
+        Symbol::Hash hash = Symbol::bytesHash(bytes, len);
+        auto &shard = shardOf(hash);
+        BucketPtr bucket;
+        {
+            lock_guard<mutex> _(shard.lock);
+            auto &found = shard.buckets[hash];
+            if (found == nullptr) {
+                found = make_shared<SymbolTable::Bucket>();
+            }
+            bucket = found;
+        }
+        return bucket->findOrPush(bytes, len);
+    }
+
+    size_t SymbolTable::sweep() {
+        size_t swept = 0;
+        for (auto &shard : gSymbolTable->shards) {
+            lock_guard<mutex> _(shard.lock);
+            for (auto it = shard.buckets.begin(); it != shard.buckets.end();) {
+                swept += it->second->sweep();
+                // intern() holds the bucket without the shard lock; such a bucket must stay reachable.
+                if (it->second->size() == 0 && it->second.use_count() == 1) {
+                    it = shard.buckets.erase(it);
+                } else {
+                    ++it;
+                }
+            }
+        }
+        return swept;
+    }
+
+    uint64_t SymbolTable::createdByThread() {
+        return tSymbolsCreated;
+    }
+
+    size_t SymbolTable::size() {
+        size_t size = 0;
+        for (auto &shard : gSymbolTable->shards) {
+            lock_guard<mutex> _(shard.lock);
+            for (const auto &[hash, bucket] : shard.buckets) {
+                size += bucket->size();
+            }
+        }
+        return size;
+    }
+
     bool SymbolTable::contains(const SymbolPtr &symbol) {
         if (auto foundBucket = findBucketByHash(symbol->hash())) {
             auto bucket = *foundBucket;
@@ -62,9 +181,10 @@ namespace CCW::Tula {
     }
 
     optional<SymbolTable::BucketPtr> SymbolTable::findBucketByHash(Symbol::Hash hash) {
-        lock_guard<mutex> _(gSymbolTableLock);
-        const auto &found = gSymbolTable->table.find(hash);
-        if (found != gSymbolTable->table.end()) {
+        auto &shard = shardOf(hash);
+        lock_guard<mutex> _(shard.lock);
+        const auto &found = shard.buckets.find(hash);
+        if (found != shard.buckets.end()) {
             return found->second;
         } else {
             return nullopt;
@@ -2,7 +2,9 @@
 
 #include "Symbol.hpp"
 
+#include <array>
 #include <map>
+#include <mutex>
 #include <vector>
 #include <optional>
 
@@ -24,19 +26,51 @@ namespace CCW::Tula {
 
         static bool putSymbol(const SymbolPtr &symbol);
 
+        // Returns the canonical symbol for `bytes`, creating it on first use.
+        // Interned symbols can be compared by pointer.
+        static SymbolPtr intern(const uint8_t *bytes, size_t len);
+
+        static SymbolPtr intern(const char *cstr) {
+            return intern(reinterpret_cast<const uint8_t *>(cstr), strlen(cstr));
+        }
+
         static bool contains(const SymbolPtr &symbol);
 
+        // Removes the symbols nothing outside the table refers to any more, such as the names of
+        // unloaded classes, and returns how many went. Interning them again makes new symbols.
+        static size_t sweep();
+
+        static size_t size();
+
+        // Symbols the calling thread created so far; for events that count the new symbols of a phase.
+        static uint64_t createdByThread();
+
         static std::optional<BucketPtr> findBucketByHash(Symbol::Hash hash);
 
     private:
         friend class VM;
 
+        // Symbols are immutable and shared by every VM of the process: the first VM creates the table
+        // and the last one destroys it.
         static void init();
 
         static void release();
 
     private:
-        std::map<SymbolHash, BucketPtr> table;
+        // Buckets are spread over shards with a lock each, so threads interning different names rarely
+        // wait for each other. Every Utf8 entry of a parsed class is interned, so with one lock parsers
+        // working in parallel, as tula-inspect runs them, would not get faster past a few threads.
+        static constexpr size_t ShardCount = 64;
+
+        struct alignas(64) Shard {
+            std::mutex lock;
+            std::map<SymbolHash, BucketPtr> buckets;
+        };
+
+        static Shard &shardOf(Symbol::Hash hash);
+
+    private:
+        std::array<Shard, ShardCount> shards;
     };
 }
 
@@ -1,34 +1,235 @@
 #include "tula/VM.hpp"
 #include "ClazzLoader.hpp"
+#include "Error.hpp"
+#include "events/EventRecorder.hpp"
+#include "Isolate.hpp"
+#include "JavaThread.hpp"
+#include "MemoryTracker.hpp"
+#include "native/NativeLinker.hpp"
+#include "SharedClassTable.hpp"
+#include "StringDeduplication.hpp"
+#include "StringTable.hpp"
 #include "SymbolTable.hpp"
 
+#include <algorithm>
+#include <fstream>
+
 namespace CCW::Tula {
-    // TODO add lock
-    static VM *gVM = nullptr;
+    // Several VMs may live in one process; each thread works with one of them at a time.
+    static thread_local VM *tCurrentVM = nullptr;
 
     VM::VM(std::string libPath, std::string initializeClazzPath) : libPath(std::move(libPath)),
-                                                                   initializeClazzPath(std::move(initializeClazzPath)) {
+                                                                   initializeClazzPath(std::move(initializeClazzPath)),
+                                                                   isolate(Isolate::allocate()) {
         SymbolTable::init();
-        bootstrapClazzLoader = std::make_shared<BootstrapClassLoader>(this, this->libPath);
-        gVM = this;
+        StringTable::init();
+        SharedClassTable::init();
+        try {
+            bootstrapClazzLoader = std::make_shared<BootstrapClassLoader>(this, this->libPath);
+        } catch (...) {
+            // No destructor runs for a VM whose constructor throws.
+            SharedClassTable::release();
+            StringTable::release();
+            SymbolTable::release();
+            Isolate::free(isolate);
+            throw;
+        }
+        nativeLinker = std::make_shared<NativeLinker>();
+        makeCurrent();
+    }
+
+    void VM::makeCurrent() {
+        tCurrentVM = this;
+        Isolate::setCurrent(isolate);
     }
 
     void VM::start() {
-        auto initializeClazz = bootstrapClazzLoader->defineClass(initializeClazzPath);
-        if(initializeClazz == nullptr) {
-            fprintf(stderr, "Class not found at %s", initializeClazzPath.c_str());
-            exit(-1);
+        if (indexClassPath) {
+            bootstrapClazzLoader->indexClassPath(classPathSnapshot);
+        }
+        if (!classLoadOrderPath.empty()) {
+            std::vector<SymbolPtr> names;
+            for (auto &name : ClassPreloader::readOrder(classLoadOrderPath)) {
+                names.push_back(SymbolTable::intern(name.c_str()));
+            }
+            bootstrapClazzLoader->preload(std::move(names), preloadThreads);
+        }
+        bootstrapClazzLoader->defineClass(initializeClazzPath);
+    }
+
+    void VM::setClassPathIndex(const std::string &snapshotPath) {
+        indexClassPath = true;
+        classPathSnapshot = snapshotPath;
+    }
+
+    void VM::setClassLoadOrder(const std::string &path, size_t threads) {
+        classLoadOrderPath = path;
+        preloadThreads = threads;
+    }
+
+    void VM::saveClassLoadOrder(const std::string &path) const {
+        ClassPreloader::writeOrder(path, bootstrapClazzLoader->getLoadedClasses());
+    }
+
+    void VM::stopPreloading() {
+        bootstrapClazzLoader->stopPreloading();
+    }
+
+    void VM::enableStringDeduplication(std::chrono::milliseconds interval) {
+        stringDeduplication = StringDeduplication::shared(interval);
+    }
+
+    void VM::registerNatives(const std::string &className, const NativeMethod *methods, size_t count) {
+        nativeLinker->registerNatives(className, methods, count);
+    }
+
+    void VM::loadLibrary(const std::string &path) {
+        nativeLinker->loadLibrary(path);
+    }
+
+    MethodHandle VM::resolveStatic(const std::string &className, const std::string &name,
+                                   const std::string &descriptor) {
+        auto klass = std::static_pointer_cast<InstanceKlass>(
+            bootstrapClazzLoader->loadClass(SymbolTable::intern(className.c_str())));
+        if (klass == nullptr) {
+            throw NoClassDefFoundError(className);
+        }
+        klass->link();
+        auto method = klass->findMethod(SymbolTable::intern(name.c_str()).get(),
+                                        SymbolTable::intern(descriptor.c_str()).get());
+        if (method == nullptr) {
+            throw NoSuchMethodError(className + "." + name + descriptor);
+        }
+        if (!method->isStatic()) {
+            throw IncompatibleClassChangeError("Expected static method " + className + "." + name + descriptor);
+        }
+        // Without an interpreter only natives can run. Classes that would need a <clinit> are turned away
+        // before initialization starts, so they are not left erroneous by what the VM lacks.
+        if (!method->isNative()) {
+            throw Error("Can't call " + className + "." + name + descriptor
+                        + ": running bytecode needs an interpreter");
+        }
+        if (auto clinit = klass->pendingStaticInitializer()) {
+            throw Error("Can't initialize " + className + ": running the <clinit> of "
+                        + clinit->getHolder()->getName()->toString() + " needs an interpreter");
         }
+        klass->initialize([](InstanceKlass &initializing, Method &) {
+            // A class of the hierarchy was changed since the check above, which linked classes never are.
+            throw Error("Can't run the static initializer of " + initializing.getName()->toString());
+        });
+
+        const NativeEntry *entry = &nativeLinker->link(*method);
+        std::string parameterTypes;
+        for (size_t i = 1; descriptor[i] != ')'; ++i) {
+            parameterTypes += descriptor[i] == '[' ? 'L' : descriptor[i];
+            while (descriptor[i] == '[') {
+                i++;
+            }
+            if (descriptor[i] == 'L') {
+                i = descriptor.find(';', i);
+            }
+        }
+        auto returnType = descriptor[descriptor.find(')') + 1];
+        return MethodHandle(this, method, method->getHolder(), entry, std::move(parameterTypes),
+                            returnType == '[' ? 'L' : returnType, method->getArgumentSlots());
+    }
+
+    void VM::attachCurrentThread() {
+        auto thread = JavaThread::current();
+        if (thread != nullptr && thread->getVM() == this) {
+            return;
+        }
+        JavaThread::attach(this);
+        makeCurrent();
+    }
+
+    void VM::detachCurrentThread() {
+        if (isCurrentThreadAttached()) {
+            JavaThread::detach();
+        }
+    }
+
+    bool VM::isCurrentThreadAttached() const {
+        auto thread = JavaThread::current();
+        return thread != nullptr && thread->getVM() == this;
     }
 
     VM *VM::current() {
-        return gVM;
+        return tCurrentVM;
+    }
+
+    ClassLookupStats VM::classLookupStats() const {
+        return bootstrapClazzLoader->getNegativeCache().getStats();
+    }
+
+    void VM::classPathChanged() {
+        bootstrapClazzLoader->classPathChanged();
+    }
+
+    void VM::startRecording() {
+        EventRecorder::start();
+    }
+
+    void VM::stopRecording(const std::string &path) {
+        auto log = EventRecorder::stop();
+        std::ofstream out(path, std::ios::binary | std::ios::trunc);
+        log.write(out);
+        if (!out) {
+            throw Error("Can't write event file " + path);
+        }
+    }
+
+    // Keeps the `topN` largest of `items`, largest first.
+    static void keepLargest(std::vector<MemoryReport::Item> &items, size_t topN) {
+        auto largerFirst = [](const MemoryReport::Item &a, const MemoryReport::Item &b) {
+            return a.bytes > b.bytes || (a.bytes == b.bytes && a.name < b.name);
+        };
+        auto keep = std::min(topN, items.size());
+        std::partial_sort(items.begin(), items.begin() + keep, items.end(), largerFirst);
+        items.resize(keep);
+    }
+
+    MemoryReport VM::memoryReport(size_t topN) const {
+        MemoryReport report;
+        for (size_t i = 0; i < static_cast<size_t>(MemoryTag::Count); ++i) {
+            auto tag = static_cast<MemoryTag>(i);
+            auto usage = MemoryTracker::usage(tag);
+            report.processCategories.push_back({MemoryTracker::nameOf(tag), usage.used, usage.reserved,
+                                                usage.count});
+            report.processUsed += usage.used;
+            report.processReserved += usage.reserved;
+        }
+        for (auto &klass : bootstrapClazzLoader->getLoadedClasses()) {
+            auto instanceKlass = std::static_pointer_cast<InstanceKlass>(klass);
+            auto name = instanceKlass->getName()->toString();
+            report.largestClasses.push_back({name, instanceKlass->getFootprint()});
+            report.largestConstantPools.push_back({name, instanceKlass->getConstantPool()->getFootprint()});
+        }
+        keepLargest(report.largestClasses, topN);
+        keepLargest(report.largestConstantPools, topN);
+        return report;
     }
 
     VM::~VM() {
+        detachCurrentThread();
+        // Classes shared with other VMs outlive this one; the next VM taking over the isolate index
+        // must find them uninitialized. The loader holds every class this VM can initialize: the supers
+        // of shared classes are loaded with them, and java/lang/Object may be the shared builtin one.
+        for (auto &entry : bootstrapClazzLoader->loadedByName) {
+            std::static_pointer_cast<InstanceKlass>(entry.second)->forgetIsolate(isolate);
+        }
+        // The linker clears the entries it cached in methods, so it goes while they exist. Classes no
+        // other VM shares unload with the loader, and their names leave the symbol table.
+        nativeLinker.reset();
+        bootstrapClazzLoader.reset();
+        SymbolTable::sweep();
+        SharedClassTable::release();
+        StringTable::release();
         SymbolTable::release();
-        if (gVM == this) {
-            gVM = nullptr;
+        if (tCurrentVM == this) {
+            tCurrentVM = nullptr;
+            Isolate::setCurrent(Isolate::None);
         }
+        Isolate::free(isolate);
     }
 }
\ No newline at end of file
@@ -1,12 +1,14 @@
 #include "ClassFileParser.hpp"
 
+#include "Descriptor.hpp"
 #include "../JVM.hpp"
 #include "../SymbolTable.hpp"
+#include "../events/EventRecorder.hpp"
 
 
 #define JAVA_CLASSFILE_MAGIC              0xCAFEBABE
 #define JAVA_MIN_SUPPORTED_VERSION        45
-#define JAVA_MAX_SUPPORTED_VERSION        52
+#define JAVA_MAX_SUPPORTED_VERSION        69
 #define JAVA_MAX_SUPPORTED_MINOR_VERSION  0
 
 // Used for backward compatibility reasons:
@@ -21,6 +23,15 @@
 // Extension method support.
 #define JAVA_8_VERSION                    52
 
+// Modules; JDK 9 and later ship their classes in a jimage.
+#define JAVA_9_VERSION                    53
+
+// CONSTANT_Dynamic.
+#define JAVA_11_VERSION                   55
+
+// Minor versions other than 0 are only used for preview features from here on.
+#define JAVA_12_VERSION                   56
+
 
 namespace CCW::Tula {
 
@@ -70,35 +81,22 @@ namespace CCW::Tula {
     }
 
 
-    Klass::Ptr ClassFileParser::parse(const uint8_t *data, uint32_t len) noexcept(false) {
-        ClassFileParser parser(data, len);
+    Klass::Ptr ClassFileParser::parse(const uint8_t *data, uint32_t len,
+                                      std::shared_ptr<Metaspace> metaspace) noexcept(false) {
+        ClassFileParser parser(data, len, std::move(metaspace));
         return parser.parse();
     }
 
-    ClassFileParser::ClassFileParser(const uint8_t *data, uint32_t len) :
-        reader(data, len), cp(nullptr) {
+    Klass::Ptr ClassFileParser::tryParse(const uint8_t *data, uint32_t len, ParseError &error,
+                                         std::shared_ptr<Metaspace> metaspace) {
+        ClassFileParser parser(data, len, std::move(metaspace));
+        auto klass = parser.tryParse();
+        error = parser.getError();
+        return klass;
     }
 
-    void ClassFileParser::throwParseException(const char *fmt, ...) {
-
-        va_list args;
-        va_start(args, fmt);
-        char buf[32];
-        size_t n = std::vsnprintf(buf, sizeof(buf), fmt, args);
-        va_end(args);
-
-        // Static buffer large enough?
-        if (n < sizeof(buf)) {
-            throw ClassFormatError({buf, n});
-        }
-
-        // Static buffer too small
-        std::string s(n + 1, 0);
-        va_start(args, fmt);
-        std::vsnprintf(const_cast<char *>(s.data()), s.size(), fmt, args);
-        va_end(args);
-
-        throw ClassFormatError(s);
+    ClassFileParser::ClassFileParser(const uint8_t *data, uint32_t len, std::shared_ptr<Metaspace> metaspace) :
+        reader(data, len), metaspace(std::move(metaspace)), cp(nullptr) {
     }
 
     bool ClassFileParser::isValidCpIndex(uint16_t index) {
@@ -106,343 +104,709 @@ namespace CCW::Tula {
     }
 
     bool isValidDescriptor(const SymbolPtr &descriptor) {
-        // TODO validate descriptor
-        return true;
+        return Descriptor::isValidField(descriptor->getBytes(), descriptor->getLength());
     }
 
-#define throwValidExceptionAssert(cond, ...) do { \
+// The phases return false once they have recorded an error.
+#define PARSE_CHECK(cond, ...) do { \
         if (!(cond)) { \
-            throwParseException(__VA_ARGS__); \
+            return fail(__VA_ARGS__); \
+        } \
+    } while(0)
+
+#define PARSE_ENSURE(size) do { \
+        if (!reader.has(size)) { \
+            return failTruncated(); \
+        } \
+    } while(0)
+
+#define PARSE_TRY(step) do { \
+        if (!(step)) { \
+            return false; \
         } \
     } while(0)
 
     Klass::Ptr ClassFileParser::parse() noexcept(false) {
-        auto magic = reader.readU32();
+        auto result = tryParse();
+        if (result == nullptr) {
+            error.raise();
+        }
+        return result;
+    }
+
+    Klass::Ptr ClassFileParser::tryParse() {
+        EventScope event(EventType::ParseClass);
+        if (!parseClass()) {
+            return nullptr;
+        }
+        event.setValue(klass->getMethods().size());
+        return klass;
+    }
+
+    bool ClassFileParser::parseClass() {
+        PARSE_TRY(parseHeader());
+        PARSE_TRY(parseConstantPool());
+        CCW_ASSERT(cp != nullptr);
+        PARSE_TRY(parseClassInfo());
+
+        {
+            EventScope fieldsEvent(EventType::ParseFields);
+            PARSE_TRY(parseFields());
+        }
+
+        {
+            EventScope methodsEvent(EventType::ParseMethods);
+            PARSE_TRY(parseMethods());
+        }
+
+        {
+            EventScope attributesEvent(EventType::ParseAttributes);
+            PARSE_TRY(parseClassAttributes());
+        }
+
+        phase = ParseErrorCode::ExtraBytes;
+        PARSE_CHECK(reader.isEos(), "Extra bytes at the end of class file");
+        return true;
+    }
+
+    bool ClassFileParser::parseHeader() {
+        phase = ParseErrorCode::InvalidMagic;
+        PARSE_ENSURE(4);
+        auto magic = reader.readU32Unchecked();
         if (magic != JAVA_CLASSFILE_MAGIC) {
-            throwParseException("Invalid Class file magic %u.", magic);
+            return fail("Invalid Class file magic %u.", magic);
         }
 
-        reader.ensure(4);
+        PARSE_ENSURE(4);
         this->minorVersion = reader.readU16Unchecked();
         this->majorVersion = reader.readU16Unchecked();
+        phase = ParseErrorCode::UnsupportedVersion;
+        PARSE_CHECK(majorVersion >= JAVA_MIN_SUPPORTED_VERSION && majorVersion <= JAVA_MAX_SUPPORTED_VERSION &&
+                    (majorVersion < JAVA_MAX_SUPPORTED_VERSION || minorVersion <= JAVA_MAX_SUPPORTED_MINOR_VERSION),
+                    "Unsupported class file version %u.%u", majorVersion, minorVersion);
+        PARSE_CHECK(majorVersion < JAVA_12_VERSION || minorVersion == 0,
+                    "Class file version %u.%u uses preview features", majorVersion, minorVersion);
+        return true;
+    }
 
-        parseConstantPool();
-        CCW_ASSERT(cp != nullptr);
-
-        reader.ensure(8);
+    bool ClassFileParser::parseClassInfo() {
+        phase = ParseErrorCode::InvalidClass;
+        PARSE_ENSURE(8);
         accessFlags = static_cast<ClassAccessFlags >(reader.readU16Unchecked());
         if (accessFlags & ClassAccessFlags::Interface) {
-            throwValidExceptionAssert(accessFlags & ClassAccessFlags::Abstract, "Interface must be abstract.");
-            throwValidExceptionAssert(!(accessFlags & ClassAccessFlags::Final), "Interface must be non-final.");
-            throwValidExceptionAssert(!(accessFlags & ClassAccessFlags::Super), "Interface must be non-super.");
-            throwValidExceptionAssert(!(accessFlags & ClassAccessFlags::Enum), "Interface must be non-enum.");
+            PARSE_CHECK(accessFlags & ClassAccessFlags::Abstract, "Interface must be abstract.");
+            PARSE_CHECK(!(accessFlags & ClassAccessFlags::Final), "Interface must be non-final.");
+            PARSE_CHECK(!(accessFlags & ClassAccessFlags::Super), "Interface must be non-super.");
+            PARSE_CHECK(!(accessFlags & ClassAccessFlags::Enum), "Interface must be non-enum.");
         } else {
-            throwValidExceptionAssert(!(accessFlags & ClassAccessFlags::Annotation), "Class is not annotation");
-            throwValidExceptionAssert(
+            PARSE_CHECK(!(accessFlags & ClassAccessFlags::Annotation), "Class is not annotation");
+            PARSE_CHECK(
                 !(accessFlags & ClassAccessFlags::Final && accessFlags & ClassAccessFlags::Abstract),
                 "Final Class can not be abstract.");
         }
 
         if (accessFlags & ClassAccessFlags::Annotation) {
-            throwValidExceptionAssert(accessFlags & ClassAccessFlags::Interface, "Annotation must be interface.");
+            PARSE_CHECK(accessFlags & ClassAccessFlags::Interface, "Annotation must be interface.");
         }
 
         auto thisClassIndex = reader.readU16Unchecked();
-        throwValidExceptionAssert(isValidCpIndex(thisClassIndex) && cp->getTagAt(thisClassIndex).isUnresolvedClass(),
-                                  "Invalid this class index at %d", thisClassIndex);
+        PARSE_CHECK(isValidCpIndex(thisClassIndex) && cp->getTagAt(thisClassIndex).isUnresolvedClass(),
+                    "Invalid this class index at %d", thisClassIndex);
         auto thisClassName = cp->getClassAt(thisClassIndex);
         auto superClassIndex = reader.readU16Unchecked();
-        throwValidExceptionAssert(superClassIndex == 0 || isValidCpIndex(superClassIndex) &&
-                                                          cp->getTagAt(
-                                                              superClassIndex).isClassOrUnresolvedClass(),
-                                  "Invalid super class index at %d", superClassIndex);
-
-        // TODO resolved super class
+        PARSE_CHECK(superClassIndex == 0 || (isValidCpIndex(superClassIndex) &&
+                                             cp->getTagAt(superClassIndex).isClassOrUnresolvedClass()),
+                    "Invalid super class index at %d", superClassIndex);
 
-        parseInterfaces();
-
-        parseFields();
+        klass = std::make_shared<InstanceKlass>(thisClassName.getUnresolvedClassName(), cp, accessFlags);
+        klass->setMajorVersion(majorVersion);
+        if (superClassIndex != 0) {
+            klass->setSuperClassName(cp->getClassAt(superClassIndex).getUnresolvedClassName());
+        }
 
-        return nullptr;
+        return parseInterfaces();
     }
 
-    void ClassFileParser::parseFields() noexcept(false) {
-        auto fieldCount = reader.readU16();
-        auto isInterface = accessFlags & ClassAccessFlags::Interface;
+    bool ClassFileParser::parseFields() {
+        PARSE_ENSURE(2);
+        auto fieldCount = reader.readU16Unchecked();
         for (int i = 0; i < fieldCount; ++i) {
-            reader.ensure(8);
-            auto fieldAccessFlags = static_cast<FieldAccessFlags>(reader.readU16Unchecked());
-            if (isInterface) {
-                throwValidExceptionAssert(
-                    (fieldAccessFlags & FieldAccessFlags::Public)
-                    && (fieldAccessFlags & FieldAccessFlags::Final)
-                    && (fieldAccessFlags & FieldAccessFlags::Static),
-                    "invalid field access flags %d in interface", fieldAccessFlags);
-            } else {
-                if (fieldAccessFlags & FieldAccessFlags::Public) {
-                    throwValidExceptionAssert(
-                        !(fieldAccessFlags & FieldAccessFlags::Protected ||
-                          fieldAccessFlags & FieldAccessFlags::Private),
-                        "invalid field access flags %d", fieldAccessFlags);
-                } else if (fieldAccessFlags & FieldAccessFlags::Private) {
-                    throwValidExceptionAssert(
-                        !(fieldAccessFlags & FieldAccessFlags::Protected ||
-                          fieldAccessFlags & FieldAccessFlags::Public),
-                        "invalid field access flags %d", fieldAccessFlags);
-                } else if (fieldAccessFlags & FieldAccessFlags::Protected) {
-                    throwValidExceptionAssert(
-                        !(fieldAccessFlags & FieldAccessFlags::Private || fieldAccessFlags & FieldAccessFlags::Public),
-                        "invalid field access flags %d", fieldAccessFlags);
-                }
+            PARSE_TRY(parseField());
+        }
+        return true;
+    }
 
-                throwValidExceptionAssert(
-                    !(fieldAccessFlags & FieldAccessFlags::Final || fieldAccessFlags & FieldAccessFlags::Volatile),
+    bool ClassFileParser::parseField() {
+        phase = ParseErrorCode::InvalidField;
+        auto isInterface = accessFlags & ClassAccessFlags::Interface;
+        PARSE_ENSURE(8);
+        auto fieldAccessFlags = static_cast<FieldAccessFlags>(reader.readU16Unchecked());
+        if (isInterface) {
+            PARSE_CHECK(
+                (fieldAccessFlags & FieldAccessFlags::Public)
+                && (fieldAccessFlags & FieldAccessFlags::Final)
+                && (fieldAccessFlags & FieldAccessFlags::Static),
+                "invalid field access flags %d in interface", fieldAccessFlags);
+        } else {
+            if (fieldAccessFlags & FieldAccessFlags::Public) {
+                PARSE_CHECK(
+                    !(fieldAccessFlags & FieldAccessFlags::Protected ||
+                      fieldAccessFlags & FieldAccessFlags::Private),
+                    "invalid field access flags %d", fieldAccessFlags);
+            } else if (fieldAccessFlags & FieldAccessFlags::Private) {
+                PARSE_CHECK(
+                    !(fieldAccessFlags & FieldAccessFlags::Protected ||
+                      fieldAccessFlags & FieldAccessFlags::Public),
+                    "invalid field access flags %d", fieldAccessFlags);
+            } else if (fieldAccessFlags & FieldAccessFlags::Protected) {
+                PARSE_CHECK(
+                    !(fieldAccessFlags & FieldAccessFlags::Private || fieldAccessFlags & FieldAccessFlags::Public),
                     "invalid field access flags %d", fieldAccessFlags);
             }
 
-            auto nameIndex = reader.readU16Unchecked();
-            throwValidExceptionAssert(isValidCpIndex(nameIndex)
-                                      && cp->getTagAt(nameIndex).isUtf8(),
-                                      "Invalid field name index at %d", nameIndex);
+            PARSE_CHECK(
+                !(fieldAccessFlags & FieldAccessFlags::Final && fieldAccessFlags & FieldAccessFlags::Volatile),
+                "invalid field access flags %d", fieldAccessFlags);
+        }
 
-            auto descriptorIndex = reader.readU16Unchecked();
-            throwValidExceptionAssert(isValidCpIndex(descriptorIndex)
-                                      && cp->getTagAt(descriptorIndex).isUtf8()
-                                      && isValidDescriptor(cp->getSymbolAt(descriptorIndex)),
-                                      "Invalid field descriptor index at %d", descriptorIndex);
+        auto nameIndex = reader.readU16Unchecked();
+        PARSE_CHECK(isValidCpIndex(nameIndex)
+                    && cp->getTagAt(nameIndex).isUtf8(),
+                    "Invalid field name index at %d", nameIndex);
 
-            parseFieldAttributes(fieldAccessFlags);
+        auto descriptorIndex = reader.readU16Unchecked();
+        PARSE_CHECK(isValidCpIndex(descriptorIndex)
+                    && cp->getTagAt(descriptorIndex).isUtf8()
+                    && isValidDescriptor(cp->getSymbolAt(descriptorIndex)),
+                    "Invalid field descriptor index at %d", descriptorIndex);
 
-            
-        }
+        uint16_t constantValueIndex = 0;
+        PARSE_TRY(parseFieldAttributes(fieldAccessFlags, constantValueIndex));
+
+        klass->addField(cp->getSymbolAt(nameIndex), cp->getSymbolAt(descriptorIndex), fieldAccessFlags,
+                        constantValueIndex);
+        return true;
     }
 
-    void ClassFileParser::parseFieldAttributes(FieldAccessFlags flags) {
+    bool ClassFileParser::parseFieldAttributes(FieldAccessFlags flags, uint16_t &constValueIndex) {
 
-        std::optional<uint16_t> constValueIndex;
-        std::optional<SymbolPtr> signature;
+        SymbolPtr signature;
         bool synthetic = false;
         bool deprecated = false;
         auto attributeCount = reader.readU16Unchecked();
         for (int i = 0; i < attributeCount; ++i) {
-            reader.ensure(6);
+            PARSE_ENSURE(6);
             auto attrNameIndex = reader.readU16Unchecked();
-            throwValidExceptionAssert(isValidCpIndex(attrNameIndex)
-                                      && cp->getTagAt(attrNameIndex).isUtf8(),
-                                      "Invalid field attribute name index at %d", attrNameIndex);
+            PARSE_CHECK(isValidCpIndex(attrNameIndex)
+                        && cp->getTagAt(attrNameIndex).isUtf8(),
+                        "Invalid field attribute name index at %d", attrNameIndex);
 
             uint32_t len = reader.readU32Unchecked();
-            reader.ensure(len);
+            PARSE_ENSURE(len);
 
             const auto &attrName = cp->getSymbolAt(attrNameIndex);
             if (attrName->equals(ATTRIBUTE_ConstantValue)) {
                 if (flags & FieldAccessFlags::Static) {
-                    throwValidExceptionAssert(len == 2, "Invalid constant value attr length %d", len);
+                    PARSE_CHECK(len == 2, "Invalid constant value attr length %d", len);
                     auto cvIndex = reader.readU16Unchecked();
-                    throwValidExceptionAssert(
+                    PARSE_CHECK(
                         isValidCpIndex(cvIndex)
                         && cp->getTagAt(cvIndex).isConstantValueType(), "Invalid constant value index %d", cvIndex);
                     constValueIndex = cvIndex;
                 } else {
-                    reader.skip(len);
+                    reader.skipUnchecked(len);
                 }
             } else if (attrName->equals(ATTRIBUTE_Synthetic)) {
-                throwValidExceptionAssert(len == 0, "Invalid synthetic attr len");
+                PARSE_CHECK(len == 0, "Invalid synthetic attr len");
                 synthetic = true;
             } else if (attrName->equals(ATTRIBUTE_Deprecated)) {
-                throwValidExceptionAssert(len == 0, "Invalid deprecated attr len");
+                PARSE_CHECK(len == 0, "Invalid deprecated attr len");
                 deprecated = true;
             } else if (attrName->equals(ATTRIBUTE_Signature)) {
-                signature = parseSignatureAttribute(len);
+                PARSE_TRY(parseSignatureAttribute(len, &signature));
             } else if (attrName->equals(ATTRIBUTE_RuntimeVisibleAnnotations)) {
-                /* auto annotations = */ parseAnnotations();
+                /* auto annotations = */ PARSE_TRY(parseAnnotations());
             } else if (attrName->equals(ATTRIBUTE_RuntimeInvisibleAnnotations)) {
-                /* auto annotations = */ parseAnnotations();
+                /* auto annotations = */ PARSE_TRY(parseAnnotations());
             } else if (attrName->equals(ATTRIBUTE_RuntimeVisibleTypeAnnotations)) {
                 // /* auto typeAnnotations = */ parseTypeAnnotations();
-                reader.skip(len);
+                reader.skipUnchecked(len);
             } else if (attrName->equals(ATTRIBUTE_RuntimeInvisibleTypeAnnotations)) {
                 // /* auto typeAnnotations = */ parseTypeAnnotations();
-                reader.skip(len);
+                reader.skipUnchecked(len);
             } else {
-                reader.skip(len);
+                reader.skipUnchecked(len);
             }
 
         }
+        return true;
     }
 
-    void ClassFileParser::parseAnnotations() noexcept(false) {
-        reader.ensure(2);
+    bool ClassFileParser::parseAnnotations() {
+        PARSE_ENSURE(2);
         auto annotationCount = reader.readU16Unchecked();
         for (int j = 0; j < annotationCount; ++j) {
-            parseAnnotation();
+            PARSE_TRY(parseAnnotation());
         }
+        return true;
     }
 
-    void ClassFileParser::parseAnnotation() noexcept(false) {
-        reader.ensure(4);
+    bool ClassFileParser::parseAnnotation() {
+        PARSE_ENSURE(4);
         auto typeIndex = reader.readU16Unchecked();
-        throwValidExceptionAssert(isValidCpIndex(typeIndex)
-                                  && cp->getTagAt(typeIndex).isUtf8(),
-                                  "Invalid runtime visible annotation type index at %d", typeIndex);
+        PARSE_CHECK(isValidCpIndex(typeIndex)
+                    && cp->getTagAt(typeIndex).isUtf8(),
+                    "Invalid runtime visible annotation type index at %d", typeIndex);
+        annotationTypes.push_back(cp->getSymbolAt(typeIndex));
         auto elementValuePairCount = reader.readU16Unchecked();
         for (int k = 0; k < elementValuePairCount; ++k) {
-            /*auto elementValue = */ parseElementValue();
+            /*auto elementValue = */ PARSE_TRY(parseElementValue());
         }
+        return true;
     }
 
-    void ClassFileParser::parseElementValue() noexcept(false) {
-        reader.ensure(3);
+    bool ClassFileParser::parseElementValue() {
+        PARSE_ENSURE(3);
         auto elementNameIndex = reader.readU16Unchecked();
-        throwValidExceptionAssert(isValidCpIndex(elementNameIndex)
-                                  && cp->getTagAt(elementNameIndex).isUtf8(),
-                                  "Invalid element name index at %d", elementNameIndex);
+        PARSE_CHECK(isValidCpIndex(elementNameIndex)
+                    && cp->getTagAt(elementNameIndex).isUtf8(),
+                    "Invalid element name index at %d", elementNameIndex);
         auto tagValue = reader.readU8Unchecked();
         auto tag = static_cast<ElementValueTag>(tagValue);
         switch (tag) {
             case ElementValueTag::Byte: {
-                auto cIndex = reader.readU16();
-                throwValidExceptionAssert(isValidCpIndex(cIndex)
-                                          && cp->getTagAt(cIndex).isInteger(),
-                                          "Invalid const value index at %d", cIndex);
+                PARSE_ENSURE(2);
+                auto cIndex = reader.readU16Unchecked();
+                PARSE_CHECK(isValidCpIndex(cIndex)
+                            && cp->getTagAt(cIndex).isInteger(),
+                            "Invalid const value index at %d", cIndex);
                 int32_t value = cp->getIntegerAt(cIndex);
                 break;
             }
             case ElementValueTag::Char: {
-                auto cIndex = reader.readU16();
-                throwValidExceptionAssert(isValidCpIndex(cIndex)
-                                          && cp->getTagAt(cIndex).isInteger(),
-                                          "Invalid const value index at %d", cIndex);
+                PARSE_ENSURE(2);
+                auto cIndex = reader.readU16Unchecked();
+                PARSE_CHECK(isValidCpIndex(cIndex)
+                            && cp->getTagAt(cIndex).isInteger(),
+                            "Invalid const value index at %d", cIndex);
                 auto value = cp->getIntegerAt(cIndex);
                 break;
             }
             case ElementValueTag::Double: {
-                auto cIndex = reader.readU16();
-                throwValidExceptionAssert(isValidCpIndex(cIndex)
-                                          && cp->getTagAt(cIndex).isDouble(),
-                                          "Invalid const value index at %d", cIndex);
+                PARSE_ENSURE(2);
+                auto cIndex = reader.readU16Unchecked();
+                PARSE_CHECK(isValidCpIndex(cIndex)
+                            && cp->getTagAt(cIndex).isDouble(),
+                            "Invalid const value index at %d", cIndex);
                 auto value = cp->getDoubleAt(cIndex);
                 break;
             }
             case ElementValueTag::Float: {
-                auto cIndex = reader.readU16();
-                throwValidExceptionAssert(isValidCpIndex(cIndex)
-                                          && cp->getTagAt(cIndex).isFloat(),
-                                          "Invalid const value index at %d", cIndex);
+                PARSE_ENSURE(2);
+                auto cIndex = reader.readU16Unchecked();
+                PARSE_CHECK(isValidCpIndex(cIndex)
+                            && cp->getTagAt(cIndex).isFloat(),
+                            "Invalid const value index at %d", cIndex);
                 auto value = cp->getFloatAt(cIndex);
                 break;
             }
             case ElementValueTag::Int: {
-                auto cIndex = reader.readU16();
-                throwValidExceptionAssert(isValidCpIndex(cIndex)
-                                          && cp->getTagAt(cIndex).isInteger(),
-                                          "Invalid const value index at %d", cIndex);
+                PARSE_ENSURE(2);
+                auto cIndex = reader.readU16Unchecked();
+                PARSE_CHECK(isValidCpIndex(cIndex)
+                            && cp->getTagAt(cIndex).isInteger(),
+                            "Invalid const value index at %d", cIndex);
                 auto value = cp->getIntegerAt(cIndex);
                 break;
             }
             case ElementValueTag::Long: {
-                auto cIndex = reader.readU16();
-                throwValidExceptionAssert(isValidCpIndex(cIndex)
-                                          && cp->getTagAt(cIndex).isLong(),
-                                          "Invalid const value index at %d", cIndex);
+                PARSE_ENSURE(2);
+                auto cIndex = reader.readU16Unchecked();
+                PARSE_CHECK(isValidCpIndex(cIndex)
+                            && cp->getTagAt(cIndex).isLong(),
+                            "Invalid const value index at %d", cIndex);
                 auto value = cp->getLongAt(cIndex);
                 break;
             }
             case ElementValueTag::Short: {
-                auto cIndex = reader.readU16();
-                throwValidExceptionAssert(isValidCpIndex(cIndex)
-                                          && cp->getTagAt(cIndex).isInteger(),
-                                          "Invalid const value index at %d", cIndex);
+                PARSE_ENSURE(2);
+                auto cIndex = reader.readU16Unchecked();
+                PARSE_CHECK(isValidCpIndex(cIndex)
+                            && cp->getTagAt(cIndex).isInteger(),
+                            "Invalid const value index at %d", cIndex);
                 auto value = cp->getIntegerAt(cIndex);
                 break;
             }
             case ElementValueTag::Boolean: {
-                auto cIndex = reader.readU16();
-                throwValidExceptionAssert(isValidCpIndex(cIndex)
-                                          && cp->getTagAt(cIndex).isInteger(),
-                                          "Invalid const value index at %d", cIndex);
+                PARSE_ENSURE(2);
+                auto cIndex = reader.readU16Unchecked();
+                PARSE_CHECK(isValidCpIndex(cIndex)
+                            && cp->getTagAt(cIndex).isInteger(),
+                            "Invalid const value index at %d", cIndex);
                 auto value = cp->getIntegerAt(cIndex);
                 break;
             }
             case ElementValueTag::String: {
-                auto cIndex = reader.readU16();
-                throwValidExceptionAssert(isValidCpIndex(cIndex)
-                                          && cp->getTagAt(cIndex).isUtf8(),
-                                          "Invalid const value index at %d", cIndex);
+                PARSE_ENSURE(2);
+                auto cIndex = reader.readU16Unchecked();
+                PARSE_CHECK(isValidCpIndex(cIndex)
+                            && cp->getTagAt(cIndex).isUtf8(),
+                            "Invalid const value index at %d", cIndex);
                 auto value = cp->getSymbolAt(cIndex);
                 break;
             }
             case ElementValueTag::EnumType: {
-                reader.ensure(4);
+                PARSE_ENSURE(4);
                 auto typeNameIndex = reader.readU16Unchecked();
                 auto constNameIndex = reader.readU16Unchecked();
-                throwValidExceptionAssert(
+                PARSE_CHECK(
                     isValidCpIndex(typeNameIndex) && cp->getTagAt(typeNameIndex).isUtf8(),
                     "Invalid type name index at %d", typeNameIndex);
-                throwValidExceptionAssert(
+                PARSE_CHECK(
                     isValidCpIndex(constNameIndex) && cp->getTagAt(constNameIndex).isUtf8(),
                     "Invalid const name index at %d", constNameIndex);
                 break;
             }
             case ElementValueTag::Class: {
-                reader.ensure(2);
+                PARSE_ENSURE(2);
                 auto classInfoIndex = reader.readU16Unchecked();
-                throwValidExceptionAssert(
+                PARSE_CHECK(
                     isValidCpIndex(classInfoIndex) && cp->getTagAt(classInfoIndex).isUtf8(),
                     "Invalid class info index at %d", classInfoIndex);
                 break;
             }
             case ElementValueTag::AnnotationType: {
-                /* auto annotation = */ parseAnnotation();
+                /* auto annotation = */ PARSE_TRY(parseAnnotation());
 
                 break;
             }
             case ElementValueTag::ArrayType: {
-                auto valueCount = reader.readU16();
+                PARSE_ENSURE(2);
+                auto valueCount = reader.readU16Unchecked();
                 for (int i = 0; i < valueCount; i++) {
-                    /*auto elementValue = */ parseElementValue();
+                    /*auto elementValue = */ PARSE_TRY(parseElementValue());
                 }
                 break;
             }
             default:
-                throwParseException("Invalid element tag value");
+                return fail("Invalid element tag value");
         }
+        return true;
     }
 
-    const SymbolPtr &ClassFileParser::parseSignatureAttribute(uint32_t len) {
-        throwValidExceptionAssert(len == 2, "Invalid signature attr length %d", len);
+    bool ClassFileParser::parseSignatureAttribute(uint32_t len, SymbolPtr *signature) {
+        PARSE_CHECK(len == 2, "Invalid signature attr length %d", len);
         auto sigIndex = reader.readU16Unchecked();
-        throwValidExceptionAssert(
+        PARSE_CHECK(
             isValidCpIndex(sigIndex)
             && cp->getTagAt(sigIndex).isUtf8(), "Invalid signature index %d", sigIndex);
-        return cp->getSymbolAt(sigIndex);
+        if (signature != nullptr) {
+            *signature = cp->getSymbolAt(sigIndex);
+        }
+        return true;
     }
 
     void parseConstantValueAttr(uint32_t len) {
 
     }
 
-    void ClassFileParser::parseInterfaces() noexcept(false) {
+    bool ClassFileParser::parseMethods() {
+        PARSE_ENSURE(2);
+        auto methodCount = reader.readU16Unchecked();
+        for (int i = 0; i < methodCount; ++i) {
+            PARSE_TRY(parseMethod());
+        }
+        return true;
+    }
+
+    bool ClassFileParser::parseMethod() {
+        phase = ParseErrorCode::InvalidMethod;
+        PARSE_ENSURE(8);
+        auto methodAccessFlags = static_cast<MethodAccessFlags>(reader.readU16Unchecked());
+
+        auto nameIndex = reader.readU16Unchecked();
+        PARSE_CHECK(isValidCpIndex(nameIndex)
+                    && cp->getTagAt(nameIndex).isUtf8(),
+                    "Invalid method name index at %d", nameIndex);
+        const auto &name = cp->getSymbolAt(nameIndex);
+
+        auto descriptorIndex = reader.readU16Unchecked();
+        PARSE_CHECK(isValidCpIndex(descriptorIndex)
+                    && cp->getTagAt(descriptorIndex).isUtf8(),
+                    "Invalid method descriptor index at %d", descriptorIndex);
+        const auto &descriptor = cp->getSymbolAt(descriptorIndex);
+        int slots = Descriptor::parameterSlots(descriptor->getBytes(), descriptor->getLength());
+        PARSE_CHECK(slots >= 0, "Invalid method descriptor at %d", descriptorIndex);
+        PARSE_CHECK(slots + (methodAccessFlags & MethodAccessFlags::Static ? 0 : 1) <= 255,
+                    "Too many arguments in method signature at %d", descriptorIndex);
+
+        PARSE_TRY(checkMethodAccessFlags(methodAccessFlags, name));
+
+        MethodCode code;
+        bool hasCode = false;
+        PARSE_TRY(parseMethodAttributes(code, hasCode));
+        bool needsCode = !(methodAccessFlags & MethodAccessFlags::Native
+                           || methodAccessFlags & MethodAccessFlags::Abstract);
+        PARSE_CHECK(hasCode == needsCode,
+                    needsCode ? "Missing Code attribute in method %s"
+                              : "Unexpected Code attribute in method %s",
+                    name);
+
+        PARSE_CHECK(klass->findLocalMethod(name.get(), descriptor.get()) == nullptr,
+                    "Duplicate method %s", name);
+        klass->addMethod(Method::create(klass.get(), name, descriptor, methodAccessFlags,
+                                        hasCode ? &code : nullptr, &cp->getMetaspace()));
+        return true;
+    }
+
+    bool ClassFileParser::checkMethodAccessFlags(MethodAccessFlags flags, const SymbolPtr &name) {
+        int visibility = (flags & MethodAccessFlags::Public ? 1 : 0)
+                         + (flags & MethodAccessFlags::Private ? 1 : 0)
+                         + (flags & MethodAccessFlags::Protected ? 1 : 0);
+        PARSE_CHECK(visibility <= 1, "Invalid method access flags %d", flags);
+
+        if (name->equals("<clinit>")) {
+            // Other flags are ignored for class initializers (JVMS 4.6).
+            return true;
+        }
+
+        bool isInterface = accessFlags & ClassAccessFlags::Interface;
+        if (isInterface) {
+            if (majorVersion < JAVA_8_VERSION) {
+                PARSE_CHECK(flags & MethodAccessFlags::Public && flags & MethodAccessFlags::Abstract,
+                            "Interface method must be public abstract, flags %d", flags);
+            } else {
+                PARSE_CHECK(!(flags & MethodAccessFlags::Protected
+                              || flags & MethodAccessFlags::Final
+                              || flags & MethodAccessFlags::Synchronized
+                              || flags & MethodAccessFlags::Native),
+                            "Invalid interface method access flags %d", flags);
+                PARSE_CHECK(visibility == 1 && !(flags & MethodAccessFlags::Protected),
+                            "Interface method must be public or private, flags %d", flags);
+            }
+        }
+
+        if (flags & MethodAccessFlags::Abstract) {
+            PARSE_CHECK(!(flags & MethodAccessFlags::Private
+                          || flags & MethodAccessFlags::Static
+                          || flags & MethodAccessFlags::Final
+                          || flags & MethodAccessFlags::Synchronized
+                          || flags & MethodAccessFlags::Native
+                          || flags & MethodAccessFlags::Strict),
+                        "Invalid abstract method access flags %d", flags);
+        }
+
+        if (name->equals("<init>")) {
+            PARSE_CHECK(!isInterface, "Interface can not declare <init>");
+            PARSE_CHECK(!(flags & MethodAccessFlags::Static
+                          || flags & MethodAccessFlags::Final
+                          || flags & MethodAccessFlags::Synchronized
+                          || flags & MethodAccessFlags::Bridge
+                          || flags & MethodAccessFlags::Native
+                          || flags & MethodAccessFlags::Abstract),
+                        "Invalid <init> access flags %d", flags);
+        }
+        return true;
+    }
+
+    bool ClassFileParser::parseMethodAttributes(MethodCode &code, bool &hasCode) {
+        PARSE_ENSURE(2);
+        auto attributeCount = reader.readU16Unchecked();
+        for (int i = 0; i < attributeCount; ++i) {
+            PARSE_ENSURE(6);
+            auto attrNameIndex = reader.readU16Unchecked();
+            PARSE_CHECK(isValidCpIndex(attrNameIndex)
+                        && cp->getTagAt(attrNameIndex).isUtf8(),
+                        "Invalid method attribute name index at %d", attrNameIndex);
+
+            uint32_t len = reader.readU32Unchecked();
+            PARSE_ENSURE(len);
+
+            const auto &attrName = cp->getSymbolAt(attrNameIndex);
+            if (attrName->equals(ATTRIBUTE_Code)) {
+                PARSE_CHECK(!hasCode, "Multiple Code attributes");
+                PARSE_TRY(parseCodeAttribute(len, code));
+                hasCode = true;
+            } else if (attrName->equals(ATTRIBUTE_Synthetic)) {
+                PARSE_CHECK(len == 0, "Invalid synthetic attr len");
+            } else if (attrName->equals(ATTRIBUTE_Deprecated)) {
+                PARSE_CHECK(len == 0, "Invalid deprecated attr len");
+            } else if (attrName->equals(ATTRIBUTE_Signature)) {
+                PARSE_TRY(parseSignatureAttribute(len));
+            } else if (attrName->equals(ATTRIBUTE_RuntimeVisibleAnnotations)) {
+                /* auto annotations = */ PARSE_TRY(parseAnnotations());
+            } else if (attrName->equals(ATTRIBUTE_RuntimeInvisibleAnnotations)) {
+                /* auto annotations = */ PARSE_TRY(parseAnnotations());
+            } else {
+                // Exceptions, parameter annotations, AnnotationDefault, MethodParameters, type annotations
+                reader.skipUnchecked(len);
+            }
+        }
+        return true;
+    }
+
+    bool ClassFileParser::parseCodeAttribute(uint32_t len, MethodCode &code) {
+        auto end = reader.buffer() + len;
+        PARSE_CHECK(len >= 12, "Invalid Code attribute length %u", len);
+        code.maxStack = reader.readU16Unchecked();
+        code.maxLocals = reader.readU16Unchecked();
+        code.codeLength = reader.readU32Unchecked();
+        PARSE_CHECK(code.codeLength > 0 && code.codeLength < 65536,
+                    "Invalid method code length %u", code.codeLength);
+        PARSE_CHECK(code.codeLength <= (uint32_t) (end - reader.buffer()),
+                    "Code attribute overflows, code length %u", code.codeLength);
+        code.code = reader.buffer();
+        reader.skipUnchecked(code.codeLength);
+
+        PARSE_ENSURE(2);
+        auto exceptionTableLength = reader.readU16Unchecked();
+        PARSE_ENSURE(8 * exceptionTableLength + 2);
+        code.exceptionTable.reserve(exceptionTableLength);
+        for (int i = 0; i < exceptionTableLength; ++i) {
+            ExceptionTableElement element{};
+            element.startPc = reader.readU16Unchecked();
+            element.endPc = reader.readU16Unchecked();
+            element.handlerPc = reader.readU16Unchecked();
+            element.catchTypeIndex = reader.readU16Unchecked();
+            PARSE_CHECK(element.startPc < element.endPc && element.endPc <= code.codeLength
+                        && element.handlerPc < code.codeLength,
+                        "Invalid exception table entry [%d, %d) -> %d",
+                        element.startPc, element.endPc, element.handlerPc);
+            PARSE_CHECK(element.catchTypeIndex == 0
+                        || (isValidCpIndex(element.catchTypeIndex)
+                            && cp->getTagAt(element.catchTypeIndex).isClassOrUnresolvedClass()),
+                        "Invalid catch type index at %d", element.catchTypeIndex);
+            code.exceptionTable.push_back(element);
+        }
+
+        LineNumberStreamWriter lineNumbers;
+        auto attributeCount = reader.readU16Unchecked();
+        for (int i = 0; i < attributeCount; ++i) {
+            PARSE_ENSURE(6);
+            auto attrNameIndex = reader.readU16Unchecked();
+            PARSE_CHECK(isValidCpIndex(attrNameIndex)
+                        && cp->getTagAt(attrNameIndex).isUtf8(),
+                        "Invalid code attribute name index at %d", attrNameIndex);
+            uint32_t attrLen = reader.readU32Unchecked();
+            PARSE_ENSURE(attrLen);
+
+            const auto &attrName = cp->getSymbolAt(attrNameIndex);
+            if (attrName->equals(ATTRIBUTE_LineNumberTable)) {
+                PARSE_TRY(parseLineNumberTable(attrLen, code.codeLength, lineNumbers));
+            } else if (attrName->equals(ATTRIBUTE_StackMapTable)) {
+                PARSE_CHECK(code.stackMapTable == nullptr, "Multiple StackMapTable attributes");
+                PARSE_CHECK(attrLen >= 2, "Invalid StackMapTable length %u", attrLen);
+                code.stackMapTable = reader.buffer();
+                code.stackMapTableLength = attrLen;
+                reader.skipUnchecked(attrLen);
+            } else {
+                // LocalVariableTable, LocalVariableTypeTable, type annotations
+                reader.skipUnchecked(attrLen);
+            }
+        }
+        PARSE_CHECK(reader.buffer() == end, "Invalid Code attribute length %u", len);
+        if (!lineNumbers.isEmpty()) {
+            code.lineNumbers = lineNumbers.finish();
+        }
+        return true;
+    }
+
+    bool ClassFileParser::parseLineNumberTable(uint32_t len, uint32_t codeLength,
+                                               LineNumberStreamWriter &writer) {
+        PARSE_CHECK(len >= 2, "Invalid LineNumberTable length %u", len);
+        auto count = reader.readU16Unchecked();
+        PARSE_CHECK(len == 2 + 4u * count, "Invalid LineNumberTable length %u", len);
+        for (int i = 0; i < count; ++i) {
+            auto startPc = reader.readU16Unchecked();
+            auto line = reader.readU16Unchecked();
+            PARSE_CHECK(startPc < codeLength, "Invalid line number start pc %d", startPc);
+            writer.write(startPc, line);
+        }
+        return true;
+    }
+
+    bool ClassFileParser::parseClassAttributes() {
+        PARSE_ENSURE(2);
+        auto attributeCount = reader.readU16Unchecked();
+        for (int i = 0; i < attributeCount; ++i) {
+            PARSE_TRY(parseClassAttribute());
+        }
+        return true;
+    }
+
+    bool ClassFileParser::parseClassAttribute() {
+        phase = ParseErrorCode::InvalidAttribute;
+        PARSE_ENSURE(6);
+        auto attrNameIndex = reader.readU16Unchecked();
+        PARSE_CHECK(isValidCpIndex(attrNameIndex)
+                    && cp->getTagAt(attrNameIndex).isUtf8(),
+                    "Invalid class attribute name index at %d", attrNameIndex);
+        uint32_t len = reader.readU32Unchecked();
+        PARSE_ENSURE(len);
+
+        const auto &attrName = cp->getSymbolAt(attrNameIndex);
+        if (attrName->equals(ATTRIBUTE_SourceFile)) {
+            PARSE_CHECK(len == 2, "Invalid SourceFile attr length %u", len);
+            auto sourceFileIndex = reader.readU16Unchecked();
+            PARSE_CHECK(isValidCpIndex(sourceFileIndex)
+                        && cp->getTagAt(sourceFileIndex).isUtf8(),
+                        "Invalid source file index %d", sourceFileIndex);
+            klass->setSourceFile(cp->getSymbolAt(sourceFileIndex));
+        } else if (attrName->equals(ATTRIBUTE_Signature)) {
+            PARSE_TRY(parseSignatureAttribute(len));
+        } else if (attrName->equals(ATTRIBUTE_RuntimeVisibleAnnotations)) {
+            /* auto annotations = */ PARSE_TRY(parseAnnotations());
+        } else if (attrName->equals(ATTRIBUTE_RuntimeInvisibleAnnotations)) {
+            /* auto annotations = */ PARSE_TRY(parseAnnotations());
+        } else {
+            // InnerClasses, EnclosingMethod, BootstrapMethods, SourceDebugExtension, ...
+            reader.skipUnchecked(len);
+        }
+        return true;
+    }
+
+    bool ClassFileParser::parseInterfaces() {
         CCW_ASSERT(interfaces.empty());
 
         auto interfacesCount = reader.readU16Unchecked();
-        reader.ensure(2 * interfacesCount);
+        PARSE_ENSURE(2 * interfacesCount);
         for (int i = 0; i < interfacesCount; ++i) {
             auto index = reader.readU16Unchecked();
-            throwValidExceptionAssert(isValidCpIndex(index) && cp->getTagAt(index).isClassOrUnresolvedClass(),
-                                      "Invalid interface index at %d", index);
+            PARSE_CHECK(isValidCpIndex(index) && cp->getTagAt(index).isClassOrUnresolvedClass(),
+                        "Invalid interface index at %d", index);
             interfaces.push_back(index);
+            klass->addInterfaceName(cp->getClassAt(index).getUnresolvedClassName());
         }
+        return true;
     }
 
-    void ClassFileParser::parseConstantPool() noexcept(false) {
-        CCW_ASSERT(cp == nullptr);
+    bool ClassFileParser::parseConstantPool() {
+        EventScope event(EventType::ParseConstantPool);
+        EventScope symbolsEvent(EventType::SymbolIntern);
+        auto symbolsBefore = SymbolTable::createdByThread();
+        PARSE_TRY(beginConstantPool());
+        auto cpSize = cp->getSize();
+        event.setValue(cpSize);
+        uint32_t slots = 0;
+        for (uint32_t i = 1; i < cpSize; i += slots) {
+            PARSE_TRY(parseConstantPoolEntry(i, slots));
+        }
+        symbolsEvent.setValue(SymbolTable::createdByThread() - symbolsBefore);
+        return resolveConstantPool();
+    }
 
-        reader.ensure(3);
+    bool ClassFileParser::beginConstantPool() {
+        CCW_ASSERT(cp == nullptr);
+        phase = ParseErrorCode::InvalidConstantPool;
+        PARSE_ENSURE(2);
         auto cpSize = reader.readU16Unchecked();
-        cp = std::make_shared<ConstantPool>(cpSize);
-        parseConstantPoolEntities();
+        cp = std::make_shared<ConstantPool>(cpSize, metaspace);
+        return true;
+    }
 
+    bool ClassFileParser::resolveConstantPool() {
+        phase = ParseErrorCode::InvalidConstantPool;
+        auto cpSize = cp->getSize();
         auto i = 0;
         while (++i < cpSize) {
             ConstantType tag = cp->getTagAt(i).type;
@@ -464,11 +828,11 @@ namespace CCW::Tula {
                 case ConstantType::Methodref:
                 case ConstantType::InterfaceMethodref: {
                     uint16_t classIndex = cp->getRefClassIndexAt(i);
-                    throwValidExceptionAssert(
+                    PARSE_CHECK(
                         isValidCpIndex(classIndex) && cp->getTagAt(classIndex).isClassOrIndex(),
                         "Invalid class index at %d", classIndex);
                     uint16_t nameAndTypeIndex = cp->getRefNameAndTypeIndexAt(i);
-                    throwValidExceptionAssert(
+                    PARSE_CHECK(
                         isValidCpIndex(nameAndTypeIndex) &&
                         cp->getTagAt(nameAndTypeIndex) == ConstantType::NameAndType,
                         "Invalid name and type index at %d", nameAndTypeIndex);
@@ -476,13 +840,13 @@ namespace CCW::Tula {
                 }
                 case ConstantType::NameAndType: {
                     uint16_t nameIndex = cp->getNameAndTypeNameIndexAt(i);
-                    throwValidExceptionAssert(
+                    PARSE_CHECK(
                         isValidCpIndex(nameIndex) && cp->getTagAt(nameIndex) == ConstantType::Utf8,
                         "Invalid name index at %d",
                         nameIndex);
 
                     uint16_t descriptorIndex = cp->getNameAndTypeDescriptorIndexAt(i);
-                    throwValidExceptionAssert(
+                    PARSE_CHECK(
                         isValidCpIndex(descriptorIndex) && cp->getTagAt(descriptorIndex) == ConstantType::Utf8,
                         "Invalid descriptor index at %d",
                         descriptorIndex);
@@ -490,48 +854,48 @@ namespace CCW::Tula {
                     break;
                 case ConstantType::MethodHandle: {
                     auto kindValue = cp->getMethodHandleReferenceKindAt(i);
-                    throwValidExceptionAssert(kindValue >= 1 && kindValue <= 9, "Invalid reference kind %d", kindValue);
+                    PARSE_CHECK(kindValue >= 1 && kindValue <= 9, "Invalid reference kind %d", kindValue);
                     auto referenceIndex = cp->getMethodHandleReferenceIndexAt(i);
-                    throwValidExceptionAssert(isValidCpIndex(referenceIndex), "Invalid reference index %d",
-                                              referenceIndex);
+                    PARSE_CHECK(isValidCpIndex(referenceIndex), "Invalid reference index %d",
+                                referenceIndex);
                     auto kind = static_cast<ReferenceKind >(kindValue);
                     switch (kind) {
                         case ReferenceKind::REF_getField:
                         case ReferenceKind::REF_getStatic:
                         case ReferenceKind::REF_putField:
                         case ReferenceKind::REF_putStatic:
-                            throwValidExceptionAssert(cp->getTagAt(referenceIndex) == ConstantType::Fieldref,
-                                                      "Invalid field reference index %d", kindValue);
+                            PARSE_CHECK(cp->getTagAt(referenceIndex) == ConstantType::Fieldref,
+                                        "Invalid field reference index %d", kindValue);
                             break;
                         case ReferenceKind::REF_invokeVirtual:
                         case ReferenceKind::REF_newInvokeSpecial:
-                            throwValidExceptionAssert(cp->getTagAt(referenceIndex) == ConstantType::Methodref,
-                                                      "Invalid method reference index %d", kindValue);
+                            PARSE_CHECK(cp->getTagAt(referenceIndex) == ConstantType::Methodref,
+                                        "Invalid method reference index %d", kindValue);
                             break;
                         case ReferenceKind::REF_invokeStatic:
                         case ReferenceKind::REF_invokeSpecial: {
                             ConstantTag refTag = cp->getTagAt(referenceIndex);
-                            throwValidExceptionAssert(
-                                majorVersion < JAVA_8_VERSION && refTag == ConstantType::Methodref ||
-                                majorVersion >= JAVA_8_VERSION &&
-                                (refTag == ConstantType::Methodref || refTag == ConstantType::InterfaceMethodref),
+                            PARSE_CHECK(
+                                (majorVersion < JAVA_8_VERSION && refTag == ConstantType::Methodref) ||
+                                (majorVersion >= JAVA_8_VERSION &&
+                                 (refTag == ConstantType::Methodref || refTag == ConstantType::InterfaceMethodref)),
                                 "Invalid method reference index %d", kindValue);
                             break;
                         }
                         case ReferenceKind::REF_invokeInterface: {
-                            throwValidExceptionAssert(cp->getTagAt(referenceIndex) == ConstantType::InterfaceMethodref,
-                                                      "Invalid method reference index %d", kindValue);
+                            PARSE_CHECK(cp->getTagAt(referenceIndex) == ConstantType::InterfaceMethodref,
+                                        "Invalid method reference index %d", kindValue);
                             break;
                         }
                         default:
-                            throwParseException("Invalid reference kind value %d", kindValue);
+                            return fail("Invalid reference kind value %d", kindValue);
                     }
 
                 }
                     break;
                 case ConstantType::MethodType: {
                     uint16_t descriptorIndex = cp->getMethodTypeDescriptorIndex(i);
-                    throwValidExceptionAssert(
+                    PARSE_CHECK(
                         isValidCpIndex(descriptorIndex) && cp->getTagAt(descriptorIndex) == ConstantType::Utf8,
                         "Invalid descriptor index at %d",
                         descriptorIndex);
@@ -539,7 +903,15 @@ namespace CCW::Tula {
                 }
                 case ConstantType::InvokeDynamic: {
                     uint16_t nameAndTypeIndex = cp->getInvokeDynamicNameAndTypeIndexAt(i);
-                    throwValidExceptionAssert(
+                    PARSE_CHECK(
+                        isValidCpIndex(nameAndTypeIndex) &&
+                        cp->getTagAt(nameAndTypeIndex) == ConstantType::NameAndType,
+                        "Invalid name and type index at %d", nameAndTypeIndex);
+                    break;
+                }
+                case ConstantType::Dynamic: {
+                    uint16_t nameAndTypeIndex = cp->getDynamicNameAndTypeIndexAt(i);
+                    PARSE_CHECK(
                         isValidCpIndex(nameAndTypeIndex) &&
                         cp->getTagAt(nameAndTypeIndex) == ConstantType::NameAndType,
                         "Invalid name and type index at %d", nameAndTypeIndex);
@@ -547,7 +919,7 @@ namespace CCW::Tula {
                 }
                 case ConstantType::ClassIndex: {
                     uint16_t nameIndex = cp->getClassIndexAt(i);
-                    throwValidExceptionAssert(
+                    PARSE_CHECK(
                         isValidCpIndex(nameIndex) && cp->getTagAt(nameIndex) == ConstantType::Utf8,
                         "Invalid class name index at %d", nameIndex);
                     const SymbolPtr &className = cp->getSymbolAt(nameIndex);
@@ -556,133 +928,143 @@ namespace CCW::Tula {
                 }
                 case ConstantType::StringIndex: {
                     uint16_t stringIndex = cp->getStringIndexAt(i);
-                    throwValidExceptionAssert(
+                    PARSE_CHECK(
                         isValidCpIndex(stringIndex) && cp->getTagAt(stringIndex) == ConstantType::Utf8,
                         "Invalid string index at %d", stringIndex);
-                    const SymbolPtr &symbol = cp->getSymbolAt(stringIndex);
-                    cp->putStringAt(i, symbol);
+                    cp->putStringAt(i, stringIndex);
                     break;
                 }
                 case ConstantType::UnresolvedClass:
                     UNREACHABLE();
-                    return;
+                    return false;
                 default:
                     UNREACHABLE();
-                    return;
+                    return false;
             }
         }
 
         // TODO validate cp
+        return true;
     }
 
-    void ClassFileParser::parseConstantPoolEntities() noexcept(false) {
-        uint16_t i = 0;
-        auto cpSize = cp->getSize();
-        while (++i < cpSize) {
-            auto tagValue = reader.readU8Unchecked();
-            switch (static_cast<ConstantType>(tagValue)) {
-                case ConstantType::Class: {
-                    auto nameIndex = reader.readU16();
-                    cp->putClassIndexAt(i, nameIndex);
-                    break;
-                }
-                case ConstantType::Fieldref: {
-                    reader.ensure(5);
-                    auto classIndex = reader.readU16Unchecked();
-                    auto nameAndTypeIndex = reader.readU16Unchecked();
-                    cp->putFieldRefAt(i, classIndex, nameAndTypeIndex);
-                    break;
-                }
-                case ConstantType::Methodref: {
-                    reader.ensure(5);
-                    auto classIndex = reader.readU16Unchecked();
-                    auto nameAndTypeIndex = reader.readU16Unchecked();
-                    cp->putMethodRefAt(i, classIndex, nameAndTypeIndex);
-                    break;
-                }
-                case ConstantType::InterfaceMethodref: {
-                    reader.ensure(5);
-                    auto classIndex = reader.readU16Unchecked();
-                    auto nameAndTypeIndex = reader.readU16Unchecked();
-                    cp->putInterfaceMethodRefAt(i, classIndex, nameAndTypeIndex);
-                    break;
-                }
-                case ConstantType::String: {
-                    reader.ensure(3);
-                    auto index = reader.readU16Unchecked();
-                    cp->putStringIndexAt(i, index);
-                    break;
-                }
-                case ConstantType::Integer: {
-                    reader.ensure(5);
-                    auto intValue = reader.readU32Unchecked();
-                    cp->putIntegerAt(i, intValue);
-                    break;
-                }
-                case ConstantType::Float: {
-                    reader.ensure(5);
-                    auto floatValue = reader.readU32Unchecked();
-                    cp->putFloatAt(i, floatValue);
-                    break;
-                }
-                case ConstantType::Long: {
-                    reader.ensure(9);
-                    auto bytes = reader.readU64Unchecked();
-                    cp->putLongAt(i, bytes);
-                    i++;
-                    break;
-                }
-                case ConstantType::Double: {
-                    reader.ensure(9);
-                    auto bytes = reader.readU64Unchecked();
-                    cp->putDoubleAt(i, bytes);
-                    i++;
-                    break;
-                }
-                case ConstantType::NameAndType: {
-                    reader.ensure(5);
-                    auto nameIndex = reader.readU16Unchecked();
-                    auto descriptor = reader.readU16Unchecked();
-                    cp->putNameAndTypeAt(i, nameIndex, descriptor);
-                    break;
-                }
-                case ConstantType::Utf8: {
-                    auto len = reader.readU16();
-                    reader.ensure(len + 1);
-                    auto symbol = Symbol::create(reader.buffer(), len);
-                    SymbolTable::putSymbol(symbol);
-                    cp->putSymbolAt(i, symbol);
-                    reader.skipUnchecked(len);
-                    break;
-                }
-                case ConstantType::MethodHandle: {
-                    reader.ensure(4);
-                    auto referenceKind = reader.readU8Unchecked();
-                    auto referenceIndex = reader.readU16Unchecked();
-                    cp->putMethodHandleAt(i, referenceKind, referenceIndex);
-                    break;
-                }
-                case ConstantType::MethodType: {
-                    reader.ensure(3);
-                    auto descriptorIndex = reader.readU16Unchecked();
-                    cp->putMethodTypeAt(i, descriptorIndex);
-                    break;
-                }
-                case ConstantType::InvokeDynamic: {
-                    reader.ensure(5);
-                    auto bootstrapMethodAttrIndex = reader.readU16Unchecked();
-                    auto nameAndTypeIndex = reader.readU16Unchecked();
-                    cp->putInvokeDynamicAt(i, bootstrapMethodAttrIndex, nameAndTypeIndex);
-                    break;
-                }
-                default: {
-                    throwParseException("Invalid constant type tag: %d at %d", tagValue, i);
-                }
+    bool ClassFileParser::parseConstantPoolEntry(uint32_t i, uint32_t &slots) {
+        phase = ParseErrorCode::InvalidConstantPool;
+        slots = 1;
+        PARSE_ENSURE(1);
+        auto tagValue = reader.readU8Unchecked();
+        switch (static_cast<ConstantType>(tagValue)) {
+            case ConstantType::Class: {
+                PARSE_ENSURE(2);
+                auto nameIndex = reader.readU16Unchecked();
+                cp->putClassIndexAt(i, nameIndex);
+                break;
+            }
+            case ConstantType::Fieldref: {
+                PARSE_ENSURE(4);
+                auto classIndex = reader.readU16Unchecked();
+                auto nameAndTypeIndex = reader.readU16Unchecked();
+                cp->putFieldRefAt(i, classIndex, nameAndTypeIndex);
+                break;
+            }
+            case ConstantType::Methodref: {
+                PARSE_ENSURE(4);
+                auto classIndex = reader.readU16Unchecked();
+                auto nameAndTypeIndex = reader.readU16Unchecked();
+                cp->putMethodRefAt(i, classIndex, nameAndTypeIndex);
+                break;
+            }
+            case ConstantType::InterfaceMethodref: {
+                PARSE_ENSURE(4);
+                auto classIndex = reader.readU16Unchecked();
+                auto nameAndTypeIndex = reader.readU16Unchecked();
+                cp->putInterfaceMethodRefAt(i, classIndex, nameAndTypeIndex);
+                break;
+            }
+            case ConstantType::String: {
+                PARSE_ENSURE(2);
+                auto index = reader.readU16Unchecked();
+                cp->putStringIndexAt(i, index);
+                break;
+            }
+            case ConstantType::Integer: {
+                PARSE_ENSURE(4);
+                auto intValue = reader.readU32Unchecked();
+                cp->putIntegerAt(i, intValue);
+                break;
+            }
+            case ConstantType::Float: {
+                PARSE_ENSURE(4);
+                auto floatValue = reader.readU32Unchecked();
+                cp->putFloatAt(i, floatValue);
+                break;
+            }
+            case ConstantType::Long: {
+                PARSE_ENSURE(8);
+                auto bytes = reader.readU64Unchecked();
+                cp->putLongAt(i, bytes);
+                slots = 2;
+                break;
+            }
+            case ConstantType::Double: {
+                PARSE_ENSURE(8);
+                auto bytes = reader.readU64Unchecked();
+                cp->putDoubleAt(i, bytes);
+                slots = 2;
+                break;
+            }
+            case ConstantType::NameAndType: {
+                PARSE_ENSURE(4);
+                auto nameIndex = reader.readU16Unchecked();
+                auto descriptor = reader.readU16Unchecked();
+                cp->putNameAndTypeAt(i, nameIndex, descriptor);
+                break;
+            }
+            case ConstantType::Utf8: {
+                PARSE_ENSURE(2);
+                auto len = reader.readU16Unchecked();
+                PARSE_ENSURE(len);
+                auto symbol = SymbolTable::intern(reader.buffer(), len);
+                cp->putSymbolAt(i, symbol);
+                reader.skipUnchecked(len);
+                break;
+            }
+            case ConstantType::MethodHandle: {
+                PARSE_ENSURE(3);
+                auto referenceKind = reader.readU8Unchecked();
+                auto referenceIndex = reader.readU16Unchecked();
+                cp->putMethodHandleAt(i, referenceKind, referenceIndex);
+                break;
+            }
+            case ConstantType::MethodType: {
+                PARSE_ENSURE(2);
+                auto descriptorIndex = reader.readU16Unchecked();
+                cp->putMethodTypeAt(i, descriptorIndex);
+                break;
+            }
+            case ConstantType::InvokeDynamic: {
+                PARSE_ENSURE(4);
+                auto bootstrapMethodAttrIndex = reader.readU16Unchecked();
+                auto nameAndTypeIndex = reader.readU16Unchecked();
+                cp->putInvokeDynamicAt(i, bootstrapMethodAttrIndex, nameAndTypeIndex);
+                break;
+            }
+            case ConstantType::Dynamic: {
+                PARSE_CHECK(majorVersion >= JAVA_11_VERSION, "Dynamic constant at %d needs version 55", i);
+                PARSE_ENSURE(4);
+                auto bootstrapMethodAttrIndex = reader.readU16Unchecked();
+                auto nameAndTypeIndex = reader.readU16Unchecked();
+                cp->putDynamicAt(i, bootstrapMethodAttrIndex, nameAndTypeIndex);
+                break;
+            }
+            default: {
+                return fail("Invalid constant type tag: %d at %d", tagValue, i);
             }
         }
+        return true;
     }
 
-    void ClassFileParser::parseTypeAnnotations() noexcept(false) {
+    bool ClassFileParser::parseTypeAnnotations() {
         // TODO
+        return true;
     }
 }
\ No newline at end of file
@@ -1,9 +1,12 @@
 #pragma once
 
 #include "ClassFileReader.hpp"
+#include "ParseError.hpp"
 
 #include "../Klass.hpp"
 #include "../ConstantPool.hpp"
+#include "../LineNumberStream.hpp"
+#include "../Metaspace.hpp"
 
 #include <vector>
 
@@ -11,46 +14,124 @@ namespace CCW::Tula {
 
     class ClassFileParser {
     public:
-        static Klass::Ptr parse(const uint8_t *data, uint32_t len) noexcept(false);
+        // Metadata of the class goes to `metaspace`, the arena of the defining loader; without one the
+        // class gets an arena of its own.
+        static Klass::Ptr parse(const uint8_t *data, uint32_t len,
+                                std::shared_ptr<Metaspace> metaspace = nullptr) noexcept(false);
 
-        ClassFileParser(const uint8_t *data, uint32_t len);
+        // Like parse(), but a malformed class yields nullptr and `error` instead of an exception, for
+        // callers that expect many of them.
+        static Klass::Ptr tryParse(const uint8_t *data, uint32_t len, ParseError &error,
+                                   std::shared_ptr<Metaspace> metaspace = nullptr);
 
+        ClassFileParser(const uint8_t *data, uint32_t len, std::shared_ptr<Metaspace> metaspace = nullptr);
+
+        // Throws ClassFormatError with the message of getError().
         Klass::Ptr parse() noexcept(false);
 
+        // nullptr when the class is malformed; getError() tells why.
+        Klass::Ptr tryParse();
+
+        [[nodiscard]] inline const ParseError &getError() const {
+            return error;
+        }
+
+        // Constant pool indexes of the direct super interfaces, valid after parse().
+        [[nodiscard]] inline const std::vector<uint16_t> &getInterfaceIndexes() const {
+            return interfaces;
+        }
+
+        // Types of the annotations on the class and its members, nested ones included, in class file
+        // order; valid after parse(). The class itself keeps no annotations.
+        [[nodiscard]] inline const std::vector<SymbolPtr> &getAnnotationTypes() const {
+            return annotationTypes;
+        }
+
     private:
-        static void throwParseException(const char *fmt, ...);
+        // Parses a class fed in chunks with the phases below, one unit of the class file at a time.
+        friend class StreamingClassFileParser;
+
+        // The parse methods return false once they have recorded an error with fail(); the error code
+        // is that of the phase being parsed.
+        template<typename... Args>
+        bool fail(const char *format, const Args &... args) {
+            error.set(phase, reader.position(), format, args...);
+            return false;
+        }
+
+        bool failTruncated() {
+            error.set(ParseErrorCode::Truncated, reader.position(), "Truncated class file");
+            return false;
+        }
+
+        bool parseClass();
+
+        bool parseHeader();
+
+        bool parseConstantPool();
+
+        // Reads the constant pool count and creates the pool.
+        bool beginConstantPool();
 
-        void parseConstantPool() noexcept(false);
+        // Parses the entry at `index` and the number of slots it takes.
+        bool parseConstantPoolEntry(uint32_t index, uint32_t &slots);
 
-        void parseConstantPoolEntities() noexcept(false);
+        // Checks the references between entries once all of them are read.
+        bool resolveConstantPool();
 
-        void parseInterfaces() noexcept(false);
+        // Access flags, this and super class, interfaces; creates the klass.
+        bool parseClassInfo();
 
-        void parseFields() noexcept(false);
+        bool parseInterfaces();
 
-        void parseAnnotations() noexcept(false);
+        bool parseFields();
 
-        void parseAnnotation() noexcept(false);
+        bool parseField();
 
-        void parseTypeAnnotations() noexcept(false);
+        bool parseAnnotations();
 
-        void parseElementValue() noexcept(false);
+        bool parseAnnotation();
+
+        bool parseTypeAnnotations();
+
+        bool parseElementValue();
 
         bool isValidCpIndex(uint16_t index);
 
-        void parseFieldAttributes(FieldAccessFlags flags);
+        bool parseFieldAttributes(FieldAccessFlags flags, uint16_t &constValueIndex);
+
+        bool parseMethods();
+
+        bool parseMethod();
+
+        bool checkMethodAccessFlags(MethodAccessFlags flags, const SymbolPtr &name);
+
+        bool parseMethodAttributes(MethodCode &code, bool &hasCode);
 
-        const SymbolPtr& parseSignatureAttribute(uint32_t len);
+        bool parseCodeAttribute(uint32_t len, MethodCode &code);
+
+        bool parseLineNumberTable(uint32_t len, uint32_t codeLength, LineNumberStreamWriter &writer);
+
+        bool parseClassAttributes();
+
+        bool parseClassAttribute();
+
+        bool parseSignatureAttribute(uint32_t len, SymbolPtr *signature = nullptr);
 
     private:
         ClassFileReader reader;
+        std::shared_ptr<Metaspace> metaspace;
         std::shared_ptr<ConstantPool> cp;
+        std::shared_ptr<InstanceKlass> klass;
 
         uint16_t minorVersion{};
         uint16_t majorVersion{};
         ClassAccessFlags accessFlags {};
 
         std::vector<uint16_t> interfaces {};
-        std::vector<uint16_t> fields {};
+        std::vector<SymbolPtr> annotationTypes {};
+
+        ParseError error;
+        ParseErrorCode phase = ParseErrorCode::InvalidMagic;
     };
 }
\ No newline at end of file
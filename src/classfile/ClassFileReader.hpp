@@ -18,12 +18,29 @@ namespace CCW::Tula {
             end = const_cast<uint8_t *>(bytes + len);
         }
 
+        // Points the reader at another buffer; the streaming parser moves it from one unit to the next.
+        inline void reset(const uint8_t *data, uint32_t size) {
+            bytes = data;
+            len = size;
+            ptr = const_cast<uint8_t *>(data);
+            end = data + size;
+        }
+
         inline void ensure(uint32_t least, const std::string &msg = "Truncated class file") noexcept(false) {
             if (remaining() < least) {
                 throw ClassFormatError(msg);
             }
         }
 
+        [[nodiscard]] inline bool has(uint32_t least) const {
+            return static_cast<uint32_t>(end - ptr) >= least;
+        }
+
+        // Bytes read so far.
+        [[nodiscard]] inline uint32_t position() const {
+            return static_cast<uint32_t>(ptr - bytes);
+        }
+
         inline uint8_t* buffer() {
             return ptr;
         }
@@ -85,7 +102,7 @@ namespace CCW::Tula {
 
     private:
         const uint8_t *bytes;
-        const uint32_t len;
+        uint32_t len;
         uint8_t *ptr;
         const uint8_t *end;
     };
@@ -0,0 +1,72 @@
+#include "Descriptor.hpp"
+
+namespace CCW::Tula {
+
+    static constexpr int MaxArrayDimensions = 255;
+
+    size_t Descriptor::fieldTypeLength(const uint8_t *bytes, size_t len) {
+        size_t i = 0;
+        while (i < len && bytes[i] == '[') {
+            if (++i > MaxArrayDimensions) {
+                return 0;
+            }
+        }
+        if (i >= len) {
+            return 0;
+        }
+        switch (bytes[i]) {
+            case 'B':
+            case 'C':
+            case 'D':
+            case 'F':
+            case 'I':
+            case 'J':
+            case 'S':
+            case 'Z':
+                return i + 1;
+            case 'L': {
+                auto start = ++i;
+                while (i < len && bytes[i] != ';') {
+                    if (bytes[i] == '.' || bytes[i] == '[') {
+                        return 0;
+                    }
+                    i++;
+                }
+                if (i >= len || i == start) {
+                    return 0;
+                }
+                return i + 1;
+            }
+            default:
+                return 0;
+        }
+    }
+
+    bool Descriptor::isValidField(const uint8_t *bytes, size_t len) {
+        return len > 0 && fieldTypeLength(bytes, len) == len;
+    }
+
+    int Descriptor::parameterSlots(const uint8_t *bytes, size_t len) {
+        if (len < 3 || bytes[0] != '(') {
+            return -1;
+        }
+        size_t i = 1;
+        int slots = 0;
+        while (i < len && bytes[i] != ')') {
+            auto typeLen = fieldTypeLength(bytes + i, len - i);
+            if (typeLen == 0) {
+                return -1;
+            }
+            slots += typeLen == 1 && (bytes[i] == 'J' || bytes[i] == 'D') ? 2 : 1;
+            i += typeLen;
+        }
+        if (i >= len) {
+            return -1;
+        }
+        i++;
+        if (len - i == 1 && bytes[i] == 'V') {
+            return slots;
+        }
+        return fieldTypeLength(bytes + i, len - i) == len - i ? slots : -1;
+    }
+}
@@ -0,0 +1,20 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+namespace CCW::Tula {
+
+    class Descriptor {
+    public:
+        // Validates a field descriptor (JVMS 4.3.2) spanning exactly `len` bytes.
+        static bool isValidField(const uint8_t *bytes, size_t len);
+
+        // Returns the number of local variable slots taken by the parameters of a method
+        // descriptor (JVMS 4.3.3), long and double counting twice, or -1 when malformed.
+        static int parameterSlots(const uint8_t *bytes, size_t len);
+
+        // Returns the length of the field type starting at `bytes`, or 0 when malformed.
+        static size_t fieldTypeLength(const uint8_t *bytes, size_t len);
+    };
+}
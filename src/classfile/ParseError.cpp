@@ -0,0 +1,55 @@
+#include "ParseError.hpp"
+#include "../Error.hpp"
+
+namespace CCW::Tula {
+
+    void ParseError::raise() const {
+        if (code == ParseErrorCode::UnsupportedVersion) {
+            throw UnsupportedClassVersionError(message());
+        }
+        throw ClassFormatError(message());
+    }
+
+    std::string ParseError::message() const {
+        std::string out;
+        size_t next = 0;
+        for (auto p = format; *p != '\0'; ++p) {
+            if (*p != '%') {
+                out += *p;
+                continue;
+            }
+            ++p;
+            while (*p == 'z' || *p == 'l' || *p == 'h') {
+                ++p;
+            }
+            switch (*p) {
+                case '%':
+                    out += '%';
+                    break;
+                case 's':
+                    if (symbol != nullptr) {
+                        out.append(reinterpret_cast<const char *>(symbol->getBytes()), symbol->getLength());
+                    }
+                    break;
+                case '\0':
+                    return out;
+                default:
+                    if (next < argumentCount) {
+                        out += std::to_string(arguments[next++]);
+                    }
+                    break;
+            }
+        }
+        return out;
+    }
+
+    const char *ParseError::codeName(ParseErrorCode code) {
+        static const char *const names[] = {
+#define TULA_PARSE_ERROR_NAME(id, description) #id,
+            TULA_PARSE_ERRORS(TULA_PARSE_ERROR_NAME)
+#undef TULA_PARSE_ERROR_NAME
+        };
+        auto index = static_cast<size_t>(code);
+        return index < sizeof(names) / sizeof(names[0]) ? names[index] : "Unknown";
+    }
+}
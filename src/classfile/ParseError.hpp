@@ -0,0 +1,93 @@
+#pragma once
+
+#include "../Symbol.hpp"
+
+#include <array>
+#include <cstdint>
+#include <string>
+#include <type_traits>
+
+namespace CCW::Tula {
+
+    // Why a class file was rejected: (id, description).
+#define TULA_PARSE_ERRORS(do_error)                                               \
+    do_error(None, "no error")                                                   \
+    do_error(Truncated, "the class file ends early")                             \
+    do_error(InvalidMagic, "not a class file")                                   \
+    do_error(UnsupportedVersion, "a class file version this VM can't load")      \
+    do_error(InvalidConstantPool, "malformed constant pool entry")               \
+    do_error(InvalidClass, "invalid access flags, this, super or interfaces")    \
+    do_error(InvalidField, "malformed field")                                    \
+    do_error(InvalidMethod, "malformed method or Code attribute")                \
+    do_error(InvalidAttribute, "malformed class attribute")                      \
+    do_error(ExtraBytes, "bytes past the end of the class")
+
+    enum class ParseErrorCode : uint8_t {
+#define TULA_PARSE_ERROR_ID(id, description) id,
+        TULA_PARSE_ERRORS(TULA_PARSE_ERROR_ID)
+#undef TULA_PARSE_ERROR_ID
+    };
+
+    // A class file error as ClassFileParser::tryParse() reports it. Recording one costs a few stores:
+    // the message is only formatted by message(), from the format and the arguments kept here.
+    class ParseError {
+    public:
+        [[nodiscard]] inline ParseErrorCode getCode() const {
+            return code;
+        }
+
+        // Where in the class file the parser stopped.
+        [[nodiscard]] inline uint32_t getOffset() const {
+            return offset;
+        }
+
+        [[nodiscard]] inline explicit operator bool() const {
+            return code != ParseErrorCode::None;
+        }
+
+        // The text ClassFormatError would carry.
+        [[nodiscard]] std::string message() const;
+
+        // Throws what the VM throws for this error: UnsupportedClassVersionError for a version it
+        // can't load, ClassFormatError otherwise.
+        [[noreturn]] void raise() const;
+
+        static const char *codeName(ParseErrorCode code);
+
+    private:
+        friend class ClassFileParser;
+        friend class StreamingClassFileParser;
+
+        static constexpr size_t MaxArguments = 3;
+
+        // `format` must be a literal; it may hold %d, %u and %zu for integers and one %s for a symbol.
+        template<typename... Args>
+        void set(ParseErrorCode errorCode, uint32_t errorOffset, const char *errorFormat, const Args &... args) {
+            static_assert(sizeof...(Args) <= MaxArguments + 1);
+            code = errorCode;
+            offset = errorOffset;
+            format = errorFormat;
+            argumentCount = 0;
+            symbol = nullptr;
+            (addArgument(args), ...);
+        }
+
+        template<typename T>
+        void addArgument(const T &value) {
+            if constexpr (std::is_same_v<T, SymbolPtr>) {
+                symbol = value;
+            } else {
+                CCW_ASSERT(argumentCount < MaxArguments);
+                arguments[argumentCount++] = static_cast<int64_t>(value);
+            }
+        }
+
+    private:
+        ParseErrorCode code = ParseErrorCode::None;
+        uint32_t offset = 0;
+        const char *format = "";
+        std::array<int64_t, MaxArguments> arguments{};
+        uint8_t argumentCount = 0;
+        SymbolPtr symbol;
+    };
+}
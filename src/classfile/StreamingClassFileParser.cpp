@@ -0,0 +1,233 @@
+#include "StreamingClassFileParser.hpp"
+
+#include <algorithm>
+#include <limits>
+
+namespace CCW::Tula {
+
+    static inline uint16_t u16At(const uint8_t *p) {
+        return uint16_t(p[0]) << 8 | uint16_t(p[1]);
+    }
+
+    static inline uint32_t u32At(const uint8_t *p) {
+        return uint32_t(p[0]) << 24 | uint32_t(p[1]) << 16 | uint32_t(p[2]) << 8 | uint32_t(p[3]);
+    }
+
+    StreamingClassFileParser::StreamingClassFileParser(std::shared_ptr<Metaspace> metaspace) :
+        parser(nullptr, 0, std::move(metaspace)) {
+    }
+
+    void StreamingClassFileParser::feed(const uint8_t *data, size_t len) noexcept(false) {
+        size_t used = 0;
+        // Top up the unit that is being buffered, only as far as its framing needs.
+        while (!pending.empty()) {
+            auto need = frame(pending.data(), pending.size());
+            if (need <= pending.size()) {
+                parseUnit(pending.data(), need);
+                pending.clear();
+                break;
+            }
+            if (used == len) {
+                return;
+            }
+            auto take = std::min(need - pending.size(), len - used);
+            pending.insert(pending.end(), data + used, data + used + take);
+            used += take;
+        }
+
+        // Whole units are parsed right from `data`; the start of the last one is kept for the next call.
+        used += parseUnits(data + used, len - used);
+        pending.assign(data + used, data + len);
+    }
+
+    Klass::Ptr StreamingClassFileParser::finish() noexcept(false) {
+        if (state != State::Done) {
+            // Parsing the rest fails where ClassFileParser::parse() would on the truncated file.
+            parseUnit(pending.data(), pending.size());
+            throw ClassFormatError("Truncated class file");
+        }
+        return parser.klass;
+    }
+
+    size_t StreamingClassFileParser::frame(const uint8_t *data, size_t len) noexcept(false) {
+        size_t size;
+        switch (state) {
+            case State::Header:
+                // magic, minor and major version, constant pool count
+                size = 10;
+                break;
+            case State::Constant: {
+                if (len < 1) {
+                    return 1;
+                }
+                switch (static_cast<ConstantType>(data[0])) {
+                    case ConstantType::Utf8:
+                        size = len < 3 ? 3 : 3 + u16At(data + 1);
+                        break;
+                    case ConstantType::Class:
+                    case ConstantType::String:
+                    case ConstantType::MethodType:
+                        size = 3;
+                        break;
+                    case ConstantType::MethodHandle:
+                        size = 4;
+                        break;
+                    case ConstantType::Integer:
+                    case ConstantType::Float:
+                    case ConstantType::Fieldref:
+                    case ConstantType::Methodref:
+                    case ConstantType::InterfaceMethodref:
+                    case ConstantType::NameAndType:
+                    case ConstantType::InvokeDynamic:
+                    case ConstantType::Dynamic:
+                        size = 5;
+                        break;
+                    case ConstantType::Long:
+                    case ConstantType::Double:
+                        size = 9;
+                        break;
+                    default:
+                        // The parser rejects the tag.
+                        size = 1;
+                        break;
+                }
+                break;
+            }
+            case State::ClassInfo:
+                // access flags, this and super class, interface count, interfaces
+                size = len < 8 ? 8 : 8 + 2 * size_t(u16At(data + 6));
+                break;
+            case State::FieldCount:
+            case State::MethodCount:
+            case State::AttributeCount:
+                size = 2;
+                break;
+            case State::Field:
+            case State::Method:
+                size = frameMember(data, len);
+                break;
+            case State::Attribute:
+                size = len < 6 ? 6 : 6 + size_t(u32At(data + 2));
+                break;
+            case State::Done:
+            default:
+                UNREACHABLE();
+        }
+        if (size > std::numeric_limits<uint32_t>::max()) {
+            throw ClassFormatError("Class file too large at offset " + std::to_string(offset));
+        }
+        return size;
+    }
+
+    size_t StreamingClassFileParser::frameMember(const uint8_t *data, size_t len) noexcept(false) {
+        if (memberSize == 0) {
+            if (len < 8) {
+                return 8;
+            }
+            memberSize = 8;
+            memberAttributes = u16At(data + 6);
+        }
+        while (memberAttributes > 0) {
+            if (len < memberSize + 6) {
+                return memberSize + 6;
+            }
+            memberSize += 6 + size_t(u32At(data + memberSize + 2));
+            memberAttributes--;
+        }
+        return memberSize;
+    }
+
+    size_t StreamingClassFileParser::parseUnits(const uint8_t *data, size_t len) noexcept(false) {
+        size_t used = 0;
+        while (state != State::Done) {
+            auto need = frame(data + used, len - used);
+            if (need > len - used) {
+                return used;
+            }
+            parseUnit(data + used, need);
+            used += need;
+        }
+        if (used < len) {
+            throw ClassFormatError("Extra bytes at the end of class file");
+        }
+        return used;
+    }
+
+    void StreamingClassFileParser::parseUnit(const uint8_t *data, size_t len) noexcept(false) {
+        auto &reader = parser.reader;
+        reader.reset(data, static_cast<uint32_t>(len));
+        switch (state) {
+            case State::Header:
+                check(parser.parseHeader() && parser.beginConstantPool());
+                constantIndex = 1;
+                nextConstant();
+                break;
+            case State::Constant: {
+                uint32_t slots = 0;
+                check(parser.parseConstantPoolEntry(constantIndex, slots));
+                constantIndex += slots;
+                nextConstant();
+                break;
+            }
+            case State::ClassInfo:
+                check(parser.parseClassInfo());
+                state = State::FieldCount;
+                break;
+            case State::FieldCount:
+                remaining = parseCount();
+                state = remaining > 0 ? State::Field : State::MethodCount;
+                break;
+            case State::Field:
+                check(parser.parseField());
+                state = --remaining > 0 ? State::Field : State::MethodCount;
+                break;
+            case State::MethodCount:
+                remaining = parseCount();
+                state = remaining > 0 ? State::Method : State::AttributeCount;
+                break;
+            case State::Method:
+                check(parser.parseMethod());
+                state = --remaining > 0 ? State::Method : State::AttributeCount;
+                break;
+            case State::AttributeCount:
+                remaining = parseCount();
+                state = remaining > 0 ? State::Attribute : State::Done;
+                break;
+            case State::Attribute:
+                check(parser.parseClassAttribute());
+                state = --remaining > 0 ? State::Attribute : State::Done;
+                break;
+            case State::Done:
+            default:
+                UNREACHABLE();
+        }
+        // The whole-file parser would go on reading where the unit's lengths disagree with its contents.
+        if (!reader.isEos()) {
+            throw ClassFormatError("Invalid attribute length at offset " + std::to_string(offset));
+        }
+        offset += len;
+        memberSize = 0;
+        memberAttributes = 0;
+    }
+
+    uint16_t StreamingClassFileParser::parseCount() noexcept(false) {
+        auto &reader = parser.reader;
+        check(reader.has(2) || parser.failTruncated());
+        return reader.readU16Unchecked();
+    }
+
+    void StreamingClassFileParser::nextConstant() noexcept(false) {
+        if (constantIndex < parser.cp->getSize()) {
+            state = State::Constant;
+        } else {
+            check(parser.resolveConstantPool());
+            state = State::ClassInfo;
+        }
+    }
+
+    void StreamingClassFileParser::check(bool parsed) noexcept(false) {
+        if (!parsed) {
+            parser.getError().raise();
+        }
+    }
+}
@@ -0,0 +1,94 @@
+#pragma once
+
+#include "ClassFileParser.hpp"
+
+#include <CCW/Base.hpp>
+
+#include <vector>
+
+namespace CCW::Tula {
+
+    // Parses a class file that arrives in chunks of any size, e.g. from a pipe, with the phases of
+    // ClassFileParser. The class file is cut into units: the header, each constant, the class info,
+    // each field, each method and each class attribute. A unit is parsed as soon as its last byte
+    // arrives; only the bytes of the unit that is still incomplete are buffered. The result and the
+    // errors are those of ClassFileParser::parse() on the whole file, except that an attribute whose
+    // contents disagree with its length is rejected right away.
+    //
+    // After an exception the parser is unusable.
+    class StreamingClassFileParser : public Noncopyable {
+    public:
+        explicit StreamingClassFileParser(std::shared_ptr<Metaspace> metaspace = nullptr);
+
+        // Parses what `data` completes; the bytes need not outlive the call. Throws ClassFormatError as
+        // soon as the class is known to be malformed, bytes past the end of the class included.
+        void feed(const uint8_t *data, size_t len) noexcept(false);
+
+        // The class, once all of it was fed; throws ClassFormatError when the input ended early.
+        Klass::Ptr finish() noexcept(false);
+
+        [[nodiscard]] inline bool isComplete() const {
+            return state == State::Done;
+        }
+
+        // Bytes held back until the rest of their unit arrives.
+        [[nodiscard]] inline size_t getBufferedBytes() const {
+            return pending.size();
+        }
+
+        [[nodiscard]] inline const std::vector<uint16_t> &getInterfaceIndexes() const {
+            return parser.getInterfaceIndexes();
+        }
+
+        [[nodiscard]] inline const std::vector<SymbolPtr> &getAnnotationTypes() const {
+            return parser.getAnnotationTypes();
+        }
+
+    private:
+        enum class State {
+            Header,
+            Constant,
+            ClassInfo,
+            FieldCount,
+            Field,
+            MethodCount,
+            Method,
+            AttributeCount,
+            Attribute,
+            Done
+        };
+
+        // The size of the unit starting at `data` when the `len` bytes hold all of it, otherwise more
+        // than `len`: the number of bytes needed to learn more about it.
+        size_t frame(const uint8_t *data, size_t len) noexcept(false);
+
+        // Frames a field or a method: an 8 byte header ending with the attribute count, then the
+        // attributes. Resumes where the previous call stopped.
+        size_t frameMember(const uint8_t *data, size_t len) noexcept(false);
+
+        // Parses the complete units at the start of `data`; returns the number of bytes they take.
+        size_t parseUnits(const uint8_t *data, size_t len) noexcept(false);
+
+        void parseUnit(const uint8_t *data, size_t len) noexcept(false);
+
+        // A field, method or attribute count.
+        uint16_t parseCount() noexcept(false);
+
+        void nextConstant() noexcept(false);
+
+        // Throws the error the parser recorded when a phase failed.
+        void check(bool parsed) noexcept(false);
+
+    private:
+        ClassFileParser parser;
+        State state = State::Header;
+        std::vector<uint8_t> pending;
+        size_t offset = 0;              // of the current unit in the class file
+        uint32_t constantIndex = 0;
+        uint16_t remaining = 0;         // fields, methods or attributes left
+
+        // Progress of frameMember() on the current unit.
+        size_t memberSize = 0;
+        uint16_t memberAttributes = 0;
+    };
+}
@@ -0,0 +1,327 @@
+#include "EventRecorder.hpp"
+#include "../Error.hpp"
+#include "../utils/Json.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <ctime>
+#include <iomanip>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+
+#if defined(__x86_64__)
+#include <cpuid.h>
+#include <x86intrin.h>
+#endif
+
+namespace CCW::Tula {
+
+    static const char EventFileMagic[8] = {'T', 'U', 'L', 'A', 'E', 'V', 'T', '1'};
+
+    // Single producer (the owning thread), single consumer (stop(), under the registry lock).
+    struct EventBuffer {
+        std::atomic<uint64_t> head{0};
+        std::atomic<uint64_t> tail{0};
+        std::atomic<uint64_t> dropped{0};
+        std::atomic<bool> retired{false};
+        uint64_t droppedBefore = 0;     // consumer side: drops of earlier recordings
+        uint32_t thread = 0;
+        // Names of this thread's events, by id - 1; ids of the log's names are assigned when drained.
+        std::mutex namesMutex;
+        std::vector<std::string> names;
+        std::vector<uint32_t> logNames;     // consumer side: log id of names[i] once drained, 0 before
+        EventRecord records[EventRecorder::BufferCapacity];
+    };
+
+    struct EventRegistry {
+        std::mutex mutex;
+        std::vector<std::unique_ptr<EventBuffer>> buffers;
+        std::vector<std::vector<EventRecord>> flushed;  // from buffers that filled up during the recording
+        size_t flushedCount = 0;
+        uint64_t dropped = 0;
+        uint32_t nextThread = 1;
+        std::vector<std::string> names{""};
+        std::unordered_map<std::string, uint32_t> nameIds;
+        uint64_t startTicks = 0;
+        std::chrono::steady_clock::time_point startTime;
+    };
+
+    static EventRegistry &registry() {
+        // Never destroyed: threads may record while the process exits.
+        static auto *registry = new EventRegistry();
+        return *registry;
+    }
+
+    static bool hasInvariantTsc() {
+#if defined(__x86_64__)
+        unsigned eax, ebx, ecx, edx;
+        if (__get_cpuid(0x80000000, &eax, &ebx, &ecx, &edx) && eax >= 0x80000007) {
+            __get_cpuid(0x80000007, &eax, &ebx, &ecx, &edx);
+            return (edx & (1u << 8u)) != 0;
+        }
+#endif
+        return false;
+    }
+
+    static const bool gUseTsc = hasInvariantTsc();
+
+    // A plain pointer, so the hot path reads it without going through a TLS wrapper function.
+    static thread_local EventBuffer *tBuffer;
+
+    // Marks the thread's buffer retired when the thread exits; stop() frees it once drained.
+    struct EventBufferRetirer {
+        ~EventBufferRetirer() {
+            if (tBuffer != nullptr) {
+                tBuffer->retired.store(true, std::memory_order_release);
+            }
+        }
+    };
+
+    static thread_local EventBufferRetirer tBufferRetirer;
+
+    // The log's id of name `id` of the buffer; called under the registry lock.
+    static uint32_t logNameOf(EventRegistry &registry, EventBuffer &buffer, uint32_t id) {
+        std::lock_guard<std::mutex> _{buffer.namesMutex};
+        if (id == 0 || id > buffer.names.size()) {
+            return 0;
+        }
+        if (buffer.logNames.size() < buffer.names.size()) {
+            buffer.logNames.resize(buffer.names.size());
+        }
+        auto &logName = buffer.logNames[id - 1];
+        if (logName == 0) {
+            const auto &name = buffer.names[id - 1];
+            auto [it, inserted] = registry.nameIds.try_emplace(name, static_cast<uint32_t>(registry.names.size()));
+            if (inserted) {
+                registry.names.push_back(name);
+            }
+            logName = it->second;
+        }
+        return logName;
+    }
+
+    // Moves the buffer's events to a new chunk of the registry; called under its lock.
+    static void drain(EventRegistry &registry, EventBuffer &buffer) {
+        auto head = buffer.head.load(std::memory_order_acquire);
+        auto tail = buffer.tail.load(std::memory_order_relaxed);
+        std::vector<EventRecord> chunk;
+        chunk.reserve(head - tail);
+        for (auto i = tail; i < head; ++i) {
+            auto &record = buffer.records[i % EventRecorder::BufferCapacity];
+            // Events begun before start() belong to the previous recording.
+            if (record.start < registry.startTicks) {
+                continue;
+            }
+            if (registry.flushedCount + chunk.size() < EventRecorder::MaxEvents) {
+                chunk.push_back(record);
+                if (record.name != 0) {
+                    chunk.back().name = logNameOf(registry, buffer, record.name);
+                }
+            } else {
+                registry.dropped++;
+            }
+        }
+        buffer.tail.store(head, std::memory_order_release);
+        auto dropped = buffer.dropped.load(std::memory_order_relaxed);
+        registry.dropped += dropped - buffer.droppedBefore;
+        buffer.droppedBefore = dropped;
+        registry.flushedCount += chunk.size();
+        registry.flushed.push_back(std::move(chunk));
+    }
+
+    static EventBuffer *attachBuffer() {
+        auto &events = registry();
+        std::lock_guard<std::mutex> _{events.mutex};
+        events.buffers.push_back(std::make_unique<EventBuffer>());
+        tBuffer = events.buffers.back().get();
+        tBuffer->thread = events.nextThread++;
+        (void) &tBufferRetirer;     // constructs the retirer, whose destructor runs at thread exit
+        return tBuffer;
+    }
+
+    uint64_t EventRecorder::ticks() {
+#if defined(__x86_64__)
+        if (gUseTsc) {
+            return __rdtsc();
+        }
+#endif
+        timespec now{};
+        clock_gettime(CLOCK_MONOTONIC, &now);
+        return static_cast<uint64_t>(now.tv_sec) * 1000000000u + static_cast<uint64_t>(now.tv_nsec);
+    }
+
+    void EventRecorder::start() {
+        auto &events = registry();
+        std::lock_guard<std::mutex> _{events.mutex};
+        for (auto &buffer : events.buffers) {
+            buffer->tail.store(buffer->head.load(std::memory_order_acquire), std::memory_order_release);
+            buffer->droppedBefore = buffer->dropped.load(std::memory_order_relaxed);
+            std::lock_guard<std::mutex> namesLock{buffer->namesMutex};
+            buffer->names.clear();
+            buffer->logNames.clear();
+        }
+        events.flushed.clear();
+        events.flushedCount = 0;
+        events.dropped = 0;
+        events.names.assign(1, "");
+        events.nameIds.clear();
+        events.startTime = std::chrono::steady_clock::now();
+        events.startTicks = ticks();
+        enabled.store(true, std::memory_order_release);
+    }
+
+    EventLog EventRecorder::stop() {
+        enabled.store(false, std::memory_order_release);
+        auto &events = registry();
+        std::lock_guard<std::mutex> _{events.mutex};
+        EventLog log;
+        auto elapsedTicks = ticks() - events.startTicks;
+        auto elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - events.startTime).count();
+        if (gUseTsc && elapsed > 0 && elapsedTicks > 0) {
+            log.ticksPerSecond = static_cast<double>(elapsedTicks) / elapsed;
+        }
+        for (auto it = events.buffers.begin(); it != events.buffers.end();) {
+            auto retired = (*it)->retired.load(std::memory_order_acquire);
+            drain(events, **it);
+            it = retired ? events.buffers.erase(it) : std::next(it);
+        }
+        log.events.reserve(events.flushedCount);
+        for (const auto &chunk : events.flushed) {
+            log.events.insert(log.events.end(), chunk.begin(), chunk.end());
+        }
+        log.names = events.names;
+        log.dropped = events.dropped;
+        events.flushed.clear();
+        events.flushedCount = 0;
+        std::sort(log.events.begin(), log.events.end(), [](const EventRecord &a, const EventRecord &b) {
+            return a.start < b.start;
+        });
+        return log;
+    }
+
+    void EventRecorder::record(EventType type, uint64_t start, uint64_t value, uint32_t name) {
+        auto end = ticks();
+        auto buffer = tBuffer;
+        if (buffer == nullptr) {
+            buffer = attachBuffer();
+        }
+        auto head = buffer->head.load(std::memory_order_relaxed);
+        if (head - buffer->tail.load(std::memory_order_acquire) >= BufferCapacity) {
+            // Once per BufferCapacity events: hand the full buffer over, unless recording has stopped.
+            auto &events = registry();
+            std::lock_guard<std::mutex> _{events.mutex};
+            if (isEnabled()) {
+                drain(events, *buffer);
+            }
+            if (head - buffer->tail.load(std::memory_order_relaxed) >= BufferCapacity) {
+                buffer->dropped.store(buffer->dropped.load(std::memory_order_relaxed) + 1,
+                                      std::memory_order_relaxed);
+                return;
+            }
+        }
+        buffer->records[head % BufferCapacity] = EventRecord{start, end - start, value, type, 0, buffer->thread,
+                                                             name, 0};
+        buffer->head.store(head + 1, std::memory_order_release);
+    }
+
+    uint32_t EventRecorder::nameId(const std::string &name) {
+        auto buffer = tBuffer;
+        if (buffer == nullptr) {
+            buffer = attachBuffer();
+        }
+        std::lock_guard<std::mutex> _{buffer->namesMutex};
+        buffer->names.push_back(name);
+        return static_cast<uint32_t>(buffer->names.size());
+    }
+
+    template<typename T>
+    static void writeValue(std::ostream &out, T value) {
+        out.write(reinterpret_cast<const char *>(&value), sizeof(value));
+    }
+
+    template<typename T>
+    static T readValue(std::istream &in) {
+        T value{};
+        if (!in.read(reinterpret_cast<char *>(&value), sizeof(value))) {
+            throw Error("Truncated event file");
+        }
+        return value;
+    }
+
+    void EventLog::write(std::ostream &out) const {
+        out.write(EventFileMagic, sizeof(EventFileMagic));
+        writeValue<uint32_t>(out, sizeof(EventRecord));
+        writeValue<uint32_t>(out, static_cast<uint32_t>(names.size()));
+        writeValue<double>(out, ticksPerSecond);
+        writeValue<uint64_t>(out, dropped);
+        writeValue<uint64_t>(out, events.size());
+        for (const auto &name : names) {
+            writeValue<uint32_t>(out, static_cast<uint32_t>(name.size()));
+            out.write(name.data(), static_cast<std::streamsize>(name.size()));
+        }
+        out.write(reinterpret_cast<const char *>(events.data()),
+                  static_cast<std::streamsize>(events.size() * sizeof(EventRecord)));
+    }
+
+    EventLog EventLog::read(std::istream &in) {
+        char magic[sizeof(EventFileMagic)];
+        if (!in.read(magic, sizeof(magic)) || memcmp(magic, EventFileMagic, sizeof(magic)) != 0) {
+            throw Error("Not an event file");
+        }
+        if (readValue<uint32_t>(in) != sizeof(EventRecord)) {
+            throw Error("Unsupported event record size");
+        }
+        EventLog log;
+        auto nameCount = readValue<uint32_t>(in);
+        log.ticksPerSecond = readValue<double>(in);
+        log.dropped = readValue<uint64_t>(in);
+        auto eventCount = readValue<uint64_t>(in);
+        log.names.clear();
+        for (uint32_t i = 0; i < nameCount; ++i) {
+            std::string name(readValue<uint32_t>(in), '\0');
+            if (!in.read(name.data(), static_cast<std::streamsize>(name.size()))) {
+                throw Error("Truncated event file");
+            }
+            log.names.push_back(std::move(name));
+        }
+        for (uint64_t i = 0; i < eventCount; ++i) {
+            auto record = readValue<EventRecord>(in);
+            if (record.type >= EventType::Count || record.name >= log.names.size()) {
+                throw Error("Corrupt event record " + std::to_string(i));
+            }
+            log.events.push_back(record);
+        }
+        return log;
+    }
+
+    const char *EventLog::typeName(EventType type) {
+        static const char *const names[] = {
+#define TULA_EVENT_NAME(id, description) #id,
+            TULA_EVENTS(TULA_EVENT_NAME)
+#undef TULA_EVENT_NAME
+        };
+        return type < EventType::Count ? names[static_cast<size_t>(type)] : "Unknown";
+    }
+
+    void EventLog::writeChromeTrace(std::ostream &out) const {
+        auto origin = events.empty() ? 0 : events.front().start;
+        auto microsPerTick = 1e6 / ticksPerSecond;
+        out << std::fixed << std::setprecision(3) << "{\"displayTimeUnit\":\"ns\",\"traceEvents\":[";
+        for (size_t i = 0; i < events.size(); ++i) {
+            const auto &event = events[i];
+            out << (i == 0 ? "\n" : ",\n") << "{\"name\":\"" << typeName(event.type)
+                << "\",\"cat\":\"tula\",\"ph\":\"X\",\"pid\":1,\"tid\":" << event.thread
+                << ",\"ts\":" << static_cast<double>(event.start - origin) * microsPerTick
+                << ",\"dur\":" << static_cast<double>(event.duration) * microsPerTick
+                << ",\"args\":{\"value\":" << event.value;
+            if (event.name != 0) {
+                out << ",\"name\":";
+                writeJsonString(out, names[event.name]);
+            }
+            out << "}}";
+        }
+        out << "\n],\"otherData\":{\"dropped\":" << dropped << "}}\n";
+    }
+}
@@ -0,0 +1,141 @@
+#pragma once
+
+#include <CCW/Base.hpp>
+
+#include <atomic>
+#include <cstdint>
+#include <istream>
+#include <ostream>
+#include <string>
+#include <vector>
+
+namespace CCW::Tula {
+
+    // Recorded events: (id, what it measures).
+#define TULA_EVENTS(do_event)                                                   \
+    do_event(FileOpen, "stat and open of a class file")                          \
+    do_event(FileRead, "read of a class file")                                   \
+    do_event(DefineClass, "load, parse, verify and annotate one class")          \
+    do_event(ParseClass, "ClassFileParser::parse")                               \
+    do_event(ParseConstantPool, "constant pool, Utf8 interning included")        \
+    do_event(ParseFields, "fields and their attributes")                         \
+    do_event(ParseMethods, "methods, Code attributes included")                  \
+    do_event(ParseAttributes, "class attributes")                                \
+    do_event(Verify, "bytecode verification")                                    \
+    do_event(SymbolIntern, "new symbols of a constant pool, counted in value")   \
+    do_event(LinkClass, "vtable and itable layout")
+
+    enum class EventType : uint16_t {
+#define TULA_EVENT_ID(id, description) id,
+        TULA_EVENTS(TULA_EVENT_ID)
+#undef TULA_EVENT_ID
+        Count
+    };
+
+    // One fixed-size record; `name` is an index into the names of the log, 0 for none.
+    struct EventRecord {
+        uint64_t start;         // ticks
+        uint64_t duration;      // ticks
+        uint64_t value;         // event specific: a size, a count
+        EventType type;
+        uint16_t reserved;
+        uint32_t thread;
+        uint32_t name;
+        uint32_t padding;
+    };
+
+    static_assert(sizeof(EventRecord) == 40);
+
+    // Everything recorded between EventRecorder::start() and stop(), as written to an event file:
+    //
+    //   magic "TULAEVT1" | u32 record size | u32 name count | f64 ticks per second | u64 dropped
+    //   | u64 event count | names (u32 length, bytes) | records
+    //
+    // Integers are little-endian; records are sorted by start.
+    struct EventLog {
+        double ticksPerSecond = 1e9;
+        uint64_t dropped = 0;
+        std::vector<std::string> names{""};
+        std::vector<EventRecord> events;
+
+        void write(std::ostream &out) const;
+
+        // Throws Error when `in` is not an event file.
+        static EventLog read(std::istream &in);
+
+        // Converts to the Chrome trace event format (chrome://tracing, Perfetto) with one complete
+        // event per record.
+        void writeChromeTrace(std::ostream &out) const;
+
+        static const char *typeName(EventType type);
+    };
+
+    // A flight recorder for the class loading path. Every thread appends to a ring buffer of its own
+    // without locks or atomic read-modify-writes; a full buffer is handed over under a lock once every
+    // BufferCapacity events. Past MaxEvents per recording, events are dropped and counted.
+    // Timestamps are TSC ticks when the TSC is invariant, CLOCK_MONOTONIC nanoseconds otherwise.
+    //
+    // While disabled, an EventScope costs one relaxed load.
+    class EventRecorder {
+    public:
+        static constexpr size_t BufferCapacity = 4096;
+        static constexpr size_t MaxEvents = size_t(1) << 22u;
+
+        [[nodiscard]] static inline bool isEnabled() {
+            return enabled.load(std::memory_order_relaxed);
+        }
+
+        // Discards what was recorded before and starts recording.
+        static void start();
+
+        // Stops recording and returns the events of all threads.
+        static EventLog stop();
+
+        static uint64_t ticks();
+
+        static void record(EventType type, uint64_t start, uint64_t value = 0, uint32_t name = 0);
+
+        // An id for `name` in the calling thread's events. Names are kept per thread, under a lock only
+        // stop() contends for, and only get their index in the log's names when the events are drained.
+        static uint32_t nameId(const std::string &name);
+
+    private:
+        static inline std::atomic<bool> enabled{false};
+    };
+
+    // Records the lifetime of the scope as one event, if the recorder was enabled when it began.
+    class EventScope : public Noncopyable {
+    public:
+        explicit EventScope(EventType type) : type(type) {
+            if (EventRecorder::isEnabled()) {
+                start = EventRecorder::ticks();
+                active = true;
+            }
+        }
+
+        // The name is only computed when recording.
+        template<typename NameFunction>
+        EventScope(EventType type, NameFunction &&name) : EventScope(type) {
+            if (active) {
+                nameId = EventRecorder::nameId(name());
+            }
+        }
+
+        inline void setValue(uint64_t eventValue) {
+            value = eventValue;
+        }
+
+        ~EventScope() {
+            if (active) {
+                EventRecorder::record(type, start, value, nameId);
+            }
+        }
+
+    private:
+        EventType type;
+        bool active = false;
+        uint32_t nameId = 0;
+        uint64_t start = 0;
+        uint64_t value = 0;
+    };
+}
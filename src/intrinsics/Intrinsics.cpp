@@ -0,0 +1,61 @@
+#include "Intrinsics.hpp"
+#include "../Klass.hpp"
+#include "../SymbolTable.hpp"
+
+namespace CCW::Tula {
+
+    struct IntrinsicSpec {
+        IntrinsicId id;
+        const char *klass;
+        const char *name;
+        const char *descriptor;
+    };
+
+    static const IntrinsicSpec IntrinsicSpecs[] = {
+#define TULA_INTRINSIC_SPEC(id, klass, name, descriptor) {IntrinsicId::id, klass, name, descriptor},
+        TULA_INTRINSICS(TULA_INTRINSIC_SPEC)
+#undef TULA_INTRINSIC_SPEC
+    };
+
+    IntrinsicRegistry::IntrinsicRegistry() {
+        for (const auto &spec : IntrinsicSpecs) {
+            auto klass = SymbolTable::intern(spec.klass);
+            auto name = SymbolTable::intern(spec.name);
+            auto descriptor = SymbolTable::intern(spec.descriptor);
+            intrinsics.emplace(Key{klass.get(), name.get(), descriptor.get()}, spec.id);
+            symbols.push_back(std::move(klass));
+            symbols.push_back(std::move(name));
+            symbols.push_back(std::move(descriptor));
+        }
+    }
+
+    IntrinsicId IntrinsicRegistry::lookup(const Symbol *klass, const Symbol *name, const Symbol *descriptor) const {
+        auto it = intrinsics.find(Key{klass, name, descriptor});
+        return it == intrinsics.end() ? IntrinsicId::None : it->second;
+    }
+
+    size_t IntrinsicRegistry::annotate(InstanceKlass &klass) const {
+        size_t count = 0;
+        for (const auto &method : klass.getMethods()) {
+            auto id = lookup(klass.getName().get(), method->name().get(), method->descriptor().get());
+            if (id != IntrinsicId::None) {
+                method->setIntrinsicId(id);
+                count++;
+            }
+        }
+        return count;
+    }
+
+    const char *IntrinsicRegistry::nameOf(IntrinsicId id) {
+        switch (id) {
+            case IntrinsicId::None:
+                return "None";
+#define TULA_INTRINSIC_NAME(id, klass, name, descriptor) case IntrinsicId::id: return #id;
+            TULA_INTRINSICS(TULA_INTRINSIC_NAME)
+#undef TULA_INTRINSIC_NAME
+            case IntrinsicId::Count:
+                break;
+        }
+        UNREACHABLE();
+    }
+}
@@ -0,0 +1,86 @@
+#pragma once
+
+#include "../Symbol.hpp"
+
+#include <CCW/Base.hpp>
+
+#include <map>
+#include <tuple>
+#include <vector>
+
+namespace CCW::Tula {
+
+    class InstanceKlass;
+
+    // JDK methods replaced by native kernels (see Kernels.hpp): (id, class, name, descriptor).
+    //
+    // Arrays.equals of float[] and double[] compares with floatToIntBits, which folds every NaN into one,
+    // so only the integral overloads are listed; raw byte comparison is exact for those.
+#define TULA_INTRINSICS(do_intrinsic)                                                                       \
+    do_intrinsic(SystemArraycopy, "java/lang/System", "arraycopy", "(Ljava/lang/Object;ILjava/lang/Object;II)V") \
+    do_intrinsic(ArraysFillBoolean, "java/util/Arrays", "fill", "([ZZ)V")                                    \
+    do_intrinsic(ArraysFillByte, "java/util/Arrays", "fill", "([BB)V")                                       \
+    do_intrinsic(ArraysFillChar, "java/util/Arrays", "fill", "([CC)V")                                       \
+    do_intrinsic(ArraysFillShort, "java/util/Arrays", "fill", "([SS)V")                                      \
+    do_intrinsic(ArraysFillInt, "java/util/Arrays", "fill", "([II)V")                                        \
+    do_intrinsic(ArraysFillLong, "java/util/Arrays", "fill", "([JJ)V")                                       \
+    do_intrinsic(ArraysFillFloat, "java/util/Arrays", "fill", "([FF)V")                                      \
+    do_intrinsic(ArraysFillDouble, "java/util/Arrays", "fill", "([DD)V")                                     \
+    do_intrinsic(ArraysEqualsBoolean, "java/util/Arrays", "equals", "([Z[Z)Z")                               \
+    do_intrinsic(ArraysEqualsByte, "java/util/Arrays", "equals", "([B[B)Z")                                  \
+    do_intrinsic(ArraysEqualsChar, "java/util/Arrays", "equals", "([C[C)Z")                                  \
+    do_intrinsic(ArraysEqualsShort, "java/util/Arrays", "equals", "([S[S)Z")                                 \
+    do_intrinsic(ArraysEqualsInt, "java/util/Arrays", "equals", "([I[I)Z")                                   \
+    do_intrinsic(ArraysEqualsLong, "java/util/Arrays", "equals", "([J[J)Z")                                  \
+    do_intrinsic(StringEquals, "java/lang/String", "equals", "(Ljava/lang/Object;)Z")                        \
+    do_intrinsic(StringHashCode, "java/lang/String", "hashCode", "()I")                                      \
+    do_intrinsic(StringIndexOfChar, "java/lang/String", "indexOf", "(I)I")                                   \
+    do_intrinsic(StringIndexOfString, "java/lang/String", "indexOf", "(Ljava/lang/String;)I")                \
+    do_intrinsic(MathAbsInt, "java/lang/Math", "abs", "(I)I")                                                \
+    do_intrinsic(MathAbsLong, "java/lang/Math", "abs", "(J)J")                                               \
+    do_intrinsic(MathAbsFloat, "java/lang/Math", "abs", "(F)F")                                              \
+    do_intrinsic(MathAbsDouble, "java/lang/Math", "abs", "(D)D")                                             \
+    do_intrinsic(MathMinInt, "java/lang/Math", "min", "(II)I")                                               \
+    do_intrinsic(MathMinLong, "java/lang/Math", "min", "(JJ)J")                                              \
+    do_intrinsic(MathMinFloat, "java/lang/Math", "min", "(FF)F")                                             \
+    do_intrinsic(MathMinDouble, "java/lang/Math", "min", "(DD)D")                                            \
+    do_intrinsic(MathMaxInt, "java/lang/Math", "max", "(II)I")                                               \
+    do_intrinsic(MathMaxLong, "java/lang/Math", "max", "(JJ)J")                                              \
+    do_intrinsic(MathMaxFloat, "java/lang/Math", "max", "(FF)F")                                             \
+    do_intrinsic(MathMaxDouble, "java/lang/Math", "max", "(DD)D")                                            \
+    do_intrinsic(MathSqrt, "java/lang/Math", "sqrt", "(D)D")                                                 \
+    do_intrinsic(StrictMathSqrt, "java/lang/StrictMath", "sqrt", "(D)D")                                     \
+    do_intrinsic(MathFloor, "java/lang/Math", "floor", "(D)D")                                               \
+    do_intrinsic(MathCeil, "java/lang/Math", "ceil", "(D)D")                                                 \
+    do_intrinsic(MathFma, "java/lang/Math", "fma", "(DDD)D")
+
+    enum class IntrinsicId : uint16_t {
+        None,
+#define TULA_INTRINSIC_ID(id, klass, name, descriptor) id,
+        TULA_INTRINSICS(TULA_INTRINSIC_ID)
+#undef TULA_INTRINSIC_ID
+        Count
+    };
+
+    // Maps (class, name, descriptor) to the intrinsic that replaces the method. Keys are interned
+    // symbols, so a lookup compares three pointers. Built once per loader; needs the SymbolTable.
+    class IntrinsicRegistry : public Noncopyable {
+    public:
+        IntrinsicRegistry();
+
+        [[nodiscard]] IntrinsicId lookup(const Symbol *klass, const Symbol *name, const Symbol *descriptor) const;
+
+        // Tags the methods of `klass` that have an intrinsic, for the interpreter and JIT to pick up.
+        // Returns how many were tagged.
+        size_t annotate(InstanceKlass &klass) const;
+
+        [[nodiscard]] static const char *nameOf(IntrinsicId id);
+
+    private:
+        using Key = std::tuple<const Symbol *, const Symbol *, const Symbol *>;
+
+        // Holds the interned symbols alive for the lifetime of the keys.
+        std::vector<SymbolPtr> symbols;
+        std::map<Key, IntrinsicId> intrinsics;
+    };
+}
@@ -0,0 +1,120 @@
+#include "Kernels.hpp"
+
+#include <algorithm>
+
+namespace CCW::Tula {
+
+    template<typename T>
+    static void fillScalar(T *dst, size_t count, T value) {
+        std::fill(dst, dst + count, value);
+    }
+
+    static bool equalsScalar(const void *a, const void *b, size_t bytes) {
+        return bytes == 0 || memcmp(a, b, bytes) == 0;
+    }
+
+    // h = 31 * h + c, four chars a step: h * 31^4 + c0 * 31^3 + c1 * 31^2 + c2 * 31 + c3.
+    template<typename Char>
+    static jint hashScalar(const Char *chars, size_t count) {
+        uint32_t h = 0;
+        size_t i = 0;
+        for (; i + 4 <= count; i += 4) {
+            h = h * (31u * 31 * 31 * 31) + chars[i] * (31u * 31 * 31) + chars[i + 1] * (31u * 31)
+                + chars[i + 2] * 31u + chars[i + 3];
+        }
+        for (; i < count; ++i) {
+            h = 31 * h + chars[i];
+        }
+        return static_cast<jint>(h);
+    }
+
+    template<typename Char>
+    static int64_t indexOfScalar(const Char *chars, size_t count, Char c) {
+        auto found = std::find(chars, chars + count, c);
+        return found == chars + count ? -1 : found - chars;
+    }
+
+    static const KernelTable ScalarKernels = {
+        SimdLevel::Scalar,
+        fillScalar<uint8_t>,
+        fillScalar<uint16_t>,
+        fillScalar<uint32_t>,
+        fillScalar<uint64_t>,
+        equalsScalar,
+        hashScalar<uint8_t>,
+        hashScalar<jchar>,
+        indexOfScalar<uint8_t>,
+        indexOfScalar<jchar>,
+    };
+
+    const KernelTable &Kernels::scalar() {
+        return ScalarKernels;
+    }
+
+    SimdLevel Kernels::detectLevel() {
+#if defined(__x86_64__)
+        __builtin_cpu_init();
+        if (__builtin_cpu_supports("avx2")) {
+            return SimdLevel::AVX2;
+        }
+        return SimdLevel::SSE2;
+#else
+        return SimdLevel::Scalar;
+#endif
+    }
+
+    const KernelTable *Kernels::forLevel(SimdLevel level) {
+        if (level > detectLevel()) {
+            return nullptr;
+        }
+        switch (level) {
+            case SimdLevel::Scalar:
+                return &ScalarKernels;
+            case SimdLevel::SSE2:
+                return sse2();
+            case SimdLevel::AVX2:
+                return avx2();
+        }
+        UNREACHABLE();
+    }
+
+    const KernelTable &Kernels::get() {
+        static const KernelTable *best = [] {
+            auto table = forLevel(detectLevel());
+            return table != nullptr ? table : &ScalarKernels;
+        }();
+        return *best;
+    }
+
+    template<typename Char>
+    static int64_t indexOfString(const Char *chars, size_t count, const Char *needle, size_t needleCount,
+                                 int64_t (*indexOfChar)(const Char *, size_t, Char)) {
+        if (needleCount == 0) {
+            return 0;
+        }
+        if (needleCount > count) {
+            return -1;
+        }
+        size_t last = count - needleCount;
+        for (size_t from = 0; from <= last;) {
+            auto found = indexOfChar(chars + from, last - from + 1, needle[0]);
+            if (found < 0) {
+                return -1;
+            }
+            from += found;
+            if (memcmp(chars + from + 1, needle + 1, (needleCount - 1) * sizeof(Char)) == 0) {
+                return static_cast<int64_t>(from);
+            }
+            from++;
+        }
+        return -1;
+    }
+
+    int64_t Kernels::indexOfLatin1(const uint8_t *chars, size_t count, const uint8_t *needle, size_t needleCount) {
+        return indexOfString(chars, count, needle, needleCount, get().indexOfLatin1);
+    }
+
+    int64_t Kernels::indexOfUtf16(const jchar *chars, size_t count, const jchar *needle, size_t needleCount) {
+        return indexOfString(chars, count, needle, needleCount, get().indexOfUtf16);
+    }
+}
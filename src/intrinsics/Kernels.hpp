@@ -0,0 +1,153 @@
+#pragma once
+
+#include "../JVM.hpp"
+
+#include <CCW/Base.hpp>
+
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+
+namespace CCW::Tula {
+
+    enum class SimdLevel : uint8_t {
+        Scalar,
+        SSE2,
+        AVX2
+    };
+
+    // Native implementations of the intrinsified JDK methods on raw array contents. Each level has its
+    // own table; every table gives bit-for-bit the results of the Java code it replaces.
+    struct KernelTable {
+        SimdLevel level;
+
+        // Arrays.fill on elements of 1, 2, 4 and 8 bytes.
+        void (*fill8)(uint8_t *dst, size_t count, uint8_t value);
+        void (*fill16)(uint16_t *dst, size_t count, uint16_t value);
+        void (*fill32)(uint32_t *dst, size_t count, uint32_t value);
+        void (*fill64)(uint64_t *dst, size_t count, uint64_t value);
+
+        // Arrays.equals of integral arrays and String.equals, on the raw bytes.
+        bool (*equals)(const void *a, const void *b, size_t bytes);
+
+        // String.hashCode of Latin-1 and UTF-16 contents.
+        jint (*hashLatin1)(const uint8_t *chars, size_t count);
+        jint (*hashUtf16)(const jchar *chars, size_t count);
+
+        // String.indexOf(char) from index 0; -1 when absent.
+        int64_t (*indexOfLatin1)(const uint8_t *chars, size_t count, uint8_t c);
+        int64_t (*indexOfUtf16)(const jchar *chars, size_t count, jchar c);
+    };
+
+    class Kernels {
+    public:
+        // The best table the CPU supports, chosen once.
+        static const KernelTable &get();
+
+        // The table of `level`, or null when this build or CPU lacks it.
+        static const KernelTable *forLevel(SimdLevel level);
+
+        [[nodiscard]] static SimdLevel detectLevel();
+
+        // System.arraycopy after its checks: overlapping ranges behave as if copied through a temporary.
+        // libc's memmove is already vectorized for every width, so there is no table entry for it.
+        static inline void arraycopy(const void *src, void *dst, size_t bytes) {
+            memmove(dst, src, bytes);
+        }
+
+        // String.indexOf(String) on Latin-1 contents: first-char scan through the table, then a compare.
+        static int64_t indexOfLatin1(const uint8_t *chars, size_t count, const uint8_t *needle, size_t needleCount);
+
+        static int64_t indexOfUtf16(const jchar *chars, size_t count, const jchar *needle, size_t needleCount);
+
+        static const KernelTable &scalar();
+
+        // Defined in KernelsX86.cpp; null on other architectures.
+        static const KernelTable *sse2();
+
+        static const KernelTable *avx2();
+    };
+
+    // java.lang.Math with Java semantics where they differ from <cmath>: NaN propagation and -0.0 < +0.0
+    // in min/max, and abs clearing the sign bit of NaN and zeros too.
+    namespace JavaMath {
+
+        template<typename T, typename Bits>
+        inline Bits bitsOf(T value) {
+            Bits bits;
+            memcpy(&bits, &value, sizeof(bits));
+            return bits;
+        }
+
+        template<typename T, typename Bits>
+        inline T fromBits(Bits bits) {
+            T value;
+            memcpy(&value, &bits, sizeof(value));
+            return value;
+        }
+
+        inline jdouble abs(jdouble a) {
+            return fromBits<jdouble>(bitsOf<jdouble, uint64_t>(a) & 0x7FFFFFFFFFFFFFFFull);
+        }
+
+        inline jfloat abs(jfloat a) {
+            return fromBits<jfloat>(bitsOf<jfloat, uint32_t>(a) & 0x7FFFFFFFu);
+        }
+
+        template<typename T, typename Bits>
+        inline T min(T a, T b) {
+            if (a != a) {
+                return a;
+            }
+            if (a == 0 && b == 0 && bitsOf<T, Bits>(b) >> (sizeof(Bits) * 8 - 1)) {
+                return b;
+            }
+            return a <= b ? a : b;
+        }
+
+        template<typename T, typename Bits>
+        inline T max(T a, T b) {
+            if (a != a) {
+                return a;
+            }
+            if (a == 0 && b == 0 && bitsOf<T, Bits>(a) >> (sizeof(Bits) * 8 - 1)) {
+                return b;
+            }
+            return a >= b ? a : b;
+        }
+
+        inline jdouble min(jdouble a, jdouble b) {
+            return min<jdouble, uint64_t>(a, b);
+        }
+
+        inline jfloat min(jfloat a, jfloat b) {
+            return min<jfloat, uint32_t>(a, b);
+        }
+
+        inline jdouble max(jdouble a, jdouble b) {
+            return max<jdouble, uint64_t>(a, b);
+        }
+
+        inline jfloat max(jfloat a, jfloat b) {
+            return max<jfloat, uint32_t>(a, b);
+        }
+
+        // IEEE 754 square root, correctly rounded on every platform we build for.
+        inline jdouble sqrt(jdouble a) {
+            return std::sqrt(a);
+        }
+
+        inline jdouble floor(jdouble a) {
+            return std::floor(a);
+        }
+
+        inline jdouble ceil(jdouble a) {
+            return std::ceil(a);
+        }
+
+        inline jdouble fma(jdouble a, jdouble b, jdouble c) {
+            return std::fma(a, b, c);
+        }
+    }
+}
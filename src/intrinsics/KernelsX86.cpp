@@ -0,0 +1,280 @@
+#include "Kernels.hpp"
+
+#if defined(__x86_64__)
+
+#include <immintrin.h>
+
+// SSE2 is part of x86-64, so its kernels need no target attribute. AVX2 kernels are compiled for AVX2
+// individually and only reached through the table once the CPU reports support.
+#define TULA_AVX2 __attribute__((target("avx2")))
+
+namespace CCW::Tula {
+
+    // Powers of 31 as wrapping 32-bit ints, for the hash recurrence.
+    static constexpr uint32_t pow31(unsigned n) {
+        return n == 0 ? 1 : 31 * pow31(n - 1);
+    }
+
+    // SSE2
+
+    static void fillBytesSSE2(uint8_t *dst, size_t bytes, __m128i pattern) {
+        size_t i = 0;
+        for (; i + 16 <= bytes; i += 16) {
+            _mm_storeu_si128(reinterpret_cast<__m128i *>(dst + i), pattern);
+        }
+        // The remainder is under 16 bytes; `pattern` starts on an element boundary, so copy its prefix.
+        alignas(16) uint8_t tail[16];
+        _mm_store_si128(reinterpret_cast<__m128i *>(tail), pattern);
+        if (i < bytes) {
+            memcpy(dst + i, tail, bytes - i);
+        }
+    }
+
+    static void fill8SSE2(uint8_t *dst, size_t count, uint8_t value) {
+        fillBytesSSE2(dst, count, _mm_set1_epi8(static_cast<char>(value)));
+    }
+
+    static void fill16SSE2(uint16_t *dst, size_t count, uint16_t value) {
+        fillBytesSSE2(reinterpret_cast<uint8_t *>(dst), count * 2, _mm_set1_epi16(static_cast<short>(value)));
+    }
+
+    static void fill32SSE2(uint32_t *dst, size_t count, uint32_t value) {
+        fillBytesSSE2(reinterpret_cast<uint8_t *>(dst), count * 4, _mm_set1_epi32(static_cast<int>(value)));
+    }
+
+    static void fill64SSE2(uint64_t *dst, size_t count, uint64_t value) {
+        fillBytesSSE2(reinterpret_cast<uint8_t *>(dst), count * 8, _mm_set1_epi64x(static_cast<long long>(value)));
+    }
+
+    static bool equalsSSE2(const void *a, const void *b, size_t bytes) {
+        auto lhs = static_cast<const uint8_t *>(a);
+        auto rhs = static_cast<const uint8_t *>(b);
+        size_t i = 0;
+        for (; i + 16 <= bytes; i += 16) {
+            auto x = _mm_loadu_si128(reinterpret_cast<const __m128i *>(lhs + i));
+            auto y = _mm_loadu_si128(reinterpret_cast<const __m128i *>(rhs + i));
+            if (_mm_movemask_epi8(_mm_cmpeq_epi8(x, y)) != 0xFFFF) {
+                return false;
+            }
+        }
+        return i == bytes || memcmp(lhs + i, rhs + i, bytes - i) == 0;
+    }
+
+    // SSE2 lacks a 32-bit multiply, which the hash recurrence needs per lane; unroll it instead.
+    template<typename Char>
+    static jint hashSSE2(const Char *chars, size_t count) {
+        uint32_t h = 0;
+        size_t i = 0;
+        for (; i + 8 <= count; i += 8) {
+            h = h * pow31(8) + chars[i] * pow31(7) + chars[i + 1] * pow31(6) + chars[i + 2] * pow31(5)
+                + chars[i + 3] * pow31(4) + chars[i + 4] * pow31(3) + chars[i + 5] * pow31(2)
+                + chars[i + 6] * pow31(1) + chars[i + 7];
+        }
+        for (; i < count; ++i) {
+            h = 31 * h + chars[i];
+        }
+        return static_cast<jint>(h);
+    }
+
+    static int64_t indexOfLatin1SSE2(const uint8_t *chars, size_t count, uint8_t c) {
+        auto needle = _mm_set1_epi8(static_cast<char>(c));
+        size_t i = 0;
+        for (; i + 16 <= count; i += 16) {
+            auto block = _mm_loadu_si128(reinterpret_cast<const __m128i *>(chars + i));
+            auto mask = static_cast<unsigned>(_mm_movemask_epi8(_mm_cmpeq_epi8(block, needle)));
+            if (mask != 0) {
+                return static_cast<int64_t>(i + __builtin_ctz(mask));
+            }
+        }
+        for (; i < count; ++i) {
+            if (chars[i] == c) {
+                return static_cast<int64_t>(i);
+            }
+        }
+        return -1;
+    }
+
+    static int64_t indexOfUtf16SSE2(const jchar *chars, size_t count, jchar c) {
+        auto needle = _mm_set1_epi16(static_cast<short>(c));
+        size_t i = 0;
+        for (; i + 8 <= count; i += 8) {
+            auto block = _mm_loadu_si128(reinterpret_cast<const __m128i *>(chars + i));
+            auto mask = static_cast<unsigned>(_mm_movemask_epi8(_mm_cmpeq_epi16(block, needle)));
+            if (mask != 0) {
+                return static_cast<int64_t>(i + __builtin_ctz(mask) / 2);
+            }
+        }
+        for (; i < count; ++i) {
+            if (chars[i] == c) {
+                return static_cast<int64_t>(i);
+            }
+        }
+        return -1;
+    }
+
+    static const KernelTable SSE2Kernels = {
+        SimdLevel::SSE2,
+        fill8SSE2,
+        fill16SSE2,
+        fill32SSE2,
+        fill64SSE2,
+        equalsSSE2,
+        hashSSE2<uint8_t>,
+        hashSSE2<jchar>,
+        indexOfLatin1SSE2,
+        indexOfUtf16SSE2,
+    };
+
+    // AVX2
+
+    TULA_AVX2 static void fillBytesAVX2(uint8_t *dst, size_t bytes, __m256i pattern) {
+        size_t i = 0;
+        for (; i + 32 <= bytes; i += 32) {
+            _mm256_storeu_si256(reinterpret_cast<__m256i *>(dst + i), pattern);
+        }
+        alignas(32) uint8_t tail[32];
+        _mm256_store_si256(reinterpret_cast<__m256i *>(tail), pattern);
+        if (i < bytes) {
+            memcpy(dst + i, tail, bytes - i);
+        }
+    }
+
+    TULA_AVX2 static void fill8AVX2(uint8_t *dst, size_t count, uint8_t value) {
+        fillBytesAVX2(dst, count, _mm256_set1_epi8(static_cast<char>(value)));
+    }
+
+    TULA_AVX2 static void fill16AVX2(uint16_t *dst, size_t count, uint16_t value) {
+        fillBytesAVX2(reinterpret_cast<uint8_t *>(dst), count * 2, _mm256_set1_epi16(static_cast<short>(value)));
+    }
+
+    TULA_AVX2 static void fill32AVX2(uint32_t *dst, size_t count, uint32_t value) {
+        fillBytesAVX2(reinterpret_cast<uint8_t *>(dst), count * 4, _mm256_set1_epi32(static_cast<int>(value)));
+    }
+
+    TULA_AVX2 static void fill64AVX2(uint64_t *dst, size_t count, uint64_t value) {
+        fillBytesAVX2(reinterpret_cast<uint8_t *>(dst), count * 8,
+                      _mm256_set1_epi64x(static_cast<long long>(value)));
+    }
+
+    TULA_AVX2 static bool equalsAVX2(const void *a, const void *b, size_t bytes) {
+        auto lhs = static_cast<const uint8_t *>(a);
+        auto rhs = static_cast<const uint8_t *>(b);
+        size_t i = 0;
+        for (; i + 32 <= bytes; i += 32) {
+            auto x = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(lhs + i));
+            auto y = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(rhs + i));
+            if (static_cast<uint32_t>(_mm256_movemask_epi8(_mm256_cmpeq_epi8(x, y))) != 0xFFFFFFFFu) {
+                return false;
+            }
+        }
+        return equalsSSE2(lhs + i, rhs + i, bytes - i);
+    }
+
+    // Eight independent lanes, each running h = h * 31^8 + c over every eighth char. Lane k then
+    // weighs 31^(7-k) in the final sum, which equals the serial recurrence modulo 2^32.
+    TULA_AVX2 static uint32_t hashLanesAVX2(__m256i lanes) {
+        const auto weights = _mm256_setr_epi32(
+            static_cast<int>(pow31(7)), static_cast<int>(pow31(6)), static_cast<int>(pow31(5)),
+            static_cast<int>(pow31(4)), static_cast<int>(pow31(3)), static_cast<int>(pow31(2)),
+            static_cast<int>(pow31(1)), static_cast<int>(pow31(0)));
+        auto weighted = _mm256_mullo_epi32(lanes, weights);
+        auto sum = _mm_add_epi32(_mm256_castsi256_si128(weighted), _mm256_extracti128_si256(weighted, 1));
+        sum = _mm_add_epi32(sum, _mm_shuffle_epi32(sum, _MM_SHUFFLE(1, 0, 3, 2)));
+        sum = _mm_add_epi32(sum, _mm_shuffle_epi32(sum, _MM_SHUFFLE(2, 3, 0, 1)));
+        return static_cast<uint32_t>(_mm_cvtsi128_si32(sum));
+    }
+
+    TULA_AVX2 static jint hashLatin1AVX2(const uint8_t *chars, size_t count) {
+        const auto p8 = _mm256_set1_epi32(static_cast<int>(pow31(8)));
+        auto lanes = _mm256_setzero_si256();
+        size_t i = 0;
+        for (; i + 8 <= count; i += 8) {
+            auto block = _mm_loadl_epi64(reinterpret_cast<const __m128i *>(chars + i));
+            lanes = _mm256_add_epi32(_mm256_mullo_epi32(lanes, p8), _mm256_cvtepu8_epi32(block));
+        }
+        uint32_t h = hashLanesAVX2(lanes);
+        for (; i < count; ++i) {
+            h = 31 * h + chars[i];
+        }
+        return static_cast<jint>(h);
+    }
+
+    TULA_AVX2 static jint hashUtf16AVX2(const jchar *chars, size_t count) {
+        const auto p8 = _mm256_set1_epi32(static_cast<int>(pow31(8)));
+        auto lanes = _mm256_setzero_si256();
+        size_t i = 0;
+        for (; i + 8 <= count; i += 8) {
+            auto block = _mm_loadu_si128(reinterpret_cast<const __m128i *>(chars + i));
+            lanes = _mm256_add_epi32(_mm256_mullo_epi32(lanes, p8), _mm256_cvtepu16_epi32(block));
+        }
+        uint32_t h = hashLanesAVX2(lanes);
+        for (; i < count; ++i) {
+            h = 31 * h + chars[i];
+        }
+        return static_cast<jint>(h);
+    }
+
+    TULA_AVX2 static int64_t indexOfLatin1AVX2(const uint8_t *chars, size_t count, uint8_t c) {
+        auto needle = _mm256_set1_epi8(static_cast<char>(c));
+        size_t i = 0;
+        for (; i + 32 <= count; i += 32) {
+            auto block = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(chars + i));
+            auto mask = static_cast<uint32_t>(_mm256_movemask_epi8(_mm256_cmpeq_epi8(block, needle)));
+            if (mask != 0) {
+                return static_cast<int64_t>(i + __builtin_ctz(mask));
+            }
+        }
+        auto found = indexOfLatin1SSE2(chars + i, count - i, c);
+        return found < 0 ? -1 : static_cast<int64_t>(i) + found;
+    }
+
+    TULA_AVX2 static int64_t indexOfUtf16AVX2(const jchar *chars, size_t count, jchar c) {
+        auto needle = _mm256_set1_epi16(static_cast<short>(c));
+        size_t i = 0;
+        for (; i + 16 <= count; i += 16) {
+            auto block = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(chars + i));
+            auto mask = static_cast<uint32_t>(_mm256_movemask_epi8(_mm256_cmpeq_epi16(block, needle)));
+            if (mask != 0) {
+                return static_cast<int64_t>(i + __builtin_ctz(mask) / 2);
+            }
+        }
+        auto found = indexOfUtf16SSE2(chars + i, count - i, c);
+        return found < 0 ? -1 : static_cast<int64_t>(i) + found;
+    }
+
+    static const KernelTable AVX2Kernels = {
+        SimdLevel::AVX2,
+        fill8AVX2,
+        fill16AVX2,
+        fill32AVX2,
+        fill64AVX2,
+        equalsAVX2,
+        hashLatin1AVX2,
+        hashUtf16AVX2,
+        indexOfLatin1AVX2,
+        indexOfUtf16AVX2,
+    };
+
+    const KernelTable *Kernels::sse2() {
+        return &SSE2Kernels;
+    }
+
+    const KernelTable *Kernels::avx2() {
+        return &AVX2Kernels;
+    }
+}
+
+#else
+
+namespace CCW::Tula {
+
+    const KernelTable *Kernels::sse2() {
+        return nullptr;
+    }
+
+    const KernelTable *Kernels::avx2() {
+        return nullptr;
+    }
+}
+
+#endif
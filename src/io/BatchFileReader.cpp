@@ -0,0 +1,357 @@
+#include "BatchFileReader.hpp"
+#include "../Error.hpp"
+#include "../utils/ThreadPool.hpp"
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <fcntl.h>
+#include <initializer_list>
+#include <linux/io_uring.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+namespace CCW::Tula {
+
+    void BatchFileReader::readFile(const std::string &path, FileRead &read) {
+        int fd = open(path.c_str(), O_RDONLY | O_CLOEXEC);
+        if (fd < 0) {
+            read.error = errno;
+            return;
+        }
+        if (!ClassFileStamp::ofDescriptor(fd, read.stamp)) {
+            read.error = errno;
+            close(fd);
+            return;
+        }
+        auto size = static_cast<size_t>(read.stamp.size);
+        read.data.reset(new uint8_t[size]);
+        size_t offset = 0;
+        while (offset < size) {
+            auto n = pread(fd, read.data.get() + offset, size - offset, static_cast<off_t>(offset));
+            if (n < 0 && errno == EINTR) {
+                continue;
+            }
+            if (n < 0) {
+                read.error = errno;
+                read.data.reset();
+                offset = 0;
+                break;
+            }
+            if (n == 0) {
+                break;  // the file shrank
+            }
+            offset += static_cast<size_t>(n);
+        }
+        read.size = offset;
+        close(fd);
+    }
+
+    // The fallback: blocking opens and reads on a thread per read in flight.
+    class ThreadFileReader : public BatchFileReader {
+    public:
+        // The calling thread reads too.
+        explicit ThreadFileReader(size_t depth) : pool(std::max<size_t>(1, depth - 1)) {
+        }
+
+        void readAll(const std::vector<std::string> &paths, const Callback &onRead) override {
+            pool.parallelFor(paths.size(), [&](size_t i) {
+                if (isCancelled()) {
+                    return;
+                }
+                FileRead read;
+                read.index = i;
+                readFile(paths[i], read);
+                onRead(std::move(read));
+            });
+        }
+
+        [[nodiscard]] Backend getBackend() const override {
+            return Backend::Threads;
+        }
+
+    private:
+        ThreadPool pool;
+    };
+
+    // glibc has no wrappers for the io_uring system calls.
+    static int ioUringSetup(unsigned entries, io_uring_params *params) {
+        return static_cast<int>(syscall(__NR_io_uring_setup, entries, params));
+    }
+
+    static int ioUringEnter(int fd, unsigned submit, unsigned minComplete, unsigned flags) {
+        return static_cast<int>(syscall(__NR_io_uring_enter, fd, submit, minComplete, flags, nullptr, 0));
+    }
+
+    static int ioUringRegister(int fd, unsigned opcode, void *arg, unsigned args) {
+        return static_cast<int>(syscall(__NR_io_uring_register, fd, opcode, arg, args));
+    }
+
+    // A submission and a completion queue shared with the kernel. Used by one thread at a time.
+    class IoUring : public Noncopyable {
+    public:
+        // Null when the kernel has no io_uring, forbids it, or lacks the operations used here.
+        static std::unique_ptr<IoUring> open(unsigned entries) {
+            io_uring_params params{};
+            int fd = ioUringSetup(entries, &params);
+            if (fd < 0) {
+                return nullptr;
+            }
+            std::unique_ptr<IoUring> ring(new IoUring(fd));
+            // One mapping for both rings came with 5.4; openat and read with 5.6, probing included.
+            if ((params.features & IORING_FEAT_SINGLE_MMAP) == 0
+                || !ring->supports({IORING_OP_OPENAT, IORING_OP_READ})) {
+                return nullptr;
+            }
+            ring->ringSize = std::max(params.sq_off.array + params.sq_entries * sizeof(unsigned),
+                                      params.cq_off.cqes + params.cq_entries * sizeof(io_uring_cqe));
+            ring->ring = mmap(nullptr, ring->ringSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, fd,
+                              IORING_OFF_SQ_RING);
+            if (ring->ring == MAP_FAILED) {
+                return nullptr;
+            }
+            ring->sqesSize = params.sq_entries * sizeof(io_uring_sqe);
+            auto sqes = mmap(nullptr, ring->sqesSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, fd,
+                             IORING_OFF_SQES);
+            if (sqes == MAP_FAILED) {
+                return nullptr;
+            }
+            ring->sqes = static_cast<io_uring_sqe *>(sqes);
+            auto base = static_cast<uint8_t *>(ring->ring);
+            ring->sqHead = reinterpret_cast<unsigned *>(base + params.sq_off.head);
+            ring->sqTail = reinterpret_cast<unsigned *>(base + params.sq_off.tail);
+            ring->sqMask = *reinterpret_cast<unsigned *>(base + params.sq_off.ring_mask);
+            ring->sqArray = reinterpret_cast<unsigned *>(base + params.sq_off.array);
+            ring->sqEntries = params.sq_entries;
+            ring->cqHead = reinterpret_cast<unsigned *>(base + params.cq_off.head);
+            ring->cqTail = reinterpret_cast<unsigned *>(base + params.cq_off.tail);
+            ring->cqMask = *reinterpret_cast<unsigned *>(base + params.cq_off.ring_mask);
+            ring->cqes = reinterpret_cast<io_uring_cqe *>(base + params.cq_off.cqes);
+            ring->sqLocalTail = *ring->sqTail;
+            return ring;
+        }
+
+        ~IoUring() {
+            if (sqes != nullptr) {
+                munmap(sqes, sqesSize);
+            }
+            if (ring != MAP_FAILED) {
+                munmap(ring, ringSize);
+            }
+            close(fd);
+        }
+
+        // A cleared submission entry, queued by the next submit(); null when the queue is full.
+        io_uring_sqe *nextSqe() {
+            if (sqLocalTail - __atomic_load_n(sqHead, __ATOMIC_ACQUIRE) >= sqEntries) {
+                return nullptr;
+            }
+            auto index = sqLocalTail & sqMask;
+            auto sqe = &sqes[index];
+            memset(sqe, 0, sizeof(*sqe));
+            sqArray[index] = index;
+            sqLocalTail++;
+            toSubmit++;
+            return sqe;
+        }
+
+        // Submits the queued entries and waits for `waitFor` completions. 0 or -errno; entries the
+        // kernel did not take stay queued.
+        int submit(unsigned waitFor) {
+            __atomic_store_n(sqTail, sqLocalTail, __ATOMIC_RELEASE);
+            int submitted = ioUringEnter(fd, toSubmit, waitFor, waitFor > 0 ? IORING_ENTER_GETEVENTS : 0);
+            if (submitted < 0) {
+                return -errno;
+            }
+            toSubmit -= std::min<unsigned>(toSubmit, submitted);
+            return 0;
+        }
+
+        // Hands each available completion to `consume`, which may queue new entries.
+        template<typename F>
+        void reap(F &&consume) {
+            auto head = *cqHead;
+            auto tail = __atomic_load_n(cqTail, __ATOMIC_ACQUIRE);
+            while (head != tail) {
+                auto cqe = cqes[head & cqMask];
+                __atomic_store_n(cqHead, ++head, __ATOMIC_RELEASE);
+                consume(cqe);
+            }
+        }
+
+    private:
+        explicit IoUring(int fd) : fd(fd) {
+        }
+
+        bool supports(std::initializer_list<unsigned> ops) const {
+            constexpr unsigned MaxOps = 256;
+            std::vector<uint8_t> buffer(sizeof(io_uring_probe) + MaxOps * sizeof(io_uring_probe_op));
+            auto probe = reinterpret_cast<io_uring_probe *>(buffer.data());
+            if (ioUringRegister(fd, IORING_REGISTER_PROBE, probe, MaxOps) < 0) {
+                return false;
+            }
+            return std::all_of(ops.begin(), ops.end(), [probe](unsigned op) {
+                return op <= probe->last_op && (probe->ops[op].flags & IO_URING_OP_SUPPORTED) != 0;
+            });
+        }
+
+    private:
+        int fd;
+        void *ring = MAP_FAILED;
+        size_t ringSize = 0;
+        io_uring_sqe *sqes = nullptr;
+        size_t sqesSize = 0;
+        unsigned *sqHead = nullptr;
+        unsigned *sqTail = nullptr;
+        unsigned sqMask = 0;
+        unsigned *sqArray = nullptr;
+        unsigned sqEntries = 0;
+        unsigned *cqHead = nullptr;
+        unsigned *cqTail = nullptr;
+        unsigned cqMask = 0;
+        io_uring_cqe *cqes = nullptr;
+        unsigned sqLocalTail = 0;
+        unsigned toSubmit = 0;
+    };
+
+    // Each file takes a slot from open to close: an openat, then reads until the file is in, one
+    // request in the ring at a time. The size comes from fstat() on the descriptor, which needs no I/O
+    // once the open brought the inode in.
+    class IoUringFileReader : public BatchFileReader {
+    public:
+        IoUringFileReader(std::unique_ptr<IoUring> ring, size_t depth) : ring(std::move(ring)), depth(depth) {
+        }
+
+        void readAll(const std::vector<std::string> &paths, const Callback &onRead) override {
+            std::vector<Slot> slots(depth);
+            std::vector<size_t> freeSlots;
+            for (size_t i = depth; i > 0; --i) {
+                freeSlots.push_back(i - 1);
+            }
+            size_t next = 0;
+            size_t inFlight = 0;
+
+            auto finish = [&](size_t i, int error) {
+                auto &slot = slots[i];
+                if (slot.fd >= 0) {
+                    close(slot.fd);
+                    slot.fd = -1;
+                }
+                slot.read.error = error;
+                slot.read.size = error == 0 ? slot.offset : 0;
+                if (error != 0) {
+                    slot.read.data.reset();
+                }
+                onRead(std::move(slot.read));
+                slot = Slot();
+                freeSlots.push_back(i);
+                inFlight--;
+            };
+
+            // Every slot has at most one entry in the ring, so there is always room for it.
+            auto queueRead = [&](size_t i) {
+                auto &slot = slots[i];
+                auto sqe = ring->nextSqe();
+                CCW_ASSERT(sqe != nullptr);
+                sqe->opcode = IORING_OP_READ;
+                sqe->fd = slot.fd;
+                sqe->addr = reinterpret_cast<uint64_t>(slot.read.data.get() + slot.offset);
+                sqe->len = static_cast<uint32_t>(std::min<uint64_t>(slot.read.stamp.size - slot.offset, 1u << 30u));
+                sqe->off = slot.offset;
+                sqe->user_data = i;
+            };
+
+            auto complete = [&](const io_uring_cqe &cqe) {
+                auto i = static_cast<size_t>(cqe.user_data);
+                auto &slot = slots[i];
+                if (slot.opening) {
+                    slot.opening = false;
+                    if (cqe.res < 0) {
+                        return finish(i, -cqe.res);
+                    }
+                    slot.fd = cqe.res;
+                    if (!ClassFileStamp::ofDescriptor(slot.fd, slot.read.stamp)) {
+                        return finish(i, errno);
+                    }
+                    slot.read.data.reset(new uint8_t[slot.read.stamp.size]);
+                } else if (cqe.res == -EINTR || cqe.res == -EAGAIN) {
+                    return queueRead(i);
+                } else if (cqe.res < 0) {
+                    return finish(i, -cqe.res);
+                } else if (cqe.res == 0) {
+                    return finish(i, 0);    // the file shrank
+                } else {
+                    slot.offset += static_cast<size_t>(cqe.res);
+                }
+                if (slot.offset >= slot.read.stamp.size) {
+                    return finish(i, 0);
+                }
+                queueRead(i);
+            };
+
+            while (true) {
+                while (!isCancelled() && next < paths.size() && !freeSlots.empty()) {
+                    auto i = freeSlots.back();
+                    freeSlots.pop_back();
+                    auto &slot = slots[i];
+                    slot.read.index = next;
+                    slot.opening = true;
+                    auto sqe = ring->nextSqe();
+                    CCW_ASSERT(sqe != nullptr);
+                    sqe->opcode = IORING_OP_OPENAT;
+                    sqe->fd = AT_FDCWD;
+                    sqe->addr = reinterpret_cast<uint64_t>(paths[next].c_str());
+                    sqe->open_flags = O_RDONLY | O_CLOEXEC;
+                    sqe->user_data = i;
+                    next++;
+                    inFlight++;
+                }
+                if (inFlight == 0) {
+                    return;
+                }
+                auto error = ring->submit(1);
+                if (error != 0 && error != -EINTR && error != -EAGAIN && error != -EBUSY) {
+                    // The kernel may still write to the buffers of the requests in flight.
+                    for (auto &slot : slots) {
+                        slot.read.data.release();
+                    }
+                    throw Error(std::string("io_uring_enter failed: ") + strerror(-error));
+                }
+                ring->reap(complete);
+            }
+        }
+
+        [[nodiscard]] Backend getBackend() const override {
+            return Backend::IoUring;
+        }
+
+    private:
+        struct Slot {
+            FileRead read;
+            int fd = -1;
+            size_t offset = 0;
+            bool opening = false;
+        };
+
+        std::unique_ptr<IoUring> ring;
+        size_t depth;
+    };
+
+    std::unique_ptr<BatchFileReader> BatchFileReader::create(Backend backend, size_t depth) {
+        depth = std::max<size_t>(1, depth);
+        if (backend != Backend::Threads) {
+            if (auto ring = IoUring::open(static_cast<unsigned>(depth))) {
+                return std::make_unique<IoUringFileReader>(std::move(ring), depth);
+            }
+            if (backend == Backend::IoUring) {
+                return nullptr;
+            }
+        }
+        return std::make_unique<ThreadFileReader>(depth);
+    }
+
+    bool BatchFileReader::isIoUringAvailable() {
+        return IoUring::open(1) != nullptr;
+    }
+}
@@ -0,0 +1,73 @@
+#pragma once
+
+#include "../SharedClassTable.hpp"
+
+#include <CCW/Base.hpp>
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace CCW::Tula {
+
+    // One whole file read by BatchFileReader.
+    struct FileRead {
+        size_t index = 0;       // of the path in the batch
+        int error = 0;          // errno of the failed open or read, 0 when the file was read
+        ClassFileStamp stamp;   // of the open file, so it describes the bytes read
+        std::unique_ptr<uint8_t[]> data;
+        size_t size = 0;
+    };
+
+    // Reads many whole files at once, so that on a cold page cache the latency of opening and reading
+    // each one overlaps with the others instead of adding up.
+    //
+    // With io_uring (Linux 5.6 and later), the opens and reads of up to `depth` files are in flight
+    // at a time and are submitted and reaped with a few system calls from the calling thread. Where
+    // io_uring is missing or disabled, `depth` threads open and pread() the files instead.
+    class BatchFileReader : public Interface {
+    public:
+        enum class Backend : uint8_t {
+            Auto,       // io_uring when the kernel has it, threads otherwise
+            IoUring,
+            Threads,
+        };
+
+        // Called once per path, as its read completes, in no particular order. With the thread
+        // backend it is called from several threads at once. It must not throw.
+        using Callback = std::function<void(FileRead &&read)>;
+
+        static constexpr size_t DefaultDepth = 64;
+
+        // Null when `backend` is IoUring and the kernel can't provide it.
+        static std::unique_ptr<BatchFileReader> create(Backend backend = Backend::Auto,
+                                                       size_t depth = DefaultDepth);
+
+        // Whether this kernel lets the process use io_uring for opening and reading files.
+        static bool isIoUringAvailable();
+
+        // Reads every file of `paths` and returns once all of them were handed to `onRead`.
+        virtual void readAll(const std::vector<std::string> &paths, const Callback &onRead) = 0;
+
+        [[nodiscard]] virtual Backend getBackend() const = 0;
+
+        // Makes readAll() start no more reads, from any thread; the reads in flight still complete.
+        // Files not read are not handed to `onRead`.
+        inline void cancel() {
+            cancelled.store(true, std::memory_order_relaxed);
+        }
+
+        [[nodiscard]] inline bool isCancelled() const {
+            return cancelled.load(std::memory_order_relaxed);
+        }
+
+    protected:
+        // Opens, stats and reads `path` with blocking calls.
+        static void readFile(const std::string &path, FileRead &read);
+
+    private:
+        std::atomic<bool> cancelled{false};
+    };
+}
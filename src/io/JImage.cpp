@@ -0,0 +1,289 @@
+#include "JImage.hpp"
+#include "../Error.hpp"
+
+#include <algorithm>
+#include <cstring>
+#include <fcntl.h>
+#include <limits>
+#include <sys/mman.h>
+#include <unistd.h>
+#include <zlib.h>
+
+namespace CCW::Tula {
+
+    static constexpr uint32_t ImageMagic = 0xCAFEDADA;
+    static constexpr uint32_t MajorVersion = 1;
+    static constexpr uint32_t MinorVersion = 0;
+    static constexpr size_t HeaderSize = 7 * sizeof(uint32_t);
+
+    // Compressed resources start with one header per compressor that was applied, outermost first.
+    static constexpr uint32_t CompressionMagic = 0xCAFEFAFA;
+    static constexpr size_t CompressionHeaderSize = 29;
+
+    static constexpr int32_t HashMultiplier = 0x01000193;
+
+    // The hash the image writer placed names with: FNV-1 over the UTF-8 bytes, kept positive.
+    static int32_t hashOf(std::string_view name, int32_t seed = HashMultiplier) {
+        auto hash = static_cast<uint32_t>(seed);
+        for (auto c : name) {
+            hash = (hash * HashMultiplier) ^ static_cast<uint8_t>(c);
+        }
+        return static_cast<int32_t>(hash & 0x7FFFFFFFu);
+    }
+
+    JImage::JImage(const std::string &path) : path(path) {
+        auto fd = open(path.c_str(), O_RDONLY | O_CLOEXEC);
+        if (fd < 0) {
+            throw Error("Can't open jimage " + path);
+        }
+        if (!ClassFileStamp::ofDescriptor(fd, stamp) || stamp.size < HeaderSize) {
+            close(fd);
+            fail("too short");
+        }
+        size = stamp.size;
+        auto mapped = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+        close(fd);
+        if (mapped == MAP_FAILED) {
+            fail("can't be mapped");
+        }
+        data = static_cast<const uint8_t *>(mapped);
+
+        uint32_t magic;
+        memcpy(&magic, data, sizeof(magic));
+        swapped = magic != ImageMagic;
+        auto fields = [this](size_t i) { return u4(data + i * sizeof(uint32_t)); };
+        if (fields(0) != ImageMagic) {
+            munmap(const_cast<uint8_t *>(data), size);
+            fail("not a jimage");
+        }
+        auto version = fields(1);
+        resourceCount = fields(3);
+        tableLength = fields(4);
+        locationsSize = fields(5);
+        stringsSize = fields(6);
+        // The index: redirects and location offsets by hash slot, then the locations and the strings.
+        uint64_t indexSize = HeaderSize + uint64_t(tableLength) * 8 + locationsSize + stringsSize;
+        const char *problem = nullptr;
+        if (version >> 16u != MajorVersion || (version & 0xFFFFu) != MinorVersion) {
+            problem = "unsupported version";
+        } else if (indexSize > size) {
+            problem = "index past the end of the file";
+        } else {
+            redirects = data + HeaderSize;
+            offsets = redirects + size_t(tableLength) * 4;
+            locations = offsets + size_t(tableLength) * 4;
+            strings = reinterpret_cast<const char *>(locations + locationsSize);
+            resourcesStart = indexSize;
+            if (stringsSize != 0 && strings[stringsSize - 1] != '\0') {
+                problem = "unterminated string table";
+            }
+        }
+        if (problem != nullptr) {
+            munmap(const_cast<uint8_t *>(data), size);
+            fail(problem);
+        }
+    }
+
+    JImage::~JImage() {
+        munmap(const_cast<uint8_t *>(data), size);
+    }
+
+    void JImage::fail(const std::string &message) const {
+        throw Error("jimage " + path + ": " + message);
+    }
+
+    uint32_t JImage::u4(const uint8_t *p) const {
+        uint32_t value;
+        memcpy(&value, p, sizeof(value));
+        return swapped ? __builtin_bswap32(value) : value;
+    }
+
+    uint64_t JImage::u8(const uint8_t *p) const {
+        uint64_t value;
+        memcpy(&value, p, sizeof(value));
+        return swapped ? __builtin_bswap64(value) : value;
+    }
+
+    std::string_view JImage::string(uint64_t offset) const {
+        if (offset >= stringsSize) {
+            return {};
+        }
+        return {strings + offset};
+    }
+
+    bool JImage::decodeLocation(uint32_t offset, Location &location) const {
+        location = {};
+        // Each attribute is a byte holding its kind and length, then its value: 1 to 8 bytes, big endian.
+        for (auto i = size_t(offset); i < locationsSize;) {
+            auto byte = locations[i++];
+            auto kind = byte >> 3u;
+            if (kind == End) {
+                return true;
+            }
+            size_t length = (byte & 7u) + 1;
+            if (kind >= AttributeCount || locationsSize - i < length) {
+                return false;
+            }
+            uint64_t value = 0;
+            for (size_t j = 0; j < length; ++j) {
+                value = value << 8u | locations[i++];
+            }
+            location.attributes[kind] = value;
+        }
+        return false;
+    }
+
+    // Removes `prefix` from the start of `name`, if it is there.
+    static bool consume(std::string_view &name, std::string_view prefix) {
+        if (name.substr(0, prefix.size()) != prefix) {
+            return false;
+        }
+        name.remove_prefix(prefix.size());
+        return true;
+    }
+
+    bool JImage::matches(const Location &location, std::string_view name) const {
+        // "/module/parent/base.extension", each part and its separator left out when empty.
+        auto module = string(location.attributes[Module]);
+        if (!module.empty() && !(consume(name, "/") && consume(name, module) && consume(name, "/"))) {
+            return false;
+        }
+        auto parent = string(location.attributes[Parent]);
+        if (!parent.empty() && !(consume(name, parent) && consume(name, "/"))) {
+            return false;
+        }
+        if (!consume(name, string(location.attributes[Base]))) {
+            return false;
+        }
+        auto extension = string(location.attributes[Extension]);
+        if (!extension.empty() && !(consume(name, ".") && consume(name, extension))) {
+            return false;
+        }
+        return name.empty();
+    }
+
+    bool JImage::find(std::string_view name, Location &location) const {
+        if (tableLength == 0) {
+            return false;
+        }
+        // The redirect of a name's bucket is the seed to hash it again with, or -1 - its slot when it
+        // is alone in the bucket. Names the image lacks land on some slot too, so the name is compared.
+        uint32_t slot = hashOf(name) % tableLength;
+        auto redirect = static_cast<int32_t>(u4(redirects + size_t(slot) * 4));
+        if (redirect > 0) {
+            slot = hashOf(name, redirect) % tableLength;
+        } else if (redirect < 0) {
+            slot = static_cast<uint32_t>(-1 - int64_t(redirect));
+            if (slot >= tableLength) {
+                return false;
+            }
+        } else {
+            return false;
+        }
+        return decodeLocation(u4(offsets + size_t(slot) * 4), location) && matches(location, name);
+    }
+
+    std::string_view JImage::moduleOf(std::string_view package) const {
+        // The content of "/packages/java.lang" lists (empty, module name offset) pairs for the
+        // modules holding a package of that name; the first non-empty one defines it.
+        std::string name = "/packages/";
+        name.append(package);
+        for (auto i = sizeof("/packages/") - 1; i < name.size(); ++i) {
+            if (name[i] == '/') {
+                name[i] = '.';
+            }
+        }
+        Location location;
+        if (!find(name, location)) {
+            return {};
+        }
+        auto content = read(location);
+        for (size_t i = 0; i + 8 <= content.size; i += 8) {
+            if (u4(content.data + i) == 0) {
+                return string(u4(content.data + i + 4));
+            }
+        }
+        return {};
+    }
+
+    bool JImage::findClass(std::string_view className, Location &location) const {
+        auto slash = className.rfind('/');
+        if (slash == std::string_view::npos) {
+            // Modules have no unnamed package.
+            return false;
+        }
+        auto module = moduleOf(className.substr(0, slash));
+        if (module.empty()) {
+            return false;
+        }
+        std::string name;
+        name.reserve(module.size() + className.size() + 8);
+        name.append("/").append(module).append("/").append(className).append(".class");
+        return find(name, location);
+    }
+
+    std::string JImage::nameOf(const Location &location) const {
+        std::string name;
+        auto module = string(location.attributes[Module]);
+        if (!module.empty()) {
+            name.append("/").append(module).append("/");
+        }
+        auto parent = string(location.attributes[Parent]);
+        if (!parent.empty()) {
+            name.append(parent).append("/");
+        }
+        name.append(string(location.attributes[Base]));
+        auto extension = string(location.attributes[Extension]);
+        if (!extension.empty()) {
+            name.append(".").append(extension);
+        }
+        return name;
+    }
+
+    JImageResource JImage::read(const Location &location) const {
+        auto offset = location.attributes[Offset];
+        auto compressed = location.attributes[Compressed];
+        auto stored = compressed != 0 ? compressed : location.attributes[Uncompressed];
+        if (offset > size - resourcesStart || stored > size - resourcesStart - offset) {
+            throw ClassFormatError("Resource " + nameOf(location) + " past the end of jimage " + path);
+        }
+        JImageResource resource;
+        resource.data = data + resourcesStart + offset;
+        resource.size = stored;
+        if (compressed != 0) {
+            decompress(resource);
+            if (resource.size != location.attributes[Uncompressed]) {
+                throw ClassFormatError("Resource " + nameOf(location) + " of jimage " + path +
+                                       " decompresses to the wrong size");
+            }
+        }
+        return resource;
+    }
+
+    void JImage::decompress(JImageResource &resource) const {
+        while (resource.size >= CompressionHeaderSize && u4(resource.data) == CompressionMagic) {
+            auto p = resource.data;
+            auto compressedSize = u8(p + 4);
+            auto uncompressedSize = u8(p + 12);
+            auto decompressor = string(u4(p + 20));
+            if (decompressor != "zip") {
+                throw ClassFormatError("jimage " + path + " uses unsupported compression " +
+                                       std::string(decompressor));
+            }
+            // zlib takes 32-bit lengths; a class file is far smaller.
+            if (compressedSize > resource.size - CompressionHeaderSize ||
+                uncompressedSize > std::numeric_limits<uint32_t>::max()) {
+                throw ClassFormatError("Malformed compressed resource in jimage " + path);
+            }
+            auto out = std::make_unique<uint8_t[]>(std::max<uint64_t>(uncompressedSize, 1));
+            auto outSize = static_cast<uLongf>(uncompressedSize);
+            if (uncompress(out.get(), &outSize, p + CompressionHeaderSize, static_cast<uLong>(compressedSize)) != Z_OK
+                || outSize != uncompressedSize) {
+                throw ClassFormatError("Corrupt compressed resource in jimage " + path);
+            }
+            resource.decompressed = std::move(out);
+            resource.data = resource.decompressed.get();
+            resource.size = uncompressedSize;
+        }
+    }
+}
@@ -0,0 +1,112 @@
+#pragma once
+
+#include "../SharedClassTable.hpp"
+
+#include <CCW/Base.hpp>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <string_view>
+
+namespace CCW::Tula {
+
+    // The bytes of one jimage resource: a view of the mapped image when it is stored as is, or of its
+    // own decompressed copy.
+    struct JImageResource {
+        const uint8_t *data = nullptr;
+        size_t size = 0;
+        std::unique_ptr<uint8_t[]> decompressed;    // owns `data` when not null
+    };
+
+    // Reads a jimage, the `lib/modules` file JDK 9 and later ship their classes in. The image is mapped
+    // into memory and never copied: a resource is found through the image's perfect hash table with
+    // one hash, one table probe and a compare, and resources stored uncompressed are handed out as
+    // views of the mapping. Resources compressed with "zip" are inflated; images made with other
+    // compressors ("compact-cp") are rejected when such a resource is read.
+    //
+    // Reading is thread-safe. Throws Error when the file can't be mapped or is not a jimage.
+    class JImage : public Noncopyable {
+    public:
+        // The attributes of a location, by kind; strings are offsets into the string table.
+        enum Attribute : uint8_t {
+            End,
+            Module,
+            Parent,
+            Base,
+            Extension,
+            Offset,         // of the resource, from the end of the index
+            Compressed,     // size, 0 when stored as is
+            Uncompressed,   // size
+            AttributeCount
+        };
+
+        struct Location {
+            uint64_t attributes[AttributeCount] = {};
+        };
+
+        explicit JImage(const std::string &path);
+
+        ~JImage();
+
+        // Finds the resource named `name`, such as "/java.base/java/lang/Object.class".
+        bool find(std::string_view name, Location &location) const;
+
+        // Finds the class file of class `className` (internal form) in the module of its package.
+        bool findClass(std::string_view className, Location &location) const;
+
+        // The module holding package `package` (internal form), or empty.
+        [[nodiscard]] std::string_view moduleOf(std::string_view package) const;
+
+        // The name of the resource at `location`.
+        [[nodiscard]] std::string nameOf(const Location &location) const;
+
+        // Throws ClassFormatError when the resource can't be decompressed.
+        [[nodiscard]] JImageResource read(const Location &location) const;
+
+        [[nodiscard]] inline const std::string &getPath() const {
+            return path;
+        }
+
+        // Of the image file when it was opened.
+        [[nodiscard]] inline const ClassFileStamp &getStamp() const {
+            return stamp;
+        }
+
+        [[nodiscard]] inline uint32_t getResourceCount() const {
+            return resourceCount;
+        }
+
+    private:
+        [[nodiscard]] uint32_t u4(const uint8_t *p) const;
+
+        [[nodiscard]] uint64_t u8(const uint8_t *p) const;
+
+        // A string of the string table; empty for an offset out of it.
+        [[nodiscard]] std::string_view string(uint64_t offset) const;
+
+        bool decodeLocation(uint32_t offset, Location &location) const;
+
+        // Whether `location` is the resource named `name`: hash tables only tell where a name would be.
+        [[nodiscard]] bool matches(const Location &location, std::string_view name) const;
+
+        void decompress(JImageResource &resource) const;
+
+        [[noreturn]] void fail(const std::string &message) const;
+
+    private:
+        std::string path;
+        ClassFileStamp stamp;
+        const uint8_t *data = nullptr;
+        size_t size = 0;
+        bool swapped = false;   // the image was written on a machine of the other byte order
+        uint32_t resourceCount = 0;
+        uint32_t tableLength = 0;
+        const uint8_t *redirects = nullptr;
+        const uint8_t *offsets = nullptr;
+        const uint8_t *locations = nullptr;
+        uint32_t locationsSize = 0;
+        const char *strings = nullptr;
+        uint32_t stringsSize = 0;
+        size_t resourcesStart = 0;
+    };
+}
@@ -0,0 +1,156 @@
+#include "NativeLinker.hpp"
+#include "../Error.hpp"
+#include "../JavaString.hpp"
+#include "../Klass.hpp"
+
+#include <dlfcn.h>
+
+namespace CCW::Tula {
+
+    NativeLinker::NativeLinker() : process(dlopen(nullptr, RTLD_LAZY)) {
+    }
+
+    NativeLinker::~NativeLinker() {
+        // Methods outlive the linker when their classes are shared with other VMs.
+        for (auto &[method, entry] : linked) {
+            const_cast<Method *>(method)->replaceNativeEntry(entry, nullptr);
+        }
+        for (auto library : libraries) {
+            dlclose(library);
+        }
+        if (process != nullptr) {
+            dlclose(process);
+        }
+    }
+
+    void NativeLinker::loadLibrary(const std::string &path) {
+        auto library = dlopen(path.c_str(), RTLD_LAZY | RTLD_LOCAL);
+        if (library == nullptr) {
+            throw UnsatisfiedLinkError("Can't load library: " + path + " (" + dlerror() + ")");
+        }
+        std::lock_guard<std::mutex> _{mutex};
+        libraries.push_back(library);
+        // Names missing so far may be in the new library.
+        for (auto it = symbols.begin(); it != symbols.end();) {
+            it = it->second == nullptr ? symbols.erase(it) : std::next(it);
+        }
+    }
+
+    void NativeLinker::registerNatives(const std::string &className, const NativeMethod *methods, size_t count) {
+        std::lock_guard<std::mutex> _{mutex};
+        for (size_t i = 0; i < count; ++i) {
+            registered[Key{className, methods[i].name, methods[i].descriptor}] = methods[i].function;
+        }
+    }
+
+    std::string NativeLinker::mangle(const std::string &name) {
+        static const char hex[] = "0123456789abcdef";
+        auto chars = JavaString::fromModifiedUtf8(reinterpret_cast<const uint8_t *>(name.data()), name.size())
+            ->toUtf16();
+        std::string mangled;
+        mangled.reserve(chars.size());
+        for (auto c : chars) {
+            if ((c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') || (c >= '0' && c <= '9')) {
+                mangled += static_cast<char>(c);
+            } else if (c == '/') {
+                mangled += '_';
+            } else if (c == '_') {
+                mangled += "_1";
+            } else if (c == ';') {
+                mangled += "_2";
+            } else if (c == '[') {
+                mangled += "_3";
+            } else {
+                mangled += "_0";
+                for (int shift = 12; shift >= 0; shift -= 4) {
+                    mangled += hex[(c >> static_cast<unsigned>(shift)) & 0xFu];
+                }
+            }
+        }
+        return mangled;
+    }
+
+    std::string NativeLinker::shortName(const std::string &className, const std::string &methodName) {
+        return "Java_" + mangle(className) + "_" + mangle(methodName);
+    }
+
+    std::string NativeLinker::longName(const std::string &className, const std::string &methodName,
+                                       const std::string &descriptor) {
+        auto parameters = descriptor.substr(1, descriptor.find(')') - 1);
+        return shortName(className, methodName) + "__" + mangle(parameters);
+    }
+
+    void *NativeLinker::lookupSymbol(const std::string &name) {
+        auto cached = symbols.find(name);
+        if (cached != symbols.end()) {
+            return cached->second;
+        }
+        void *function = nullptr;
+        for (auto library : libraries) {
+            if ((function = dlsym(library, name.c_str())) != nullptr) {
+                break;
+            }
+        }
+        if (function == nullptr && process != nullptr) {
+            function = dlsym(process, name.c_str());
+        }
+        symbols.emplace(name, function);
+        return function;
+    }
+
+    void *NativeLinker::findFunction(const Method &method) {
+        auto className = method.getHolder()->getName()->toString();
+        auto methodName = method.name()->toString();
+        auto descriptor = method.descriptor()->toString();
+        auto found = registered.find(Key{className, methodName, descriptor});
+        if (found != registered.end()) {
+            return found->second;
+        }
+        if (auto function = lookupSymbol(shortName(className, methodName))) {
+            return function;
+        }
+        return lookupSymbol(longName(className, methodName, descriptor));
+    }
+
+    const NativeEntry &NativeLinker::link(Method &method) {
+        auto cached = method.getNativeEntry();
+        if (cached != nullptr && cached->owner == this) {
+            return *cached;
+        }
+        std::lock_guard<std::mutex> _{mutex};
+        // Another thread may have linked it while we waited for the lock, or the method caches the
+        // entry of another VM.
+        if (auto it = linked.find(&method); it != linked.end()) {
+            return *it->second;
+        }
+        auto description = method.getHolder()->getName()->toString() + "." + method.name()->toString()
+                           + method.descriptor()->toString();
+        if (!method.isNative()) {
+            throw UnsatisfiedLinkError(description + " is not native");
+        }
+        auto function = findFunction(method);
+        if (function == nullptr) {
+            throw UnsatisfiedLinkError(description);
+        }
+        auto signature = std::make_shared<NativeSignature>(method.descriptor()->toString());
+        auto stub = signature->getStub();
+        if (stub == nullptr) {
+            throw UnsatisfiedLinkError(description + ": more than "
+                                       + std::to_string(NativeSignature::MaxStubArguments)
+                                       + " parameters are not supported on this platform");
+        }
+        NativeEntry entry{this, function, stub, static_cast<uint8_t>(signature->getArgumentCount()),
+                          static_cast<uint8_t>(method.isStatic() ? 0 : 1), signature->getReturnType(), {}, nullptr};
+        if (signature->getArgumentCount() > NativeSignature::MaxStubArguments) {
+            entry.signature = std::move(signature);
+        } else {
+            for (size_t i = 0; i < signature->getArgumentCount(); ++i) {
+                entry.slotOffsets[i] = signature->getSlotOffset(i);
+            }
+        }
+        entries.push_back(entry);
+        linked.emplace(&method, &entries.back());
+        method.replaceNativeEntry(nullptr, &entries.back());
+        return entries.back();
+    }
+}
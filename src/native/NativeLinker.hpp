@@ -0,0 +1,69 @@
+#pragma once
+
+#include "NativeStubs.hpp"
+
+#include <CCW/Base.hpp>
+#include <tula/Native.hpp>
+
+#include <deque>
+#include <map>
+#include <mutex>
+#include <string>
+#include <tuple>
+#include <unordered_map>
+#include <vector>
+
+namespace CCW::Tula {
+
+    class Method;
+
+    // Binds native methods to C functions once and hands out NativeEntry call descriptors.
+    //
+    // Registered natives win; otherwise the JNI short name (Java_pkg_Class_name) and then the long name
+    // (with __ and the mangled parameters) are looked up in the loaded libraries, in load order, and
+    // finally in the process itself. Lookups are cached by mangled name, so overloads and re-linking
+    // never repeat a dlsym.
+    class NativeLinker : public Noncopyable {
+    public:
+        NativeLinker();
+
+        ~NativeLinker();
+
+        // dlopen()s a library for later lookups. Throws UnsatisfiedLinkError when it cannot be loaded.
+        void loadLibrary(const std::string &path);
+
+        // Binds the natives of `className` (internal form) directly, skipping dlsym for them.
+        void registerNatives(const std::string &className, const NativeMethod *methods, size_t count);
+
+        // Returns the entry of a native method, linking it on the first call; later calls only load
+        // the entry cached in the method. Every VM has a linker of its own, and a method shared
+        // between VMs caches the entry of one of them: the others find theirs under the lock.
+        // Throws UnsatisfiedLinkError.
+        const NativeEntry &link(Method &method);
+
+        // The JNI name mangling of a class, method or descriptor fragment (JNI spec, "Resolving Native
+        // Method Names").
+        static std::string mangle(const std::string &name);
+
+        static std::string shortName(const std::string &className, const std::string &methodName);
+
+        static std::string longName(const std::string &className, const std::string &methodName,
+                                    const std::string &descriptor);
+
+    private:
+        void *lookupSymbol(const std::string &name);
+
+        void *findFunction(const Method &method);
+
+    private:
+        using Key = std::tuple<std::string, std::string, std::string>;
+
+        std::mutex mutex;
+        void *process;
+        std::vector<void *> libraries;
+        std::map<Key, void *> registered;
+        std::unordered_map<std::string, void *> symbols;    // null caches a miss until the next loadLibrary
+        std::deque<NativeEntry> entries;                    // stable addresses, referenced from methods
+        std::unordered_map<const Method *, const NativeEntry *> linked;
+    };
+}
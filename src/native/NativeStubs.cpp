@@ -0,0 +1,275 @@
+#include "NativeStubs.hpp"
+
+#include <CCW/Base.hpp>
+
+#include <algorithm>
+#include <array>
+#include <cstring>
+#include <type_traits>
+#include <utility>
+
+namespace CCW::Tula {
+
+    static NativeKind kindOf(char type) {
+        switch (type) {
+            case 'F':
+                return NativeKind::Float;
+            case 'D':
+                return NativeKind::Double;
+            case 'V':
+                return NativeKind::Void;
+            default:
+                return NativeKind::Word;
+        }
+    }
+
+    NativeSignature::NativeSignature(const std::string &descriptor) {
+        CCW_ASSERT(!descriptor.empty() && descriptor[0] == '(');
+        uint64_t kinds = 0;
+        size_t slot = 0;
+        size_t i = 1;
+        while (descriptor[i] != ')') {
+            char type = descriptor[i];
+            while (descriptor[i] == '[') {
+                i++;
+            }
+            if (descriptor[i] == 'L') {
+                i = descriptor.find(';', i);
+            }
+            i++;
+            auto kind = kindOf(type);
+            if (argumentCount < MaxStubArguments) {
+                kinds |= static_cast<uint64_t>(kind) << (2 * argumentCount);
+            }
+            slotOffsets.push_back(static_cast<uint8_t>(slot));
+            argumentKinds.push_back(kind);
+            argumentCount++;
+            slot += type == 'J' || type == 'D' ? 2 : 1;
+        }
+        returnType = descriptor[i + 1];
+        returnKind = kindOf(returnType);
+        fingerprint = static_cast<uint64_t>(returnKind) | (std::min<uint64_t>(argumentCount, 0xFF) << 2u)
+                      | (kinds << 10u);
+    }
+
+    // The stubs: one instantiation per (return kind, argument kinds) shape, enumerated at compile time.
+
+    template<NativeKind Kind>
+    using KindType = std::conditional_t<Kind == NativeKind::Word, int64_t,
+        std::conditional_t<Kind == NativeKind::Float, jfloat,
+            std::conditional_t<Kind == NativeKind::Double, jdouble, void>>>;
+
+    template<typename T>
+    static inline T argument(const JavaSlot *args, uint8_t offset) {
+        if constexpr (std::is_same_v<T, int64_t>) {
+            return static_cast<int64_t>(args[offset]);
+        } else {
+            // Floats live in the low half of their slot.
+            T value;
+            if constexpr (std::is_same_v<T, jfloat>) {
+                auto bits = static_cast<uint32_t>(args[offset]);
+                memcpy(&value, &bits, sizeof(value));
+            } else {
+                memcpy(&value, &args[offset], sizeof(value));
+            }
+            return value;
+        }
+    }
+
+    // Word results come back with unspecified upper bits for narrow types; cut them to the Java type.
+    static inline uint64_t normalize(int64_t result, char returnType) {
+        switch (returnType) {
+            case 'Z':
+                return static_cast<uint8_t>(result) != 0;
+            case 'B':
+                return static_cast<uint64_t>(static_cast<int64_t>(static_cast<int8_t>(result)));
+            case 'C':
+                return static_cast<uint16_t>(result);
+            case 'S':
+                return static_cast<uint64_t>(static_cast<int64_t>(static_cast<int16_t>(result)));
+            case 'I':
+                return static_cast<uint64_t>(static_cast<int64_t>(static_cast<int32_t>(result)));
+            default:
+                return static_cast<uint64_t>(result);
+        }
+    }
+
+    // Calls `call` and returns its result as a slot.
+    template<typename R, typename Call>
+    static inline uint64_t resultOf(char returnType, Call &&call) {
+        if constexpr (std::is_void_v<R>) {
+            call();
+            return 0;
+        } else if constexpr (std::is_same_v<R, int64_t>) {
+            return normalize(call(), returnType);
+        } else {
+            R result = call();
+            uint64_t bits = 0;
+            memcpy(&bits, &result, sizeof(result));
+            return bits;
+        }
+    }
+
+    template<typename R, typename... A, size_t... I>
+    static uint64_t callNative(const NativeEntry &entry, void *env, void *self, const JavaSlot *args,
+                               std::index_sequence<I...>) {
+        auto function = reinterpret_cast<R (*)(void *, void *, A...)>(entry.function);
+        return resultOf<R>(entry.returnType, [&] {
+            return function(env, self, argument<A>(args, entry.slotOffsets[I])...);
+        });
+    }
+
+    template<typename R, typename... A>
+    static uint64_t stub(const NativeEntry &entry, void *env, void *self, const JavaSlot *args) {
+        return callNative<R, A...>(entry, env, self, args, std::index_sequence_for<A...>{});
+    }
+
+    static constexpr size_t pow3(size_t n) {
+        return n == 0 ? 1 : 3 * pow3(n - 1);
+    }
+
+    // Shapes number the argument kinds of one arity in base 3, first argument in the lowest digit.
+    template<size_t Shape, size_t Index>
+    using ArgumentType = KindType<static_cast<NativeKind>(Shape / pow3(Index) % 3)>;
+
+    template<typename R, size_t Shape, size_t... I>
+    static constexpr NativeStub stubOf(std::index_sequence<I...>) {
+        return &stub<R, ArgumentType<Shape, I>...>;
+    }
+
+    template<typename R, size_t Arity, size_t... Shapes>
+    static constexpr std::array<NativeStub, sizeof...(Shapes)> stubsOf(std::index_sequence<Shapes...>) {
+        return {stubOf<R, Shapes>(std::make_index_sequence<Arity>{})...};
+    }
+
+    template<typename R>
+    struct StubTables {
+        static constexpr auto arity0 = stubsOf<R, 0>(std::make_index_sequence<pow3(0)>{});
+        static constexpr auto arity1 = stubsOf<R, 1>(std::make_index_sequence<pow3(1)>{});
+        static constexpr auto arity2 = stubsOf<R, 2>(std::make_index_sequence<pow3(2)>{});
+        static constexpr auto arity3 = stubsOf<R, 3>(std::make_index_sequence<pow3(3)>{});
+        static constexpr auto arity4 = stubsOf<R, 4>(std::make_index_sequence<pow3(4)>{});
+
+        static NativeStub get(size_t arity, size_t shape) {
+            static_assert(NativeSignature::MaxStubArguments == 4, "one table per arity up to the maximum");
+            switch (arity) {
+                case 0:
+                    return arity0[shape];
+                case 1:
+                    return arity1[shape];
+                case 2:
+                    return arity2[shape];
+                case 3:
+                    return arity3[shape];
+                case 4:
+                    return arity4[shape];
+                default:
+                    return nullptr;
+            }
+        }
+    };
+
+#if (defined(__x86_64__) || defined(__aarch64__)) && defined(__linux__)
+#define TULA_GENERIC_NATIVE_STUB 1
+
+    // The generic stub. Both calling conventions assign integer and floating point arguments to their
+    // own registers in order, and pass the rest on the stack in order, one 8-byte slot each with narrow
+    // values in the low bytes. So any signature can be called through one prototype taking every
+    // integer register, every vector register and enough stack slots: the callee reads what it declares
+    // and ignores the rest, which the caller pops.
+#if defined(__x86_64__)
+    static constexpr size_t IntegerRegisters = 6;
+#else
+    static constexpr size_t IntegerRegisters = 8;
+#endif
+    static constexpr size_t VectorRegisters = 8;
+    // Most wide natives spill a few slots; up to 255 parameters need the large prototype.
+    static constexpr size_t SmallStackSlots = 8;
+    static constexpr size_t MaxStackSlots = 256;
+
+    template<size_t>
+    using WordAt = uint64_t;
+
+    template<size_t>
+    using VectorAt = double;
+
+    template<typename R, size_t... W, size_t... V, size_t... S>
+    static R callSpread(void *function, const uint64_t *words, const double *vectors, const uint64_t *stack,
+                        std::index_sequence<W...>, std::index_sequence<V...>, std::index_sequence<S...>) {
+        auto spread = reinterpret_cast<R (*)(WordAt<W>..., VectorAt<V>..., WordAt<S>...)>(function);
+        return spread(words[W]..., vectors[V]..., stack[S]...);
+    }
+
+    template<typename R, size_t StackSlots>
+    static R callSpread(void *function, const uint64_t *words, const double *vectors, const uint64_t *stack) {
+        return callSpread<R>(function, words, vectors, stack, std::make_index_sequence<IntegerRegisters>{},
+                             std::make_index_sequence<VectorRegisters>{}, std::make_index_sequence<StackSlots>{});
+    }
+
+    template<typename R>
+    static uint64_t genericStub(const NativeEntry &entry, void *env, void *self, const JavaSlot *args) {
+        uint64_t words[IntegerRegisters] = {};
+        double vectors[VectorRegisters] = {};
+        uint64_t stack[MaxStackSlots];
+        size_t wordCount = 0;
+        size_t vectorCount = 0;
+        size_t stackCount = 0;
+        words[wordCount++] = reinterpret_cast<uintptr_t>(env);
+        words[wordCount++] = reinterpret_cast<uintptr_t>(self);
+        const auto &signature = *entry.signature;
+        for (size_t i = 0; i < signature.getArgumentCount(); ++i) {
+            // Slots hold floats in their low half, as registers and stack slots do.
+            auto slot = args[signature.getSlotOffset(i)];
+            if (signature.getArgumentKind(i) == NativeKind::Word) {
+                if (wordCount < IntegerRegisters) {
+                    words[wordCount++] = slot;
+                    continue;
+                }
+            } else if (vectorCount < VectorRegisters) {
+                memcpy(&vectors[vectorCount++], &slot, sizeof(slot));
+                continue;
+            }
+            stack[stackCount++] = slot;
+        }
+        bool small = stackCount <= SmallStackSlots;
+        std::fill(stack + stackCount, stack + (small ? SmallStackSlots : MaxStackSlots), 0);
+        return resultOf<R>(entry.returnType, [&] {
+            return small ? callSpread<R, SmallStackSlots>(entry.function, words, vectors, stack)
+                         : callSpread<R, MaxStackSlots>(entry.function, words, vectors, stack);
+        });
+    }
+#endif
+
+    NativeStub NativeSignature::getStub() const {
+        if (argumentCount > MaxStubArguments) {
+#ifdef TULA_GENERIC_NATIVE_STUB
+            switch (returnKind) {
+                case NativeKind::Word:
+                    return &genericStub<int64_t>;
+                case NativeKind::Float:
+                    return &genericStub<jfloat>;
+                case NativeKind::Double:
+                    return &genericStub<jdouble>;
+                case NativeKind::Void:
+                    return &genericStub<void>;
+            }
+#endif
+            return nullptr;
+        }
+        size_t shape = 0;
+        for (size_t i = argumentCount; i-- > 0;) {
+            shape = shape * 3 + static_cast<size_t>(argumentKinds[i]);
+        }
+        switch (returnKind) {
+            case NativeKind::Word:
+                return StubTables<int64_t>::get(argumentCount, shape);
+            case NativeKind::Float:
+                return StubTables<jfloat>::get(argumentCount, shape);
+            case NativeKind::Double:
+                return StubTables<jdouble>::get(argumentCount, shape);
+            case NativeKind::Void:
+                return StubTables<void>::get(argumentCount, shape);
+        }
+        UNREACHABLE();
+    }
+}
@@ -0,0 +1,105 @@
+#pragma once
+
+#include "../JVM.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace CCW::Tula {
+
+    // A Java frame slot as seen by native calls: 64 bits wide, ints sign-extended and sub-int values
+    // already normalized (booleans 0 or 1, chars zero-extended). Longs and doubles take two slots with
+    // the value in the first; floats keep their bits in the low half; references are pointers.
+    using JavaSlot = uint64_t;
+
+    struct NativeEntry;
+    class NativeLinker;
+
+    // Calls the native function of `entry` with the method's argument slots, receiver first for
+    // instance methods, and returns the result normalized to the Java return type.
+    using NativeStub = uint64_t (*)(const NativeEntry &entry, void *env, void *self, const JavaSlot *args);
+
+    // How an argument travels in the C calling convention. Every integral Java type and references
+    // go in general purpose registers as full words, so one stub serves every mix of them.
+    enum class NativeKind : uint8_t {
+        Word,
+        Float,
+        Double,
+        Void    // return only
+    };
+
+    // The register shape of a method descriptor: its kinds packed two bits each, the return kind
+    // first, then the argument count, then one kind per argument of the first MaxStubArguments.
+    // Descriptors with the same fingerprint share a stub.
+    class NativeSignature {
+    public:
+        // With env and the receiver this fills the six integer argument registers of x86-64 and
+        // stays below the eight of AArch64, so stub calls never pass arguments on the stack.
+        static constexpr size_t MaxStubArguments = 4;
+
+        // Parses a well-formed method descriptor.
+        explicit NativeSignature(const std::string &descriptor);
+
+        [[nodiscard]] inline uint64_t getFingerprint() const {
+            return fingerprint;
+        }
+
+        [[nodiscard]] inline size_t getArgumentCount() const {
+            return argumentCount;
+        }
+
+        [[nodiscard]] inline NativeKind getReturnKind() const {
+            return returnKind;
+        }
+
+        [[nodiscard]] inline char getReturnType() const {
+            return returnType;
+        }
+
+        // Slot of each parameter, counting from the first parameter (not the receiver).
+        [[nodiscard]] inline uint8_t getSlotOffset(size_t index) const {
+            return slotOffsets[index];
+        }
+
+        [[nodiscard]] inline NativeKind getArgumentKind(size_t index) const {
+            return argumentKinds[index];
+        }
+
+        // The generated stub for this shape. Signatures with more than MaxStubArguments parameters get
+        // the generic stub, which places every argument by the C calling convention at call time and
+        // reads the shape from NativeEntry::signature; it is null on platforms it does not know.
+        [[nodiscard]] NativeStub getStub() const;
+
+    private:
+        uint64_t fingerprint = 0;
+        size_t argumentCount = 0;
+        NativeKind returnKind = NativeKind::Void;
+        char returnType = 'V';
+        std::vector<uint8_t> slotOffsets;
+        std::vector<NativeKind> argumentKinds;
+    };
+
+    // A linked native method: what the interpreter needs to call it without looking at the descriptor.
+    struct NativeEntry {
+        const NativeLinker *owner;
+        void *function;
+        NativeStub stub;
+        uint8_t argumentCount;
+        uint8_t receiverSlots;                                      // 1 for instance methods, else 0
+        char returnType;
+        uint8_t slotOffsets[NativeSignature::MaxStubArguments];     // from args + receiverSlots
+        std::shared_ptr<const NativeSignature> signature;           // for the generic stub only
+
+        // `locals` are the method's argument slots; `self` is used for static methods, which have no
+        // receiver slot, and stands in for the class mirror.
+        inline uint64_t invoke(void *env, void *self, const JavaSlot *locals) const {
+            if (receiverSlots != 0) {
+                self = reinterpret_cast<void *>(static_cast<uintptr_t>(locals[0]));
+            }
+            return stub(*this, env, self, locals + receiverSlots);
+        }
+    };
+}
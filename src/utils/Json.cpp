@@ -0,0 +1,22 @@
+#include "Json.hpp"
+
+#include <iomanip>
+
+namespace CCW::Tula {
+
+    void writeJsonString(std::ostream &out, std::string_view value) {
+        out << '"';
+        for (unsigned char c : value) {
+            if (c == '"' || c == '\\') {
+                out << '\\' << c;
+            } else if (c < 0x20) {
+                auto fill = out.fill('0');
+                out << "\\u" << std::hex << std::setw(4) << static_cast<int>(c) << std::dec;
+                out.fill(fill);
+            } else {
+                out << c;
+            }
+        }
+        out << '"';
+    }
+}
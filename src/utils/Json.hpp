@@ -0,0 +1,11 @@
+#pragma once
+
+#include <ostream>
+#include <string_view>
+
+namespace CCW::Tula {
+
+    // Writes `value` as a JSON string literal: quotes and backslashes escaped, control characters as
+    // \u00XX. Other bytes pass through, so UTF-8 input stays UTF-8.
+    void writeJsonString(std::ostream &out, std::string_view value);
+}
@@ -0,0 +1,89 @@
+#include "Sha256.hpp"
+
+#include <cstring>
+
+namespace CCW::Tula {
+
+    static constexpr uint32_t RoundConstants[64] = {
+        0x428a2f98, 0x71374491, 0xb5c0fbcf, 0xe9b5dba5, 0x3956c25b, 0x59f111f1, 0x923f82a4, 0xab1c5ed5,
+        0xd807aa98, 0x12835b01, 0x243185be, 0x550c7dc3, 0x72be5d74, 0x80deb1fe, 0x9bdc06a7, 0xc19bf174,
+        0xe49b69c1, 0xefbe4786, 0x0fc19dc6, 0x240ca1cc, 0x2de92c6f, 0x4a7484aa, 0x5cb0a9dc, 0x76f988da,
+        0x983e5152, 0xa831c66d, 0xb00327c8, 0xbf597fc7, 0xc6e00bf3, 0xd5a79147, 0x06ca6351, 0x14292967,
+        0x27b70a85, 0x2e1b2138, 0x4d2c6dfc, 0x53380d13, 0x650a7354, 0x766a0abb, 0x81c2c92e, 0x92722c85,
+        0xa2bfe8a1, 0xa81a664b, 0xc24b8b70, 0xc76c51a3, 0xd192e819, 0xd6990624, 0xf40e3585, 0x106aa070,
+        0x19a4c116, 0x1e376c08, 0x2748774c, 0x34b0bcb5, 0x391c0cb3, 0x4ed8aa4a, 0x5b9cca4f, 0x682e6ff3,
+        0x748f82ee, 0x78a5636f, 0x84c87814, 0x8cc70208, 0x90befffa, 0xa4506ceb, 0xbef9a3f7, 0xc67178f2
+    };
+
+    static inline uint32_t rotateRight(uint32_t x, uint32_t n) {
+        return (x >> n) | (x << (32 - n));
+    }
+
+    static void compress(uint32_t *state, const uint8_t *block) {
+        uint32_t w[64];
+        for (int i = 0; i < 16; ++i) {
+            w[i] = uint32_t(block[4 * i]) << 24u | uint32_t(block[4 * i + 1]) << 16u
+                   | uint32_t(block[4 * i + 2]) << 8u | block[4 * i + 3];
+        }
+        for (int i = 16; i < 64; ++i) {
+            auto s0 = rotateRight(w[i - 15], 7) ^ rotateRight(w[i - 15], 18) ^ (w[i - 15] >> 3u);
+            auto s1 = rotateRight(w[i - 2], 17) ^ rotateRight(w[i - 2], 19) ^ (w[i - 2] >> 10u);
+            w[i] = w[i - 16] + s0 + w[i - 7] + s1;
+        }
+        auto a = state[0], b = state[1], c = state[2], d = state[3];
+        auto e = state[4], f = state[5], g = state[6], h = state[7];
+        for (int i = 0; i < 64; ++i) {
+            auto t1 = h + (rotateRight(e, 6) ^ rotateRight(e, 11) ^ rotateRight(e, 25)) + ((e & f) ^ (~e & g))
+                      + RoundConstants[i] + w[i];
+            auto t2 = (rotateRight(a, 2) ^ rotateRight(a, 13) ^ rotateRight(a, 22)) + ((a & b) ^ (a & c) ^ (b & c));
+            h = g;
+            g = f;
+            f = e;
+            e = d + t1;
+            d = c;
+            c = b;
+            b = a;
+            a = t1 + t2;
+        }
+        state[0] += a;
+        state[1] += b;
+        state[2] += c;
+        state[3] += d;
+        state[4] += e;
+        state[5] += f;
+        state[6] += g;
+        state[7] += h;
+    }
+
+    Sha256::Digest Sha256::of(const uint8_t *bytes, size_t len) {
+        uint32_t state[8] = {0x6a09e667, 0xbb67ae85, 0x3c6ef372, 0xa54ff53a,
+                             0x510e527f, 0x9b05688c, 0x1f83d9ab, 0x5be0cd19};
+        size_t full = len / 64 * 64;
+        for (size_t i = 0; i < full; i += 64) {
+            compress(state, bytes + i);
+        }
+        // The rest, a one bit, zeros and the length in bits fill one or two more blocks.
+        uint8_t tail[128] = {};
+        size_t rest = len - full;
+        if (rest != 0) {
+            memcpy(tail, bytes + full, rest);
+        }
+        tail[rest] = 0x80;
+        size_t tailSize = rest < 56 ? 64 : 128;
+        uint64_t bits = uint64_t(len) * 8;
+        for (int i = 0; i < 8; ++i) {
+            tail[tailSize - 1 - i] = static_cast<uint8_t>(bits >> (8u * i));
+        }
+        for (size_t i = 0; i < tailSize; i += 64) {
+            compress(state, tail + i);
+        }
+        Digest digest;
+        for (int i = 0; i < 8; ++i) {
+            digest[4 * i] = static_cast<uint8_t>(state[i] >> 24u);
+            digest[4 * i + 1] = static_cast<uint8_t>(state[i] >> 16u);
+            digest[4 * i + 2] = static_cast<uint8_t>(state[i] >> 8u);
+            digest[4 * i + 3] = static_cast<uint8_t>(state[i]);
+        }
+        return digest;
+    }
+}
@@ -0,0 +1,16 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+
+namespace CCW::Tula {
+
+    // SHA-256 of FIPS 180-4, for content digests that must not be forgeable.
+    class Sha256 {
+    public:
+        using Digest = std::array<uint8_t, 32>;
+
+        static Digest of(const uint8_t *bytes, size_t len);
+    };
+}
@@ -0,0 +1,91 @@
+#include "ThreadPool.hpp"
+
+#include <algorithm>
+#include <atomic>
+
+namespace CCW::Tula {
+
+    ThreadPool::ThreadPool(size_t threadCount) {
+        if (threadCount == 0) {
+            threadCount = std::max(1u, std::thread::hardware_concurrency());
+        }
+        workers.reserve(threadCount);
+        for (size_t i = 0; i < threadCount; ++i) {
+            workers.emplace_back([this]() { run(); });
+        }
+    }
+
+    ThreadPool::~ThreadPool() {
+        {
+            std::lock_guard<std::mutex> _(lock);
+            stopping = true;
+        }
+        available.notify_all();
+        for (auto &worker : workers) {
+            worker.join();
+        }
+    }
+
+    void ThreadPool::run() {
+        while (true) {
+            std::function<void()> task;
+            {
+                std::unique_lock<std::mutex> guard(lock);
+                available.wait(guard, [this]() { return stopping || !tasks.empty(); });
+                if (tasks.empty()) {
+                    return;
+                }
+                task = std::move(tasks.front());
+                tasks.pop();
+            }
+            task();
+        }
+    }
+
+    void ThreadPool::parallelFor(size_t count, const std::function<void(size_t)> &body) {
+        if (count == 0) {
+            return;
+        }
+        // Work is handed out by an atomic cursor instead of one task per index, so cheap items do not
+        // pay a queue round trip each. Helpers that only start after the cursor ran out never touch
+        // `body`, so the caller just waits for the helpers that are still inside it.
+        struct State {
+            std::atomic<size_t> next{0};
+            std::atomic<size_t> running{0};
+            std::mutex lock;
+            std::condition_variable done;
+            std::exception_ptr error;
+        };
+        auto state = std::make_shared<State>();
+        auto bodyPtr = &body;
+        auto drain = [state, count, bodyPtr]() {
+            state->running.fetch_add(1);
+            for (size_t i = state->next.fetch_add(1); i < count; i = state->next.fetch_add(1)) {
+                try {
+                    (*bodyPtr)(i);
+                } catch (...) {
+                    std::lock_guard<std::mutex> _(state->lock);
+                    if (!state->error) {
+                        state->error = std::current_exception();
+                    }
+                }
+            }
+            if (state->running.fetch_sub(1) == 1) {
+                std::lock_guard<std::mutex> _(state->lock);
+                state->done.notify_all();
+            }
+        };
+
+        auto helpers = std::min(count - 1, workers.size());
+        for (size_t i = 0; i < helpers; ++i) {
+            submit(drain);
+        }
+        drain();
+
+        std::unique_lock<std::mutex> guard(state->lock);
+        state->done.wait(guard, [&state]() { return state->running.load() == 0; });
+        if (state->error) {
+            std::rethrow_exception(state->error);
+        }
+    }
+}
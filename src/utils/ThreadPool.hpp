@@ -0,0 +1,53 @@
+#pragma once
+
+#include <CCW/Base.hpp>
+
+#include <condition_variable>
+#include <functional>
+#include <future>
+#include <mutex>
+#include <queue>
+#include <thread>
+#include <vector>
+
+namespace CCW::Tula {
+
+    class ThreadPool : public Noncopyable {
+    public:
+        // 0 threads means one per hardware thread.
+        explicit ThreadPool(size_t threadCount = 0);
+
+        ~ThreadPool();
+
+        [[nodiscard]] inline size_t getThreadCount() const {
+            return workers.size();
+        }
+
+        template<typename F>
+        auto submit(F &&task) -> std::future<decltype(task())> {
+            using Result = decltype(task());
+            auto packaged = std::make_shared<std::packaged_task<Result()>>(std::forward<F>(task));
+            auto future = packaged->get_future();
+            {
+                std::lock_guard<std::mutex> _(lock);
+                tasks.emplace([packaged]() { (*packaged)(); });
+            }
+            available.notify_one();
+            return future;
+        }
+
+        // Runs body(i) for every i in [0, count) on the pool and waits for all of them.
+        // The calling thread takes part, so nested use from a worker cannot deadlock.
+        void parallelFor(size_t count, const std::function<void(size_t)> &body);
+
+    private:
+        void run();
+
+    private:
+        std::mutex lock;
+        std::condition_variable available;
+        std::queue<std::function<void()>> tasks;
+        std::vector<std::thread> workers;
+        bool stopping = false;
+    };
+}
@@ -0,0 +1,195 @@
+#include "StackMapTable.hpp"
+#include "../Error.hpp"
+
+#include <algorithm>
+
+namespace CCW::Tula {
+
+    static void pushType(std::vector<VerificationType> &slots, VerificationType type) {
+        slots.push_back(type);
+        if (type.isCategory2()) {
+            slots.push_back(type.secondSlot());
+        }
+    }
+
+    StackMapTable::StackMapTable(const Method &method, ConstantPool &cp,
+                                 const std::vector<VerificationType> &initialLocals) {
+        if (method.getStackMapTableLength() == 0) {
+            return;
+        }
+        const uint8_t *p = method.getStackMapTable();
+        const uint8_t *end = p + method.getStackMapTableLength();
+        auto maxLocals = method.getMaxLocals();
+        auto maxStack = method.getMaxStack();
+        auto codeLength = static_cast<uint16_t>(method.getCodeLength());
+
+        auto ensure = [&p, end](size_t n) {
+            if ((size_t) (end - p) < n) {
+                throw VerifyError("Truncated StackMapTable");
+            }
+        };
+        auto readU2 = [&p, &ensure]() {
+            ensure(2);
+            uint16_t value = uint16_t(p[0]) << 8u | uint16_t(p[1]);
+            p += 2;
+            return value;
+        };
+
+        auto count = readU2();
+        frames.reserve(count);
+
+        // Locals are tracked per type (not per slot) so chop frames can drop whole long/double entries.
+        std::vector<VerificationType> locals;
+        for (size_t i = 0; i < initialLocals.size(); ++i) {
+            locals.push_back(initialLocals[i]);
+            if (initialLocals[i].isCategory2()) {
+                i++;
+            }
+        }
+        std::vector<VerificationType> stack;
+        int32_t previousBci = -1;
+
+        for (int i = 0; i < count; ++i) {
+            ensure(1);
+            uint8_t frameType = *p++;
+            uint16_t offsetDelta;
+            stack.clear();
+            if (frameType < 64) {
+                // same_frame
+                offsetDelta = frameType;
+            } else if (frameType < 128) {
+                // same_locals_1_stack_item_frame
+                offsetDelta = frameType - 64;
+                stack.push_back(readType(p, end, cp, codeLength));
+            } else if (frameType < 247) {
+                throw VerifyError("Reserved StackMapTable frame type " + std::to_string(frameType));
+            } else if (frameType == 247) {
+                offsetDelta = readU2();
+                stack.push_back(readType(p, end, cp, codeLength));
+            } else if (frameType < 251) {
+                // chop_frame
+                offsetDelta = readU2();
+                size_t chop = 251 - frameType;
+                if (chop > locals.size()) {
+                    throw VerifyError("StackMapTable chops more locals than present");
+                }
+                locals.resize(locals.size() - chop);
+            } else if (frameType == 251) {
+                offsetDelta = readU2();
+            } else if (frameType < 255) {
+                // append_frame
+                offsetDelta = readU2();
+                for (int k = 0; k < frameType - 251; ++k) {
+                    locals.push_back(readType(p, end, cp, codeLength));
+                }
+            } else {
+                // full_frame
+                offsetDelta = readU2();
+                locals.clear();
+                auto localCount = readU2();
+                for (int k = 0; k < localCount; ++k) {
+                    locals.push_back(readType(p, end, cp, codeLength));
+                }
+                auto stackCount = readU2();
+                for (int k = 0; k < stackCount; ++k) {
+                    stack.push_back(readType(p, end, cp, codeLength));
+                }
+            }
+
+            int32_t bci = previousBci < 0 ? offsetDelta : previousBci + offsetDelta + 1;
+            if (bci >= codeLength) {
+                throw VerifyError("StackMapTable frame at " + std::to_string(bci) + " is past the code end");
+            }
+            previousBci = bci;
+
+            std::vector<VerificationType> localSlots;
+            for (const auto &type : locals) {
+                pushType(localSlots, type);
+            }
+            std::vector<VerificationType> stackSlots;
+            for (const auto &type : stack) {
+                pushType(stackSlots, type);
+            }
+            if (localSlots.size() > maxLocals) {
+                throw VerifyError("StackMapTable frame at " + std::to_string(bci) + " exceeds max locals");
+            }
+            if (stackSlots.size() > maxStack) {
+                throw VerifyError("StackMapTable frame at " + std::to_string(bci) + " exceeds max stack");
+            }
+            addFrame(static_cast<uint16_t>(bci), localSlots, stackSlots);
+        }
+        if (p != end) {
+            throw VerifyError("Extra bytes in StackMapTable");
+        }
+    }
+
+    VerificationType StackMapTable::readType(const uint8_t *&p, const uint8_t *end, ConstantPool &cp,
+                                             uint16_t codeLength) {
+        if (p >= end) {
+            throw VerifyError("Truncated StackMapTable");
+        }
+        uint8_t tag = *p++;
+        switch (tag) {
+            case 0:
+                return VerificationType::top();
+            case 1:
+                return VerificationType::integer();
+            case 2:
+                return VerificationType::floatType();
+            case 3:
+                return VerificationType::doubleType();
+            case 4:
+                return VerificationType::longType();
+            case 5:
+                return VerificationType::null();
+            case 6:
+                return VerificationType::uninitializedThis();
+            case 7:
+            case 8: {
+                if (end - p < 2) {
+                    throw VerifyError("Truncated StackMapTable");
+                }
+                uint16_t value = uint16_t(p[0]) << 8u | uint16_t(p[1]);
+                p += 2;
+                if (tag == 8) {
+                    if (value >= codeLength) {
+                        throw VerifyError("Uninitialized type offset " + std::to_string(value) + " is out of code");
+                    }
+                    return VerificationType::uninitialized(value);
+                }
+                if (!cp.isValidIndex(value) || !cp.getTagAt(value).isClassOrUnresolvedClass()) {
+                    throw VerifyError("Invalid class index " + std::to_string(value) + " in StackMapTable");
+                }
+                // Class entries hold the interned name symbol, so the pointer is canonical.
+                return VerificationType::object(cp.getClassAt(value).getUnresolvedClassName().get());
+            }
+            default:
+                throw VerifyError("Invalid verification type tag " + std::to_string(tag));
+        }
+    }
+
+    void StackMapTable::addFrame(uint16_t bci, const std::vector<VerificationType> &locals,
+                                 const std::vector<VerificationType> &stack) {
+        // Trailing Top locals are implicit.
+        auto localsSize = locals.size();
+        while (localsSize > 0 && locals[localsSize - 1] == VerificationType::top()) {
+            localsSize--;
+        }
+        bool flagThisUninit = std::find(locals.begin(), locals.begin() + localsSize,
+                                        VerificationType::uninitializedThis()) != locals.begin() + localsSize;
+        frames.push_back(StackMapFrame{bci, static_cast<uint16_t>(localsSize), static_cast<uint16_t>(stack.size()),
+                                       flagThisUninit, static_cast<uint32_t>(types.size())});
+        types.insert(types.end(), locals.begin(), locals.begin() + localsSize);
+        types.insert(types.end(), stack.begin(), stack.end());
+    }
+
+    const StackMapFrame *StackMapTable::frameAt(uint16_t bci) const {
+        auto found = std::lower_bound(frames.begin(), frames.end(), bci, [](const StackMapFrame &frame, uint16_t bci) {
+            return frame.bci < bci;
+        });
+        if (found != frames.end() && found->bci == bci) {
+            return &*found;
+        }
+        return nullptr;
+    }
+}
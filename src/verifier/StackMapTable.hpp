@@ -0,0 +1,53 @@
+#pragma once
+
+#include "VerificationType.hpp"
+#include "../ConstantPool.hpp"
+#include "../Method.hpp"
+
+#include <vector>
+
+namespace CCW::Tula {
+
+    struct StackMapFrame {
+        uint16_t bci;
+        uint16_t localsSize;        // slots after this are Top
+        uint16_t stackSize;
+        bool flagThisUninit;
+        uint32_t typesOffset;       // locals, then stack, in StackMapTable::types
+    };
+
+    // The StackMapTable of one method decoded into absolute bcis and fully expanded frames.
+    // All frames share one type array, so walking them in bci order is a linear scan.
+    class StackMapTable : public Noncopyable {
+    public:
+        // Decodes the method's StackMapTable relative to `initialLocals`, the frame implied by the descriptor.
+        // Throws VerifyError on malformed frames.
+        StackMapTable(const Method &method, ConstantPool &cp, const std::vector<VerificationType> &initialLocals);
+
+        [[nodiscard]] inline const std::vector<StackMapFrame> &getFrames() const {
+            return frames;
+        }
+
+        [[nodiscard]] inline const VerificationType *localsOf(const StackMapFrame &frame) const {
+            return types.data() + frame.typesOffset;
+        }
+
+        [[nodiscard]] inline const VerificationType *stackOf(const StackMapFrame &frame) const {
+            return types.data() + frame.typesOffset + frame.localsSize;
+        }
+
+        // Frame at exactly `bci`, or nullptr.
+        [[nodiscard]] const StackMapFrame *frameAt(uint16_t bci) const;
+
+    private:
+        static VerificationType readType(const uint8_t *&p, const uint8_t *end, ConstantPool &cp,
+                                         uint16_t codeLength);
+
+        void addFrame(uint16_t bci, const std::vector<VerificationType> &locals,
+                      const std::vector<VerificationType> &stack);
+
+    private:
+        std::vector<StackMapFrame> frames;
+        std::vector<VerificationType> types;
+    };
+}
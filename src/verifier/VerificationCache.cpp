@@ -0,0 +1,127 @@
+#include "VerificationCache.hpp"
+
+#include <fstream>
+#include <mutex>
+
+namespace CCW::Tula {
+
+    static constexpr char ArchiveMagic[8] = {'T', 'U', 'L', 'A', 'V', 'C', '0', '3'};
+    static constexpr uint64_t MaxArchiveEntries = 1u << 24u;
+
+    VerificationCache::Digest VerificationCache::digest(const uint8_t *bytes, size_t len) {
+        return Sha256::of(bytes, len);
+    }
+
+    bool VerificationCache::contains(Digest digest) const {
+        std::shared_lock<std::shared_timed_mutex> _{mutex};
+        return verified.find(digest) != verified.end();
+    }
+
+    bool VerificationCache::find(Digest digest, std::vector<Assumption> &assumptions) const {
+        std::shared_lock<std::shared_timed_mutex> _{mutex};
+        auto it = verified.find(digest);
+        if (it == verified.end()) {
+            return false;
+        }
+        assumptions = it->second;
+        return true;
+    }
+
+    void VerificationCache::add(Digest digest, std::vector<Assumption> assumptions) {
+        if (assumptions.size() > MaxAssumptions) {
+            return;
+        }
+        std::unique_lock<std::shared_timed_mutex> _{mutex};
+        verified[digest] = std::move(assumptions);
+    }
+
+    size_t VerificationCache::size() const {
+        std::shared_lock<std::shared_timed_mutex> _{mutex};
+        return verified.size();
+    }
+
+    template<typename T>
+    static bool readValue(std::istream &in, T &value) {
+        return static_cast<bool>(in.read(reinterpret_cast<char *>(&value), sizeof(value)));
+    }
+
+    template<typename T>
+    static void writeValue(std::ostream &out, const T &value) {
+        out.write(reinterpret_cast<const char *>(&value), sizeof(value));
+    }
+
+    static bool readName(std::istream &in, std::string &name) {
+        uint16_t length;
+        if (!readValue(in, length)) {
+            return false;
+        }
+        name.resize(length);
+        return static_cast<bool>(in.read(&name[0], length));
+    }
+
+    static void writeName(std::ostream &out, const std::string &name) {
+        writeValue(out, static_cast<uint16_t>(name.size()));
+        out.write(name.data(), static_cast<std::streamsize>(name.size()));
+    }
+
+    bool VerificationCache::load(const std::string &path) {
+        std::ifstream f(path, std::ios::binary);
+        if (!f.is_open()) {
+            return false;
+        }
+        char magic[sizeof(ArchiveMagic)];
+        uint64_t count = 0;
+        f.read(magic, sizeof(magic));
+        if (!f || memcmp(magic, ArchiveMagic, sizeof(magic)) != 0 || !readValue(f, count)
+            || count > MaxArchiveEntries) {
+            return false;
+        }
+        // Each entry: the digest, the number of assumptions, then per assumption whether it held and the
+        // target and source names, each a u2 length and its bytes.
+        std::vector<std::pair<Digest, std::vector<Assumption>>> entries(count);
+        for (auto &entry : entries) {
+            uint32_t assumptions;
+            if (!readValue(f, entry.first) || !readValue(f, assumptions) || assumptions > MaxAssumptions) {
+                return false;
+            }
+            entry.second.resize(assumptions);
+            for (auto &assumption : entry.second) {
+                uint8_t assignable;
+                if (!readValue(f, assignable) || assignable > 1 || !readName(f, assumption.target)
+                    || !readName(f, assumption.source)) {
+                    return false;
+                }
+                assumption.assignable = assignable != 0;
+            }
+        }
+        std::unique_lock<std::shared_timed_mutex> _{mutex};
+        for (auto &entry : entries) {
+            verified[entry.first] = std::move(entry.second);
+        }
+        return true;
+    }
+
+    bool VerificationCache::save(const std::string &path) const {
+        std::vector<std::pair<Digest, std::vector<Assumption>>> entries;
+        {
+            std::shared_lock<std::shared_timed_mutex> _{mutex};
+            entries.assign(verified.begin(), verified.end());
+        }
+        std::ofstream f(path, std::ios::binary | std::ios::trunc);
+        if (!f.is_open()) {
+            return false;
+        }
+        f.write(ArchiveMagic, sizeof(ArchiveMagic));
+        writeValue(f, static_cast<uint64_t>(entries.size()));
+        for (const auto &entry : entries) {
+            writeValue(f, entry.first);
+            writeValue(f, static_cast<uint32_t>(entry.second.size()));
+            for (const auto &assumption : entry.second) {
+                writeValue(f, static_cast<uint8_t>(assumption.assignable));
+                writeName(f, assumption.target);
+                writeName(f, assumption.source);
+            }
+        }
+        return static_cast<bool>(f);
+    }
+}
@@ -0,0 +1,70 @@
+#pragma once
+
+#include "../utils/Sha256.hpp"
+
+#include <CCW/Base.hpp>
+
+#include <cstdint>
+#include <cstring>
+#include <shared_mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace CCW::Tula {
+
+    // Class files that already passed verification, keyed by the SHA-256 of their bytes.
+    // It can be saved to and loaded from a startup archive so that unchanged classes skip verification
+    // on the next run. A class file crafted to collide with a verified one would need a SHA-256
+    // collision; the archive itself must still come from a trusted place.
+    //
+    // Verification also depends on the class hierarchy the assignability checks walked, which lives in
+    // other class files. Each entry keeps the answers it relied on, and is only good while the class
+    // path still gives the same ones.
+    class VerificationCache : public Noncopyable {
+    public:
+        using Digest = Sha256::Digest;
+
+        // Verifications relying on more assumptions are not kept.
+        static constexpr uint32_t MaxAssumptions = 1u << 16u;
+
+        // One assignability check a verification relied on: whether `source` was assignable to `target`.
+        struct Assumption {
+            std::string target;
+            std::string source;
+            bool assignable;
+
+            inline bool operator==(const Assumption &other) const {
+                return assignable == other.assignable && target == other.target && source == other.source;
+            }
+        };
+
+        static Digest digest(const uint8_t *bytes, size_t len);
+
+        [[nodiscard]] bool contains(Digest digest) const;
+
+        // The assumptions the class file with `digest` was verified under; false when it never was.
+        bool find(Digest digest, std::vector<Assumption> &assumptions) const;
+
+        void add(Digest digest, std::vector<Assumption> assumptions = {});
+
+        [[nodiscard]] size_t size() const;
+
+        // Merges the entries stored at `path`. Returns false when the file is missing or malformed.
+        bool load(const std::string &path);
+
+        bool save(const std::string &path) const;
+
+    private:
+        struct DigestHash {
+            size_t operator()(const Digest &digest) const {
+                size_t hash;
+                memcpy(&hash, digest.data(), sizeof(hash));
+                return hash;
+            }
+        };
+
+        mutable std::shared_timed_mutex mutex;
+        std::unordered_map<Digest, std::vector<Assumption>, DigestHash> verified;
+    };
+}
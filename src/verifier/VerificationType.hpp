@@ -0,0 +1,119 @@
+#pragma once
+
+#include "../Symbol.hpp"
+
+#include <cstdint>
+
+namespace CCW::Tula {
+
+    // A verification type of JVMS 4.10.1.2. Reference types carry their interned class name, so two
+    // types are equal when tag, name pointer and allocation bci are.
+    class VerificationType {
+    public:
+        enum class Tag : uint8_t {
+            Top,
+            Integer,
+            Float,
+            Long,
+            Double,
+            Long2,              // second slot of a long
+            Double2,            // second slot of a double
+            Null,
+            UninitializedThis,
+            Uninitialized,      // result of `new` at `bci`, before its <init> ran
+            Object              // class or array type named by `name`
+        };
+
+        constexpr VerificationType() : tag(Tag::Top), bci(0), name(nullptr) {}
+
+        static constexpr VerificationType top() {
+            return VerificationType(Tag::Top);
+        }
+
+        static constexpr VerificationType integer() {
+            return VerificationType(Tag::Integer);
+        }
+
+        static constexpr VerificationType floatType() {
+            return VerificationType(Tag::Float);
+        }
+
+        static constexpr VerificationType longType() {
+            return VerificationType(Tag::Long);
+        }
+
+        static constexpr VerificationType doubleType() {
+            return VerificationType(Tag::Double);
+        }
+
+        static constexpr VerificationType null() {
+            return VerificationType(Tag::Null);
+        }
+
+        static constexpr VerificationType uninitializedThis() {
+            return VerificationType(Tag::UninitializedThis);
+        }
+
+        static constexpr VerificationType uninitialized(uint16_t bci) {
+            return VerificationType(Tag::Uninitialized, bci, nullptr);
+        }
+
+        static constexpr VerificationType object(const Symbol *name) {
+            return VerificationType(Tag::Object, 0, name);
+        }
+
+        [[nodiscard]] inline Tag getTag() const {
+            return tag;
+        }
+
+        [[nodiscard]] inline uint16_t getBci() const {
+            return bci;
+        }
+
+        [[nodiscard]] inline const Symbol *getName() const {
+            return name;
+        }
+
+        [[nodiscard]] inline bool isCategory2() const {
+            return tag == Tag::Long || tag == Tag::Double;
+        }
+
+        [[nodiscard]] inline bool isCategory2Second() const {
+            return tag == Tag::Long2 || tag == Tag::Double2;
+        }
+
+        [[nodiscard]] inline bool isReference() const {
+            return tag == Tag::Null || tag == Tag::Object || isUninitialized();
+        }
+
+        [[nodiscard]] inline bool isUninitialized() const {
+            return tag == Tag::Uninitialized || tag == Tag::UninitializedThis;
+        }
+
+        [[nodiscard]] inline bool isArray() const {
+            return tag == Tag::Object && name->getLength() > 0 && name->getBytes()[0] == '[';
+        }
+
+        // The type of the second slot of a category 2 type.
+        [[nodiscard]] inline VerificationType secondSlot() const {
+            return VerificationType(tag == Tag::Long ? Tag::Long2 : Tag::Double2);
+        }
+
+        bool operator==(const VerificationType &rhs) const {
+            return tag == rhs.tag && bci == rhs.bci && name == rhs.name;
+        }
+
+        bool operator!=(const VerificationType &rhs) const {
+            return !(rhs == *this);
+        }
+
+    private:
+        explicit constexpr VerificationType(Tag tag, uint16_t bci = 0, const Symbol *name = nullptr) :
+            tag(tag), bci(bci), name(name) {}
+
+    private:
+        Tag tag;
+        uint16_t bci;
+        const Symbol *name;
+    };
+}
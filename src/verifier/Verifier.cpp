@@ -0,0 +1,1491 @@
+#include "Verifier.hpp"
+#include "StackMapTable.hpp"
+#include "../Bytecodes.hpp"
+#include "../Error.hpp"
+#include "../SymbolTable.hpp"
+#include "../classfile/Descriptor.hpp"
+
+#include <algorithm>
+#include <mutex>
+
+namespace CCW::Tula {
+
+    static constexpr uint16_t TypeCheckingMinVersion = 50;
+    static constexpr uint16_t InterfaceMethodrefSpecialVersion = 52;
+
+    // Class names the verifier builds types from, interned once per Verifier.
+    struct VerifierNames {
+        SymbolPtr object;
+        SymbolPtr string;
+        SymbolPtr clazz;
+        SymbolPtr throwable;
+        SymbolPtr cloneable;
+        SymbolPtr serializable;
+        SymbolPtr methodType;
+        SymbolPtr methodHandle;
+        SymbolPtr init;
+        SymbolPtr intArray;
+        SymbolPtr longArray;
+        SymbolPtr floatArray;
+        SymbolPtr doubleArray;
+        SymbolPtr byteArray;
+        SymbolPtr booleanArray;
+        SymbolPtr charArray;
+        SymbolPtr shortArray;
+
+        VerifierNames() :
+            object(SymbolTable::intern("java/lang/Object")),
+            string(SymbolTable::intern("java/lang/String")),
+            clazz(SymbolTable::intern("java/lang/Class")),
+            throwable(SymbolTable::intern("java/lang/Throwable")),
+            cloneable(SymbolTable::intern("java/lang/Cloneable")),
+            serializable(SymbolTable::intern("java/io/Serializable")),
+            methodType(SymbolTable::intern("java/lang/invoke/MethodType")),
+            methodHandle(SymbolTable::intern("java/lang/invoke/MethodHandle")),
+            init(SymbolTable::intern("<init>")),
+            intArray(SymbolTable::intern("[I")),
+            longArray(SymbolTable::intern("[J")),
+            floatArray(SymbolTable::intern("[F")),
+            doubleArray(SymbolTable::intern("[D")),
+            byteArray(SymbolTable::intern("[B")),
+            booleanArray(SymbolTable::intern("[Z")),
+            charArray(SymbolTable::intern("[C")),
+            shortArray(SymbolTable::intern("[S")) {
+        }
+    };
+
+    struct HandlerInfo {
+        uint16_t startPc;
+        uint16_t endPc;
+        const StackMapFrame *frame;
+        VerificationType catchType;
+    };
+
+    class MethodVerifier {
+    public:
+        MethodVerifier(const InstanceKlass &klass, const Method &method, const VerifierNames &names,
+                       const Verifier::AssignabilityCheck &check) :
+            klass(klass),
+            method(method),
+            cp(*klass.getConstantPool()),
+            names(names),
+            check(check),
+            code(method.getCode()),
+            codeLength(method.getCodeLength()),
+            maxLocals(method.getMaxLocals()),
+            maxStack(method.getMaxStack()) {
+        }
+
+        void verify() {
+            computeInstructionStarts();
+            auto initialLocals = buildInitialFrame();
+            StackMapTable stackMap(method, cp, initialLocals);
+            this->stackMap = &stackMap;
+            for (const auto &frame : stackMap.getFrames()) {
+                if (!instructionStarts[frame.bci]) {
+                    bci = frame.bci;
+                    fail("StackMapTable frame is not at an instruction boundary");
+                }
+            }
+            collectHandlers();
+            parseReturnType();
+
+            const auto &frames = stackMap.getFrames();
+            size_t frameCursor = 0;
+            bool fallsThrough = true;
+            for (bci = 0; bci < codeLength; bci = nextBci) {
+                nextBci = bci + Bytecodes::length(code, bci, codeLength);
+                if (frameCursor < frames.size() && frames[frameCursor].bci == bci) {
+                    const auto &frame = frames[frameCursor++];
+                    if (fallsThrough) {
+                        checkAssignableToFrame(frame, stack.data(), stack.size(), "fall through");
+                    }
+                    loadFrame(frame);
+                } else if (!fallsThrough) {
+                    fail("Expecting a stackmap frame after an unconditional branch");
+                }
+                checkHandlers();
+                localsModified = false;
+                fallsThrough = execute();
+                if (localsModified) {
+                    checkHandlers();
+                }
+            }
+            if (fallsThrough) {
+                fail("Falling off the end of the code");
+            }
+        }
+
+    private:
+        [[noreturn]] void fail(const std::string &message) const {
+            throw VerifyError(message + " at bci " + std::to_string(bci));
+        }
+
+        // Decoding
+
+        void computeInstructionStarts() {
+            instructionStarts.assign(codeLength, false);
+            for (uint32_t i = 0; i < codeLength;) {
+                auto len = Bytecodes::length(code, i, codeLength);
+                if (len == 0) {
+                    bci = i;
+                    fail("Illegal or truncated instruction");
+                }
+                instructionStarts[i] = true;
+                i += len;
+            }
+        }
+
+        std::vector<VerificationType> buildInitialFrame() {
+            locals.assign(maxLocals, VerificationType::top());
+            stack.clear();
+            stack.reserve(maxStack);
+            std::vector<VerificationType> initial;
+            if (!method.isStatic()) {
+                if (method.isInitializer() && klass.getSuperClassName() != nullptr) {
+                    initial.push_back(VerificationType::uninitializedThis());
+                    flagThisUninit = true;
+                } else {
+                    initial.push_back(VerificationType::object(klass.getName().get()));
+                }
+            }
+            const auto &descriptor = method.descriptor();
+            const uint8_t *p = descriptor->getBytes() + 1;
+            const uint8_t *end = descriptor->getBytes() + descriptor->getLength();
+            while (*p != ')') {
+                auto len = Descriptor::fieldTypeLength(p, end - p);
+                auto type = typeOf(p, len);
+                initial.push_back(type);
+                if (type.isCategory2()) {
+                    initial.push_back(type.secondSlot());
+                }
+                p += len;
+            }
+            if (initial.size() > maxLocals) {
+                fail("Arguments can't fit into locals");
+            }
+            std::copy(initial.begin(), initial.end(), locals.begin());
+            return initial;
+        }
+
+        void parseReturnType() {
+            const auto &descriptor = method.descriptor();
+            const uint8_t *bytes = descriptor->getBytes();
+            size_t len = descriptor->getLength();
+            auto close = std::find(bytes, bytes + len, ')') + 1;
+            returnsVoid = *close == 'V';
+            if (!returnsVoid) {
+                returnType = typeOf(close, bytes + len - close);
+            }
+        }
+
+        void collectHandlers() {
+            auto table = method.getExceptionTable();
+            for (int i = 0; i < method.getExceptionTableLength(); ++i) {
+                const auto &element = table[i];
+                bci = element.handlerPc;
+                if (!instructionStarts[element.startPc]
+                    || (element.endPc < codeLength && !instructionStarts[element.endPc])) {
+                    fail("Exception handler range is not at instruction boundaries");
+                }
+                if (!instructionStarts[element.handlerPc]) {
+                    fail("Exception handler is not at an instruction boundary");
+                }
+                auto frame = stackMap->frameAt(element.handlerPc);
+                if (frame == nullptr) {
+                    fail("Expecting a stackmap frame at exception handler");
+                }
+                auto catchType = VerificationType::object(names.throwable.get());
+                if (element.catchTypeIndex != 0) {
+                    catchType = VerificationType::object(classNameAt(element.catchTypeIndex));
+                    if (!isAssignable(VerificationType::object(names.throwable.get()), catchType)) {
+                        fail("Catch type is not a subclass of Throwable");
+                    }
+                }
+                handlers.push_back(HandlerInfo{element.startPc, element.endPc, frame, catchType});
+            }
+        }
+
+        // Types
+
+        VerificationType typeOf(const uint8_t *p, size_t len) const {
+            switch (p[0]) {
+                case 'B':
+                case 'C':
+                case 'I':
+                case 'S':
+                case 'Z':
+                    return VerificationType::integer();
+                case 'F':
+                    return VerificationType::floatType();
+                case 'J':
+                    return VerificationType::longType();
+                case 'D':
+                    return VerificationType::doubleType();
+                case 'L':
+                    return VerificationType::object(intern(p + 1, len - 2));
+                default:
+                    return VerificationType::object(intern(p, len));
+            }
+        }
+
+        // Types only hold the name, so the symbols interned for them are kept until the method is verified.
+        const Symbol *intern(const uint8_t *bytes, size_t len) const {
+            interned.push_back(SymbolTable::intern(bytes, len));
+            return interned.back().get();
+        }
+
+        static bool isArrayName(const Symbol *name) {
+            return name->getLength() > 1 && name->getBytes()[0] == '[';
+        }
+
+        bool isAssignable(const VerificationType &target, const VerificationType &source) const {
+            if (target == source) {
+                return true;
+            }
+            switch (target.getTag()) {
+                case VerificationType::Tag::Top:
+                    return true;
+                case VerificationType::Tag::Object:
+                    if (source.getTag() == VerificationType::Tag::Null) {
+                        return true;
+                    }
+                    return source.getTag() == VerificationType::Tag::Object
+                           && isAssignableName(target.getName(), source.getName());
+                default:
+                    return false;
+            }
+        }
+
+        bool isAssignableName(const Symbol *target, const Symbol *source) const {
+            if (target == source || target == names.object.get()) {
+                return true;
+            }
+            bool targetArray = isArrayName(target);
+            bool sourceArray = isArrayName(source);
+            if (targetArray) {
+                if (!sourceArray) {
+                    return false;
+                }
+                // Identical primitive components would have matched by identity above.
+                auto targetComponent = target->getBytes()[1];
+                auto sourceComponent = source->getBytes()[1];
+                bool targetReference = targetComponent == 'L' || targetComponent == '[';
+                bool sourceReference = sourceComponent == 'L' || sourceComponent == '[';
+                if (!targetReference || !sourceReference) {
+                    return false;
+                }
+                return isAssignableName(componentName(target), componentName(source));
+            }
+            if (sourceArray) {
+                return target == names.cloneable.get() || target == names.serializable.get();
+            }
+            // Class types need the hierarchy; without a check to walk it nothing else is assignable.
+            return check && check(target, source);
+        }
+
+        const Symbol *componentName(const Symbol *arrayName) const {
+            auto bytes = arrayName->getBytes();
+            auto len = arrayName->getLength();
+            if (bytes[1] == 'L') {
+                return intern(bytes + 2, len - 3);
+            }
+            return intern(bytes + 1, len - 1);
+        }
+
+        const Symbol *classNameAt(uint16_t index) const {
+            if (!cp.isValidIndex(index) || !cp.getTagAt(index).isClassOrUnresolvedClass()) {
+                fail("Expecting a class constant at " + std::to_string(index));
+            }
+            // Class entries hold the interned name symbol.
+            return cp.getClassAt(index).getUnresolvedClassName().get();
+        }
+
+        // Frames
+
+        void loadFrame(const StackMapFrame &frame) {
+            auto frameLocals = stackMap->localsOf(frame);
+            std::copy(frameLocals, frameLocals + frame.localsSize, locals.begin());
+            std::fill(locals.begin() + frame.localsSize, locals.end(), VerificationType::top());
+            auto frameStack = stackMap->stackOf(frame);
+            stack.assign(frameStack, frameStack + frame.stackSize);
+            flagThisUninit = frame.flagThisUninit;
+        }
+
+        void checkAssignableToFrame(const StackMapFrame &frame, const VerificationType *stackTypes, size_t stackSize,
+                                    const char *what) const {
+            auto frameLocals = stackMap->localsOf(frame);
+            for (uint16_t i = 0; i < maxLocals; ++i) {
+                auto target = i < frame.localsSize ? frameLocals[i] : VerificationType::top();
+                if (!isAssignable(target, locals[i])) {
+                    fail(std::string("Bad local ") + std::to_string(i) + " for stackmap frame at "
+                         + std::to_string(frame.bci) + " (" + what + ")");
+                }
+            }
+            if (stackSize != frame.stackSize) {
+                fail(std::string("Inconsistent stack height for stackmap frame at ") + std::to_string(frame.bci)
+                     + " (" + what + ")");
+            }
+            auto frameStack = stackMap->stackOf(frame);
+            for (size_t i = 0; i < stackSize; ++i) {
+                if (!isAssignable(frameStack[i], stackTypes[i])) {
+                    fail(std::string("Bad operand stack for stackmap frame at ") + std::to_string(frame.bci)
+                         + " (" + what + ")");
+                }
+            }
+            if (flagThisUninit && !frame.flagThisUninit) {
+                fail(std::string("Uninitialized this escapes to stackmap frame at ") + std::to_string(frame.bci));
+            }
+        }
+
+        void checkBranch(int64_t target) {
+            if (target < 0 || target >= codeLength || !instructionStarts[target]) {
+                fail("Illegal branch target " + std::to_string(target));
+            }
+            auto frame = stackMap->frameAt(static_cast<uint16_t>(target));
+            if (frame == nullptr) {
+                fail("Expecting a stackmap frame at branch target " + std::to_string(target));
+            }
+            checkAssignableToFrame(*frame, stack.data(), stack.size(), "branch");
+        }
+
+        void checkHandlers() const {
+            for (const auto &handler : handlers) {
+                if (bci >= handler.startPc && bci < handler.endPc) {
+                    checkAssignableToFrame(*handler.frame, &handler.catchType, 1, "exception handler");
+                }
+            }
+        }
+
+        // Operand stack and locals
+
+        void push(VerificationType type) {
+            size_t slots = type.isCategory2() ? 2 : 1;
+            if (stack.size() + slots > maxStack) {
+                fail("Operand stack overflow");
+            }
+            stack.push_back(type);
+            if (type.isCategory2()) {
+                stack.push_back(type.secondSlot());
+            }
+        }
+
+        VerificationType popSlot() {
+            if (stack.empty()) {
+                fail("Operand stack underflow");
+            }
+            auto type = stack.back();
+            stack.pop_back();
+            return type;
+        }
+
+        VerificationType pop(VerificationType expected) {
+            if (expected.isCategory2()) {
+                auto second = popSlot();
+                auto first = popSlot();
+                if (first != expected || second != expected.secondSlot()) {
+                    fail("Bad type on operand stack");
+                }
+                return first;
+            }
+            auto actual = popSlot();
+            if (!isAssignable(expected, actual)) {
+                fail("Bad type on operand stack");
+            }
+            return actual;
+        }
+
+        VerificationType popReference() {
+            auto type = popSlot();
+            if (!type.isReference()) {
+                fail("Expecting a reference on operand stack");
+            }
+            return type;
+        }
+
+        VerificationType popObject() {
+            return pop(VerificationType::object(names.object.get()));
+        }
+
+        // The top `depth` slots must start at a value boundary, so dup/swap never split a long or double.
+        void checkStackBoundary(size_t depth) const {
+            if (stack.size() < depth) {
+                fail("Operand stack underflow");
+            }
+            if (stack[stack.size() - depth].isCategory2Second()) {
+                fail("Splitting a category 2 value on operand stack");
+            }
+        }
+
+        // Moves the top `top` slots below the next `below` slots, keeping a copy on top.
+        void duplicate(size_t top, size_t below) {
+            checkStackBoundary(top);
+            if (below != 0) {
+                checkStackBoundary(top + below);
+            }
+            if (stack.size() + top > maxStack) {
+                fail("Operand stack overflow");
+            }
+            auto position = stack.end() - top - below;
+            std::vector<VerificationType> copy(stack.end() - top, stack.end());
+            stack.insert(position, copy.begin(), copy.end());
+        }
+
+        VerificationType loadLocal(uint32_t index, VerificationType expected) {
+            if (index + (expected.isCategory2() ? 1 : 0) >= maxLocals) {
+                fail("Illegal local variable index " + std::to_string(index));
+            }
+            if (expected.isCategory2()) {
+                if (locals[index] != expected || locals[index + 1] != expected.secondSlot()) {
+                    fail("Bad local variable type at " + std::to_string(index));
+                }
+                return expected;
+            }
+            if (!isAssignable(expected, locals[index])) {
+                fail("Bad local variable type at " + std::to_string(index));
+            }
+            return locals[index];
+        }
+
+        VerificationType loadReference(uint32_t index) {
+            if (index >= maxLocals) {
+                fail("Illegal local variable index " + std::to_string(index));
+            }
+            if (!locals[index].isReference()) {
+                fail("Expecting a reference in local " + std::to_string(index));
+            }
+            return locals[index];
+        }
+
+        void storeLocal(uint32_t index, VerificationType type) {
+            uint32_t slots = type.isCategory2() ? 2 : 1;
+            if (index + slots > maxLocals) {
+                fail("Illegal local variable index " + std::to_string(index));
+            }
+            if (index > 0 && locals[index - 1].isCategory2()) {
+                locals[index - 1] = VerificationType::top();
+            }
+            if (index + slots < maxLocals && locals[index + slots].isCategory2Second()) {
+                locals[index + slots] = VerificationType::top();
+            }
+            locals[index] = type;
+            if (type.isCategory2()) {
+                locals[index + 1] = type.secondSlot();
+            }
+            localsModified = true;
+        }
+
+        void load(uint32_t index, VerificationType type) {
+            push(loadLocal(index, type));
+        }
+
+        void store(uint32_t index, VerificationType type) {
+            storeLocal(index, pop(type));
+        }
+
+        void replaceUninitialized(const VerificationType &from, const VerificationType &to) {
+            std::replace(locals.begin(), locals.end(), from, to);
+            std::replace(stack.begin(), stack.end(), from, to);
+        }
+
+        // Arrays
+
+        void arrayLoad(const SymbolPtr &arrayName, const SymbolPtr &alternative, VerificationType element) {
+            pop(VerificationType::integer());
+            auto array = popReference();
+            if (array.getTag() != VerificationType::Tag::Null && array.getName() != arrayName.get()
+                && (alternative == nullptr || array.getName() != alternative.get())) {
+                fail("Bad array type for array load");
+            }
+            push(element);
+        }
+
+        void arrayStore(const SymbolPtr &arrayName, const SymbolPtr &alternative, VerificationType element) {
+            pop(element);
+            pop(VerificationType::integer());
+            auto array = popReference();
+            if (array.getTag() != VerificationType::Tag::Null && array.getName() != arrayName.get()
+                && (alternative == nullptr || array.getName() != alternative.get())) {
+                fail("Bad array type for array store");
+            }
+        }
+
+        static bool isReferenceArray(const VerificationType &type) {
+            if (!type.isArray()) {
+                return false;
+            }
+            auto component = type.getName()->getBytes()[1];
+            return component == 'L' || component == '[';
+        }
+
+        VerificationType arrayOf(const Symbol *component) const {
+            std::string name = "[";
+            if (isArrayName(component)) {
+                name.append(reinterpret_cast<const char *>(component->getBytes()), component->getLength());
+            } else {
+                name += 'L';
+                name.append(reinterpret_cast<const char *>(component->getBytes()), component->getLength());
+                name += ';';
+            }
+            return VerificationType::object(intern(reinterpret_cast<const uint8_t *>(name.data()), name.size()));
+        }
+
+        // Members
+
+        struct MemberRef {
+            const Symbol *className;
+            const Symbol *name;
+            const Symbol *descriptor;
+        };
+
+        MemberRef memberRefAt(uint16_t index) const {
+            MemberRef ref{};
+            ref.className = classNameAt(cp.getRefClassIndexAt(index));
+            auto nameAndType = cp.getRefNameAndTypeIndexAt(index);
+            ref.name = cp.getSymbolAt(cp.getNameAndTypeNameIndexAt(nameAndType)).get();
+            ref.descriptor = cp.getSymbolAt(cp.getNameAndTypeDescriptorIndexAt(nameAndType)).get();
+            return ref;
+        }
+
+        void fieldInstruction(Bytecode opcode, uint16_t index) {
+            if (!cp.isValidIndex(index) || cp.getConstantTypeAt(index) != ConstantType::Fieldref) {
+                fail("Expecting a field reference");
+            }
+            auto ref = memberRefAt(index);
+            if (!Descriptor::isValidField(ref.descriptor->getBytes(), ref.descriptor->getLength())) {
+                fail("Invalid field descriptor");
+            }
+            auto fieldType = typeOf(ref.descriptor->getBytes(), ref.descriptor->getLength());
+            auto owner = VerificationType::object(ref.className);
+            switch (opcode) {
+                case Bytecode::_getstatic:
+                    push(fieldType);
+                    break;
+                case Bytecode::_putstatic:
+                    pop(fieldType);
+                    break;
+                case Bytecode::_getfield:
+                    pop(owner);
+                    push(fieldType);
+                    break;
+                default: {
+                    pop(fieldType);
+                    auto receiver = popSlot();
+                    // Constructors may store their own fields before calling the super constructor.
+                    bool initializingThis = receiver == VerificationType::uninitializedThis()
+                                            && ref.className == klass.getName().get();
+                    if (!initializingThis && !isAssignable(owner, receiver)) {
+                        fail("Bad receiver for putfield");
+                    }
+                    break;
+                }
+            }
+        }
+
+        void invokeInstruction(Bytecode opcode, uint16_t index) {
+            const Symbol *className = nullptr;
+            const Symbol *name;
+            const Symbol *descriptor;
+            if (opcode == Bytecode::_invokedynamic) {
+                if (!cp.isValidIndex(index) || cp.getConstantTypeAt(index) != ConstantType::InvokeDynamic) {
+                    fail("Expecting an invokedynamic constant");
+                }
+                if (code[bci + 3] != 0 || code[bci + 4] != 0) {
+                    fail("Non zero invokedynamic operand bytes");
+                }
+                auto nameAndType = cp.getInvokeDynamicNameAndTypeIndexAt(index);
+                name = cp.getSymbolAt(cp.getNameAndTypeNameIndexAt(nameAndType)).get();
+                descriptor = cp.getSymbolAt(cp.getNameAndTypeDescriptorIndexAt(nameAndType)).get();
+            } else {
+                if (!cp.isValidIndex(index)) {
+                    fail("Invalid method reference index");
+                }
+                auto tag = cp.getTagAt(index);
+                bool valid;
+                switch (opcode) {
+                    case Bytecode::_invokevirtual:
+                        valid = tag == ConstantType::Methodref;
+                        break;
+                    case Bytecode::_invokeinterface:
+                        valid = tag == ConstantType::InterfaceMethodref;
+                        break;
+                    default:
+                        valid = tag == ConstantType::Methodref
+                                || (tag == ConstantType::InterfaceMethodref
+                                    && klass.getMajorVersion() >= InterfaceMethodrefSpecialVersion);
+                        break;
+                }
+                if (!valid) {
+                    fail("Bad method reference for invoke instruction");
+                }
+                auto ref = memberRefAt(index);
+                className = ref.className;
+                name = ref.name;
+                descriptor = ref.descriptor;
+            }
+
+            auto bytes = descriptor->getBytes();
+            auto len = descriptor->getLength();
+            int argumentSlots = Descriptor::parameterSlots(bytes, len);
+            if (argumentSlots < 0) {
+                fail("Invalid method descriptor");
+            }
+            bool isInit = name == names.init.get();
+            if (name->getLength() > 0 && name->getBytes()[0] == '<'
+                && !(isInit && opcode == Bytecode::_invokespecial)) {
+                fail("Illegal call to internal method");
+            }
+            if (opcode == Bytecode::_invokeinterface) {
+                if (code[bci + 3] != argumentSlots + 1 || code[bci + 4] != 0) {
+                    fail("Inconsistent invokeinterface count");
+                }
+            }
+
+            // Pop arguments right to left.
+            arguments.clear();
+            const uint8_t *p = bytes + 1;
+            while (*p != ')') {
+                auto typeLen = Descriptor::fieldTypeLength(p, bytes + len - p);
+                arguments.push_back(typeOf(p, typeLen));
+                p += typeLen;
+            }
+            for (auto it = arguments.rbegin(); it != arguments.rend(); ++it) {
+                pop(*it);
+            }
+
+            if (isInit) {
+                if (p[1] != 'V') {
+                    fail("<init> must return void");
+                }
+                auto receiver = popSlot();
+                if (receiver == VerificationType::uninitializedThis()) {
+                    if (className != klass.getName().get() && className != klass.getSuperClassName().get()) {
+                        fail("Bad <init> call on uninitialized this");
+                    }
+                    replaceUninitialized(receiver, VerificationType::object(klass.getName().get()));
+                    flagThisUninit = false;
+                } else if (receiver.getTag() == VerificationType::Tag::Uninitialized) {
+                    auto newBci = receiver.getBci();
+                    if (static_cast<Bytecode>(code[newBci]) != Bytecode::_new) {
+                        fail("Uninitialized type does not refer to a new instruction");
+                    }
+                    auto allocated = classNameAt(Bytecodes::readU2(code + newBci + 1));
+                    if (allocated != className) {
+                        fail("Calling <init> of a different class");
+                    }
+                    replaceUninitialized(receiver, VerificationType::object(allocated));
+                } else {
+                    fail("Expecting an uninitialized object for <init>");
+                }
+                localsModified = true;
+                return;
+            }
+
+            if (opcode == Bytecode::_invokespecial) {
+                pop(VerificationType::object(klass.getName().get()));
+            } else if (opcode == Bytecode::_invokeinterface) {
+                // Interface types are treated as java/lang/Object by the type checker.
+                popObject();
+            } else if (opcode != Bytecode::_invokestatic && opcode != Bytecode::_invokedynamic) {
+                pop(VerificationType::object(className));
+            }
+
+            if (p[1] != 'V') {
+                push(typeOf(p + 1, bytes + len - p - 1));
+            }
+        }
+
+        void ldc(uint16_t index, bool wide) {
+            if (!cp.isValidIndex(index)) {
+                fail("Invalid ldc index");
+            }
+            auto tag = cp.getConstantTypeAt(index);
+            if (wide) {
+                if (tag == ConstantType::Long) {
+                    push(VerificationType::longType());
+                } else if (tag == ConstantType::Double) {
+                    push(VerificationType::doubleType());
+                } else {
+                    fail("Bad ldc2_w constant");
+                }
+                return;
+            }
+            switch (tag) {
+                case ConstantType::Integer:
+                    push(VerificationType::integer());
+                    break;
+                case ConstantType::Float:
+                    push(VerificationType::floatType());
+                    break;
+                case ConstantType::String:
+                    push(VerificationType::object(names.string.get()));
+                    break;
+                case ConstantType::Class:
+                case ConstantType::UnresolvedClass:
+                    push(VerificationType::object(names.clazz.get()));
+                    break;
+                case ConstantType::MethodType:
+                    push(VerificationType::object(names.methodType.get()));
+                    break;
+                case ConstantType::MethodHandle:
+                    push(VerificationType::object(names.methodHandle.get()));
+                    break;
+                default:
+                    fail("Bad ldc constant");
+            }
+        }
+
+        void returnInstruction(VerificationType type) {
+            if (returnsVoid) {
+                fail("Method expects no return value");
+            }
+            if (type.getTag() == VerificationType::Tag::Object) {
+                // areturn: any reference assignable to the declared type.
+                if (returnType.getTag() != VerificationType::Tag::Object) {
+                    fail("Method does not return a reference");
+                }
+                pop(returnType);
+                return;
+            }
+            if (returnType != type) {
+                fail("Bad return type");
+            }
+            pop(type);
+        }
+
+        // Executes the instruction at `bci` on the current frame. Returns whether it can fall through.
+        bool execute() {
+            const uint8_t *bc = code + bci;
+            auto opcode = static_cast<Bytecode>(bc[0]);
+            const auto integer = VerificationType::integer();
+            const auto floatType = VerificationType::floatType();
+            const auto longType = VerificationType::longType();
+            const auto doubleType = VerificationType::doubleType();
+
+            switch (opcode) {
+                case Bytecode::_nop:
+                    break;
+                case Bytecode::_aconst_null:
+                    push(VerificationType::null());
+                    break;
+                case Bytecode::_iconst_m1:
+                case Bytecode::_iconst_0:
+                case Bytecode::_iconst_1:
+                case Bytecode::_iconst_2:
+                case Bytecode::_iconst_3:
+                case Bytecode::_iconst_4:
+                case Bytecode::_iconst_5:
+                case Bytecode::_bipush:
+                case Bytecode::_sipush:
+                    push(integer);
+                    break;
+                case Bytecode::_lconst_0:
+                case Bytecode::_lconst_1:
+                    push(longType);
+                    break;
+                case Bytecode::_fconst_0:
+                case Bytecode::_fconst_1:
+                case Bytecode::_fconst_2:
+                    push(floatType);
+                    break;
+                case Bytecode::_dconst_0:
+                case Bytecode::_dconst_1:
+                    push(doubleType);
+                    break;
+                case Bytecode::_ldc:
+                    ldc(bc[1], false);
+                    break;
+                case Bytecode::_ldc_w:
+                    ldc(Bytecodes::readU2(bc + 1), false);
+                    break;
+                case Bytecode::_ldc2_w:
+                    ldc(Bytecodes::readU2(bc + 1), true);
+                    break;
+
+                case Bytecode::_iload:
+                    load(bc[1], integer);
+                    break;
+                case Bytecode::_lload:
+                    load(bc[1], longType);
+                    break;
+                case Bytecode::_fload:
+                    load(bc[1], floatType);
+                    break;
+                case Bytecode::_dload:
+                    load(bc[1], doubleType);
+                    break;
+                case Bytecode::_aload:
+                    push(loadReference(bc[1]));
+                    break;
+                case Bytecode::_iload_0:
+                case Bytecode::_iload_1:
+                case Bytecode::_iload_2:
+                case Bytecode::_iload_3:
+                    load(bc[0] - (uint8_t) Bytecode::_iload_0, integer);
+                    break;
+                case Bytecode::_lload_0:
+                case Bytecode::_lload_1:
+                case Bytecode::_lload_2:
+                case Bytecode::_lload_3:
+                    load(bc[0] - (uint8_t) Bytecode::_lload_0, longType);
+                    break;
+                case Bytecode::_fload_0:
+                case Bytecode::_fload_1:
+                case Bytecode::_fload_2:
+                case Bytecode::_fload_3:
+                    load(bc[0] - (uint8_t) Bytecode::_fload_0, floatType);
+                    break;
+                case Bytecode::_dload_0:
+                case Bytecode::_dload_1:
+                case Bytecode::_dload_2:
+                case Bytecode::_dload_3:
+                    load(bc[0] - (uint8_t) Bytecode::_dload_0, doubleType);
+                    break;
+                case Bytecode::_aload_0:
+                case Bytecode::_aload_1:
+                case Bytecode::_aload_2:
+                case Bytecode::_aload_3:
+                    push(loadReference(bc[0] - (uint8_t) Bytecode::_aload_0));
+                    break;
+
+                case Bytecode::_iaload:
+                    arrayLoad(names.intArray, nullptr, integer);
+                    break;
+                case Bytecode::_laload:
+                    arrayLoad(names.longArray, nullptr, longType);
+                    break;
+                case Bytecode::_faload:
+                    arrayLoad(names.floatArray, nullptr, floatType);
+                    break;
+                case Bytecode::_daload:
+                    arrayLoad(names.doubleArray, nullptr, doubleType);
+                    break;
+                case Bytecode::_baload:
+                    arrayLoad(names.byteArray, names.booleanArray, integer);
+                    break;
+                case Bytecode::_caload:
+                    arrayLoad(names.charArray, nullptr, integer);
+                    break;
+                case Bytecode::_saload:
+                    arrayLoad(names.shortArray, nullptr, integer);
+                    break;
+                case Bytecode::_aaload: {
+                    pop(integer);
+                    auto array = popReference();
+                    if (array.getTag() == VerificationType::Tag::Null) {
+                        push(VerificationType::null());
+                    } else if (isReferenceArray(array)) {
+                        push(VerificationType::object(componentName(array.getName())));
+                    } else {
+                        fail("Bad array type for aaload");
+                    }
+                    break;
+                }
+
+                case Bytecode::_istore:
+                    store(bc[1], integer);
+                    break;
+                case Bytecode::_lstore:
+                    store(bc[1], longType);
+                    break;
+                case Bytecode::_fstore:
+                    store(bc[1], floatType);
+                    break;
+                case Bytecode::_dstore:
+                    store(bc[1], doubleType);
+                    break;
+                case Bytecode::_astore:
+                    storeLocal(bc[1], popReference());
+                    break;
+                case Bytecode::_istore_0:
+                case Bytecode::_istore_1:
+                case Bytecode::_istore_2:
+                case Bytecode::_istore_3:
+                    store(bc[0] - (uint8_t) Bytecode::_istore_0, integer);
+                    break;
+                case Bytecode::_lstore_0:
+                case Bytecode::_lstore_1:
+                case Bytecode::_lstore_2:
+                case Bytecode::_lstore_3:
+                    store(bc[0] - (uint8_t) Bytecode::_lstore_0, longType);
+                    break;
+                case Bytecode::_fstore_0:
+                case Bytecode::_fstore_1:
+                case Bytecode::_fstore_2:
+                case Bytecode::_fstore_3:
+                    store(bc[0] - (uint8_t) Bytecode::_fstore_0, floatType);
+                    break;
+                case Bytecode::_dstore_0:
+                case Bytecode::_dstore_1:
+                case Bytecode::_dstore_2:
+                case Bytecode::_dstore_3:
+                    store(bc[0] - (uint8_t) Bytecode::_dstore_0, doubleType);
+                    break;
+                case Bytecode::_astore_0:
+                case Bytecode::_astore_1:
+                case Bytecode::_astore_2:
+                case Bytecode::_astore_3:
+                    storeLocal(bc[0] - (uint8_t) Bytecode::_astore_0, popReference());
+                    break;
+
+                case Bytecode::_iastore:
+                    arrayStore(names.intArray, nullptr, integer);
+                    break;
+                case Bytecode::_lastore:
+                    arrayStore(names.longArray, nullptr, longType);
+                    break;
+                case Bytecode::_fastore:
+                    arrayStore(names.floatArray, nullptr, floatType);
+                    break;
+                case Bytecode::_dastore:
+                    arrayStore(names.doubleArray, nullptr, doubleType);
+                    break;
+                case Bytecode::_bastore:
+                    arrayStore(names.byteArray, names.booleanArray, integer);
+                    break;
+                case Bytecode::_castore:
+                    arrayStore(names.charArray, nullptr, integer);
+                    break;
+                case Bytecode::_sastore:
+                    arrayStore(names.shortArray, nullptr, integer);
+                    break;
+                case Bytecode::_aastore: {
+                    popObject();
+                    pop(integer);
+                    auto array = popReference();
+                    if (array.getTag() != VerificationType::Tag::Null && !isReferenceArray(array)) {
+                        fail("Bad array type for aastore");
+                    }
+                    break;
+                }
+
+                case Bytecode::_pop:
+                    checkStackBoundary(1);
+                    popSlot();
+                    break;
+                case Bytecode::_pop2:
+                    checkStackBoundary(2);
+                    popSlot();
+                    popSlot();
+                    break;
+                case Bytecode::_dup:
+                    duplicate(1, 0);
+                    break;
+                case Bytecode::_dup_x1:
+                    duplicate(1, 1);
+                    break;
+                case Bytecode::_dup_x2:
+                    duplicate(1, 2);
+                    break;
+                case Bytecode::_dup2:
+                    duplicate(2, 0);
+                    break;
+                case Bytecode::_dup2_x1:
+                    duplicate(2, 1);
+                    break;
+                case Bytecode::_dup2_x2:
+                    duplicate(2, 2);
+                    break;
+                case Bytecode::_swap: {
+                    checkStackBoundary(1);
+                    checkStackBoundary(2);
+                    std::swap(stack[stack.size() - 1], stack[stack.size() - 2]);
+                    break;
+                }
+
+                case Bytecode::_iadd:
+                case Bytecode::_isub:
+                case Bytecode::_imul:
+                case Bytecode::_idiv:
+                case Bytecode::_irem:
+                case Bytecode::_ishl:
+                case Bytecode::_ishr:
+                case Bytecode::_iushr:
+                case Bytecode::_iand:
+                case Bytecode::_ior:
+                case Bytecode::_ixor:
+                    pop(integer);
+                    pop(integer);
+                    push(integer);
+                    break;
+                case Bytecode::_ladd:
+                case Bytecode::_lsub:
+                case Bytecode::_lmul:
+                case Bytecode::_ldiv:
+                case Bytecode::_lrem:
+                case Bytecode::_land:
+                case Bytecode::_lor:
+                case Bytecode::_lxor:
+                    pop(longType);
+                    pop(longType);
+                    push(longType);
+                    break;
+                case Bytecode::_lshl:
+                case Bytecode::_lshr:
+                case Bytecode::_lushr:
+                    pop(integer);
+                    pop(longType);
+                    push(longType);
+                    break;
+                case Bytecode::_fadd:
+                case Bytecode::_fsub:
+                case Bytecode::_fmul:
+                case Bytecode::_fdiv:
+                case Bytecode::_frem:
+                    pop(floatType);
+                    pop(floatType);
+                    push(floatType);
+                    break;
+                case Bytecode::_dadd:
+                case Bytecode::_dsub:
+                case Bytecode::_dmul:
+                case Bytecode::_ddiv:
+                case Bytecode::_drem:
+                    pop(doubleType);
+                    pop(doubleType);
+                    push(doubleType);
+                    break;
+                case Bytecode::_ineg:
+                case Bytecode::_i2b:
+                case Bytecode::_i2c:
+                case Bytecode::_i2s:
+                    pop(integer);
+                    push(integer);
+                    break;
+                case Bytecode::_lneg:
+                    pop(longType);
+                    push(longType);
+                    break;
+                case Bytecode::_fneg:
+                    pop(floatType);
+                    push(floatType);
+                    break;
+                case Bytecode::_dneg:
+                    pop(doubleType);
+                    push(doubleType);
+                    break;
+                case Bytecode::_iinc:
+                    loadLocal(bc[1], integer);
+                    storeLocal(bc[1], integer);
+                    break;
+
+                case Bytecode::_i2l:
+                    pop(integer);
+                    push(longType);
+                    break;
+                case Bytecode::_i2f:
+                    pop(integer);
+                    push(floatType);
+                    break;
+                case Bytecode::_i2d:
+                    pop(integer);
+                    push(doubleType);
+                    break;
+                case Bytecode::_l2i:
+                    pop(longType);
+                    push(integer);
+                    break;
+                case Bytecode::_l2f:
+                    pop(longType);
+                    push(floatType);
+                    break;
+                case Bytecode::_l2d:
+                    pop(longType);
+                    push(doubleType);
+                    break;
+                case Bytecode::_f2i:
+                    pop(floatType);
+                    push(integer);
+                    break;
+                case Bytecode::_f2l:
+                    pop(floatType);
+                    push(longType);
+                    break;
+                case Bytecode::_f2d:
+                    pop(floatType);
+                    push(doubleType);
+                    break;
+                case Bytecode::_d2i:
+                    pop(doubleType);
+                    push(integer);
+                    break;
+                case Bytecode::_d2l:
+                    pop(doubleType);
+                    push(longType);
+                    break;
+                case Bytecode::_d2f:
+                    pop(doubleType);
+                    push(floatType);
+                    break;
+
+                case Bytecode::_lcmp:
+                    pop(longType);
+                    pop(longType);
+                    push(integer);
+                    break;
+                case Bytecode::_fcmpl:
+                case Bytecode::_fcmpg:
+                    pop(floatType);
+                    pop(floatType);
+                    push(integer);
+                    break;
+                case Bytecode::_dcmpl:
+                case Bytecode::_dcmpg:
+                    pop(doubleType);
+                    pop(doubleType);
+                    push(integer);
+                    break;
+
+                case Bytecode::_ifeq:
+                case Bytecode::_ifne:
+                case Bytecode::_iflt:
+                case Bytecode::_ifge:
+                case Bytecode::_ifgt:
+                case Bytecode::_ifle:
+                    pop(integer);
+                    checkBranch(bci + Bytecodes::readS2(bc + 1));
+                    break;
+                case Bytecode::_if_icmpeq:
+                case Bytecode::_if_icmpne:
+                case Bytecode::_if_icmplt:
+                case Bytecode::_if_icmpge:
+                case Bytecode::_if_icmpgt:
+                case Bytecode::_if_icmple:
+                    pop(integer);
+                    pop(integer);
+                    checkBranch(bci + Bytecodes::readS2(bc + 1));
+                    break;
+                case Bytecode::_if_acmpeq:
+                case Bytecode::_if_acmpne:
+                    popReference();
+                    popReference();
+                    checkBranch(bci + Bytecodes::readS2(bc + 1));
+                    break;
+                case Bytecode::_ifnull:
+                case Bytecode::_ifnonnull:
+                    popReference();
+                    checkBranch(bci + Bytecodes::readS2(bc + 1));
+                    break;
+                case Bytecode::_goto:
+                    checkBranch(bci + Bytecodes::readS2(bc + 1));
+                    return false;
+                case Bytecode::_goto_w:
+                    checkBranch(bci + (int64_t) Bytecodes::readS4(bc + 1));
+                    return false;
+                case Bytecode::_jsr:
+                case Bytecode::_jsr_w:
+                case Bytecode::_ret:
+                    fail("jsr/ret are not allowed in class files with StackMapTable");
+
+                case Bytecode::_tableswitch:
+                case Bytecode::_lookupswitch: {
+                    pop(integer);
+                    uint32_t operands = (bci + 4) & ~3u;
+                    checkBranch(bci + (int64_t) Bytecodes::readS4(code + operands));
+                    if (opcode == Bytecode::_tableswitch) {
+                        int64_t low = Bytecodes::readS4(code + operands + 4);
+                        int64_t high = Bytecodes::readS4(code + operands + 8);
+                        for (int64_t i = 0; i <= high - low; ++i) {
+                            checkBranch(bci + (int64_t) Bytecodes::readS4(code + operands + 12 + 4 * i));
+                        }
+                    } else {
+                        int32_t pairs = Bytecodes::readS4(code + operands + 4);
+                        for (int32_t i = 0; i < pairs; ++i) {
+                            auto pair = code + operands + 8 + 8 * i;
+                            if (i > 0 && Bytecodes::readS4(pair) <= Bytecodes::readS4(pair - 8)) {
+                                fail("lookupswitch keys are not sorted");
+                            }
+                            checkBranch(bci + (int64_t) Bytecodes::readS4(pair + 4));
+                        }
+                    }
+                    return false;
+                }
+
+                case Bytecode::_ireturn:
+                    returnInstruction(integer);
+                    return false;
+                case Bytecode::_lreturn:
+                    returnInstruction(longType);
+                    return false;
+                case Bytecode::_freturn:
+                    returnInstruction(floatType);
+                    return false;
+                case Bytecode::_dreturn:
+                    returnInstruction(doubleType);
+                    return false;
+                case Bytecode::_areturn:
+                    returnInstruction(VerificationType::object(names.object.get()));
+                    return false;
+                case Bytecode::_return:
+                    if (!returnsVoid) {
+                        fail("Method expects a return value");
+                    }
+                    if (flagThisUninit) {
+                        fail("Constructor must call super() or this() before return");
+                    }
+                    return false;
+
+                case Bytecode::_getstatic:
+                case Bytecode::_putstatic:
+                case Bytecode::_getfield:
+                case Bytecode::_putfield:
+                    fieldInstruction(opcode, Bytecodes::readU2(bc + 1));
+                    break;
+                case Bytecode::_invokevirtual:
+                case Bytecode::_invokespecial:
+                case Bytecode::_invokestatic:
+                case Bytecode::_invokeinterface:
+                case Bytecode::_invokedynamic:
+                    invokeInstruction(opcode, Bytecodes::readU2(bc + 1));
+                    break;
+
+                case Bytecode::_new: {
+                    auto className = classNameAt(Bytecodes::readU2(bc + 1));
+                    if (isArrayName(className)) {
+                        fail("Illegal new of an array class");
+                    }
+                    auto type = VerificationType::uninitialized(static_cast<uint16_t>(bci));
+                    if (std::find(stack.begin(), stack.end(), type) != stack.end()) {
+                        fail("Uninitialized object of this new is still on the operand stack");
+                    }
+                    replaceUninitialized(type, VerificationType::top());
+                    push(type);
+                    break;
+                }
+                case Bytecode::_newarray: {
+                    pop(integer);
+                    static const SymbolPtr VerifierNames::*arrays[] = {
+                        &VerifierNames::booleanArray, &VerifierNames::charArray, &VerifierNames::floatArray,
+                        &VerifierNames::doubleArray, &VerifierNames::byteArray, &VerifierNames::shortArray,
+                        &VerifierNames::intArray, &VerifierNames::longArray
+                    };
+                    if (bc[1] < 4 || bc[1] > 11) {
+                        fail("Illegal newarray type " + std::to_string(bc[1]));
+                    }
+                    push(VerificationType::object((names.*arrays[bc[1] - 4]).get()));
+                    break;
+                }
+                case Bytecode::_anewarray: {
+                    auto component = classNameAt(Bytecodes::readU2(bc + 1));
+                    pop(integer);
+                    push(arrayOf(component));
+                    break;
+                }
+                case Bytecode::_multianewarray: {
+                    auto className = classNameAt(Bytecodes::readU2(bc + 1));
+                    uint8_t dimensions = bc[3];
+                    auto bytes = className->getBytes();
+                    size_t arrayDimensions = 0;
+                    while (arrayDimensions < className->getLength() && bytes[arrayDimensions] == '[') {
+                        arrayDimensions++;
+                    }
+                    if (dimensions == 0 || arrayDimensions < dimensions) {
+                        fail("Illegal multianewarray dimensions");
+                    }
+                    for (int i = 0; i < dimensions; ++i) {
+                        pop(integer);
+                    }
+                    push(VerificationType::object(className));
+                    break;
+                }
+                case Bytecode::_arraylength: {
+                    auto array = popReference();
+                    if (array.getTag() != VerificationType::Tag::Null && !array.isArray()) {
+                        fail("Bad type for arraylength");
+                    }
+                    push(integer);
+                    break;
+                }
+                case Bytecode::_athrow:
+                    pop(VerificationType::object(names.throwable.get()));
+                    return false;
+                case Bytecode::_checkcast: {
+                    auto className = classNameAt(Bytecodes::readU2(bc + 1));
+                    popObject();
+                    push(VerificationType::object(className));
+                    break;
+                }
+                case Bytecode::_instanceof:
+                    classNameAt(Bytecodes::readU2(bc + 1));
+                    popObject();
+                    push(integer);
+                    break;
+                case Bytecode::_monitorenter:
+                case Bytecode::_monitorexit:
+                    popObject();
+                    break;
+
+                case Bytecode::_wide: {
+                    auto widened = static_cast<Bytecode>(bc[1]);
+                    uint16_t index = Bytecodes::readU2(bc + 2);
+                    switch (widened) {
+                        case Bytecode::_iload:
+                            load(index, integer);
+                            break;
+                        case Bytecode::_lload:
+                            load(index, longType);
+                            break;
+                        case Bytecode::_fload:
+                            load(index, floatType);
+                            break;
+                        case Bytecode::_dload:
+                            load(index, doubleType);
+                            break;
+                        case Bytecode::_aload:
+                            push(loadReference(index));
+                            break;
+                        case Bytecode::_istore:
+                            store(index, integer);
+                            break;
+                        case Bytecode::_lstore:
+                            store(index, longType);
+                            break;
+                        case Bytecode::_fstore:
+                            store(index, floatType);
+                            break;
+                        case Bytecode::_dstore:
+                            store(index, doubleType);
+                            break;
+                        case Bytecode::_astore:
+                            storeLocal(index, popReference());
+                            break;
+                        case Bytecode::_iinc:
+                            loadLocal(index, integer);
+                            storeLocal(index, integer);
+                            break;
+                        case Bytecode::_ret:
+                            fail("jsr/ret are not allowed in class files with StackMapTable");
+                        default:
+                            fail("Illegal instruction after wide");
+                    }
+                    break;
+                }
+                default:
+                    fail("Illegal instruction");
+            }
+            return true;
+        }
+
+    private:
+        const InstanceKlass &klass;
+        const Method &method;
+        ConstantPool &cp;
+        const VerifierNames &names;
+        const Verifier::AssignabilityCheck &check;
+
+        const uint8_t *code;
+        uint32_t codeLength;
+        uint16_t maxLocals;
+        uint16_t maxStack;
+
+        const StackMapTable *stackMap = nullptr;
+        std::vector<bool> instructionStarts;
+        std::vector<HandlerInfo> handlers;
+        bool returnsVoid = true;
+        VerificationType returnType;
+
+        // Current frame
+        uint32_t bci = 0;
+        uint32_t nextBci = 0;
+        std::vector<VerificationType> locals;
+        std::vector<VerificationType> stack;
+        bool flagThisUninit = false;
+        bool localsModified = false;
+        std::vector<VerificationType> arguments;
+        mutable std::vector<SymbolPtr> interned;
+    };
+
+    Verifier::Verifier(ThreadPool *pool, std::shared_ptr<VerificationCache> cache) :
+        pool(pool), cache(std::move(cache)), names(std::make_unique<VerifierNames>()) {
+    }
+
+    Verifier::~Verifier() = default;
+
+    static std::string methodDescription(const InstanceKlass &klass, const Method &method) {
+        return klass.getName()->toString() + "." + method.name()->toString() + method.descriptor()->toString();
+    }
+
+    std::string Verifier::verifyMethod(const InstanceKlass &klass, const Method &method,
+                                       const AssignabilityCheck &check) {
+        if (!method.hasCode()) {
+            return {};
+        }
+        if (klass.getMajorVersion() < TypeCheckingMinVersion) {
+            return "Can't verify " + methodDescription(klass, method) + ": class files before version "
+                   + std::to_string(TypeCheckingMinVersion) + " need the type inference verifier";
+        }
+        try {
+            MethodVerifier verifier(klass, method, *names, check);
+            verifier.verify();
+            return {};
+        } catch (const VerifyError &error) {
+            return "Verification failed in " + methodDescription(klass, method) + ": " + error.what();
+        }
+    }
+
+    std::vector<std::string> Verifier::verifyMethods(const InstanceKlass &klass, const AssignabilityCheck &check) {
+        const auto &methods = klass.getMethods();
+        std::vector<std::string> results(methods.size());
+        auto verifyAt = [this, &klass, &methods, &results, &check](size_t i) {
+            results[i] = verifyMethod(klass, *methods[i], check);
+        };
+        if (pool != nullptr && methods.size() > 1) {
+            pool->parallelFor(methods.size(), verifyAt);
+        } else {
+            for (size_t i = 0; i < methods.size(); ++i) {
+                verifyAt(i);
+            }
+        }
+        return results;
+    }
+
+    void Verifier::verify(const InstanceKlass &klass, const uint8_t *bytes, size_t len,
+                          const AssignabilityCheck &check) noexcept(false) {
+        if (cache == nullptr || bytes == nullptr) {
+            for (const auto &result : verifyMethods(klass, check)) {
+                if (!result.empty()) {
+                    throw VerifyError(result);
+                }
+            }
+            return;
+        }
+        auto digest = VerificationCache::digest(bytes, len);
+        std::vector<VerificationCache::Assumption> assumptions;
+        if (cache->find(digest, assumptions) && holds(assumptions, check)) {
+            return;
+        }
+
+        // The checks of methods verified in parallel are recorded together.
+        std::mutex assumptionsMutex;
+        assumptions.clear();
+        AssignabilityCheck recordingCheck = [&](const Symbol *target, const Symbol *source) {
+            bool assignable = check && check(target, source);
+            VerificationCache::Assumption assumption{target->toString(), source->toString(), assignable};
+            std::lock_guard<std::mutex> _{assumptionsMutex};
+            if (std::find(assumptions.begin(), assumptions.end(), assumption) == assumptions.end()) {
+                assumptions.push_back(std::move(assumption));
+            }
+            return assignable;
+        };
+        for (const auto &result : verifyMethods(klass, recordingCheck)) {
+            if (!result.empty()) {
+                throw VerifyError(result);
+            }
+        }
+        cache->add(digest, std::move(assumptions));
+    }
+
+    bool Verifier::holds(const std::vector<VerificationCache::Assumption> &assumptions,
+                         const AssignabilityCheck &check) {
+        for (const auto &assumption : assumptions) {
+            auto target = SymbolTable::intern(reinterpret_cast<const uint8_t *>(assumption.target.data()),
+                                              assumption.target.size());
+            auto source = SymbolTable::intern(reinterpret_cast<const uint8_t *>(assumption.source.data()),
+                                              assumption.source.size());
+            if ((check && check(target.get(), source.get())) != assumption.assignable) {
+                return false;
+            }
+        }
+        return true;
+    }
+}
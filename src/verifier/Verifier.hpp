@@ -0,0 +1,63 @@
+#pragma once
+
+#include "VerificationCache.hpp"
+#include "../Klass.hpp"
+#include "../utils/ThreadPool.hpp"
+
+#include <functional>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace CCW::Tula {
+
+    struct VerifierNames;
+
+    // Type-checking verifier of JVMS 4.10.1, driven by StackMapTable frames.
+    // Each method is checked in one forward pass over its bytecode; methods are independent, so a class
+    // is verified in parallel when a thread pool is given.
+    //
+    // Class files older than version 50 have no StackMapTable; they would need the type inference verifier,
+    // which Tula lacks, so they fail verification.
+    class Verifier : public Noncopyable {
+    public:
+        // Whether a value of class `source` may be stored where class `target` is expected. Both are
+        // interned, non-array, distinct class names, and `target` is not java/lang/Object. The verifier
+        // can't walk the class hierarchy itself: without a check, such assignments are rejected.
+        using AssignabilityCheck = std::function<bool(const Symbol *target, const Symbol *source)>;
+
+        // Interns the class names it checks against, so the symbol table must be initialized.
+        explicit Verifier(ThreadPool *pool = nullptr, std::shared_ptr<VerificationCache> cache = nullptr);
+
+        ~Verifier();
+
+        [[nodiscard]] inline const std::shared_ptr<VerificationCache> &getCache() const {
+            return cache;
+        }
+
+        // Verifies every method of `klass` and throws VerifyError for the first method that fails.
+        // When a cache is set, `bytes` (the class file the klass was parsed from) is used as the cache key,
+        // and classes found in the cache are accepted without verification as long as `check` still gives
+        // the answers they were verified with. Class types are checked for assignability with `check`,
+        // which the class loader defining `klass` provides.
+        void verify(const InstanceKlass &klass, const uint8_t *bytes = nullptr, size_t len = 0,
+                    const AssignabilityCheck &check = nullptr) noexcept(false);
+
+        // Verifies every method and returns one message per method, empty for methods that passed.
+        std::vector<std::string> verifyMethods(const InstanceKlass &klass, const AssignabilityCheck &check = nullptr);
+
+        // Returns an empty string when `method` passes, the reason it does not otherwise.
+        std::string verifyMethod(const InstanceKlass &klass, const Method &method,
+                                 const AssignabilityCheck &check = nullptr);
+
+    private:
+        // Whether `check` still answers every assumption a cached verification made.
+        static bool holds(const std::vector<VerificationCache::Assumption> &assumptions,
+                          const AssignabilityCheck &check);
+
+    private:
+        ThreadPool *pool;
+        std::shared_ptr<VerificationCache> cache;
+        std::unique_ptr<VerifierNames> names;
+    };
+}
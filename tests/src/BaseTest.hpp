@@ -1,8 +1,38 @@
 #pragma once
 
 #include <gtest/gtest.h>
+#include <tula/VM.hpp>
+
+#include <Error.hpp>
+
+#include <cstring>
+#include <filesystem>
+#include <memory>
 
 namespace CCW::Tula {
+
+    // Resolves the bytecode method `name()V` of `className`. Until Tula has an interpreter this loads and
+    // links the class, then fails with an Error for the missing interpreter; linkage errors pass through.
+    inline void resolveBytecode(VM &vm, const std::string &className, const std::string &name = "run") {
+        try {
+            vm.resolveStatic(className, name, "()V");
+        } catch (const LinkageError &) {
+            throw;
+        } catch (const Error &e) {
+            ASSERT_NE(nullptr, strstr(e.what(), "needs an interpreter")) << e.what();
+            return;
+        }
+        FAIL() << className << "." << name << " ran without an interpreter";
+    }
+
+    // An empty directory `name` of the test temp directory, ending with a slash.
+    inline std::string emptyTempDir(const std::string &name) {
+        auto dir = ::testing::TempDir() + name + "/";
+        std::filesystem::remove_all(dir);
+        std::filesystem::create_directories(dir);
+        return dir;
+    }
+
     class BaseTest : public ::testing::Test {
     protected:
 
@@ -12,14 +42,16 @@ namespace CCW::Tula {
     protected:
         void SetUp() override {
             BaseTest::SetUp();  // Sets up the base fixture first.
-            
+            vm = std::make_unique<VM>("", "");
         }
 
         void TearDown() override {
-            // clean-up work for FooTest ...
+            vm.reset();
             BaseTest::TearDown();  // Remember to tear down the base fixture
         }
 
+        std::unique_ptr<VM> vm;
+
     };
 }
 
@@ -0,0 +1,326 @@
+#pragma once
+
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <map>
+#include <string>
+#include <vector>
+
+namespace CCW::Tula {
+
+    // Assembles class files in memory so tests do not depend on javac.
+    class ClassFileBuilder {
+    public:
+        struct ExceptionHandler {
+            uint16_t startPc;
+            uint16_t endPc;
+            uint16_t handlerPc;
+            uint16_t catchType;
+        };
+
+        // A RuntimeVisibleAnnotations entry with int elements only.
+        struct Annotation {
+            std::string type;       // descriptor, e.g. "Lcom/foo/Marker;"
+            std::vector<std::pair<std::string, int32_t>> values;
+        };
+
+        struct MethodSpec {
+            uint16_t accessFlags = 0x0001;
+            std::string name;
+            std::string descriptor;
+            bool hasCode = true;
+            uint16_t maxStack = 0;
+            uint16_t maxLocals = 0;
+            std::vector<uint8_t> code;
+            std::vector<ExceptionHandler> exceptionTable;
+            std::vector<std::pair<uint16_t, uint16_t>> lineNumbers;
+            std::vector<uint8_t> stackMapTable;     // body after attribute_length
+            std::vector<Annotation> annotations;
+        };
+
+        // `public static void name() {}`
+        static MethodSpec emptyStaticMethod(const std::string &name = "run") {
+            MethodSpec method;
+            method.accessFlags = 0x0009;
+            method.name = name;
+            method.descriptor = "()V";
+            method.code = {0xB1};   // return
+            return method;
+        }
+
+        // Writes `className` with an empty static `method()V` to the class path directory `dir`.
+        static std::string writeRunnable(const std::string &dir, const std::string &className,
+                                         const std::string &method = "run") {
+            return ClassFileBuilder(className).addMethod(emptyStaticMethod(method)).writeTo(dir);
+        }
+
+        explicit ClassFileBuilder(std::string thisClass, std::string superClass = "java/lang/Object") :
+            thisClass(thisClass) {
+            thisClassIndex = classRef(thisClass);
+            superClassIndex = superClass.empty() ? 0 : classRef(superClass);
+        }
+
+        ClassFileBuilder &version(uint16_t major, uint16_t minor = 0) {
+            majorVersion = major;
+            minorVersion = minor;
+            return *this;
+        }
+
+        ClassFileBuilder &accessFlags(uint16_t flags) {
+            classAccessFlags = flags;
+            return *this;
+        }
+
+        ClassFileBuilder &addInterface(const std::string &name) {
+            interfaces.push_back(classRef(name));
+            return *this;
+        }
+
+        ClassFileBuilder &addField(uint16_t flags, const std::string &name, const std::string &descriptor,
+                                   const std::vector<Annotation> &annotations = {}) {
+            fields.push_back({flags, utf8(name), utf8(descriptor), annotationsAttribute(annotations)});
+            return *this;
+        }
+
+        ClassFileBuilder &addMethod(const MethodSpec &method) {
+            methods.push_back(method);
+            return *this;
+        }
+
+        ClassFileBuilder &addAnnotation(const Annotation &annotation) {
+            classAnnotations.push_back(annotation);
+            return *this;
+        }
+
+        ClassFileBuilder &sourceFile(const std::string &name) {
+            sourceFileIndex = utf8(name);
+            return *this;
+        }
+
+        uint16_t utf8(const std::string &value) {
+            auto found = utf8s.find(value);
+            if (found != utf8s.end()) {
+                return found->second;
+            }
+            std::vector<uint8_t> entry{1};
+            u2(entry, value.size());
+            entry.insert(entry.end(), value.begin(), value.end());
+            return utf8s[value] = addEntry(entry);
+        }
+
+        uint16_t classRef(const std::string &name) {
+            auto found = classes.find(name);
+            if (found != classes.end()) {
+                return found->second;
+            }
+            std::vector<uint8_t> entry{7};
+            u2(entry, utf8(name));
+            return classes[name] = addEntry(entry);
+        }
+
+        uint16_t string(const std::string &value) {
+            std::vector<uint8_t> entry{8};
+            u2(entry, utf8(value));
+            return addEntry(entry);
+        }
+
+        uint16_t integer(int32_t value) {
+            std::vector<uint8_t> entry{3};
+            u4(entry, value);
+            return addEntry(entry);
+        }
+
+        uint16_t nameAndType(const std::string &name, const std::string &descriptor) {
+            std::vector<uint8_t> entry{12};
+            u2(entry, utf8(name));
+            u2(entry, utf8(descriptor));
+            return addEntry(entry);
+        }
+
+        uint16_t dynamicConstant(uint16_t bootstrapMethod, const std::string &name, const std::string &descriptor) {
+            auto nameAndTypeIndex = nameAndType(name, descriptor);
+            std::vector<uint8_t> entry{17};
+            u2(entry, bootstrapMethod);
+            u2(entry, nameAndTypeIndex);
+            return addEntry(entry);
+        }
+
+        uint16_t methodRef(const std::string &owner, const std::string &name, const std::string &descriptor) {
+            return memberRef(10, owner, name, descriptor);
+        }
+
+        uint16_t fieldRef(const std::string &owner, const std::string &name, const std::string &descriptor) {
+            return memberRef(9, owner, name, descriptor);
+        }
+
+        // Builds the class into `dir` + its name + ".class", creating the package directories, and
+        // returns the path.
+        std::string writeTo(const std::string &dir) {
+            auto bytes = build();
+            auto path = dir + thisClass + ".class";
+            std::filesystem::create_directories(std::filesystem::path(path).parent_path());
+            std::ofstream out(path, std::ios::binary | std::ios::trunc);
+            out.write(reinterpret_cast<const char *>(bytes.data()), static_cast<std::streamsize>(bytes.size()));
+            return path;
+        }
+
+        std::vector<uint8_t> build() {
+            // Attribute names must be in the pool before it is written.
+            auto codeName = utf8("Code");
+            auto lineNumbersName = utf8("LineNumberTable");
+            auto stackMapName = utf8("StackMapTable");
+            auto sourceFileName = utf8("SourceFile");
+            std::vector<std::vector<uint8_t>> methodAnnotations;
+            for (const auto &method : methods) {
+                utf8(method.name);
+                utf8(method.descriptor);
+                methodAnnotations.push_back(annotationsAttribute(method.annotations));
+            }
+            auto classAttribute = annotationsAttribute(classAnnotations);
+
+            std::vector<uint8_t> out;
+            u4(out, 0xCAFEBABE);
+            u2(out, minorVersion);
+            u2(out, majorVersion);
+            u2(out, poolCount);
+            out.insert(out.end(), pool.begin(), pool.end());
+            u2(out, classAccessFlags);
+            u2(out, thisClassIndex);
+            u2(out, superClassIndex);
+            u2(out, interfaces.size());
+            for (auto index : interfaces) {
+                u2(out, index);
+            }
+            u2(out, fields.size());
+            for (const auto &field : fields) {
+                u2(out, field.accessFlags);
+                u2(out, field.nameIndex);
+                u2(out, field.descriptorIndex);
+                u2(out, field.annotations.empty() ? 0 : 1);
+                out.insert(out.end(), field.annotations.begin(), field.annotations.end());
+            }
+            u2(out, methods.size());
+            for (size_t i = 0; i < methods.size(); ++i) {
+                const auto &method = methods[i];
+                u2(out, method.accessFlags);
+                u2(out, utf8(method.name));
+                u2(out, utf8(method.descriptor));
+                u2(out, (method.hasCode ? 1 : 0) + (methodAnnotations[i].empty() ? 0 : 1));
+                out.insert(out.end(), methodAnnotations[i].begin(), methodAnnotations[i].end());
+                if (!method.hasCode) {
+                    continue;
+                }
+                std::vector<uint8_t> code;
+                u2(code, method.maxStack);
+                u2(code, method.maxLocals);
+                u4(code, method.code.size());
+                code.insert(code.end(), method.code.begin(), method.code.end());
+                u2(code, method.exceptionTable.size());
+                for (const auto &handler : method.exceptionTable) {
+                    u2(code, handler.startPc);
+                    u2(code, handler.endPc);
+                    u2(code, handler.handlerPc);
+                    u2(code, handler.catchType);
+                }
+                u2(code, (method.lineNumbers.empty() ? 0 : 1) + (method.stackMapTable.empty() ? 0 : 1));
+                if (!method.lineNumbers.empty()) {
+                    u2(code, lineNumbersName);
+                    u4(code, 2 + 4 * method.lineNumbers.size());
+                    u2(code, method.lineNumbers.size());
+                    for (const auto &entry : method.lineNumbers) {
+                        u2(code, entry.first);
+                        u2(code, entry.second);
+                    }
+                }
+                if (!method.stackMapTable.empty()) {
+                    u2(code, stackMapName);
+                    u4(code, method.stackMapTable.size());
+                    code.insert(code.end(), method.stackMapTable.begin(), method.stackMapTable.end());
+                }
+                u2(out, codeName);
+                u4(out, code.size());
+                out.insert(out.end(), code.begin(), code.end());
+            }
+            u2(out, (sourceFileIndex != 0 ? 1 : 0) + (classAttribute.empty() ? 0 : 1));
+            if (sourceFileIndex != 0) {
+                u2(out, sourceFileName);
+                u4(out, 2);
+                u2(out, sourceFileIndex);
+            }
+            out.insert(out.end(), classAttribute.begin(), classAttribute.end());
+            return out;
+        }
+
+        static void u2(std::vector<uint8_t> &out, uint32_t value) {
+            out.push_back(value >> 8u);
+            out.push_back(value);
+        }
+
+        static void u4(std::vector<uint8_t> &out, uint32_t value) {
+            u2(out, value >> 16u);
+            u2(out, value);
+        }
+
+    private:
+        struct FieldSpec {
+            uint16_t accessFlags;
+            uint16_t nameIndex;
+            uint16_t descriptorIndex;
+            std::vector<uint8_t> annotations;   // the whole attribute, empty for none
+        };
+
+        // Adds the constants of `annotations` to the pool, which must happen before build() writes it.
+        std::vector<uint8_t> annotationsAttribute(const std::vector<Annotation> &annotations) {
+            std::vector<uint8_t> attribute;
+            if (annotations.empty()) {
+                return attribute;
+            }
+            std::vector<uint8_t> body;
+            u2(body, annotations.size());
+            for (const auto &annotation : annotations) {
+                u2(body, utf8(annotation.type));
+                u2(body, annotation.values.size());
+                for (const auto &[name, value] : annotation.values) {
+                    u2(body, utf8(name));
+                    body.push_back('I');
+                    u2(body, integer(value));
+                }
+            }
+            u2(attribute, utf8("RuntimeVisibleAnnotations"));
+            u4(attribute, body.size());
+            attribute.insert(attribute.end(), body.begin(), body.end());
+            return attribute;
+        }
+
+        uint16_t addEntry(const std::vector<uint8_t> &entry) {
+            pool.insert(pool.end(), entry.begin(), entry.end());
+            return poolCount++;
+        }
+
+        uint16_t memberRef(uint8_t tag, const std::string &owner, const std::string &name,
+                           const std::string &descriptor) {
+            std::vector<uint8_t> entry{tag};
+            u2(entry, classRef(owner));
+            u2(entry, nameAndType(name, descriptor));
+            return addEntry(entry);
+        }
+
+    private:
+        uint16_t majorVersion = 52;
+        uint16_t minorVersion = 0;
+        uint16_t classAccessFlags = 0x0021;
+        std::string thisClass;
+        uint16_t thisClassIndex;
+        uint16_t superClassIndex;
+        uint16_t sourceFileIndex = 0;
+        uint16_t poolCount = 1;
+        std::vector<uint8_t> pool;
+        std::map<std::string, uint16_t> utf8s;
+        std::map<std::string, uint16_t> classes;
+        std::vector<uint16_t> interfaces;
+        std::vector<FieldSpec> fields;
+        std::vector<MethodSpec> methods;
+        std::vector<Annotation> classAnnotations;
+    };
+}
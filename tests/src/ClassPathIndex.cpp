@@ -0,0 +1,123 @@
+#include "BaseTest.hpp"
+#include "ClassFileBuilder.hpp"
+#include <gtest/gtest.h>
+
+#include <ClassPathIndex.hpp>
+#include <Error.hpp>
+
+#include <filesystem>
+#include <fstream>
+
+namespace CCW::Tula {
+
+    class TestClassPathIndex : public VMTest {
+    };
+
+    TEST_F(TestClassPathIndex, TestBuild) {
+        auto first = emptyTempDir("index-first");
+        auto second = emptyTempDir("index-second");
+        ClassFileBuilder::writeRunnable(first, "com/tula/A");
+        ClassFileBuilder::writeRunnable(first, "com/tula/deep/er/B");
+        ClassFileBuilder::writeRunnable(second, "com/tula/A");
+        ClassFileBuilder::writeRunnable(second, "com/tula/C");
+        ClassFileBuilder::writeRunnable(second, "D");
+        std::ofstream(second + "com/tula/README") << "not a class";
+        std::filesystem::create_directory_symlink(second + "com", second + "com/tula/loop");
+
+        auto index = ClassPathIndex::build({first, second, first + "missing"}, 2);
+        ASSERT_EQ(0, index->find("com/tula/A"));
+        ASSERT_EQ(0, index->find("com/tula/deep/er/B"));
+        ASSERT_EQ(1, index->find("com/tula/C"));
+        ASSERT_EQ(1, index->find("D"));
+        ASSERT_EQ(ClassPathIndex::NotFound, index->find("com/tula/README"));
+        ASSERT_EQ(ClassPathIndex::NotFound, index->find("com/tula/Missing"));
+        ASSERT_EQ(ClassPathIndex::NotFound, index->find("com/tula"));
+        ASSERT_EQ(4u, index->getClassCount());
+        ASSERT_FALSE(index->isLoadedFromSnapshot());
+    }
+
+    TEST_F(TestClassPathIndex, TestSnapshot) {
+        auto dir = emptyTempDir("index-snapshot");
+        ClassFileBuilder::writeRunnable(dir, "com/tula/A");
+        auto snapshot = ::testing::TempDir() + "index-snapshot.bin";
+        ASSERT_EQ(nullptr, ClassPathIndex::load(snapshot + ".missing", {dir}));
+
+        auto built = ClassPathIndex::build({dir});
+        ASSERT_TRUE(built->save(snapshot));
+        auto loaded = ClassPathIndex::load(snapshot, {dir});
+        ASSERT_NE(nullptr, loaded);
+        ASSERT_TRUE(loaded->isLoadedFromSnapshot());
+        ASSERT_EQ(0, loaded->find("com/tula/A"));
+        ASSERT_EQ(built->getClassCount(), loaded->getClassCount());
+        ASSERT_EQ(built->getDirectoryCount(), loaded->getDirectoryCount());
+
+        // Built for other roots.
+        ASSERT_EQ(nullptr, ClassPathIndex::load(snapshot, {dir, dir + "other"}));
+
+        // A class added to a directory makes the snapshot stale.
+        ClassFileBuilder::writeRunnable(dir, "com/tula/B");
+        ASSERT_EQ(nullptr, ClassPathIndex::load(snapshot, {dir}));
+        ASSERT_TRUE(ClassPathIndex::build({dir})->save(snapshot));
+        ASSERT_EQ(0, ClassPathIndex::load(snapshot, {dir})->find("com/tula/B"));
+
+        std::ofstream(snapshot, std::ios::binary | std::ios::trunc) << "TULACP01";
+        ASSERT_EQ(nullptr, ClassPathIndex::load(snapshot, {dir}));
+
+        // A class with an empty name: one root, no directories, one class of root 0.
+        {
+            std::ofstream out(snapshot, std::ios::binary | std::ios::trunc);
+            auto u32 = [&out](uint32_t value) { out.write(reinterpret_cast<const char *>(&value), sizeof(value)); };
+            out << "TULACP01";
+            u32(static_cast<uint32_t>(dir.size()));
+            out << dir;
+            u32(0);
+            u32(1);
+            u32(0);
+            u32(0);
+        }
+        ASSERT_EQ(nullptr, ClassPathIndex::load(snapshot, {dir}));
+
+        std::vector<std::string> tooMany(ClassPathIndex::MaxRoots + 1, dir);
+        ASSERT_EQ(nullptr, ClassPathIndex::load(snapshot, tooMany));
+        ASSERT_THROW(ClassPathIndex::build(tooMany), Error);
+    }
+
+    TEST_F(TestClassPathIndex, TestVM) {
+        auto first = emptyTempDir("index-vm-first");
+        auto second = emptyTempDir("index-vm-second");
+        ClassFileBuilder::writeRunnable(first, "com/tula/Shadowed", "first");
+        ClassFileBuilder::writeRunnable(second, "com/tula/Shadowed", "second");
+        ClassFileBuilder::writeRunnable(second, "com/tula/Second");
+        ClassFileBuilder::writeRunnable(second, "Init");
+        auto snapshot = ::testing::TempDir() + "index-vm.bin";
+        std::filesystem::remove(snapshot);
+
+        VM vm(first + ":" + second, second + "Init.class");
+        vm.setClassPathIndex(snapshot);
+        vm.start();
+        resolveBytecode(vm, "com/tula/Shadowed", "first");
+        resolveBytecode(vm, "com/tula/Second");
+        ASSERT_THROW(vm.resolveStatic("com/tula/Missing", "run", "()V"), NoClassDefFoundError);
+        // Missing and java/lang/Object, which the loader provides as the class path has none.
+        ASSERT_EQ(2u, vm.classLookupStats().misses);
+        ASSERT_TRUE(std::filesystem::exists(snapshot));
+
+        // Classes written later are found once the class path is indexed again.
+        ClassFileBuilder::writeRunnable(first, "com/tula/Missing");
+        vm.classPathChanged();
+        resolveBytecode(vm, "com/tula/Missing");
+    }
+
+    TEST_F(TestClassPathIndex, TestVMWithoutIndex) {
+        auto first = emptyTempDir("index-vm-plain-first");
+        auto second = emptyTempDir("index-vm-plain-second");
+        ClassFileBuilder::writeRunnable(first, "com/tula/Shadowed", "first");
+        ClassFileBuilder::writeRunnable(second, "com/tula/Shadowed", "second");
+        ClassFileBuilder::writeRunnable(second, "com/tula/Second");
+
+        VM vm(first + ":" + second, "");
+        resolveBytecode(vm, "com/tula/Shadowed", "first");
+        resolveBytecode(vm, "com/tula/Second");
+        ASSERT_THROW(vm.resolveStatic("com/tula/Missing", "run", "()V"), NoClassDefFoundError);
+    }
+}
@@ -0,0 +1,160 @@
+#include "BaseTest.hpp"
+#include "ClassFileBuilder.hpp"
+#include "JImageBuilder.hpp"
+#include <gtest/gtest.h>
+
+#include <ClassPreloader.hpp>
+#include <ClazzLoader.hpp>
+#include <SymbolTable.hpp>
+
+#include <fstream>
+
+namespace CCW::Tula {
+
+    class TestClassPreloader : public VMTest {
+    };
+
+    // Writes classes with a static `run()V` to a directory of their own.
+    static std::string writeClasses(const std::string &name, const std::vector<std::string> &classes) {
+        auto dir = emptyTempDir(name);
+        for (auto &className : classes) {
+            ClassFileBuilder::writeRunnable(dir, className);
+        }
+        return dir;
+    }
+
+    TEST_F(TestClassPreloader, TestPreload) {
+        std::vector<std::string> classes;
+        for (int i = 0; i < 32; ++i) {
+            classes.push_back("com/tula/C" + std::to_string(i));
+        }
+        auto dir = writeClasses("preload", classes);
+        std::vector<SymbolPtr> names;
+        for (auto &className : classes) {
+            names.push_back(SymbolTable::intern(className.c_str()));
+        }
+        names.push_back(SymbolTable::intern("com/tula/Gone"));
+
+        BootstrapClassLoader loader(vm.get(), dir);
+        loader.preload(names, 3);
+        loader.getPreloader()->wait();
+        auto stats = loader.getPreloader()->getStats();
+        ASSERT_EQ(33u, stats.listed);
+        ASSERT_EQ(32u, stats.preloaded);
+        ASSERT_EQ(1u, stats.failed);
+
+        // Preloaded classes are loaded once asked for, in the order asked.
+        ASSERT_TRUE(loader.getLoadedClasses().empty());
+        for (int i = 9; i >= 0; --i) {
+            auto klass = loader.findLoadedKlass(names[i]);
+            ASSERT_NE(nullptr, klass);
+            ASSERT_EQ(names[i].get(), klass->name().get());
+            ASSERT_EQ(klass, loader.loadClass(names[i]));
+        }
+        ASSERT_EQ(nullptr, loader.findLoadedKlass(names.back()));
+        ASSERT_EQ(10u, loader.getPreloader()->getStats().taken);
+        auto loaded = loader.getLoadedClasses();
+        ASSERT_EQ(10u, loaded.size());
+        ASSERT_EQ(names[9].get(), loaded.front()->name().get());
+
+        // Classes nobody asked for are dropped, and loaded the usual way afterwards.
+        loader.stopPreloading();
+        ASSERT_EQ(nullptr, loader.getPreloader());
+        ASSERT_EQ(nullptr, loader.findLoadedKlass(names[20]));
+        ASSERT_NE(nullptr, loader.loadClass(names[20]));
+        ASSERT_EQ(11u, loader.getLoadedClasses().size());
+    }
+
+    TEST_F(TestClassPreloader, TestBounded) {
+        auto dir = writeClasses("preload-bounded", {});
+        std::vector<SymbolPtr> names;
+        for (size_t i = 0; i <= ClassPreloader::MaxClasses; ++i) {
+            names.push_back(SymbolTable::intern(("com/tula/Stale" + std::to_string(i)).c_str()));
+        }
+        BootstrapClassLoader loader(vm.get(), dir);
+        loader.preload(names, 2);
+        loader.getPreloader()->wait();
+        auto stats = loader.getPreloader()->getStats();
+        ASSERT_EQ(ClassPreloader::MaxClasses, stats.listed);
+        ASSERT_EQ(ClassPreloader::MaxClasses, stats.failed);
+    }
+
+    TEST_F(TestClassPreloader, TestSkipImageClasses) {
+        JImageBuilder builder;
+        for (auto className : {"com/tula/InImage0", "com/tula/InImage1"}) {
+            builder.addClass("tula.base", className, ClassFileBuilder(className)
+                .addMethod(ClassFileBuilder::emptyStaticMethod("run")).build());
+        }
+        auto image = ::testing::TempDir() + "preload.jimage";
+        {
+            auto bytes = builder.build();
+            std::ofstream out(image, std::ios::binary | std::ios::trunc);
+            out.write(reinterpret_cast<const char *>(bytes.data()), bytes.size());
+        }
+        auto dir = writeClasses("preload-image", {"com/tula/OnDisk0", "com/tula/OnDisk1"});
+        std::vector<SymbolPtr> names;
+        for (auto className : {"com/tula/InImage0", "com/tula/OnDisk0", "com/tula/InImage1", "com/tula/OnDisk1"}) {
+            names.push_back(SymbolTable::intern(className));
+        }
+
+        // Image classes are not read as files, so they neither take reader slots nor fail.
+        BootstrapClassLoader loader(vm.get(), image + ":" + dir);
+        loader.preload(names, 2);
+        loader.getPreloader()->wait();
+        auto stats = loader.getPreloader()->getStats();
+        ASSERT_EQ(4u, stats.listed);
+        ASSERT_EQ(2u, stats.inImages);
+        ASSERT_EQ(2u, stats.preloaded);
+        ASSERT_EQ(0u, stats.failed);
+
+        for (auto &name : names) {
+            auto klass = loader.loadClass(name);
+            ASSERT_NE(nullptr, klass);
+            ASSERT_EQ(name.get(), klass->name().get());
+        }
+        ASSERT_EQ(2u, loader.getPreloader()->getStats().taken);
+    }
+
+    TEST_F(TestClassPreloader, TestStopWhilePreloading) {
+        std::vector<std::string> classes;
+        std::vector<SymbolPtr> names;
+        for (int i = 0; i < 200; ++i) {
+            classes.push_back("com/tula/S" + std::to_string(i));
+            names.push_back(SymbolTable::intern(classes.back().c_str()));
+        }
+        auto dir = writeClasses("preload-stop", classes);
+        BootstrapClassLoader loader(vm.get(), dir);
+        loader.preload(names, 2);
+        for (auto &name : names) {
+            ASSERT_NE(nullptr, loader.loadClass(name));
+            if (name == names[50]) {
+                loader.stopPreloading();
+            }
+        }
+        ASSERT_EQ(200u, loader.getLoadedClasses().size());
+    }
+
+    TEST_F(TestClassPreloader, TestRecordAndReplay) {
+        auto dir = writeClasses("preload-vm", {"Init", "com/tula/A", "com/tula/B", "com/tula/C"});
+        auto order = dir + "classes.lst";
+        {
+            VM first(dir, dir + "Init.class");
+            first.setClassLoadOrder(order);
+            first.start();
+            for (auto name : {"com/tula/B", "com/tula/A", "com/tula/B"}) {
+                resolveBytecode(first, name);
+            }
+            first.saveClassLoadOrder(order);
+        }
+        ASSERT_EQ((std::vector<std::string>{"com/tula/B", "com/tula/A"}), ClassPreloader::readOrder(order));
+
+        VM second(dir, dir + "Init.class");
+        second.setClassLoadOrder(order, 1);
+        second.start();
+        resolveBytecode(second, "com/tula/A");
+        resolveBytecode(second, "com/tula/C");
+        second.stopPreloading();
+        second.saveClassLoadOrder(order);
+        ASSERT_EQ((std::vector<std::string>{"com/tula/A", "com/tula/C"}), ClassPreloader::readOrder(order));
+    }
+}
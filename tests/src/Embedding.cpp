@@ -0,0 +1,138 @@
+#include "ClassFileBuilder.hpp"
+#include <gtest/gtest.h>
+#include <tula/VM.hpp>
+
+#include <Error.hpp>
+#include <JVM.hpp>
+
+#include <thread>
+
+namespace CCW::Tula {
+
+    static jint add(void *, void *, jint a, jint b) {
+        return a + b;
+    }
+
+    static jdouble scale(void *, void *, jdouble value, jfloat factor, jlong offset) {
+        return value * factor + static_cast<jdouble>(offset);
+    }
+
+    static jboolean isNull(void *, void *, void *object) {
+        return object == nullptr;
+    }
+
+    // Calls GetVersion through the JNI function table, as natives built against jni.h do.
+    static jint version(void *env, void *) {
+        using GetVersion = jint (*)(void *);
+        auto functions = *static_cast<const GetVersion *const *>(env);
+        return functions[4](env);
+    }
+
+    // Writes a class with static natives `add(II)I`, `scale(DFJ)D`, `isNull(Ljava/lang/Object;)Z`,
+    // `version()I` and a bytecode method `run()V` to the test directory, where the VM's bootstrap loader
+    // finds it.
+    static std::string writeEmbeddedClass() {
+        ClassFileBuilder builder("Embedded");
+        for (auto [name, descriptor] : {std::pair{"add", "(II)I"}, {"scale", "(DFJ)D"},
+                                        {"isNull", "(Ljava/lang/Object;)Z"}, {"version", "()I"}}) {
+            ClassFileBuilder::MethodSpec method;
+            method.accessFlags = 0x0109;    // public static native
+            method.name = name;
+            method.descriptor = descriptor;
+            method.hasCode = false;
+            builder.addMethod(method);
+        }
+        builder.addMethod(ClassFileBuilder::emptyStaticMethod());
+        auto dir = ::testing::TempDir();
+        builder.writeTo(dir);
+        return dir;
+    }
+
+    class TestEmbedding : public ::testing::Test {
+    protected:
+        void SetUp() override {
+            vm = std::make_unique<VM>(writeEmbeddedClass(), "");
+            NativeMethod natives[] = {
+                {"add", "(II)I", reinterpret_cast<void *>(add)},
+                {"scale", "(DFJ)D", reinterpret_cast<void *>(scale)},
+                {"isNull", "(Ljava/lang/Object;)Z", reinterpret_cast<void *>(isNull)},
+                {"version", "()I", reinterpret_cast<void *>(version)},
+            };
+            vm->registerNatives("Embedded", natives, 4);
+        }
+
+        void TearDown() override {
+            vm.reset();
+        }
+
+        std::unique_ptr<VM> vm;
+    };
+
+    TEST_F(TestEmbedding, TestCall) {
+        auto addHandle = vm->resolveStatic("Embedded", "add", "(II)I");
+        ASSERT_EQ("II", addHandle.getParameterTypes());
+        ASSERT_THROW(addHandle.call<int32_t>(1, 2), Error);
+
+        vm->attachCurrentThread();
+        vm->attachCurrentThread();
+        ASSERT_TRUE(vm->isCurrentThreadAttached());
+        ASSERT_EQ(-3, addHandle.call<int32_t>(-5, 2));
+        ASSERT_THROW(addHandle.call<int64_t>(1, 2), Error);
+        ASSERT_THROW(addHandle.call<int32_t>(1), Error);
+
+        auto scaleHandle = vm->resolveStatic("Embedded", "scale", "(DFJ)D");
+        ASSERT_EQ(5, scaleHandle.getArgumentSlots());
+        ASSERT_EQ(8.0, scaleHandle.call<double>(1.5, 4.0f, int64_t{2}));
+
+        auto isNullHandle = vm->resolveStatic("Embedded", "isNull", "(Ljava/lang/Object;)Z");
+        int object;
+        ASSERT_TRUE(isNullHandle.call<bool>(static_cast<void *>(nullptr)));
+        ASSERT_FALSE(isNullHandle.call<bool>(static_cast<void *>(&object)));
+
+        ASSERT_THROW(vm->resolveStatic("Embedded", "add", "(JJ)J"), NoSuchMethodError);
+        ASSERT_THROW(vm->resolveStatic("Missing", "add", "(II)I"), NoClassDefFoundError);
+        ASSERT_EQ(0x00150000, vm->resolveStatic("Embedded", "version", "()I").call<int32_t>());
+        // Bytecode is turned away until there is an interpreter.
+        ASSERT_THROW(vm->resolveStatic("Embedded", "run", "()V"), Error);
+
+        vm->detachCurrentThread();
+        ASSERT_FALSE(vm->isCurrentThreadAttached());
+    }
+
+    TEST_F(TestEmbedding, TestBatch) {
+        auto addHandle = vm->resolveStatic("Embedded", "add", "(II)I");
+        vm->attachCurrentThread();
+
+        int32_t a[] = {1, 2, 3, 4};
+        int32_t b[] = {10, 20, 30, 40};
+        int32_t sums[4];
+        addHandle.callBatch(4, sums, a, b);
+        ASSERT_EQ((std::vector<int32_t>{11, 22, 33, 44}), std::vector<int32_t>(sums, sums + 4));
+
+        MethodHandle::Slot slots[] = {1, 1, 2, 2, static_cast<MethodHandle::Slot>(-3), 3};
+        MethodHandle::Slot results[3];
+        addHandle.invokeBatch(slots, 3, results);
+        ASSERT_EQ(2, results[0]);
+        ASSERT_EQ(4, results[1]);
+        ASSERT_EQ(0, results[2]);
+    }
+
+    TEST_F(TestEmbedding, TestThreads) {
+        auto addHandle = vm->resolveStatic("Embedded", "add", "(II)I");
+        std::vector<std::thread> threads;
+        std::vector<int32_t> results(4);
+        for (int32_t i = 0; i < 4; ++i) {
+            threads.emplace_back([this, &addHandle, &results, i] {
+                vm->attachCurrentThread();
+                for (int32_t n = 0; n < 1000; ++n) {
+                    results[i] = addHandle.call<int32_t>(results[i], i);
+                }
+                vm->detachCurrentThread();
+            });
+        }
+        for (auto &thread : threads) {
+            thread.join();
+        }
+        ASSERT_EQ((std::vector<int32_t>{0, 1000, 2000, 3000}), results);
+    }
+}
@@ -0,0 +1,179 @@
+#include "BaseTest.hpp"
+#include <gtest/gtest.h>
+
+#include <Exceptions.hpp>
+#include <Klass.hpp>
+#include <LineNumberStream.hpp>
+#include <SymbolTable.hpp>
+
+#include <random>
+
+namespace CCW::Tula {
+
+    class TestExceptions : public VMTest {
+    };
+
+    static Method::Ptr methodWithHandlers(const std::vector<ExceptionTableElement> &table, uint32_t codeLength = 64) {
+        std::vector<uint8_t> bytecode(codeLength, 0x00);
+        MethodCode code;
+        code.maxStack = 1;
+        code.maxLocals = 1;
+        code.code = bytecode.data();
+        code.codeLength = codeLength;
+        code.exceptionTable = table;
+        return Method::create(nullptr, Symbol::create("run"), Symbol::create("()V"), MethodAccessFlags::Static,
+                              &code);
+    }
+
+    static int linearHandler(const std::vector<ExceptionTableElement> &table, uint16_t bci, uint16_t thrown) {
+        for (const auto &element : table) {
+            if (element.startPc <= bci && bci < element.endPc
+                && (element.catchTypeIndex == 0 || element.catchTypeIndex == thrown)) {
+                return element.handlerPc;
+            }
+        }
+        return -1;
+    }
+
+    TEST(TestExceptionRanges, TestNestedHandlers) {
+        // try { try { [2, 5) } catch (B) { 30 } } catch (A) { 20 } finally { 40 }
+        std::vector<ExceptionTableElement> table = {
+            {2, 5, 30, 2},
+            {0, 10, 20, 1},
+            {0, 10, 40, 0},
+        };
+        auto method = methodWithHandlers(table);
+        auto catches = [](uint16_t type) { return [type](uint16_t catchType) { return catchType == type; }; };
+
+        ASSERT_EQ(30, method->findExceptionHandler(3, catches(2)));
+        ASSERT_EQ(20, method->findExceptionHandler(3, catches(1)));
+        ASSERT_EQ(40, method->findExceptionHandler(3, catches(3)));
+        ASSERT_EQ(20, method->findExceptionHandler(0, catches(1)));
+        ASSERT_EQ(40, method->findExceptionHandler(9, catches(2)));
+        ASSERT_EQ(-1, method->findExceptionHandler(10, catches(1)));
+        ASSERT_EQ(-1, method->findExceptionHandler(63, catches(1)));
+
+        // [0, 2) and [5, 10) share the same entries, but are not adjacent.
+        ASSERT_EQ(3, method->getExceptionRangeCount());
+    }
+
+    TEST(TestExceptionRanges, TestAdjacentRangesMerge) {
+        auto method = methodWithHandlers({{0, 4, 20, 0}, {4, 8, 20, 0}, {8, 12, 30, 0}});
+        ASSERT_EQ(3, method->getExceptionRangeCount());
+        auto same = methodWithHandlers({{0, 8, 20, 0}, {0, 4, 30, 1}, {4, 8, 30, 1}});
+        // Entry 0 covers both halves, but the inner entries differ, so the ranges stay apart.
+        ASSERT_EQ(2, same->getExceptionRangeCount());
+        ASSERT_EQ(nullptr, methodWithHandlers({})->findExceptionRange(0));
+    }
+
+    TEST(TestExceptionRanges, TestMatchesLinearScan) {
+        std::mt19937 random(42);
+        for (int round = 0; round < 50; ++round) {
+            std::vector<ExceptionTableElement> table;
+            auto entries = random() % 12;
+            for (uint32_t i = 0; i < entries; ++i) {
+                uint16_t start = random() % 60;
+                uint16_t end = start + 1 + random() % (64 - start);
+                table.push_back({start, end, static_cast<uint16_t>(random() % 64),
+                                 static_cast<uint16_t>(random() % 4)});
+            }
+            auto method = methodWithHandlers(table);
+            for (uint16_t bci = 0; bci < 64; ++bci) {
+                for (uint16_t thrown = 1; thrown < 4; ++thrown) {
+                    auto matches = [thrown](uint16_t catchType) { return catchType == thrown; };
+                    ASSERT_EQ(linearHandler(table, bci, thrown), method->findExceptionHandler(bci, matches));
+                }
+            }
+        }
+    }
+
+    TEST_F(TestExceptions, TestLazyStackTrace) {
+        auto klass = std::make_shared<InstanceKlass>(SymbolTable::intern("com/tula/Thrower"), nullptr,
+                                                     ClassAccessFlags::Public);
+        klass->setSourceFile(SymbolTable::intern("Thrower.java"));
+
+        std::vector<uint8_t> bytecode(8, 0x00);
+        LineNumberStreamWriter lines;
+        lines.write(0, 10);
+        lines.write(4, 12);
+        MethodCode code;
+        code.code = bytecode.data();
+        code.codeLength = bytecode.size();
+        code.lineNumbers = lines.finish();
+        auto run = klass->addMethod(Method::create(klass.get(), SymbolTable::intern("run"), SymbolTable::intern("()V"),
+                                                   MethodAccessFlags::Public, &code));
+        auto read = klass->addMethod(SymbolTable::intern("read"), SymbolTable::intern("()I"),
+                                     MethodAccessFlags::Native);
+
+        StackFrame frames[] = {{read, 0}, {run, 5}, {run, 1}};
+        auto trace = StackTrace::capture(frames, 3);
+        ASSERT_FALSE(trace->isMaterialized());
+        ASSERT_EQ(3, trace->getFrames().size());
+
+        Throwable throwable(SymbolTable::intern("java/io/IOException"), "closed", trace);
+        ASSERT_FALSE(trace->isMaterialized());
+        const auto &elements = throwable.getStackTrace();
+        ASSERT_TRUE(trace->isMaterialized());
+        ASSERT_EQ(3, elements.size());
+        ASSERT_EQ("com.tula.Thrower", elements[0].declaringClass);
+        ASSERT_EQ("read", elements[0].methodName);
+        ASSERT_EQ(StackTraceElement::NativeLineNumber, elements[0].lineNumber);
+        ASSERT_EQ("Thrower.java", elements[1].fileName);
+        ASSERT_EQ(12, elements[1].lineNumber);
+        ASSERT_EQ(10, elements[2].lineNumber);
+        ASSERT_EQ(&elements, &throwable.getStackTrace());
+
+        ASSERT_EQ(2, StackTrace::capture(frames, 3, 2)->getFrames().size());
+
+        // The trace keeps the class of its methods alive until it is read.
+        auto pinned = StackTrace::capture(frames, 3);
+        std::weak_ptr<InstanceKlass> weak = klass;
+        klass.reset();
+        ASSERT_FALSE(weak.expired());
+        ASSERT_EQ("read", pinned->getElements()[0].methodName);
+    }
+
+    TEST_F(TestExceptions, TestFastThrow) {
+        auto method = methodWithHandlers({});
+        StackFrame site[] = {{method.get(), 7}};
+        StackFrame otherSite[] = {{method.get(), 9}};
+
+        ImplicitExceptions slow;
+        ASSERT_EQ(nullptr, slow.getPreallocated(ImplicitException::NullPointer));
+        for (int i = 0; i < 4; ++i) {
+            auto npe = slow.create(ImplicitException::NullPointer, "x is null", site, 1);
+            ASSERT_TRUE(npe->getClassName()->equals("java/lang/NullPointerException"));
+            ASSERT_EQ("x is null", npe->getMessage());
+            ASSERT_NE(nullptr, npe->getBacktrace());
+        }
+
+        ImplicitExceptions fast(true, 2);
+        auto first = fast.create(ImplicitException::ArrayIndexOutOfBounds, "1", site, 1);
+        auto second = fast.create(ImplicitException::ArrayIndexOutOfBounds, "2", site, 1);
+        ASSERT_NE(nullptr, first->getBacktrace());
+        ASSERT_NE(nullptr, second->getBacktrace());
+
+        auto hot = fast.create(ImplicitException::ArrayIndexOutOfBounds, "3", site, 1);
+        ASSERT_EQ(fast.getPreallocated(ImplicitException::ArrayIndexOutOfBounds), hot);
+        ASSERT_EQ(nullptr, hot->getBacktrace());
+        ASSERT_TRUE(hot->getStackTrace().empty());
+        ASSERT_TRUE(hot->getClassName()->equals("java/lang/ArrayIndexOutOfBoundsException"));
+
+        // Other sites and other kinds are counted separately.
+        ASSERT_NE(nullptr, fast.create(ImplicitException::ArrayIndexOutOfBounds, "4", otherSite, 1)->getBacktrace());
+        ASSERT_NE(nullptr, fast.create(ImplicitException::NullPointer, "5", site, 1)->getBacktrace());
+
+        // A method tracks a bounded number of sites; the ones past it never turn hot.
+        auto busy = methodWithHandlers({});
+        for (uint16_t bci = 0; bci < 64; ++bci) {
+            StackFrame frame[] = {{busy.get(), bci}};
+            for (int i = 0; i < 3; ++i) {
+                fast.create(ImplicitException::ClassCast, "", frame, 1);
+            }
+        }
+        StackFrame late[] = {{busy.get(), 63}};
+        ASSERT_NE(nullptr, fast.create(ImplicitException::ClassCast, "", late, 1)->getBacktrace());
+        StackFrame early[] = {{busy.get(), 0}};
+        ASSERT_EQ(nullptr, fast.create(ImplicitException::ClassCast, "", early, 1)->getBacktrace());
+    }
+}
@@ -0,0 +1,38 @@
+#include <gtest/gtest.h>
+#include <InvocationCounter.hpp>
+
+namespace CCW::Tula {
+
+    TEST(TestInvocationCounter, TestIncrement) {
+        InvocationCounter counter;
+        ASSERT_EQ(0, counter.getCount());
+        ASSERT_EQ(1, counter.increment());
+        ASSERT_EQ(2, counter.increment());
+        counter.decay();
+        ASSERT_EQ(1, counter.getCount());
+        counter.reset();
+        ASSERT_EQ(0, counter.getCount());
+    }
+
+    TEST(TestInvocationCounter, TestOSRBeforeStandardCompile) {
+        CompilationPolicy policy(100, 140);
+        ASSERT_EQ(140, policy.getBackedgeThreshold());
+
+        // A method entered once whose loop keeps spinning.
+        InvocationCounter invocations;
+        InvocationCounter backedges;
+        invocations.increment();
+        ASSERT_EQ(CompileKind::None, policy.onInvocation(invocations, backedges));
+
+        // The loop passes the invocation threshold at 99 back edges, yet requests nothing before OSR: the
+        // whole method compiled then would only be entered on an invocation that never comes.
+        CompileKind kind = CompileKind::None;
+        while (kind == CompileKind::None) {
+            backedges.increment();
+            kind = policy.onBackedge(backedges);
+        }
+        ASSERT_EQ(CompileKind::OSR, kind);
+        ASSERT_EQ(policy.getBackedgeThreshold(), backedges.getCount());
+        ASSERT_EQ(CompileKind::Standard, policy.onInvocation(invocations, backedges));
+    }
+}
@@ -0,0 +1,251 @@
+#include "BaseTest.hpp"
+#include "ClassFileBuilder.hpp"
+#include <gtest/gtest.h>
+#include <tula/VM.hpp>
+
+#include <Error.hpp>
+#include <JVM.hpp>
+#include <InitBarrier.hpp>
+#include <Klass.hpp>
+#include <SharedClassTable.hpp>
+#include <SymbolTable.hpp>
+
+#include <filesystem>
+#include <thread>
+
+namespace CCW::Tula {
+
+    static jint answer(void *, void *) {
+        return 42;
+    }
+
+    static jint otherAnswer(void *, void *) {
+        return 7;
+    }
+
+    // Writes classes `Shared`, with a static native `answer()I`, and `Initialized`, which adds a
+    // <clinit>, to a directory of their own.
+    static std::string writeIsolateClasses() {
+        auto dir = ::testing::TempDir() + "isolates/";
+        std::filesystem::create_directories(dir);
+        for (auto name : {"Shared", "Initialized"}) {
+            ClassFileBuilder builder(name);
+            ClassFileBuilder::MethodSpec native;
+            native.accessFlags = 0x0109;    // public static native
+            native.name = "answer";
+            native.descriptor = "()I";
+            native.hasCode = false;
+            builder.addMethod(native);
+            if (std::string(name) == "Initialized") {
+                builder.addMethod(ClassFileBuilder::emptyStaticMethod("<clinit>"));
+            }
+            builder.writeTo(dir);
+        }
+        return dir;
+    }
+
+    static std::unique_ptr<VM> newVM(const std::string &dir, void *answerFunction) {
+        auto vm = std::make_unique<VM>(dir, "");
+        NativeMethod natives[] = {{"answer", "()I", answerFunction}};
+        vm->registerNatives("Shared", natives, 1);
+        return vm;
+    }
+
+    TEST(TestIsolates, TestCurrent) {
+        auto dir = writeIsolateClasses();
+        auto first = newVM(dir, reinterpret_cast<void *>(answer));
+        ASSERT_EQ(first.get(), VM::current());
+        auto second = newVM(dir, reinterpret_cast<void *>(answer));
+        ASSERT_EQ(second.get(), VM::current());
+
+        std::thread([&first] {
+            ASSERT_EQ(nullptr, VM::current());
+            first->attachCurrentThread();
+            ASSERT_EQ(first.get(), VM::current());
+            first->detachCurrentThread();
+        }).join();
+        ASSERT_EQ(second.get(), VM::current());
+
+        first->attachCurrentThread();
+        ASSERT_EQ(first.get(), VM::current());
+        first->detachCurrentThread();
+        second.reset();
+        first.reset();
+        ASSERT_EQ(nullptr, VM::current());
+    }
+
+    TEST(TestIsolates, TestSharedMetadata) {
+        auto dir = writeIsolateClasses();
+        auto first = newVM(dir, reinterpret_cast<void *>(answer));
+        auto firstHandle = first->resolveStatic("Shared", "answer", "()I");
+        auto second = newVM(dir, reinterpret_cast<void *>(otherAnswer));
+        auto secondHandle = second->resolveStatic("Shared", "answer", "()I");
+
+        // One parse serves both VMs, and so does the symbol table.
+        ClassFileStamp stamp;
+        ASSERT_TRUE(ClassFileStamp::of(dir + "Shared.class", stamp));
+        auto klass = SharedClassTable::find(dir + "Shared.class", stamp, false);
+        ASSERT_NE(nullptr, klass);
+        ASSERT_EQ(klass->name(), SymbolTable::intern("Shared"));
+
+        // Natives are linked per VM even though the method is shared.
+        first->attachCurrentThread();
+        ASSERT_EQ(42, firstHandle.call<int32_t>());
+        second->attachCurrentThread();
+        ASSERT_EQ(7, secondHandle.call<int32_t>());
+        ASSERT_EQ(7, second->resolveStatic("Shared", "answer", "()I").call<int32_t>());
+        second->detachCurrentThread();
+
+        // The first VM keeps working once the second is gone.
+        second.reset();
+        first->attachCurrentThread();
+        ASSERT_EQ(42, firstHandle.call<int32_t>());
+        ASSERT_EQ(42, first->resolveStatic("Shared", "answer", "()I").call<int32_t>());
+    }
+
+    TEST(TestIsolates, TestInitializationPerIsolate) {
+        auto dir = writeIsolateClasses();
+        auto first = newVM(dir, reinterpret_cast<void *>(answer));
+        auto second = newVM(dir, reinterpret_cast<void *>(answer));
+        first->attachCurrentThread();
+        first->resolveStatic("Shared", "answer", "()I");
+        ClassFileStamp stamp;
+        ASSERT_TRUE(ClassFileStamp::of(dir + "Shared.class", stamp));
+        auto klass = std::static_pointer_cast<InstanceKlass>(SharedClassTable::find(dir + "Shared.class", stamp,
+                                                                                    false));
+        ASSERT_NE(nullptr, klass);
+        ASSERT_TRUE(klass->isInitialized());
+
+        // The class is shared, its statics are not: the second VM initializes it on its own.
+        second->attachCurrentThread();
+        ASSERT_FALSE(klass->isInitialized());
+        ASSERT_EQ(ClassState::Linked, klass->getState());
+        second->resolveStatic("Shared", "answer", "()I");
+        ASSERT_TRUE(klass->isInitialized());
+
+        // A VM reusing the isolate index of a destroyed one starts with fresh class state.
+        second.reset();
+        auto third = newVM(dir, reinterpret_cast<void *>(answer));
+        third->attachCurrentThread();
+        ASSERT_FALSE(klass->isInitialized());
+        first->attachCurrentThread();
+        ASSERT_TRUE(klass->isInitialized());
+
+        // <clinit> can't run without an interpreter. The class is turned away before its initialization
+        // starts, so asking again is not answered with the NoClassDefFoundError of an erroneous class.
+        auto turnedAway = [](VM &vm) {
+            try {
+                vm.resolveStatic("Initialized", "answer", "()I");
+            } catch (const LinkageError &) {
+                return false;
+            } catch (const Error &) {
+                return true;
+            }
+            return false;
+        };
+        ASSERT_TRUE(turnedAway(*first));
+        ASSERT_TRUE(turnedAway(*first));
+        third->attachCurrentThread();
+        ASSERT_TRUE(turnedAway(*third));
+    }
+
+    TEST(TestIsolates, TestInitBarrierPerIsolate) {
+        auto dir = writeIsolateClasses();
+        auto first = newVM(dir, reinterpret_cast<void *>(answer));
+        auto second = newVM(dir, reinterpret_cast<void *>(answer));
+        auto klass = std::make_shared<InstanceKlass>(Symbol::create("com/tula/PerIsolate"), nullptr,
+                                                     ClassAccessFlags::Public);
+        klass->addMethod(Symbol::create("<clinit>"), Symbol::create("()V"), MethodAccessFlags::Static);
+        klass->link();
+
+        int runs = 0;
+        ClinitRunner runner = [&runs](InstanceKlass &, Method &) { runs++; };
+        InitBarrier barrier(klass.get());
+        first->attachCurrentThread();
+        barrier.enter(runner);
+        ASSERT_TRUE(barrier.isPatched());
+        ASSERT_TRUE(klass->isInitialized());
+
+        second->attachCurrentThread();
+        ASSERT_FALSE(barrier.isPatched());
+        ASSERT_FALSE(klass->isInitialized());
+        ASSERT_EQ(ClassState::Linked, klass->getState());
+        barrier.enter(runner);
+        ASSERT_TRUE(barrier.isPatched());
+        ASSERT_EQ(2, runs);
+
+        first->attachCurrentThread();
+        barrier.enter(runner);
+        ASSERT_EQ(2, runs);
+    }
+
+    static ClassFileBuilder::MethodSpec staticNative(const std::string &name) {
+        ClassFileBuilder::MethodSpec native;
+        native.accessFlags = 0x0109;    // public static native
+        native.name = name;
+        native.descriptor = "()I";
+        native.hasCode = false;
+        return native;
+    }
+
+    TEST(TestIsolates, TestSharedSuperInitialization) {
+        auto dir = emptyTempDir("isolates-supers");
+        ClassFileBuilder("Base").addMethod(ClassFileBuilder::emptyStaticMethod("<clinit>")).writeTo(dir);
+        ClassFileBuilder("Derived", "Base").addMethod(staticNative("answer")).writeTo(dir);
+        auto load = [](VM &vm) {
+            // Loads both classes, then stops at the <clinit> of Base.
+            ASSERT_THROW(vm.resolveStatic("Derived", "answer", "()I"), Error);
+        };
+        auto first = std::make_unique<VM>(dir, "");
+        load(*first);
+        ClassFileStamp stamp;
+        ASSERT_TRUE(ClassFileStamp::of(dir + "Derived.class", stamp));
+        auto derived = std::static_pointer_cast<InstanceKlass>(SharedClassTable::find(dir + "Derived.class", stamp,
+                                                                                      false));
+        ASSERT_NE(nullptr, derived);
+        auto base = derived->getSuperKlass();
+        ASSERT_EQ(SymbolTable::intern("Base"), base->getName());
+
+        std::vector<std::string> runs;
+        ClinitRunner runner = [&runs](InstanceKlass &klass, Method &) { runs.push_back(klass.name()->toString()); };
+        auto second = std::make_unique<VM>(dir, "");
+        load(*second);
+        derived->initialize(runner);
+        ASSERT_TRUE(base->isInitialized());
+
+        // The second VM loaded Base along with the shared Derived, so its isolate index comes back clean.
+        second.reset();
+        auto third = std::make_unique<VM>(dir, "");
+        ASSERT_FALSE(base->isInitialized());
+        load(*third);
+        derived->initialize(runner);
+        std::vector<std::string> expected{"Base", "Base"};
+        ASSERT_EQ(expected, runs);
+    }
+
+    TEST(TestIsolates, TestSharedClassOfAnotherHierarchy) {
+        auto common = emptyTempDir("isolates-common");
+        auto firstDir = emptyTempDir("isolates-first");
+        auto secondDir = emptyTempDir("isolates-second");
+        ClassFileBuilder("Derived", "Base").writeTo(common);
+        ClassFileBuilder("Base").addMethod(staticNative("first")).writeTo(firstDir);
+        ClassFileBuilder("Base").addMethod(staticNative("second")).writeTo(secondDir);
+
+        VM first(firstDir + ":" + common, "");
+        NativeMethod firstNatives[] = {{"first", "()I", reinterpret_cast<void *>(answer)}};
+        first.registerNatives("Base", firstNatives, 1);
+        first.attachCurrentThread();
+        ASSERT_EQ(42, first.resolveStatic("Derived", "first", "()I").call<int32_t>());
+        ASSERT_THROW(first.resolveStatic("Derived", "second", "()I"), NoSuchMethodError);
+
+        // Derived is the same file for both, but its super class is not: the second VM gets its own.
+        VM second(secondDir + ":" + common, "");
+        NativeMethod secondNatives[] = {{"second", "()I", reinterpret_cast<void *>(otherAnswer)}};
+        second.registerNatives("Base", secondNatives, 1);
+        second.attachCurrentThread();
+        ASSERT_EQ(7, second.resolveStatic("Derived", "second", "()I").call<int32_t>());
+        ASSERT_THROW(second.resolveStatic("Derived", "first", "()I"), NoSuchMethodError);
+        first.attachCurrentThread();
+        ASSERT_EQ(42, first.resolveStatic("Derived", "first", "()I").call<int32_t>());
+    }
+}
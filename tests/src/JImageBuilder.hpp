@@ -0,0 +1,251 @@
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <map>
+#include <set>
+#include <string>
+#include <vector>
+#include <zlib.h>
+
+namespace CCW::Tula {
+
+    // Writes jimages the way the JDK's jlink lays them out, so tests do not depend on a JDK.
+    class JImageBuilder {
+    public:
+        // Adds `/module/className.class` and records the module of its package.
+        JImageBuilder &addClass(const std::string &module, const std::string &className,
+                                const std::vector<uint8_t> &bytes, bool compress = false) {
+            auto slash = className.rfind('/');
+            auto package = className.substr(0, slash == std::string::npos ? 0 : slash);
+            std::replace(package.begin(), package.end(), '/', '.');
+            packages.emplace(package, module);
+            return addResource("/" + module + "/" + className + ".class", bytes, compress);
+        }
+
+        JImageBuilder &addResource(const std::string &name, const std::vector<uint8_t> &bytes, bool compress = false) {
+            resources.push_back({name, bytes, compress});
+            return *this;
+        }
+
+        // Writes the image in big-endian byte order, as a big-endian machine would.
+        JImageBuilder &bigEndian() {
+            swapped = true;
+            return *this;
+        }
+
+        std::vector<uint8_t> build() {
+            for (auto &entry : packages) {
+                std::vector<uint8_t> content;
+                u4(content, 0);     // not empty
+                u4(content, addString(entry.second));
+                addResource("/packages/" + entry.first, content);
+            }
+
+            std::vector<uint8_t> data;
+            std::vector<std::vector<uint8_t>> locations;
+            for (auto &resource : resources) {
+                auto stored = resource.compress ? zip(resource.bytes) : resource.bytes;
+                uint64_t attributes[8] = {};
+                splitName(resource.name, attributes);
+                attributes[5] = data.size();
+                attributes[6] = resource.compress ? stored.size() : 0;
+                attributes[7] = resource.bytes.size();
+                data.insert(data.end(), stored.begin(), stored.end());
+                locations.push_back(encodeLocation(attributes));
+            }
+
+            auto count = static_cast<uint32_t>(resources.size());
+            std::vector<int32_t> redirects(count);
+            std::vector<int64_t> slots(count, -1);
+            placeNames(redirects, slots);
+
+            std::vector<uint8_t> locationBytes;
+            std::vector<uint32_t> offsets(count);
+            for (uint32_t slot = 0; slot < count; ++slot) {
+                offsets[slot] = static_cast<uint32_t>(locationBytes.size());
+                auto &location = locations[slots[slot]];
+                locationBytes.insert(locationBytes.end(), location.begin(), location.end());
+            }
+
+            std::vector<uint8_t> out;
+            u4(out, 0xCAFEDADA);
+            u4(out, 1u << 16u);         // version 1.0
+            u4(out, 0);                 // flags
+            u4(out, count);
+            u4(out, count);
+            u4(out, static_cast<uint32_t>(locationBytes.size()));
+            u4(out, static_cast<uint32_t>(strings.size()));
+            for (auto redirect : redirects) {
+                u4(out, static_cast<uint32_t>(redirect));
+            }
+            for (auto offset : offsets) {
+                u4(out, offset);
+            }
+            out.insert(out.end(), locationBytes.begin(), locationBytes.end());
+            out.insert(out.end(), strings.begin(), strings.end());
+            out.insert(out.end(), data.begin(), data.end());
+            return out;
+        }
+
+        static int32_t hashOf(const std::string &name, int32_t seed = 0x01000193) {
+            auto hash = static_cast<uint32_t>(seed);
+            for (auto c : name) {
+                hash = (hash * 0x01000193u) ^ static_cast<uint8_t>(c);
+            }
+            return static_cast<int32_t>(hash & 0x7FFFFFFFu);
+        }
+
+    private:
+        struct Resource {
+            std::string name;
+            std::vector<uint8_t> bytes;
+            bool compress;
+        };
+
+        void u4(std::vector<uint8_t> &out, uint32_t value) const {
+            for (int i = 0; i < 4; ++i) {
+                out.push_back(static_cast<uint8_t>(value >> (swapped ? 24 - 8 * i : 8 * i)));
+            }
+        }
+
+        void u8(std::vector<uint8_t> &out, uint64_t value) const {
+            for (int i = 0; i < 8; ++i) {
+                out.push_back(static_cast<uint8_t>(value >> (swapped ? 56 - 8 * i : 8 * i)));
+            }
+        }
+
+        uint32_t addString(const std::string &value) {
+            if (strings.empty()) {
+                strings.push_back(0);   // offset 0 is the empty string
+            }
+            if (value.empty()) {
+                return 0;
+            }
+            auto it = stringOffsets.find(value);
+            if (it != stringOffsets.end()) {
+                return it->second;
+            }
+            auto offset = static_cast<uint32_t>(strings.size());
+            strings.insert(strings.end(), value.begin(), value.end());
+            strings.push_back(0);
+            stringOffsets.emplace(value, offset);
+            return offset;
+        }
+
+        // Module, parent, base and extension, as jlink splits names.
+        void splitName(std::string name, uint64_t *attributes) {
+            std::string module, parent, base, extension;
+            if (name.rfind("/packages/", 0) == 0) {
+                module = "packages";
+                base = name.substr(10);
+            } else {
+                auto slash = name.find('/', 1);
+                if (name.size() >= 2 && name[0] == '/' && slash != std::string::npos) {
+                    module = name.substr(1, slash - 1);
+                    name = name.substr(slash + 1);
+                }
+                slash = name.rfind('/');
+                if (slash != std::string::npos && slash > 1) {
+                    parent = name.substr(0, slash);
+                    name = name.substr(slash + 1);
+                }
+                auto dot = name.rfind('.');
+                base = dot == std::string::npos ? name : name.substr(0, dot);
+                extension = dot == std::string::npos ? "" : name.substr(dot + 1);
+            }
+            attributes[1] = addString(module);
+            attributes[2] = addString(parent);
+            attributes[3] = addString(base);
+            attributes[4] = addString(extension);
+        }
+
+        static std::vector<uint8_t> encodeLocation(const uint64_t *attributes) {
+            std::vector<uint8_t> out;
+            for (uint8_t kind = 1; kind < 8; ++kind) {
+                auto value = attributes[kind];
+                if (value == 0) {
+                    continue;
+                }
+                int length = 1;
+                while (length < 8 && value >> (8 * length) != 0) {
+                    length++;
+                }
+                out.push_back(static_cast<uint8_t>(kind << 3u | (length - 1)));
+                for (int i = length - 1; i >= 0; --i) {
+                    out.push_back(static_cast<uint8_t>(value >> (8 * i)));
+                }
+            }
+            out.push_back(0);
+            return out;
+        }
+
+        // A perfect hash: buckets of several names get a seed that spreads them over free slots, and
+        // names alone in their bucket take the free slots left.
+        void placeNames(std::vector<int32_t> &redirects, std::vector<int64_t> &slots) const {
+            auto count = resources.size();
+            std::vector<std::vector<size_t>> buckets(count);
+            for (size_t i = 0; i < count; ++i) {
+                buckets[hashOf(resources[i].name) % count].push_back(i);
+            }
+            std::vector<size_t> order(count);
+            for (size_t i = 0; i < count; ++i) {
+                order[i] = i;
+            }
+            std::stable_sort(order.begin(), order.end(), [&buckets](size_t a, size_t b) {
+                return buckets[a].size() > buckets[b].size();
+            });
+            size_t nextFree = 0;
+            for (auto bucket : order) {
+                auto &names = buckets[bucket];
+                if (names.size() > 1) {
+                    for (int32_t seed = 1;; ++seed) {
+                        std::set<size_t> taken;
+                        for (auto name : names) {
+                            auto slot = hashOf(resources[name].name, seed) % count;
+                            if (slots[slot] != -1 || !taken.insert(slot).second) {
+                                break;
+                            }
+                        }
+                        if (taken.size() == names.size()) {
+                            for (auto name : names) {
+                                slots[hashOf(resources[name].name, seed) % count] = static_cast<int64_t>(name);
+                            }
+                            redirects[bucket] = seed;
+                            break;
+                        }
+                    }
+                } else if (names.size() == 1) {
+                    while (slots[nextFree] != -1) {
+                        nextFree++;
+                    }
+                    slots[nextFree] = static_cast<int64_t>(names[0]);
+                    redirects[bucket] = -1 - static_cast<int32_t>(nextFree);
+                }
+            }
+        }
+
+        std::vector<uint8_t> zip(const std::vector<uint8_t> &bytes) {
+            auto bound = compressBound(static_cast<uLong>(bytes.size()));
+            std::vector<uint8_t> compressed(bound);
+            compress2(compressed.data(), &bound, bytes.data(), static_cast<uLong>(bytes.size()), Z_BEST_COMPRESSION);
+            compressed.resize(bound);
+            std::vector<uint8_t> out;
+            u4(out, 0xCAFEFAFA);
+            u8(out, compressed.size());
+            u8(out, bytes.size());
+            u4(out, addString("zip"));
+            u4(out, 0);     // no configuration
+            out.push_back(1);   // terminal
+            out.insert(out.end(), compressed.begin(), compressed.end());
+            return out;
+        }
+
+    private:
+        std::vector<Resource> resources;
+        std::map<std::string, std::string> packages;
+        std::vector<uint8_t> strings;
+        std::map<std::string, uint32_t> stringOffsets;
+        bool swapped = false;
+    };
+}
@@ -0,0 +1,507 @@
+#include "BaseTest.hpp"
+#include "ClassFileBuilder.hpp"
+#include <gtest/gtest.h>
+#include <ClazzLoader.hpp>
+#include <Klass.hpp>
+#include <InitBarrier.hpp>
+#include <InlineCache.hpp>
+#include <Error.hpp>
+#include <SymbolTable.hpp>
+
+#include <chrono>
+#include <stdexcept>
+#include <thread>
+
+namespace CCW::Tula {
+
+    static InstanceKlass::Ptr newKlass(const char *name, ClassAccessFlags flags = ClassAccessFlags::Public) {
+        return std::make_shared<InstanceKlass>(Symbol::create(name), nullptr, flags);
+    }
+
+    static InstanceKlass::Ptr newInterface(const char *name) {
+        return newKlass(name, ClassAccessFlags::Public | ClassAccessFlags::Interface | ClassAccessFlags::Abstract);
+    }
+
+    TEST(TestKlass, TestVTableOverride) {
+        auto object = newKlass("java/lang/Object");
+        auto objectToString = object->addMethod(Symbol::create("toString"), Symbol::create("()Ljava/lang/String;"),
+                                                MethodAccessFlags::Public);
+        auto objectHashCode = object->addMethod(Symbol::create("hashCode"), Symbol::create("()I"),
+                                                MethodAccessFlags::Public);
+        object->addMethod(Symbol::create("<init>"), Symbol::create("()V"), MethodAccessFlags::Public);
+        object->link();
+        ASSERT_EQ(2, object->getVTable().size());
+
+        auto a = newKlass("com/tula/A");
+        a->setSuperKlass(object);
+        auto aToString = a->addMethod(Symbol::create("toString"), Symbol::create("()Ljava/lang/String;"),
+                                      MethodAccessFlags::Public);
+        auto aRun = a->addMethod(Symbol::create("run"), Symbol::create("()V"), MethodAccessFlags::Public);
+        auto aFinal = a->addMethod(Symbol::create("done"), Symbol::create("()V"),
+                                   MethodAccessFlags::Public | MethodAccessFlags::Final);
+        auto aStatic = a->addMethod(Symbol::create("create"), Symbol::create("()V"),
+                                    MethodAccessFlags::Public | MethodAccessFlags::Static);
+        a->link();
+
+        ASSERT_EQ(3, a->getVTable().size());
+        ASSERT_EQ(objectToString->getVTableIndex(), aToString->getVTableIndex());
+        ASSERT_EQ(2, aRun->getVTableIndex());
+        ASSERT_EQ(Method::InvalidIndex, aFinal->getVTableIndex());
+        ASSERT_EQ(Method::InvalidIndex, aStatic->getVTableIndex());
+
+        ASSERT_EQ(aToString, a->selectVirtual(objectToString));
+        ASSERT_EQ(objectHashCode, a->selectVirtual(objectHashCode));
+        ASSERT_EQ(aFinal, a->selectVirtual(aFinal));
+    }
+
+    TEST(TestKlass, TestPackagePrivateOverride) {
+        auto base = newKlass("com/tula/Base");
+        auto baseRun = base->addMethod(Symbol::create("run"), Symbol::create("()V"), MethodAccessFlags{});
+        base->link();
+
+        auto other = newKlass("com/other/Derived");
+        other->setSuperKlass(base);
+        auto otherRun = other->addMethod(Symbol::create("run"), Symbol::create("()V"), MethodAccessFlags::Public);
+        other->link();
+        ASSERT_NE(baseRun->getVTableIndex(), otherRun->getVTableIndex());
+        ASSERT_EQ(baseRun, other->selectVirtual(baseRun));
+
+        auto same = newKlass("com/tula/Derived");
+        same->setSuperKlass(base);
+        auto sameRun = same->addMethod(Symbol::create("run"), Symbol::create("()V"), MethodAccessFlags{});
+        same->link();
+        ASSERT_EQ(sameRun, same->selectVirtual(baseRun));
+    }
+
+    TEST(TestKlass, TestITable) {
+        auto runnable = newInterface("java/lang/Runnable");
+        auto runnableRun = runnable->addMethod(Symbol::create("run"), Symbol::create("()V"),
+                                               MethodAccessFlags::Public | MethodAccessFlags::Abstract);
+        runnable->link();
+
+        auto task = newInterface("com/tula/Task");
+        task->addLocalInterface(runnable);
+        auto taskName = task->addMethod(Symbol::create("name"), Symbol::create("()Ljava/lang/String;"),
+                                        MethodAccessFlags::Public | MethodAccessFlags::Abstract);
+        auto taskPriority = task->addMethod(Symbol::create("priority"), Symbol::create("()I"),
+                                            MethodAccessFlags::Public);
+        task->link();
+        ASSERT_EQ(0, taskName->getITableIndex());
+        ASSERT_EQ(1, taskPriority->getITableIndex());
+
+        auto impl = newKlass("com/tula/Impl");
+        impl->addLocalInterface(task);
+        auto implName = impl->addMethod(Symbol::create("name"), Symbol::create("()Ljava/lang/String;"),
+                                        MethodAccessFlags::Public);
+        auto implRun = impl->addMethod(Symbol::create("run"), Symbol::create("()V"), MethodAccessFlags::Public);
+        impl->link();
+
+        ASSERT_EQ(2, impl->getITable().size());
+        ASSERT_TRUE(impl->implements(runnable.get()));
+        ASSERT_EQ(implName, impl->selectInterface(taskName));
+        ASSERT_EQ(implRun, impl->selectInterface(runnableRun));
+        // Default method inherited from the interface.
+        ASSERT_EQ(taskPriority, impl->selectInterface(taskPriority));
+
+        auto unrelated = newKlass("com/tula/Unrelated");
+        unrelated->link();
+        ASSERT_EQ(nullptr, unrelated->selectInterface(runnableRun));
+    }
+
+    TEST(TestKlass, TestMaximallySpecific) {
+        auto run = Symbol::create("run");
+        auto v = Symbol::create("()V");
+        auto base = newInterface("com/tula/Base");
+        auto baseRun = base->addMethod(run, v, MethodAccessFlags::Public);
+        auto redeclared = newInterface("com/tula/Redeclared");
+        redeclared->addLocalInterface(base);
+        auto redeclaredRun = redeclared->addMethod(run, v, MethodAccessFlags::Public | MethodAccessFlags::Abstract);
+        auto refined = newInterface("com/tula/Refined");
+        refined->addLocalInterface(base);
+        auto refinedRun = refined->addMethod(run, v, MethodAccessFlags::Public);
+        auto unrelated = newInterface("com/tula/Unrelated");
+        auto unrelatedRun = unrelated->addMethod(run, v, MethodAccessFlags::Public | MethodAccessFlags::Abstract);
+
+        // The default of a sub interface wins over its super interface's, whatever the declaration order.
+        auto a = newKlass("com/tula/A");
+        a->addLocalInterface(base);
+        a->addLocalInterface(refined);
+        ASSERT_EQ(refinedRun, a->findMethod(run.get(), v.get()));
+        a->link();
+        ASSERT_EQ(refinedRun, a->findMethod(run.get(), v.get()));
+        ASSERT_EQ(refinedRun, a->selectInterface(baseRun));
+        ASSERT_EQ(refinedRun, a->selectInterface(refinedRun));
+
+        // An abstract redeclaration hides the default it overrides.
+        auto b = newKlass("com/tula/B");
+        b->addLocalInterface(redeclared);
+        b->link();
+        ASSERT_EQ(redeclaredRun, b->findMethod(run.get(), v.get()));
+        ASSERT_EQ(redeclaredRun, b->selectInterface(baseRun));
+
+        // A single default wins over an abstract method of an unrelated interface.
+        auto c = newKlass("com/tula/C");
+        c->addLocalInterface(unrelated);
+        c->addLocalInterface(base);
+        c->link();
+        ASSERT_EQ(baseRun, c->selectInterface(unrelatedRun));
+        ASSERT_EQ(baseRun, c->selectInterface(baseRun));
+
+        // Conflicting defaults select nothing to run, so an abstract method takes the slot.
+        auto other = newInterface("com/tula/Other");
+        auto otherRun = other->addMethod(run, v, MethodAccessFlags::Public);
+        auto d = newKlass("com/tula/D");
+        d->addLocalInterface(base);
+        d->addLocalInterface(other);
+        d->addLocalInterface(unrelated);
+        d->link();
+        ASSERT_EQ(unrelatedRun, d->selectInterface(baseRun));
+        ASSERT_EQ(unrelatedRun, d->selectInterface(otherRun));
+
+        // A sub class adding a more specific interface selects again what its super class inherited.
+        auto e = newKlass("com/tula/E");
+        e->setSuperKlass(c);
+        e->addLocalInterface(refined);
+        e->link();
+        ASSERT_EQ(c->getVTable().size(), e->getVTable().size());
+        ASSERT_EQ(refinedRun, e->selectInterface(baseRun));
+        ASSERT_EQ(baseRun, c->selectInterface(baseRun));
+    }
+
+    TEST(TestKlass, TestDefaultOverride) {
+        auto run = Symbol::create("run");
+        auto v = Symbol::create("()V");
+        auto i = newInterface("com/tula/I");
+        auto iRun = i->addMethod(run, v, MethodAccessFlags::Public);
+        i->link();
+        auto a = newKlass("com/tula/A");
+        a->addLocalInterface(i);
+        a->link();
+        auto b = newKlass("com/tula/B");
+        b->setSuperKlass(a);
+        auto bRun = b->addMethod(run, v, MethodAccessFlags::Public);
+        b->link();
+
+        // invokevirtual A.run resolves to the default method and still dispatches to the override.
+        ASSERT_EQ(iRun, a->findMethod(run.get(), v.get()));
+        ASSERT_EQ(iRun, a->selectVirtual(iRun));
+        ASSERT_EQ(bRun, b->selectVirtual(iRun));
+        ASSERT_EQ(bRun, b->selectInterface(iRun));
+        InlineCache cache(iRun);
+        ASSERT_EQ(iRun, cache.invokeVirtual(a.get()));
+        ASSERT_EQ(bRun, cache.invokeVirtual(b.get()));
+    }
+
+    TEST(TestKlass, TestITableIndex) {
+        std::vector<InstanceKlass::Ptr> interfaces;
+        std::vector<Method *> methods;
+        auto impl = newKlass("com/tula/Impl");
+        for (int i = 0; i < 40; ++i) {
+            auto name = "com/tula/I" + std::to_string(i);
+            interfaces.push_back(newInterface(name.c_str()));
+            interfaces.back()->addMethod(Symbol::create(("m" + std::to_string(i)).c_str()), Symbol::create("()V"),
+                                         MethodAccessFlags::Public | MethodAccessFlags::Abstract);
+            interfaces.back()->addMethod(Symbol::create("run"), Symbol::create("()V"),
+                                         MethodAccessFlags::Public | MethodAccessFlags::Abstract);
+            if (i % 2 == 0) {
+                impl->addLocalInterface(interfaces.back());
+            }
+        }
+        for (int i = 0; i < 40; i += 2) {
+            methods.push_back(impl->addMethod(Symbol::create(("m" + std::to_string(i)).c_str()), Symbol::create("()V"),
+                                              MethodAccessFlags::Public));
+        }
+        auto implRun = impl->addMethod(Symbol::create("run"), Symbol::create("()V"), MethodAccessFlags::Public);
+        impl->link();
+
+        ASSERT_EQ(20, impl->getITable().size());
+        for (int i = 0; i < 40; ++i) {
+            const auto &interfaceMethods = interfaces[i]->getMethods();
+            if (i % 2 == 0) {
+                ASSERT_EQ(methods[i / 2], impl->selectInterface(interfaceMethods[0].get())) << i;
+                ASSERT_EQ(implRun, impl->selectInterface(interfaceMethods[1].get())) << i;
+            } else {
+                ASSERT_EQ(nullptr, impl->itableMethod(interfaces[i].get(), 0)) << i;
+            }
+        }
+    }
+
+    TEST(TestKlass, TestInlineCache) {
+        auto base = newKlass("com/tula/Base");
+        auto baseRun = base->addMethod(Symbol::create("run"), Symbol::create("()V"), MethodAccessFlags::Public);
+        base->link();
+        auto a = newKlass("com/tula/A");
+        a->setSuperKlass(base);
+        auto aRun = a->addMethod(Symbol::create("run"), Symbol::create("()V"), MethodAccessFlags::Public);
+        a->link();
+        auto b = newKlass("com/tula/B");
+        b->setSuperKlass(base);
+        b->link();
+
+        InlineCache cache(baseRun);
+        ASSERT_EQ(InlineCache::State::Clean, cache.getState());
+        ASSERT_EQ(aRun, cache.invokeVirtual(a.get()));
+        ASSERT_EQ(InlineCache::State::Monomorphic, cache.getState());
+        ASSERT_EQ(aRun, cache.invokeVirtual(a.get()));
+        ASSERT_EQ(InlineCache::State::Monomorphic, cache.getState());
+        ASSERT_EQ(baseRun, cache.invokeVirtual(b.get()));
+        ASSERT_EQ(InlineCache::State::Megamorphic, cache.getState());
+        ASSERT_EQ(aRun, cache.invokeVirtual(a.get()));
+    }
+
+    class TestMemberLookup : public VMTest {
+    };
+
+    TEST_F(TestMemberLookup, TestFindMembers) {
+        auto objectName = SymbolTable::intern("java/lang/Object");
+        auto init = SymbolTable::intern("<init>");
+        auto voidDescriptor = SymbolTable::intern("()V");
+        auto run = SymbolTable::intern("run");
+        auto count = SymbolTable::intern("count");
+        auto intDescriptor = SymbolTable::intern("I");
+
+        auto object = std::make_shared<InstanceKlass>(objectName, nullptr, ClassAccessFlags::Public);
+        auto objectInit = object->addMethod(init, voidDescriptor, MethodAccessFlags::Public);
+        object->link();
+
+        auto runnable = std::make_shared<InstanceKlass>(
+            SymbolTable::intern("java/lang/Runnable"), nullptr,
+            ClassAccessFlags::Public | ClassAccessFlags::Interface | ClassAccessFlags::Abstract);
+        auto runnableRun = runnable->addMethod(run, voidDescriptor,
+                                               MethodAccessFlags::Public | MethodAccessFlags::Abstract);
+        auto constant = runnable->addField(count, intDescriptor,
+                                           FieldAccessFlags::Public | FieldAccessFlags::Static |
+                                           FieldAccessFlags::Final);
+        runnable->link();
+
+        auto task = std::make_shared<InstanceKlass>(SymbolTable::intern("com/tula/Task"), nullptr,
+                                                    ClassAccessFlags::Public | ClassAccessFlags::Abstract);
+        task->setSuperKlass(object);
+        task->addLocalInterface(runnable);
+        for (int i = 0; i < 32; ++i) {
+            auto name = "m" + std::to_string(i);
+            task->addMethod(SymbolTable::intern(name.c_str()), voidDescriptor, MethodAccessFlags::Public);
+        }
+        auto taskCount = task->addField(count, SymbolTable::intern("J"), FieldAccessFlags::Private);
+        task->link();
+
+        ASSERT_EQ(objectInit, task->findMethod(init.get(), voidDescriptor.get()));
+        ASSERT_EQ(runnableRun, task->findMethod(run.get(), voidDescriptor.get()));
+        ASSERT_EQ(nullptr, task->findLocalMethod(run.get(), voidDescriptor.get()));
+        ASSERT_EQ(SymbolTable::intern("m17").get(), task->findLocalMethod(SymbolTable::intern("m17").get(),
+                                                                          voidDescriptor.get())->name().get());
+        ASSERT_EQ(taskCount, task->findField(count.get(), SymbolTable::intern("J").get()));
+        ASSERT_EQ(constant, task->findField(count.get(), intDescriptor.get()));
+
+        auto missing = SymbolTable::intern("missing");
+        ASSERT_EQ(nullptr, task->findMethod(missing.get(), voidDescriptor.get()));
+        ASSERT_EQ(nullptr, task->findMethod(missing.get(), voidDescriptor.get()));
+        ASSERT_EQ(nullptr, task->findField(missing.get(), intDescriptor.get()));
+
+        ASSERT_EQ(2, task->rememberedMisses());
+
+        // Remembered misses don't keep their names interned.
+        std::weak_ptr<Symbol> missingName = missing;
+        missing.reset();
+        SymbolTable::sweep();
+        ASSERT_TRUE(missingName.expired());
+        ASSERT_EQ(0, task->rememberedMisses());
+        missing = SymbolTable::intern("missing");
+        ASSERT_EQ(nullptr, task->findMethod(missing.get(), voidDescriptor.get()));
+        ASSERT_EQ(runnableRun, task->findMethod(run.get(), voidDescriptor.get()));
+
+        // However many distinct lookups fail, only the latest ones in each slot are kept.
+        std::vector<SymbolPtr> names;
+        for (int i = 0; i < 1000; ++i) {
+            names.push_back(SymbolTable::intern(("missing" + std::to_string(i)).c_str()));
+            ASSERT_EQ(nullptr, task->findMethod(names.back().get(), voidDescriptor.get()));
+            ASSERT_EQ(nullptr, task->findField(names.back().get(), intDescriptor.get()));
+        }
+        ASSERT_LE(task->rememberedMisses(), 2 * InstanceKlass::MissingSlots);
+        ASSERT_GT(task->rememberedMisses(), 0u);
+        for (const auto &name : names) {
+            ASSERT_EQ(nullptr, task->findMethod(name.get(), voidDescriptor.get()));
+        }
+        names.clear();
+        SymbolTable::sweep();
+        ASSERT_EQ(0, task->rememberedMisses());
+    }
+
+    static void addClinit(const InstanceKlass::Ptr &klass) {
+        klass->addMethod(Symbol::create("<clinit>"), Symbol::create("()V"), MethodAccessFlags::Static);
+    }
+
+    class TestClassInitialization : public VMTest {
+    };
+
+    TEST_F(TestClassInitialization, TestOrder) {
+        auto object = newKlass("java/lang/Object");
+        object->link();
+        auto withDefault = newInterface("com/tula/WithDefault");
+        withDefault->addMethod(Symbol::create("run"), Symbol::create("()V"), MethodAccessFlags::Public);
+        addClinit(withDefault);
+        withDefault->link();
+        auto abstractOnly = newInterface("com/tula/AbstractOnly");
+        abstractOnly->addMethod(Symbol::create("run"), Symbol::create("()V"),
+                                MethodAccessFlags::Public | MethodAccessFlags::Abstract);
+        addClinit(abstractOnly);
+        abstractOnly->link();
+        auto a = newKlass("com/tula/A");
+        a->setSuperKlass(object);
+        addClinit(a);
+        a->link();
+        auto b = newKlass("com/tula/B");
+        b->setSuperKlass(a);
+        b->addLocalInterface(withDefault);
+        b->addLocalInterface(abstractOnly);
+        addClinit(b);
+        b->link();
+
+        std::vector<std::string> order;
+        ClinitRunner runner = [&](InstanceKlass &klass, Method &clinit) {
+            ASSERT_EQ(ClassState::BeingInitialized, klass.getState());
+            ASSERT_TRUE(clinit.isStaticInitializer());
+            ASSERT_EQ(&klass, clinit.getHolder());
+            order.push_back(klass.name()->toString());
+            // A recursive request from the initializing thread returns at once.
+            klass.initialize(runner);
+        };
+
+        ASSERT_FALSE(b->isInitialized());
+        b->initialize(runner);
+        ASSERT_TRUE(b->isInitialized());
+        ASSERT_TRUE(a->isInitialized());
+        ASSERT_TRUE(object->isInitialized());
+        ASSERT_TRUE(withDefault->isInitialized());
+        ASSERT_FALSE(abstractOnly->isInitialized());
+        std::vector<std::string> expected{"com/tula/A", "com/tula/WithDefault", "com/tula/B"};
+        ASSERT_EQ(expected, order);
+
+        b->initialize(runner);
+        ASSERT_EQ(3, order.size());
+    }
+
+    TEST_F(TestClassInitialization, TestErrors) {
+        auto object = newKlass("java/lang/Object");
+        object->link();
+        auto failing = newKlass("com/tula/Failing");
+        failing->setSuperKlass(object);
+        addClinit(failing);
+        failing->link();
+        auto sub = newKlass("com/tula/Sub");
+        sub->setSuperKlass(failing);
+        sub->link();
+
+        int runs = 0;
+        ClinitRunner throwing = [&runs](InstanceKlass &, Method &) {
+            runs++;
+            throw std::runtime_error("boom");
+        };
+        ASSERT_THROW(sub->initialize(throwing), ExceptionInInitializerError);
+        ASSERT_EQ(ClassState::InitializationError, failing->getState());
+        ASSERT_EQ(ClassState::InitializationError, sub->getState());
+        ASSERT_THROW(failing->initialize(throwing), NoClassDefFoundError);
+        ASSERT_EQ(1, runs);
+
+        auto linkageFailure = newKlass("com/tula/LinkageFailure");
+        linkageFailure->setSuperKlass(object);
+        addClinit(linkageFailure);
+        linkageFailure->link();
+        ClinitRunner throwingError = [](InstanceKlass &, Method &) {
+            throw VerifyError("bad code");
+        };
+        ASSERT_THROW(linkageFailure->initialize(throwingError), VerifyError);
+    }
+
+    TEST_F(TestClassInitialization, TestConcurrentBarrier) {
+        auto object = newKlass("java/lang/Object");
+        object->link();
+        auto slow = newKlass("com/tula/Slow");
+        slow->setSuperKlass(object);
+        addClinit(slow);
+        slow->link();
+
+        std::atomic<int> runs{0};
+        int staticField = 0;
+        ClinitRunner runner = [&](InstanceKlass &klass, Method &) {
+            if (klass.name()->equals("com/tula/Slow")) {
+                std::this_thread::sleep_for(std::chrono::milliseconds(20));
+                staticField = 42;
+                runs++;
+            }
+        };
+
+        InitBarrier barrier(slow.get());
+        ASSERT_FALSE(barrier.isPatched());
+        std::vector<std::thread> threads;
+        std::atomic<int> observed{0};
+        for (int i = 0; i < 8; ++i) {
+            threads.emplace_back([&] {
+                Isolate::Scope isolate(vm->getIsolate());
+                barrier.enter(runner);
+                if (staticField == 42) {
+                    observed++;
+                }
+            });
+        }
+        for (auto &thread : threads) {
+            thread.join();
+        }
+        ASSERT_EQ(1, runs.load());
+        ASSERT_EQ(8, observed.load());
+        ASSERT_TRUE(barrier.isPatched());
+        ASSERT_TRUE(slow->isInitialized());
+
+        // A thread working for no VM does not see the state of the first isolate.
+        std::thread([&] {
+            ASSERT_EQ(Isolate::None, Isolate::current());
+            ASSERT_FALSE(barrier.isPatched());
+            ASSERT_FALSE(slow->isInitialized());
+            ASSERT_THROW(barrier.enter(runner), Error);
+        }).join();
+        ASSERT_EQ(1, runs.load());
+    }
+
+    class TestLoadSupers : public VMTest {
+    };
+
+    TEST_F(TestLoadSupers, TestResolve) {
+        auto dir = emptyTempDir("supers");
+        ClassFileBuilder("com/tula/Base").writeTo(dir);
+        ClassFileBuilder("com/tula/Task").accessFlags(0x0601).writeTo(dir);   // public interface
+        ClassFileBuilder("com/tula/Derived", "com/tula/Base").addInterface("com/tula/Task").writeTo(dir);
+        ClassFileBuilder("com/tula/CycleA", "com/tula/CycleB").writeTo(dir);
+        ClassFileBuilder("com/tula/CycleB", "com/tula/CycleA").writeTo(dir);
+        ClassFileBuilder("com/tula/ImplementsClass").addInterface("com/tula/Base").writeTo(dir);
+        ClassFileBuilder("com/tula/ExtendsInterface", "com/tula/Task").writeTo(dir);
+        ClassFileBuilder("com/tula/Orphan", "com/tula/Missing").writeTo(dir);
+
+        BootstrapClassLoader loader(vm.get(), dir);
+        auto load = [&loader](const char *name) {
+            return std::static_pointer_cast<InstanceKlass>(loader.loadClass(SymbolTable::intern(name)));
+        };
+        auto derived = load("com/tula/Derived");
+        ASSERT_NE(nullptr, derived);
+        ASSERT_EQ(load("com/tula/Base"), derived->getSuperKlass());
+        ASSERT_EQ((std::vector<InstanceKlass::Ptr>{load("com/tula/Task")}), derived->getLocalInterfaces());
+        // The class path has no JDK, so the loader provides java/lang/Object.
+        auto object = derived->getSuperKlass()->getSuperKlass();
+        ASSERT_NE(nullptr, object);
+        ASSERT_EQ(SymbolTable::intern("java/lang/Object"), object->getName());
+        ASSERT_EQ(nullptr, object->getSuperKlass());
+        derived->link();
+        ASSERT_TRUE(object->isLinked());
+        ASSERT_TRUE(derived->implements(load("com/tula/Task").get()));
+
+        ASSERT_THROW(load("com/tula/CycleA"), ClassCircularityError);
+        ASSERT_THROW(load("com/tula/ImplementsClass"), IncompatibleClassChangeError);
+        ASSERT_THROW(load("com/tula/ExtendsInterface"), IncompatibleClassChangeError);
+        // Classes whose supers fail to load are not published, so each attempt fails alike.
+        for (int i = 0; i < 2; ++i) {
+            ASSERT_THROW(load("com/tula/Orphan"), NoClassDefFoundError);
+        }
+        ASSERT_EQ(nullptr, loader.loadClass(SymbolTable::intern("com/tula/Missing")));
+        ASSERT_THROW(loader.defineClass(dir + "com/tula/Missing.class"), NoClassDefFoundError);
+        ASSERT_THROW(VM(dir, dir + "com/tula/Missing.class").start(), NoClassDefFoundError);
+    }
+}
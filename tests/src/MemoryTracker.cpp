@@ -0,0 +1,74 @@
+#include "BaseTest.hpp"
+#include "ClassFileBuilder.hpp"
+#include <gtest/gtest.h>
+#include <tula/VM.hpp>
+
+#include <MemoryTracker.hpp>
+#include <Metaspace.hpp>
+#include <Method.hpp>
+#include <Symbol.hpp>
+
+namespace CCW::Tula {
+
+    TEST(TestMemoryTracker, TestSymbols) {
+        auto before = MemoryTracker::usage(MemoryTag::Symbols);
+        {
+            auto symbol = Symbol::create("com/tula/Tracked");
+            auto during = MemoryTracker::usage(MemoryTag::Symbols);
+            ASSERT_EQ(before.count + 1, during.count);
+            ASSERT_GE(during.used - before.used, static_cast<int64_t>(sizeof(Symbol) + 16));
+            ASSERT_EQ(during.used - before.used, during.reserved - before.reserved);
+        }
+        auto after = MemoryTracker::usage(MemoryTag::Symbols);
+        ASSERT_EQ(before.count, after.count);
+        ASSERT_EQ(before.used, after.used);
+    }
+
+    TEST(TestMemoryTracker, TestMetaspace) {
+        auto metaspaceBefore = MemoryTracker::usage(MemoryTag::Metaspace);
+        auto methodsBefore = MemoryTracker::usage(MemoryTag::Methods);
+        {
+            Metaspace metaspace(1024);
+            metaspace.allocate(100, 8, MemoryTag::Methods);
+            auto methods = MemoryTracker::usage(MemoryTag::Methods);
+            auto reserved = MemoryTracker::usage(MemoryTag::Metaspace);
+            // Arena memory is used by the allocating category and reserved by the metaspace.
+            ASSERT_EQ(methodsBefore.used + 100, methods.used);
+            ASSERT_EQ(methodsBefore.reserved, methods.reserved);
+            ASSERT_EQ(metaspaceBefore.reserved + 1024, reserved.reserved);
+            ASSERT_EQ(metaspaceBefore.count + 1, reserved.count);
+        }
+        ASSERT_EQ(methodsBefore.used, MemoryTracker::usage(MemoryTag::Methods).used);
+        ASSERT_EQ(metaspaceBefore.reserved, MemoryTracker::usage(MemoryTag::Metaspace).reserved);
+        ASSERT_EQ(metaspaceBefore.count, MemoryTracker::usage(MemoryTag::Metaspace).count);
+    }
+
+    TEST(TestMemoryTracker, TestReport) {
+        auto dir = emptyTempDir("memory");
+        ClassFileBuilder::writeRunnable(dir, "Measured");
+
+        VM vm(dir, "");
+        resolveBytecode(vm, "Measured");
+        auto report = vm.memoryReport(1);
+        ASSERT_EQ(static_cast<size_t>(MemoryTag::Count), report.processCategories.size());
+        int64_t used = 0;
+        for (const auto &category : report.processCategories) {
+            used += category.used;
+        }
+        ASSERT_EQ(used, report.processUsed);
+        ASSERT_GT(report.processReserved, 0);
+        ASSERT_EQ(1u, report.largestClasses.size());
+        ASSERT_EQ("Measured", report.largestClasses[0].name);
+        ASSERT_GT(report.largestClasses[0].bytes, sizeof(Method));
+        ASSERT_EQ(1u, report.largestConstantPools.size());
+        ASSERT_GT(report.largestConstantPools[0].bytes, 0u);
+
+        auto text = report.toText();
+        ASSERT_NE(std::string::npos, text.find("constant pools"));
+        ASSERT_NE(std::string::npos, text.find("Measured"));
+        auto json = report.toJson();
+        ASSERT_EQ(0u, json.find("{\"processUsed\":" + std::to_string(report.processUsed) + ","));
+        ASSERT_NE(std::string::npos, json.find("\"name\":\"symbol table\""));
+        ASSERT_NE(std::string::npos, json.find("\"largestClasses\":[{\"name\":\"Measured\""));
+    }
+}
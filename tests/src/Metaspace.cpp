@@ -0,0 +1,88 @@
+#include "BaseTest.hpp"
+#include "ClassFileBuilder.hpp"
+#include <gtest/gtest.h>
+
+#include <ClazzLoader.hpp>
+#include <Metaspace.hpp>
+#include <SymbolTable.hpp>
+
+namespace CCW::Tula {
+
+    TEST(TestMetaspace, TestAllocate) {
+        auto before = Metaspace::totalReserved();
+        {
+            Metaspace metaspace(1024);
+            auto small = metaspace.allocate(10, 1);
+            auto aligned = metaspace.allocate(8, 64);
+            ASSERT_EQ(0, reinterpret_cast<uintptr_t>(aligned) % 64);
+            ASSERT_NE(small, aligned);
+            ASSERT_EQ(1024, metaspace.getReserved());
+
+            // Large blocks get their own chunk and leave the current one open.
+            metaspace.allocate(4096);
+            ASSERT_EQ(1024 + 4096 + alignof(std::max_align_t), metaspace.getReserved());
+            auto next = static_cast<uint8_t *>(metaspace.allocate(1, 1));
+            ASSERT_LT(next, static_cast<uint8_t *>(aligned) + 1024);
+            ASSERT_GE(Metaspace::totalReserved(), before + metaspace.getReserved());
+
+            auto array = metaspace.createArray<int64_t>(MemoryTag::Metaspace, 16);
+            for (int i = 0; i < 16; ++i) {
+                ASSERT_EQ(0, array[i]);
+            }
+        }
+        ASSERT_EQ(before, Metaspace::totalReserved());
+    }
+
+    TEST(TestMetaspace, TestFinalizers) {
+        auto symbol = Symbol::create("com/tula/Finalized");
+        std::vector<int> order;
+        struct Recorder {
+            std::vector<int> &order;
+            int id;
+
+            ~Recorder() {
+                order.push_back(id);
+            }
+        };
+        {
+            Metaspace metaspace;
+            metaspace.create<SymbolPtr>(MemoryTag::Metaspace, symbol);
+            metaspace.create<Recorder>(MemoryTag::Metaspace, Recorder{order, 1});
+            metaspace.create<Recorder>(MemoryTag::Metaspace, Recorder{order, 2});
+            ASSERT_EQ(2, symbol.use_count());
+            order.clear();  // the temporaries
+        }
+        ASSERT_EQ(1, symbol.use_count());
+        ASSERT_EQ((std::vector<int>{2, 1}), order);
+    }
+
+    class TestClassUnloading : public VMTest {
+    };
+
+    TEST_F(TestClassUnloading, TestLoaderArenaIsFreed) {
+        auto dir = emptyTempDir("unloading");
+        ClassFileBuilder::writeRunnable(dir, "com/tula/plugin/Redeployed", "onlyInRedeployed");
+
+        SymbolTable::sweep();
+        auto symbols = SymbolTable::size();
+        std::weak_ptr<Metaspace> arena;
+        for (int deployment = 0; deployment < 3; ++deployment) {
+            auto loader = std::make_shared<BootstrapClassLoader>(vm.get(), dir);
+            arena = loader->getMetaspace();
+            auto klass = std::static_pointer_cast<InstanceKlass>(
+                loader->loadClass(SymbolTable::intern("com/tula/plugin/Redeployed")));
+            ASSERT_NE(nullptr, klass);
+            ASSERT_NE(nullptr, klass->findLocalMethod(SymbolTable::intern("onlyInRedeployed").get(),
+                                                      SymbolTable::intern("()V").get()));
+            ASSERT_GT(arena.lock()->getUsed(), klass->getMethods()[0]->getSize());
+
+            // The class keeps the arena alive after its loader is gone.
+            loader.reset();
+            ASSERT_FALSE(arena.expired());
+            klass.reset();
+            ASSERT_TRUE(arena.expired());
+            SymbolTable::sweep();
+            ASSERT_EQ(symbols, SymbolTable::size());
+        }
+    }
+}
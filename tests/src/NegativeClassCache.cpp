@@ -0,0 +1,94 @@
+#include "BaseTest.hpp"
+#include "ClassFileBuilder.hpp"
+#include <gtest/gtest.h>
+
+#include <Error.hpp>
+#include <NegativeClassCache.hpp>
+#include <SymbolTable.hpp>
+
+#include <filesystem>
+
+namespace CCW::Tula {
+
+    class TestNegativeClassCache : public VMTest {
+    };
+
+    static std::string emptyClassPath(const std::string &name) {
+        auto dir = emptyTempDir(name);
+        std::filesystem::create_directories(dir + "com/tula");
+        return dir;
+    }
+
+    TEST_F(TestNegativeClassCache, TestRevalidation) {
+        auto dir = emptyClassPath("negative");
+        NegativeClassCache cache({dir}, 64, std::chrono::milliseconds(0));
+        auto missing = SymbolTable::intern("com/tula/Missing");
+        auto other = SymbolTable::intern("com/tula/Other");
+        auto nowhere = SymbolTable::intern("org/nowhere/Missing");
+        ASSERT_FALSE(cache.isAbsent(missing));
+        cache.recordAbsent(missing);
+        cache.recordAbsent(other);
+        cache.recordAbsent(nowhere);
+        ASSERT_TRUE(cache.isAbsent(missing));
+        ASSERT_TRUE(cache.isAbsent(nowhere));
+
+        // A new file in the package forgets the absences of that package only.
+        ClassFileBuilder::writeRunnable(dir, "com/tula/Missing");
+        ASSERT_FALSE(cache.isAbsent(missing));
+        ASSERT_FALSE(cache.isAbsent(other));
+        ASSERT_TRUE(cache.isAbsent(nowhere));
+        std::filesystem::create_directories(dir + "org/nowhere");
+        ASSERT_FALSE(cache.isAbsent(nowhere));
+
+        // A file written before the absence is recorded is seen.
+        cache.recordAbsent(missing);
+        ASSERT_FALSE(cache.isAbsent(missing));
+
+        auto stats = cache.getStats();
+        ASSERT_EQ(8u, stats.lookups);
+        ASSERT_EQ(3u, stats.hits);
+        ASSERT_EQ(4u, stats.misses);
+        ASSERT_EQ(3u, stats.invalidations);
+        ASSERT_EQ(0u, stats.size);
+    }
+
+    TEST_F(TestNegativeClassCache, TestCapacity) {
+        auto dir = emptyClassPath("negative-capacity");
+        NegativeClassCache cache({dir}, 16);
+        std::vector<SymbolPtr> names;
+        for (int i = 0; i < 1000; ++i) {
+            names.push_back(SymbolTable::intern(("com/tula/Missing" + std::to_string(i)).c_str()));
+            cache.recordAbsent(names.back());
+        }
+        auto stats = cache.getStats();
+        ASSERT_LE(stats.size, 16u);
+        ASSERT_EQ(1000u, stats.size + stats.evictions);
+        // The newest absences are kept.
+        ASSERT_TRUE(cache.isAbsent(names.back()));
+
+        cache.invalidate();
+        ASSERT_FALSE(cache.isAbsent(names.back()));
+        ASSERT_EQ(0u, cache.getStats().size);
+    }
+
+    TEST_F(TestNegativeClassCache, TestVM) {
+        auto dir = emptyClassPath("negative-vm");
+        VM vm(dir, "");
+        for (int i = 0; i < 3; ++i) {
+            ASSERT_THROW(vm.resolveStatic("com/tula/Optional", "run", "()V"), NoClassDefFoundError);
+        }
+        auto stats = vm.classLookupStats();
+        ASSERT_EQ(1u, stats.misses);
+        ASSERT_EQ(2u, stats.hits);
+        ASSERT_EQ(3u, stats.lookups);
+        ASSERT_EQ(1u, stats.size);
+        ASSERT_NEAR(2.0 / 3, stats.hitRate(), 1e-9);
+        ASSERT_GT(stats.missesPerSecond(), 0);
+
+        ClassFileBuilder::writeRunnable(dir, "com/tula/Optional");
+        vm.classPathChanged();
+        resolveBytecode(vm, "com/tula/Optional");
+        // Only the super class java/lang/Object is absent now; the loader provides one.
+        ASSERT_EQ(1u, vm.classLookupStats().size);
+    }
+}
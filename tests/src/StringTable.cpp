@@ -0,0 +1,173 @@
+#include "BaseTest.hpp"
+#include "ClassFileBuilder.hpp"
+#include <gtest/gtest.h>
+
+#include <classfile/ClassFileParser.hpp>
+#include <Klass.hpp>
+#include <StringDeduplication.hpp>
+#include <StringTable.hpp>
+#include <SymbolTable.hpp>
+
+#include <thread>
+
+namespace CCW::Tula {
+
+    class TestStringTable : public VMTest {
+    };
+
+    TEST(TestJavaString, TestCompactStrings) {
+        auto ascii = JavaString::fromModifiedUtf8("hello");
+        ASSERT_TRUE(ascii->isLatin1());
+        ASSERT_EQ(5, ascii->length());
+        ASSERT_EQ(5, ascii->getValue()->size());
+        ASSERT_EQ('e', ascii->charAt(1));
+        ASSERT_EQ(99162322, ascii->hashCode());
+
+        // "café" has a char above 0x7F but below 0x100, so it still fits in Latin-1.
+        auto latin1 = JavaString::fromModifiedUtf8("caf\xC3\xA9");
+        ASSERT_TRUE(latin1->isLatin1());
+        ASSERT_EQ(u"café", latin1->toUtf16());
+
+        // U+4E2D needs UTF-16; an embedded NUL is C0 80 in modified UTF-8.
+        auto utf16 = JavaString::fromModifiedUtf8("a\xE4\xB8\xAD\xC0\x80");
+        ASSERT_EQ(JavaString::Coder::UTF16, utf16->getCoder());
+        ASSERT_EQ(3, utf16->length());
+        ASSERT_EQ(6, utf16->getValue()->size());
+        ASSERT_EQ(0x4E2D, utf16->charAt(1));
+        ASSERT_EQ(0, utf16->charAt(2));
+        jchar chars[] = {'a', 0x4E2D, 0};
+        ASSERT_TRUE(utf16->equals(*JavaString::fromUtf16(chars, 3)));
+        ASSERT_EQ(JavaString::fromUtf16(chars, 3)->hashCode(), utf16->hashCode());
+
+        jchar narrow[] = {'h', 'e', 'l', 'l', 'o'};
+        auto fromUtf16 = JavaString::fromUtf16(narrow, 5);
+        ASSERT_TRUE(fromUtf16->isLatin1());
+        ASSERT_TRUE(fromUtf16->equals(*ascii));
+
+        auto malformed = JavaString::fromModifiedUtf8("\xE4\xB8");
+        ASSERT_EQ(u"��", malformed->toUtf16());
+    }
+
+    TEST_F(TestStringTable, TestIntern) {
+        auto a = StringTable::intern(JavaString::fromModifiedUtf8("java"));
+        auto b = StringTable::intern(JavaString::fromModifiedUtf8("java"));
+        ASSERT_EQ(a, b);
+        ASSERT_EQ(a, StringTable::intern(SymbolTable::intern("java").get()));
+        ASSERT_EQ(nullptr, StringTable::lookup(*JavaString::fromModifiedUtf8("javac")));
+        ASSERT_EQ(a, StringTable::lookup(*JavaString::fromModifiedUtf8("java")));
+        ASSERT_EQ(1, StringTable::size());
+
+        // Strings are not symbols: interning one leaves the other table alone.
+        ASSERT_FALSE(SymbolTable::contains(Symbol::create("javac")));
+    }
+
+    TEST_F(TestStringTable, TestConcurrentIntern) {
+        std::vector<JavaString::Ptr> results(8);
+        std::vector<std::thread> threads;
+        for (size_t i = 0; i < results.size(); ++i) {
+            threads.emplace_back([&results, i] {
+                for (int n = 0; n < 200; ++n) {
+                    auto string = StringTable::intern(JavaString::fromModifiedUtf8(std::to_string(n).c_str()));
+                    if (n == 7) {
+                        results[i] = string;
+                    }
+                }
+            });
+        }
+        for (auto &thread : threads) {
+            thread.join();
+        }
+        for (const auto &result : results) {
+            ASSERT_EQ(results[0], result);
+        }
+        ASSERT_EQ(200, StringTable::size());
+    }
+
+    TEST_F(TestStringTable, TestLdcResolution) {
+        ClassFileBuilder builder("com/tula/Strings");
+        auto hello = builder.string("hello");
+        auto again = builder.string("hello");
+        auto other = builder.string("world");
+        auto bytes = builder.build();
+        auto klass = std::static_pointer_cast<InstanceKlass>(ClassFileParser::parse(bytes.data(), bytes.size()));
+        auto &cp = *klass->getConstantPool();
+
+        ASSERT_TRUE(cp.getStringSymbolAt(hello)->equals("hello"));
+        ASSERT_EQ(0, StringTable::size());
+        auto resolved = cp.resolveStringAt(hello);
+        ASSERT_EQ(1, StringTable::size());
+        ASSERT_EQ(resolved, cp.resolveStringAt(hello));
+        ASSERT_EQ(resolved, cp.resolveStringAt(again));
+        ASSERT_NE(resolved, cp.resolveStringAt(other));
+        ASSERT_EQ(u"world", cp.resolveStringAt(other)->toUtf16());
+
+        // The pool keeps its strings: it may be shared by VMs that outlive the table they came from.
+        vm.reset();
+        ASSERT_EQ(u"hello", resolved->toUtf16());
+        ASSERT_EQ(resolved, cp.resolveStringAt(again));
+    }
+
+    TEST(TestStringDeduplication, TestDeduplicate) {
+        StringDeduplication dedup;
+        auto a = JavaString::fromModifiedUtf8("duplicated text");
+        auto b = JavaString::fromModifiedUtf8("duplicated text");
+        auto c = JavaString::fromModifiedUtf8("something else");
+        ASSERT_NE(a->getValue(), b->getValue());
+        dedup.enqueue(a);
+        dedup.enqueue(b);
+        dedup.enqueue(c);
+        {
+            auto dropped = JavaString::fromModifiedUtf8("dropped");
+            dedup.enqueue(dropped);
+        }
+
+        auto stats = dedup.deduplicate();
+        ASSERT_EQ(3, stats.inspected);
+        ASSERT_EQ(1, stats.deduplicated);
+        ASSERT_EQ(15, stats.bytesSaved);
+        ASSERT_EQ(a->getValue(), b->getValue());
+        ASSERT_TRUE(a->equals(*b));
+
+        // Later passes still merge into arrays seen before.
+        auto d = JavaString::fromModifiedUtf8("duplicated text");
+        dedup.enqueue(d);
+        ASSERT_EQ(1, dedup.deduplicate().deduplicated);
+        ASSERT_EQ(a->getValue(), d->getValue());
+        ASSERT_EQ(2, dedup.getTotalStats().deduplicated);
+    }
+
+    TEST(TestStringDeduplication, TestBackground) {
+        StringDeduplication dedup;
+        auto a = JavaString::fromModifiedUtf8("background");
+        auto b = JavaString::fromModifiedUtf8("background");
+        dedup.enqueue(a);
+        dedup.enqueue(b);
+        dedup.start(std::chrono::milliseconds(1));
+        for (int i = 0; i < 1000 && a->getValue() != b->getValue(); ++i) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+        dedup.stop();
+        ASSERT_EQ(a->getValue(), b->getValue());
+    }
+
+    TEST_F(TestStringTable, TestSharedDeduplication) {
+        auto before = JavaString::fromModifiedUtf8("shared text");
+        vm->enableStringDeduplication(std::chrono::hours(1));
+        auto pass = StringDeduplication::shared(std::chrono::milliseconds(1));
+        auto a = JavaString::fromModifiedUtf8("shared text");
+        auto b = JavaString::fromModifiedUtf8("shared text");
+
+        // Only strings created while the pass runs are queued.
+        auto stats = pass->deduplicate();
+        ASSERT_EQ(2, stats.inspected);
+        ASSERT_EQ(1, stats.deduplicated);
+        ASSERT_EQ(a->getValue(), b->getValue());
+        ASSERT_NE(before->getValue(), a->getValue());
+
+        // The pass stops with the last VM holding it, and strings are no longer queued.
+        pass.reset();
+        vm.reset();
+        auto after = JavaString::fromModifiedUtf8("shared text");
+        ASSERT_EQ(0, StringDeduplication::shared(std::chrono::hours(1))->deduplicate().inspected);
+    }
+}
@@ -0,0 +1,20 @@
+#include "BaseTest.hpp"
+#include <gtest/gtest.h>
+
+#include "SymbolTable.hpp"
+
+namespace CCW::Tula {
+
+    class TestSymbolTable : public VMTest {
+    };
+
+    TEST_F(TestSymbolTable, TestIntern) {
+        auto a = SymbolTable::intern("java/lang/Object");
+        auto b = SymbolTable::intern("java/lang/Object");
+        auto c = SymbolTable::intern("java/lang/Objec");
+        ASSERT_EQ(a.get(), b.get());
+        ASSERT_NE(a.get(), c.get());
+        ASSERT_TRUE(SymbolTable::contains(a));
+        ASSERT_FALSE(SymbolTable::contains(Symbol::create("java/lang/String")));
+    }
+}
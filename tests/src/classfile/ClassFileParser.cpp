@@ -0,0 +1,232 @@
+#include "../BaseTest.hpp"
+#include "../ClassFileBuilder.hpp"
+#include <gtest/gtest.h>
+
+#include <classfile/ClassFileParser.hpp>
+#include <SymbolTable.hpp>
+
+namespace CCW::Tula {
+
+    class TestClassFileParser : public VMTest {
+    };
+
+    static ClassFileBuilder::MethodSpec mainMethod() {
+        ClassFileBuilder::MethodSpec method;
+        method.accessFlags = 0x0009;
+        method.name = "main";
+        method.descriptor = "([Ljava/lang/String;)V";
+        method.maxStack = 2;
+        method.maxLocals = 3;
+        // iconst_0, istore_1, iload_1, iconst_2, iadd, istore_2, return
+        method.code = {0x03, 0x3c, 0x1b, 0x05, 0x60, 0x3d, 0xb1};
+        method.lineNumbers = {{0, 5}, {2, 6}, {6, 7}};
+        return method;
+    }
+
+    TEST_F(TestClassFileParser, TestMethods) {
+        ClassFileBuilder builder("com/tula/Test");
+        builder.sourceFile("Test.java");
+        builder.addField(0x0002, "count", "J");
+
+        ClassFileBuilder::MethodSpec init;
+        init.name = "<init>";
+        init.descriptor = "()V";
+        init.maxStack = 1;
+        init.maxLocals = 1;
+        // aload_0, invokespecial Object.<init>, return
+        auto objectInit = builder.methodRef("java/lang/Object", "<init>", "()V");
+        init.code = {0x2a, 0xb7, (uint8_t) (objectInit >> 8u), (uint8_t) objectInit, 0xb1};
+        builder.addMethod(init);
+
+        auto main = mainMethod();
+        main.exceptionTable = {{0, 6, 6, builder.classRef("java/lang/Throwable")}};
+        builder.addMethod(main);
+
+        ClassFileBuilder::MethodSpec run;
+        run.accessFlags = 0x0401;
+        run.name = "run";
+        run.descriptor = "(JD)I";
+        run.hasCode = false;
+        builder.addMethod(run);
+
+        auto bytes = builder.build();
+        auto klass = std::static_pointer_cast<InstanceKlass>(ClassFileParser::parse(bytes.data(), bytes.size()));
+        ASSERT_TRUE(klass->name()->equals("com/tula/Test"));
+        ASSERT_TRUE(klass->getSourceFile()->equals("Test.java"));
+        ASSERT_EQ(1, klass->getFields().size());
+        ASSERT_EQ(3, klass->getMethods().size());
+
+        auto mainMethod = klass->findLocalMethod(SymbolTable::intern("main").get(),
+                                                 SymbolTable::intern("([Ljava/lang/String;)V").get());
+        ASSERT_NE(nullptr, mainMethod);
+        ASSERT_TRUE(mainMethod->isStatic());
+        ASSERT_EQ(1, mainMethod->getArgumentSlots());
+        ASSERT_EQ(2, mainMethod->getMaxStack());
+        ASSERT_EQ(3, mainMethod->getMaxLocals());
+        ASSERT_EQ(7, mainMethod->getCodeLength());
+        ASSERT_EQ(0, memcmp(main.code.data(), mainMethod->getCode(), main.code.size()));
+        ASSERT_EQ(0, reinterpret_cast<uintptr_t>(mainMethod) % Method::Alignment);
+
+        ASSERT_EQ(1, mainMethod->getExceptionTableLength());
+        auto handler = mainMethod->getExceptionTable()[0];
+        ASSERT_EQ(0, handler.startPc);
+        ASSERT_EQ(6, handler.endPc);
+        ASSERT_EQ(6, handler.handlerPc);
+        ASSERT_TRUE(klass->getConstantPool()->getTagAt(handler.catchTypeIndex).isUnresolvedClass());
+
+        ASSERT_TRUE(mainMethod->hasLineNumbers());
+        ASSERT_EQ(5, mainMethod->getLineNumber(0));
+        ASSERT_EQ(5, mainMethod->getLineNumber(1));
+        ASSERT_EQ(6, mainMethod->getLineNumber(2));
+        ASSERT_EQ(7, mainMethod->getLineNumber(6));
+
+        auto initMethod = klass->findLocalMethod(SymbolTable::intern("<init>").get(),
+                                                 SymbolTable::intern("()V").get());
+        ASSERT_EQ(1, initMethod->getArgumentSlots());
+        ASSERT_FALSE(initMethod->hasLineNumbers());
+        ASSERT_EQ(-1, initMethod->getLineNumber(0));
+
+        auto runMethod = klass->findLocalMethod(SymbolTable::intern("run").get(),
+                                                SymbolTable::intern("(JD)I").get());
+        ASSERT_FALSE(runMethod->hasCode());
+        ASSERT_EQ(5, runMethod->getArgumentSlots());
+    }
+
+    TEST_F(TestClassFileParser, TestInvalidMethods) {
+        {
+            ClassFileBuilder builder("com/tula/Test");
+            auto method = mainMethod();
+            method.hasCode = false;
+            builder.addMethod(method);
+            auto bytes = builder.build();
+            ASSERT_THROW(ClassFileParser::parse(bytes.data(), bytes.size()), ClassFormatError);
+        }
+        {
+            ClassFileBuilder builder("com/tula/Test");
+            auto method = mainMethod();
+            method.descriptor = "(Ljava/lang/String)V";
+            builder.addMethod(method);
+            auto bytes = builder.build();
+            ASSERT_THROW(ClassFileParser::parse(bytes.data(), bytes.size()), ClassFormatError);
+        }
+        {
+            ClassFileBuilder builder("com/tula/Test");
+            auto method = mainMethod();
+            method.exceptionTable = {{0, 8, 0, 0}};
+            builder.addMethod(method);
+            auto bytes = builder.build();
+            ASSERT_THROW(ClassFileParser::parse(bytes.data(), bytes.size()), ClassFormatError);
+        }
+        {
+            ClassFileBuilder builder("com/tula/Test");
+            builder.addMethod(mainMethod());
+            builder.addMethod(mainMethod());
+            auto bytes = builder.build();
+            ASSERT_THROW(ClassFileParser::parse(bytes.data(), bytes.size()), ClassFormatError);
+        }
+    }
+
+    TEST_F(TestClassFileParser, TestTryParse) {
+        ClassFileBuilder builder("com/tula/Test");
+        builder.addMethod(mainMethod());
+        auto bytes = builder.build();
+        ParseError error;
+        ASSERT_NE(nullptr, ClassFileParser::tryParse(bytes.data(), bytes.size(), error));
+        ASSERT_FALSE(error);
+        ASSERT_EQ(ParseErrorCode::None, error.getCode());
+
+        ASSERT_EQ(nullptr, ClassFileParser::tryParse(bytes.data(), 30, error));
+        ASSERT_EQ(ParseErrorCode::Truncated, error.getCode());
+        ASSERT_EQ("Truncated class file", error.message());
+        ASSERT_LE(error.getOffset(), 30u);
+
+        auto corrupt = bytes;
+        corrupt[3] = 0x00;
+        ASSERT_EQ(nullptr, ClassFileParser::tryParse(corrupt.data(), corrupt.size(), error));
+        ASSERT_EQ(ParseErrorCode::InvalidMagic, error.getCode());
+        ASSERT_EQ(4u, error.getOffset());
+        ASSERT_EQ("Invalid Class file magic 3405691392.", error.message());
+        ASSERT_STREQ("InvalidMagic", ParseError::codeName(error.getCode()));
+
+        auto extended = bytes;
+        extended.push_back(0);
+        ASSERT_EQ(nullptr, ClassFileParser::tryParse(extended.data(), extended.size(), error));
+        ASSERT_EQ(ParseErrorCode::ExtraBytes, error.getCode());
+        ASSERT_EQ(bytes.size(), error.getOffset());
+
+        ClassFileBuilder duplicate("com/tula/Test");
+        duplicate.addMethod(mainMethod());
+        duplicate.addMethod(mainMethod());
+        bytes = duplicate.build();
+        ClassFileParser parser(bytes.data(), bytes.size());
+        ASSERT_EQ(nullptr, parser.tryParse());
+        ASSERT_EQ(ParseErrorCode::InvalidMethod, parser.getError().getCode());
+        ASSERT_EQ("Duplicate method main", parser.getError().message());
+        try {
+            ClassFileParser::parse(bytes.data(), bytes.size());
+            FAIL();
+        } catch (const ClassFormatError &e) {
+            ASSERT_STREQ("Duplicate method main", e.what());
+        }
+    }
+
+    TEST_F(TestClassFileParser, TestVersions) {
+        auto parseVersion = [](uint16_t major, uint16_t minor) {
+            ClassFileBuilder builder("com/tula/Test");
+            builder.version(major, minor);
+            builder.addMethod(mainMethod());
+            auto bytes = builder.build();
+            return ClassFileParser::parse(bytes.data(), bytes.size());
+        };
+        for (uint16_t major : {45, 52, 53, 61, 65, 69}) {
+            ASSERT_EQ(major, std::static_pointer_cast<InstanceKlass>(parseVersion(major, 0))->getMajorVersion());
+        }
+        ASSERT_NE(nullptr, parseVersion(45, 3));
+        ASSERT_THROW(parseVersion(44, 0), UnsupportedClassVersionError);
+        ASSERT_THROW(parseVersion(70, 0), UnsupportedClassVersionError);
+        // Preview features of any release.
+        ASSERT_THROW(parseVersion(61, 0xFFFF), UnsupportedClassVersionError);
+
+        ClassFileBuilder builder("com/tula/Test");
+        builder.version(70);
+        auto bytes = builder.build();
+        ParseError error;
+        ASSERT_EQ(nullptr, ClassFileParser::tryParse(bytes.data(), bytes.size(), error));
+        ASSERT_EQ(ParseErrorCode::UnsupportedVersion, error.getCode());
+        ASSERT_EQ("Unsupported class file version 70.0", error.message());
+    }
+
+    TEST_F(TestClassFileParser, TestDynamicConstant) {
+        ClassFileBuilder builder("com/tula/Test");
+        auto index = builder.dynamicConstant(0, "value", "I");
+        builder.addMethod(mainMethod());
+        auto bytes = builder.build();
+        ASSERT_THROW(ClassFileParser::parse(bytes.data(), bytes.size()), ClassFormatError);
+
+        builder.version(55);
+        bytes = builder.build();
+        auto klass = std::static_pointer_cast<InstanceKlass>(ClassFileParser::parse(bytes.data(), bytes.size()));
+        ASSERT_EQ(ConstantType::Dynamic, klass->getConstantPool()->getConstantTypeAt(index));
+    }
+
+    TEST(TestLineNumberStream, TestRoundTrip) {
+        std::vector<std::pair<uint16_t, uint16_t>> entries = {
+            {0, 10}, {3, 11}, {3, 11}, {40, 9}, {41, 1000}, {65535, 65535}, {12, 2}
+        };
+        LineNumberStreamWriter writer;
+        for (const auto &entry : entries) {
+            writer.write(entry.first, entry.second);
+        }
+        auto bytes = writer.finish();
+        LineNumberStreamReader reader(bytes.data());
+        for (size_t i = 0; i < entries.size(); ++i) {
+            if (i == 2) {
+                continue;   // repeated entry is dropped
+            }
+            ASSERT_TRUE(reader.next());
+            ASSERT_EQ(entries[i].first, reader.getBci());
+            ASSERT_EQ(entries[i].second, reader.getLine());
+        }
+        ASSERT_FALSE(reader.next());
+    }
+}
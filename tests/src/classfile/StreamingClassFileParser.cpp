@@ -0,0 +1,153 @@
+#include "../BaseTest.hpp"
+#include "../ClassFileBuilder.hpp"
+#include <gtest/gtest.h>
+
+#include <ClassGenerator.hpp>
+#include <classfile/ClassFileParser.hpp>
+#include <classfile/StreamingClassFileParser.hpp>
+
+#include <random>
+
+namespace CCW::Tula {
+
+    class TestStreamingClassFileParser : public VMTest {
+    };
+
+    // Feeds `bytes` in chunks of the given sizes, repeated until all of it is fed.
+    static std::shared_ptr<InstanceKlass> parseInChunks(const std::vector<uint8_t> &bytes,
+                                                        const std::vector<size_t> &chunks) {
+        StreamingClassFileParser parser;
+        size_t offset = 0;
+        for (size_t i = 0; offset < bytes.size(); ++i) {
+            auto size = std::min(chunks[i % chunks.size()], bytes.size() - offset);
+            // A copy that dies with the call, so the parser can't keep pointers into it.
+            std::vector<uint8_t> chunk(bytes.begin() + offset, bytes.begin() + offset + size);
+            parser.feed(chunk.data(), chunk.size());
+            offset += size;
+        }
+        EXPECT_TRUE(parser.isComplete());
+        EXPECT_EQ(0u, parser.getBufferedBytes());
+        return std::static_pointer_cast<InstanceKlass>(parser.finish());
+    }
+
+    static void expectSameClass(InstanceKlass &expected, InstanceKlass &actual) {
+        ASSERT_EQ(expected.name().get(), actual.name().get());
+        ASSERT_EQ(expected.getSuperClassName().get(), actual.getSuperClassName().get());
+        ASSERT_EQ(expected.getSourceFile().get(), actual.getSourceFile().get());
+        ASSERT_EQ(expected.getConstantPool()->getSize(), actual.getConstantPool()->getSize());
+        ASSERT_EQ(expected.getFields().size(), actual.getFields().size());
+        for (size_t i = 0; i < expected.getFields().size(); ++i) {
+            const auto &field = *expected.getFields()[i];
+            const auto &other = *actual.getFields()[i];
+            ASSERT_EQ(field.name().get(), other.name().get());
+            ASSERT_EQ(field.descriptor().get(), other.descriptor().get());
+            ASSERT_EQ(field.getConstantValueIndex(), other.getConstantValueIndex());
+        }
+        ASSERT_EQ(expected.getMethods().size(), actual.getMethods().size());
+        for (size_t i = 0; i < expected.getMethods().size(); ++i) {
+            const auto &method = *expected.getMethods()[i];
+            const auto &other = *actual.getMethods()[i];
+            ASSERT_EQ(method.name().get(), other.name().get());
+            ASSERT_EQ(method.descriptor().get(), other.descriptor().get());
+            ASSERT_EQ(method.getMaxStack(), other.getMaxStack());
+            ASSERT_EQ(method.getCodeLength(), other.getCodeLength());
+            ASSERT_EQ(0, memcmp(method.getCode(), other.getCode(), method.getCodeLength()));
+            ASSERT_EQ(method.getExceptionTableLength(), other.getExceptionTableLength());
+            ASSERT_EQ(method.hasLineNumbers(), other.hasLineNumbers());
+        }
+    }
+
+    TEST_F(TestStreamingClassFileParser, TestChunkings) {
+        CorpusSpec spec;
+        spec.classes = 8;
+        spec.annotations = 2;
+        spec.codeLength = 200;
+        ClassGenerator generator(spec);
+        std::mt19937 random(7);
+        for (size_t i = 0; i < spec.classes; ++i) {
+            auto bytes = generator.generate(i);
+            ClassFileParser oneShot(bytes.data(), bytes.size());
+            auto expected = std::static_pointer_cast<InstanceKlass>(oneShot.parse());
+
+            std::vector<size_t> randomChunks;
+            for (int j = 0; j < 64; ++j) {
+                randomChunks.push_back(1 + random() % 97);
+            }
+            for (const auto &chunks : std::vector<std::vector<size_t>>{{1}, {2}, {3}, {7}, {4096}, randomChunks}) {
+                auto klass = parseInChunks(bytes, chunks);
+                expectSameClass(*expected, *klass);
+            }
+        }
+    }
+
+    TEST_F(TestStreamingClassFileParser, TestParsesBeforeTheEnd) {
+        ClassFileBuilder builder("com/tula/Stream");
+        builder.sourceFile("Stream.java");
+        builder.addInterface("java/lang/Runnable");
+        builder.addField(0x0002, "count", "J", {{"Lcom/tula/Marker;", {}}});
+        for (int i = 0; i < 16; ++i) {
+            ClassFileBuilder::MethodSpec method;
+            method.accessFlags = 0x0009;
+            method.name = "m" + std::to_string(i);
+            method.descriptor = "()V";
+            method.code = std::vector<uint8_t>(1000, 0x00);   // nop
+            method.code.push_back(0xb1);                        // return
+            method.lineNumbers = {{0, 1}};
+            builder.addMethod(method);
+        }
+        auto bytes = builder.build();
+
+        StreamingClassFileParser parser;
+        size_t largest = 0;
+        for (size_t i = 0; i < bytes.size() / 2; ++i) {
+            parser.feed(&bytes[i], 1);
+            largest = std::max(largest, parser.getBufferedBytes());
+        }
+        // Only the method being received is held back.
+        ASSERT_FALSE(parser.isComplete());
+        ASSERT_LT(largest, 1100u);
+        parser.feed(bytes.data() + bytes.size() / 2, bytes.size() - bytes.size() / 2);
+
+        auto expected = std::static_pointer_cast<InstanceKlass>(ClassFileParser::parse(bytes.data(), bytes.size()));
+        expectSameClass(*expected, *std::static_pointer_cast<InstanceKlass>(parser.finish()));
+        ASSERT_EQ(1u, parser.getInterfaceIndexes().size());
+        ASSERT_EQ(1u, parser.getAnnotationTypes().size());
+        ASSERT_TRUE(parser.getAnnotationTypes()[0]->equals("Lcom/tula/Marker;"));
+    }
+
+    TEST_F(TestStreamingClassFileParser, TestInvalidInput) {
+        ClassFileBuilder builder("com/tula/Stream");
+        builder.sourceFile("Stream.java");
+        builder.addField(0x0002, "count", "J");
+        builder.addMethod(ClassFileBuilder::emptyStaticMethod());
+        auto bytes = builder.build();
+
+        // Every truncation is caught, in the middle of a unit or between two.
+        for (size_t len = 0; len < bytes.size(); ++len) {
+            StreamingClassFileParser parser;
+            parser.feed(bytes.data(), len);
+            ASSERT_FALSE(parser.isComplete());
+            ASSERT_THROW(parser.finish(), ClassFormatError);
+            ASSERT_THROW(ClassFileParser::parse(bytes.data(), len), ClassFormatError);
+        }
+
+        {
+            auto extended = bytes;
+            extended.push_back(0);
+            StreamingClassFileParser parser;
+            ASSERT_THROW(parser.feed(extended.data(), extended.size()), ClassFormatError);
+        }
+        {
+            StreamingClassFileParser parser;
+            parser.feed(bytes.data(), bytes.size());
+            uint8_t extra = 0;
+            ASSERT_THROW(parser.feed(&extra, 1), ClassFormatError);
+        }
+        {
+            auto corrupt = bytes;
+            corrupt[3] = 0x00;     // magic
+            StreamingClassFileParser parser;
+            ASSERT_THROW(parser.feed(corrupt.data(), 10), ClassFormatError);
+        }
+    }
+}
@@ -0,0 +1,152 @@
+#include "../BaseTest.hpp"
+#include "../ClassFileBuilder.hpp"
+#include <gtest/gtest.h>
+
+#include <ClazzLoader.hpp>
+#include <Error.hpp>
+#include <events/EventRecorder.hpp>
+
+#include <filesystem>
+#include <fstream>
+#include <set>
+#include <sstream>
+#include <thread>
+
+namespace CCW::Tula {
+
+    static size_t countOf(const EventLog &log, EventType type) {
+        return std::count_if(log.events.begin(), log.events.end(),
+                             [type](const EventRecord &event) { return event.type == type; });
+    }
+
+    TEST(TestEventRecorder, TestDisabled) {
+        ASSERT_FALSE(EventRecorder::isEnabled());
+        {
+            EventScope event(EventType::ParseClass, []() -> std::string {
+                ADD_FAILURE() << "names are not computed while disabled";
+                return "";
+            });
+        }
+        EventRecorder::start();
+        auto log = EventRecorder::stop();
+        ASSERT_TRUE(log.events.empty());
+    }
+
+    TEST(TestEventRecorder, TestThreads) {
+        EventRecorder::start();
+        std::vector<std::thread> threads;
+        for (int t = 0; t < 4; ++t) {
+            threads.emplace_back([] {
+                for (int i = 0; i < 100; ++i) {
+                    EventScope event(EventType::FileRead, [i] { return i % 2 == 0 ? "even" : "odd"; });
+                    event.setValue(i);
+                }
+            });
+        }
+        for (auto &thread : threads) {
+            thread.join();
+        }
+        auto log = EventRecorder::stop();
+        ASSERT_EQ(400, countOf(log, EventType::FileRead));
+        ASSERT_EQ(0, log.dropped);
+        std::set<uint32_t> threadIds;
+        for (size_t i = 0; i < log.events.size(); ++i) {
+            threadIds.insert(log.events[i].thread);
+            ASSERT_EQ(log.events[i].value % 2 == 0 ? "even" : "odd", log.names[log.events[i].name]);
+            if (i > 0) {
+                ASSERT_LE(log.events[i - 1].start, log.events[i].start);
+            }
+        }
+        ASSERT_EQ(4, threadIds.size());
+        // Names of all threads are merged in the log.
+        ASSERT_EQ(3, log.names.size());
+    }
+
+    TEST(TestEventRecorder, TestOverflow) {
+        EventRecorder::start();
+        for (size_t i = 0; i < EventRecorder::BufferCapacity + 10; ++i) {
+            EventScope event(EventType::SymbolIntern);
+        }
+        auto log = EventRecorder::stop();
+        ASSERT_EQ(EventRecorder::BufferCapacity + 10, log.events.size());
+        ASSERT_EQ(0, log.dropped);
+
+        // A buffer filling up while stopped drops; the next recording starts empty.
+        for (size_t i = 0; i < EventRecorder::BufferCapacity + 10; ++i) {
+            EventScope event(EventType::SymbolIntern);
+        }
+        EventRecorder::start();
+        { EventScope event(EventType::SymbolIntern); }
+        log = EventRecorder::stop();
+        ASSERT_EQ(1, log.events.size());
+        ASSERT_EQ(0, log.dropped);
+    }
+
+    TEST(TestEventRecorder, TestFileAndChromeTrace) {
+        EventLog log;
+        log.ticksPerSecond = 1e9;
+        log.names.push_back("com/tula/\"Quoted\"");
+        log.events.push_back(EventRecord{1000, 2500, 7, EventType::DefineClass, 0, 1, 1, 0});
+        log.events.push_back(EventRecord{1500, 500, 0, EventType::ParseConstantPool, 0, 1, 0, 0});
+        std::stringstream file;
+        log.write(file);
+
+        auto read = EventLog::read(file);
+        ASSERT_EQ(log.names, read.names);
+        ASSERT_EQ(2, read.events.size());
+        ASSERT_EQ(EventType::DefineClass, read.events[0].type);
+        ASSERT_EQ(2500, read.events[0].duration);
+
+        std::stringstream json;
+        read.writeChromeTrace(json);
+        auto trace = json.str();
+        ASSERT_NE(std::string::npos, trace.find(R"("name":"DefineClass")"));
+        ASSERT_NE(std::string::npos, trace.find(R"("ts":0.500,"dur":0.500)"));
+        ASSERT_NE(std::string::npos, trace.find(R"("name":"com/tula/\"Quoted\"")"));
+
+        std::stringstream garbage("not an event file");
+        ASSERT_THROW(EventLog::read(garbage), Error);
+    }
+
+    class TestClassLoadingEvents : public VMTest {
+    };
+
+    TEST_F(TestClassLoadingEvents, TestDefineClass) {
+        auto dir = emptyTempDir("events");
+        auto path = ClassFileBuilder::writeRunnable(dir, "com/tula/Recorded", "recordedMethod");
+
+        BootstrapClassLoader loader(vm.get(), dir);
+        VM::startRecording();
+        auto klass = loader.defineClass(path);
+        ASSERT_NE(nullptr, klass);
+        auto eventsPath = ::testing::TempDir() + "define.tevents";
+        VM::stopRecording(eventsPath);
+
+        std::ifstream in(eventsPath, std::ios::binary);
+        auto log = EventLog::read(in);
+        for (auto type : {EventType::DefineClass, EventType::FileOpen, EventType::FileRead, EventType::ParseClass,
+                          EventType::ParseConstantPool, EventType::ParseFields, EventType::ParseMethods,
+                          EventType::ParseAttributes}) {
+            ASSERT_EQ(1, countOf(log, type)) << EventLog::typeName(type);
+        }
+        // One event for the symbols of the constant pool, counting the ones it created.
+        ASSERT_EQ(1, countOf(log, EventType::SymbolIntern));
+        auto symbols = *std::find_if(log.events.begin(), log.events.end(), [](const EventRecord &event) {
+            return event.type == EventType::SymbolIntern;
+        });
+        ASSERT_GE(symbols.value, 1u);
+
+        // The class definition encloses its phases.
+        auto define = *std::find_if(log.events.begin(), log.events.end(), [](const EventRecord &event) {
+            return event.type == EventType::DefineClass;
+        });
+        ASSERT_EQ(path, log.names[define.name]);
+        ASSERT_EQ(std::filesystem::file_size(path), define.value);
+        for (const auto &event : log.events) {
+            ASSERT_GE(event.start, define.start);
+            ASSERT_LE(event.start + event.duration, define.start + define.duration);
+        }
+
+        ASSERT_THROW(VM::stopRecording("/nonexistent/dir/events"), Error);
+    }
+}
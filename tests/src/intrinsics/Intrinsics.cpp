@@ -0,0 +1,174 @@
+#include "../BaseTest.hpp"
+#include "../ClassFileBuilder.hpp"
+#include <gtest/gtest.h>
+
+#include <classfile/ClassFileParser.hpp>
+#include <intrinsics/Intrinsics.hpp>
+#include <intrinsics/Kernels.hpp>
+#include <Klass.hpp>
+#include <SymbolTable.hpp>
+
+#include <limits>
+#include <random>
+
+namespace CCW::Tula {
+
+    class TestIntrinsics : public VMTest {
+    };
+
+    // The Java code each kernel replaces, written out literally.
+    static jint javaHashCode(const std::vector<jchar> &chars) {
+        jint h = 0;
+        for (auto c : chars) {
+            h = static_cast<jint>(31u * static_cast<uint32_t>(h) + c);
+        }
+        return h;
+    }
+
+    static std::vector<const KernelTable *> supportedTables() {
+        std::vector<const KernelTable *> tables;
+        for (auto level : {SimdLevel::Scalar, SimdLevel::SSE2, SimdLevel::AVX2}) {
+            if (auto table = Kernels::forLevel(level)) {
+                tables.push_back(table);
+            }
+        }
+        return tables;
+    }
+
+    TEST(TestKernels, TestDispatch) {
+        ASSERT_NE(nullptr, Kernels::forLevel(SimdLevel::Scalar));
+        ASSERT_EQ(Kernels::detectLevel(), Kernels::get().level);
+        ASSERT_EQ(&Kernels::get(), Kernels::forLevel(Kernels::detectLevel()));
+    }
+
+    TEST(TestKernels, TestHashCode) {
+        std::mt19937 random(42);
+        for (auto table : supportedTables()) {
+            for (size_t length = 0; length < 100; ++length) {
+                std::vector<jchar> chars(length);
+                std::vector<uint8_t> latin1(length);
+                for (size_t i = 0; i < length; ++i) {
+                    latin1[i] = static_cast<uint8_t>(random());
+                    chars[i] = latin1[i];
+                }
+                ASSERT_EQ(javaHashCode(chars), table->hashLatin1(latin1.data(), length)) << length;
+                for (auto &c : chars) {
+                    c = static_cast<jchar>(random());
+                }
+                ASSERT_EQ(javaHashCode(chars), table->hashUtf16(chars.data(), length)) << length;
+            }
+        }
+    }
+
+    TEST(TestKernels, TestEqualsAndIndexOf) {
+        std::mt19937 random(7);
+        for (auto table : supportedTables()) {
+            for (size_t length = 0; length < 80; ++length) {
+                std::vector<jchar> a(length);
+                for (auto &c : a) {
+                    c = static_cast<jchar>('a' + random() % 4);
+                }
+                auto b = a;
+                ASSERT_TRUE(table->equals(a.data(), b.data(), length * 2));
+                for (size_t i = 0; i < length; ++i) {
+                    b[i] ^= 0x100;
+                    ASSERT_FALSE(table->equals(a.data(), b.data(), length * 2));
+                    b[i] ^= 0x100;
+                }
+
+                std::vector<uint8_t> bytes(a.begin(), a.end());
+                for (jchar c : {jchar('a'), jchar('d'), jchar('z'), jchar(0x161)}) {
+                    auto expected = std::find(a.begin(), a.end(), c);
+                    int64_t index = expected == a.end() ? -1 : expected - a.begin();
+                    ASSERT_EQ(index, table->indexOfUtf16(a.data(), length, c));
+                    if (c < 0x100) {
+                        ASSERT_EQ(index, table->indexOfLatin1(bytes.data(), length, static_cast<uint8_t>(c)));
+                    }
+                }
+            }
+        }
+
+        std::string text(100, 'a');
+        text += "needle";
+        auto chars = reinterpret_cast<const uint8_t *>(text.data());
+        ASSERT_EQ(100, Kernels::indexOfLatin1(chars, text.size(), reinterpret_cast<const uint8_t *>("needle"), 6));
+        ASSERT_EQ(95, Kernels::indexOfLatin1(chars, text.size(), reinterpret_cast<const uint8_t *>("aaaaan"), 6));
+        ASSERT_EQ(-1, Kernels::indexOfLatin1(chars, text.size(), reinterpret_cast<const uint8_t *>("needles"), 7));
+        ASSERT_EQ(0, Kernels::indexOfLatin1(chars, text.size(), nullptr, 0));
+    }
+
+    TEST(TestKernels, TestFill) {
+        for (auto table : supportedTables()) {
+            for (size_t length = 0; length < 40; ++length) {
+                // Guard elements on both sides catch writes outside [1, length + 1).
+                std::vector<uint64_t> longs(length + 2, 0);
+                table->fill64(longs.data() + 1, length, 0x0102030405060708ull);
+                std::vector<uint16_t> shorts(length + 2, 0);
+                table->fill16(shorts.data() + 1, length, 0xBEEF);
+                std::vector<uint8_t> bytes(length + 2, 0);
+                table->fill8(bytes.data() + 1, length, 0x5A);
+                std::vector<uint32_t> ints(length + 2, 0);
+                table->fill32(ints.data() + 1, length, 0xCAFEBABE);
+                for (size_t i = 0; i < length + 2; ++i) {
+                    bool inside = i > 0 && i <= length;
+                    ASSERT_EQ(inside ? 0x0102030405060708ull : 0, longs[i]);
+                    ASSERT_EQ(inside ? 0xBEEF : 0, shorts[i]);
+                    ASSERT_EQ(inside ? 0x5A : 0, bytes[i]);
+                    ASSERT_EQ(inside ? 0xCAFEBABE : 0, ints[i]);
+                }
+            }
+        }
+
+        // System.arraycopy within one array copies as if through a temporary.
+        int values[] = {1, 2, 3, 4, 5, 6};
+        Kernels::arraycopy(values, values + 2, 4 * sizeof(int));
+        ASSERT_EQ((std::vector<int>{1, 2, 1, 2, 3, 4}), std::vector<int>(values, values + 6));
+    }
+
+    TEST(TestKernels, TestJavaMath) {
+        auto nan = std::numeric_limits<jdouble>::quiet_NaN();
+        ASSERT_TRUE(std::signbit(JavaMath::min(0.0, -0.0)));
+        ASSERT_TRUE(std::signbit(JavaMath::min(-0.0, 0.0)));
+        ASSERT_FALSE(std::signbit(JavaMath::max(0.0, -0.0)));
+        ASSERT_FALSE(std::signbit(JavaMath::max(-0.0, 0.0)));
+        ASSERT_TRUE(std::isnan(JavaMath::min(1.0, nan)));
+        ASSERT_TRUE(std::isnan(JavaMath::max(nan, 1.0)));
+        ASSERT_EQ(1.0f, JavaMath::min(1.0f, 2.0f));
+        ASSERT_EQ(2.0, JavaMath::max(1.0, 2.0));
+        ASSERT_FALSE(std::signbit(JavaMath::abs(-0.0)));
+        ASSERT_FALSE(std::signbit(JavaMath::abs(-nan)));
+        ASSERT_EQ(3.5f, JavaMath::abs(-3.5f));
+        ASSERT_EQ(-0.0, JavaMath::ceil(-0.5));
+        ASSERT_TRUE(std::signbit(JavaMath::ceil(-0.5)));
+        ASSERT_EQ(-1.0, JavaMath::floor(-0.5));
+        ASSERT_EQ(1.4142135623730951, JavaMath::sqrt(2.0));
+    }
+
+    TEST_F(TestIntrinsics, TestRegistry) {
+        IntrinsicRegistry registry;
+        auto system = SymbolTable::intern("java/lang/System");
+        auto arraycopy = SymbolTable::intern("arraycopy");
+        ASSERT_EQ(IntrinsicId::SystemArraycopy,
+                  registry.lookup(system.get(), arraycopy.get(),
+                                  SymbolTable::intern("(Ljava/lang/Object;ILjava/lang/Object;II)V").get()));
+        ASSERT_EQ(IntrinsicId::None, registry.lookup(system.get(), arraycopy.get(),
+                                                     SymbolTable::intern("()V").get()));
+        ASSERT_STREQ("StringHashCode", IntrinsicRegistry::nameOf(IntrinsicId::StringHashCode));
+
+        ClassFileBuilder builder("java/lang/Math");
+        for (auto [name, descriptor] : {std::pair{"sqrt", "(D)D"}, {"cbrt", "(D)D"}, {"max", "(II)I"}}) {
+            ClassFileBuilder::MethodSpec method;
+            method.accessFlags = 0x0109;    // public static native
+            method.name = name;
+            method.descriptor = descriptor;
+            method.hasCode = false;
+            builder.addMethod(method);
+        }
+        auto bytes = builder.build();
+        auto klass = std::static_pointer_cast<InstanceKlass>(ClassFileParser::parse(bytes.data(), bytes.size()));
+        ASSERT_EQ(2, registry.annotate(*klass));
+        ASSERT_EQ(IntrinsicId::MathSqrt, klass->getMethods()[0]->getIntrinsicId());
+        ASSERT_EQ(IntrinsicId::None, klass->getMethods()[1]->getIntrinsicId());
+        ASSERT_EQ(IntrinsicId::MathMaxInt, klass->getMethods()[2]->getIntrinsicId());
+    }
+}
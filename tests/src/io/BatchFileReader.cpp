@@ -0,0 +1,92 @@
+#include <gtest/gtest.h>
+
+#include <io/BatchFileReader.hpp>
+
+#include <filesystem>
+#include <fstream>
+#include <mutex>
+
+namespace CCW::Tula {
+
+    using Backend = BatchFileReader::Backend;
+
+    class TestBatchFileReader : public ::testing::TestWithParam<Backend> {
+    protected:
+        void SetUp() override {
+            if (GetParam() == Backend::IoUring && !BatchFileReader::isIoUringAvailable()) {
+                GTEST_SKIP() << "io_uring is not available";
+            }
+        }
+    };
+
+    // Files of assorted sizes, the empty one and one larger than a read of the fallback included.
+    static std::vector<std::string> writeFiles(const std::string &name, std::vector<std::vector<uint8_t>> &contents) {
+        auto dir = ::testing::TempDir() + name + "/";
+        std::filesystem::remove_all(dir);
+        std::filesystem::create_directories(dir);
+        std::vector<std::string> paths;
+        for (size_t i = 0; i < 300; ++i) {
+            size_t size = i == 0 ? 0 : i == 1 ? size_t(3) << 20u : (i * 7919) % 20000;
+            std::vector<uint8_t> bytes(size);
+            for (size_t j = 0; j < size; ++j) {
+                bytes[j] = static_cast<uint8_t>(i * 31 + j);
+            }
+            paths.push_back(dir + std::to_string(i) + ".class");
+            std::ofstream(paths.back(), std::ios::binary).write(reinterpret_cast<const char *>(bytes.data()), size);
+            contents.push_back(std::move(bytes));
+        }
+        return paths;
+    }
+
+    TEST_P(TestBatchFileReader, TestReadAll) {
+        std::vector<std::vector<uint8_t>> contents;
+        auto paths = writeFiles("batch", contents);
+        paths.push_back(paths[5] + ".missing");
+
+        auto files = BatchFileReader::create(GetParam(), 16);
+        ASSERT_NE(nullptr, files);
+        ASSERT_EQ(GetParam(), files->getBackend());
+        std::mutex lock;
+        std::vector<int> seen(paths.size());
+        files->readAll(paths, [&](FileRead &&read) {
+            std::lock_guard<std::mutex> _{lock};
+            seen[read.index]++;
+            if (read.index == contents.size()) {
+                EXPECT_EQ(ENOENT, read.error);
+                EXPECT_EQ(nullptr, read.data);
+                return;
+            }
+            auto &expected = contents[read.index];
+            EXPECT_EQ(0, read.error);
+            EXPECT_EQ(expected.size(), read.size);
+            EXPECT_EQ(expected.size(), read.stamp.size);
+            if (!expected.empty()) {
+                EXPECT_EQ(0, memcmp(expected.data(), read.data.get(), expected.size())) << read.index;
+            }
+        });
+        for (auto count : seen) {
+            ASSERT_EQ(1, count);
+        }
+
+        // The reader takes the next batch.
+        size_t reads = 0;
+        files->readAll({paths[2], paths[3]}, [&](FileRead &&) { reads++; });
+        ASSERT_EQ(2u, reads);
+    }
+
+    TEST_P(TestBatchFileReader, TestCancel) {
+        std::vector<std::vector<uint8_t>> contents;
+        auto paths = writeFiles("batch-cancel", contents);
+        auto files = BatchFileReader::create(GetParam(), 4);
+        std::atomic<size_t> reads{0};
+        files->readAll(paths, [&](FileRead &&) {
+            if (++reads == 10) {
+                files->cancel();
+            }
+        });
+        ASSERT_GE(reads.load(), 10u);
+        ASSERT_LT(reads.load(), paths.size());
+    }
+
+    INSTANTIATE_TEST_SUITE_P(Backends, TestBatchFileReader, ::testing::Values(Backend::IoUring, Backend::Threads));
+}
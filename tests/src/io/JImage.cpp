@@ -0,0 +1,141 @@
+#include "../BaseTest.hpp"
+#include "../ClassFileBuilder.hpp"
+#include "../JImageBuilder.hpp"
+#include <gtest/gtest.h>
+
+#include <Error.hpp>
+#include <io/JImage.hpp>
+
+#include <cstring>
+#include <fstream>
+
+namespace CCW::Tula {
+
+    class TestJImage : public VMTest {
+    };
+
+    static std::vector<uint8_t> classBytes(const std::string &name, const std::string &method = "run",
+                                           uint16_t major = 61) {
+        return ClassFileBuilder(name).version(major).addMethod(ClassFileBuilder::emptyStaticMethod(method)).build();
+    }
+
+    static std::string writeImage(const std::string &name, const std::vector<uint8_t> &bytes) {
+        auto path = ::testing::TempDir() + name;
+        std::ofstream out(path, std::ios::binary | std::ios::trunc);
+        out.write(reinterpret_cast<const char *>(bytes.data()), bytes.size());
+        return path;
+    }
+
+    static void expectResource(const JImage &image, const std::string &name, const std::vector<uint8_t> &expected,
+                               bool compressed) {
+        JImage::Location location;
+        ASSERT_TRUE(image.find(name, location)) << name;
+        ASSERT_EQ(name, image.nameOf(location));
+        auto resource = image.read(location);
+        ASSERT_EQ(expected.size(), resource.size) << name;
+        ASSERT_EQ(0, memcmp(expected.data(), resource.data, expected.size())) << name;
+        // Stored resources are views of the mapped image.
+        ASSERT_EQ(compressed, resource.decompressed != nullptr) << name;
+    }
+
+    TEST_F(TestJImage, TestFind) {
+        JImageBuilder builder;
+        std::vector<std::string> names;
+        for (int i = 0; i < 500; ++i) {
+            names.push_back("com/tula/p" + std::to_string(i % 7) + "/C" + std::to_string(i));
+            builder.addClass(i % 7 < 4 ? "tula.base" : "tula.extra", names.back(), classBytes(names.back()),
+                             i % 3 == 0);
+        }
+        std::vector<uint8_t> text{'h', 'i'};
+        builder.addResource("/tula.base/META-INF/notes.txt", text);
+        builder.addResource("/tula.base/noextension", text, true);
+        JImage image(writeImage("find.jimage", builder.build()));
+        ASSERT_EQ(500u + 2 + 7, image.getResourceCount());
+
+        for (int i = 0; i < 500; ++i) {
+            auto module = i % 7 < 4 ? "tula.base" : "tula.extra";
+            expectResource(image, std::string("/") + module + "/" + names[i] + ".class", classBytes(names[i]),
+                           i % 3 == 0);
+        }
+        expectResource(image, "/tula.base/META-INF/notes.txt", text, false);
+        expectResource(image, "/tula.base/noextension", text, true);
+
+        JImage::Location location;
+        for (auto missing : {"", "/", "/tula.base/com/tula/p0/C1.class", "/tula.base/com/tula/p0/C0",
+                             "/tula.base/com/tula/p0/C0.clas", "/tula.base/com/tula/p0/C0.classes",
+                             "tula.base/com/tula/p0/C0.class", "/tula.base/META-INF/notes"}) {
+            ASSERT_FALSE(image.find(missing, location)) << missing;
+        }
+        ASSERT_TRUE(image.findClass("com/tula/p3/C10", location));
+        ASSERT_EQ("/tula.base/com/tula/p3/C10.class", image.nameOf(location));
+        ASSERT_TRUE(image.findClass("com/tula/p4/C11", location));
+        ASSERT_EQ("/tula.extra/com/tula/p4/C11.class", image.nameOf(location));
+        ASSERT_FALSE(image.findClass("com/tula/p3/C11", location));
+        ASSERT_FALSE(image.findClass("Unnamed", location));
+        ASSERT_FALSE(image.findClass("com/missing/C0", location));
+        ASSERT_EQ("tula.base", image.moduleOf("com/tula/p0"));
+        ASSERT_EQ("tula.extra", image.moduleOf("com/tula/p6"));
+        ASSERT_EQ("", image.moduleOf("com/tula"));
+    }
+
+    TEST_F(TestJImage, TestBigEndian) {
+        JImageBuilder builder;
+        builder.bigEndian();
+        builder.addClass("tula.base", "com/tula/A", classBytes("com/tula/A"));
+        builder.addClass("tula.base", "com/tula/B", classBytes("com/tula/B"), true);
+        JImage image(writeImage("big-endian.jimage", builder.build()));
+        expectResource(image, "/tula.base/com/tula/A.class", classBytes("com/tula/A"), false);
+        expectResource(image, "/tula.base/com/tula/B.class", classBytes("com/tula/B"), true);
+    }
+
+    TEST_F(TestJImage, TestInvalid) {
+        ASSERT_THROW(JImage(::testing::TempDir() + "missing.jimage"), Error);
+        ASSERT_THROW(JImage(writeImage("short.jimage", {0xDA, 0xDA, 0xFE, 0xCA})), Error);
+
+        JImageBuilder builder;
+        builder.addResource("/tula.base/com/tula/A.class", classBytes("com/tula/A"));
+        auto bytes = builder.build();
+        auto notImage = bytes;
+        notImage[0] = 0;
+        ASSERT_THROW(JImage(writeImage("not.jimage", notImage)), Error);
+        auto newer = bytes;
+        newer[6] = 2;   // major version 2
+        ASSERT_THROW(JImage(writeImage("newer.jimage", newer)), Error);
+        auto truncated = bytes;
+        truncated.resize(40);
+        ASSERT_THROW(JImage(writeImage("truncated.jimage", truncated)), Error);
+
+        // The index is intact, the resource is not.
+        truncated = bytes;
+        truncated.resize(bytes.size() - 10);
+        JImage image(writeImage("truncated-resource.jimage", truncated));
+        JImage::Location location;
+        ASSERT_TRUE(image.find("/tula.base/com/tula/A.class", location));
+        ASSERT_THROW((void) image.read(location), ClassFormatError);
+    }
+
+    TEST_F(TestJImage, TestVM) {
+        JImageBuilder builder;
+        builder.addClass("tula.base", "com/tula/Shadowed", classBytes("com/tula/Shadowed", "image"));
+        builder.addClass("tula.base", "com/tula/Compressed", classBytes("com/tula/Compressed"), true);
+        auto image = writeImage("vm.jimage", builder.build());
+        auto dir = emptyTempDir("jimage-vm");
+        for (auto name : {"com/tula/Shadowed", "com/tula/Loose"}) {
+            ClassFileBuilder::writeRunnable(dir, name, "directory");
+        }
+
+        VM vm(image + ":" + dir, "");
+        resolveBytecode(vm, "com/tula/Shadowed", "image");
+        resolveBytecode(vm, "com/tula/Compressed");
+        resolveBytecode(vm, "com/tula/Loose", "directory");
+        ASSERT_THROW(vm.resolveStatic("com/tula/Missing", "run", "()V"), NoClassDefFoundError);
+
+        // Classes of the image are shared with the other VMs of the process.
+        ClassFileStamp stamp;
+        ASSERT_TRUE(ClassFileStamp::of(image, stamp));
+        ASSERT_NE(nullptr, SharedClassTable::find(image + "!/tula.base/com/tula/Compressed.class", stamp, false));
+        ASSERT_THROW(vm.resolveStatic("com/tula/Loose", "image", "()V"), NoSuchMethodError);
+
+        ASSERT_THROW(VM(dir + "com/tula/Loose.class", ""), Error);
+    }
+}
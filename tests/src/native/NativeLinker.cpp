@@ -0,0 +1,233 @@
+#include "../BaseTest.hpp"
+#include <gtest/gtest.h>
+
+#include <Error.hpp>
+#include <Klass.hpp>
+#include <native/NativeLinker.hpp>
+#include <SymbolTable.hpp>
+
+#include <cstring>
+
+using namespace CCW::Tula;
+
+// Found through dlsym on the test executable, which exports its symbols.
+extern "C" __attribute__((visibility("default"))) jint Java_com_tula_1native_Natives_triple(void *, void *, jint x) {
+    return x * 3;
+}
+
+extern "C" __attribute__((visibility("default"))) jint
+Java_com_tula_1native_Natives_pick__I_3Ljava_lang_String_2(void *, void *, jint x, void *) {
+    return x + 1;
+}
+
+namespace CCW::Tula {
+
+    class TestNativeLinker : public VMTest {
+    protected:
+        void SetUp() override {
+            VMTest::SetUp();
+            klass = std::make_shared<InstanceKlass>(SymbolTable::intern("com/tula_native/Natives"), nullptr,
+                                                    ClassAccessFlags::Public);
+        }
+
+        Method *addNative(const char *name, const char *descriptor, bool isStatic = true) {
+            auto flags = isStatic ? MethodAccessFlags::Native | MethodAccessFlags::Static : MethodAccessFlags::Native;
+            return klass->addMethod(SymbolTable::intern(name), SymbolTable::intern(descriptor), flags);
+        }
+
+        std::shared_ptr<InstanceKlass> klass;
+    };
+
+    static jdouble mix(void *, void *, jint i, jlong j, jfloat f, jdouble d) {
+        return i + static_cast<jdouble>(j) * 2 + f * 4 + d * 8;
+    }
+
+    static jboolean isPositive(void *, void *, jlong value) {
+        return value > 0;
+    }
+
+    static jbyte narrow(void *, void *, jint value) {
+        return static_cast<jbyte>(value);
+    }
+
+    static void *receiver(void *, void *self, jfloat) {
+        return self;
+    }
+
+    static void store(void *, void *, jint *target, jint value) {
+        *target = value;
+    }
+
+    // More integers and floating point values than either kind has argument registers; records what arrived.
+    static jdouble wideArguments[18];
+
+    static jdouble wide(void *, void *self, jint a, jfloat b, jlong c, jdouble d, jint e, jfloat f, jdouble g, jint h,
+                        jfloat i, jdouble j, jint k, jfloat l, jdouble m, jint n, jfloat o, jdouble p, jint *q) {
+        jdouble arguments[] = {static_cast<jdouble>(self != nullptr), static_cast<jdouble>(a), b,
+                               static_cast<jdouble>(c), d, static_cast<jdouble>(e), f, g, static_cast<jdouble>(h),
+                               i, j, static_cast<jdouble>(k), l, m, static_cast<jdouble>(n), o, p,
+                               static_cast<jdouble>(*q)};
+        memcpy(wideArguments, arguments, sizeof(arguments));
+        return 0.5;
+    }
+
+    static jshort wideNarrow(void *, void *, jint a, jint b, jint c, jint d, jint e, jint f, jint g) {
+        return static_cast<jshort>(a + b + c + d + e + f + g);
+    }
+
+    // Spills past the small stub prototype.
+    static jlong many(void *, void *, jint x0, jint x1, jint x2, jint x3, jint x4, jint x5, jint x6, jint x7, jint x8,
+                      jint x9, jint x10, jint x11, jint x12, jint x13, jint x14, jint x15, jint x16, jint x17,
+                      jint x18, jint x19) {
+        return 1 * x0 + 2 * x1 + 3 * x2 + 4 * x3 + 5 * x4 + 6 * x5 + 7 * x6 + 8 * x7 + 9 * x8 + 10 * x9 + 11 * x10
+               + 12 * x11 + 13 * x12 + 14 * x13 + 15 * x14 + 16 * x15 + 17 * x16 + 18 * x17 + 19 * x18 + 20 * x19;
+    }
+
+    static jfloat wideFloat(void *, void *, jfloat a, jfloat b, jfloat c, jfloat d, jfloat e, jfloat f, jfloat g,
+                            jfloat h, jfloat i, jfloat j) {
+        return a - b + c - d + e - f + g - h + i - j;
+    }
+
+    TEST(TestNativeSignature, TestMangling) {
+        ASSERT_EQ("java_lang_String", NativeLinker::mangle("java/lang/String"));
+        ASSERT_EQ("a_1b_3_2", NativeLinker::mangle("a_b[;"));
+        ASSERT_EQ("caf_000e9", NativeLinker::mangle("caf\xC3\xA9"));
+        ASSERT_EQ("Java_p_Q_f", NativeLinker::shortName("p/Q", "f"));
+        ASSERT_EQ("Java_p_Q_f__I_3Ljava_lang_String_2",
+                  NativeLinker::longName("p/Q", "f", "(I[Ljava/lang/String;)V"));
+        ASSERT_EQ("Java_p_Q_f__", NativeLinker::longName("p/Q", "f", "()V"));
+    }
+
+    TEST(TestNativeSignature, TestFingerprint) {
+        NativeSignature signature("(IJ[[DLjava/lang/Object;F)Z");
+        ASSERT_EQ(5, signature.getArgumentCount());
+        ASSERT_EQ('Z', signature.getReturnType());
+        ASSERT_EQ(NativeKind::Word, signature.getArgumentKind(2));
+        ASSERT_EQ(3, signature.getSlotOffset(2));
+        ASSERT_EQ(4, signature.getSlotOffset(3));
+        ASSERT_EQ(NativeKind::Float, signature.getArgumentKind(4));
+        ASSERT_EQ(5, signature.getSlotOffset(4));
+
+        // Only the register shape matters: all integral types and references share one stub.
+        NativeSignature a("(BLjava/lang/String;D)I");
+        NativeSignature b("(J[ID)Z");
+        ASSERT_EQ(a.getFingerprint(), b.getFingerprint());
+        ASSERT_EQ(a.getStub(), b.getStub());
+        ASSERT_NE(a.getFingerprint(), NativeSignature("(BLjava/lang/String;F)I").getFingerprint());
+        ASSERT_NE(nullptr, NativeSignature("()V").getStub());
+    }
+
+    TEST_F(TestNativeLinker, TestRegisteredNatives) {
+        NativeLinker linker;
+        NativeMethod natives[] = {
+            {"mix", "(IJFD)D", reinterpret_cast<void *>(mix)},
+            {"isPositive", "(J)Z", reinterpret_cast<void *>(isPositive)},
+            {"narrow", "(I)B", reinterpret_cast<void *>(narrow)},
+            {"receiver", "(F)Ljava/lang/Object;", reinterpret_cast<void *>(receiver)},
+            {"store", "([II)V", reinterpret_cast<void *>(store)},
+        };
+        linker.registerNatives("com/tula_native/Natives", natives, 5);
+
+        auto floatSlot = [](jfloat f) {
+            uint32_t bits;
+            memcpy(&bits, &f, sizeof(bits));
+            return static_cast<JavaSlot>(bits);
+        };
+        auto doubleSlot = [](jdouble d) {
+            JavaSlot bits;
+            memcpy(&bits, &d, sizeof(bits));
+            return bits;
+        };
+
+        auto mixMethod = addNative("mix", "(IJFD)D");
+        auto &entry = linker.link(*mixMethod);
+        ASSERT_EQ(&entry, &linker.link(*mixMethod));
+        ASSERT_EQ(&entry, mixMethod->getNativeEntry());
+        JavaSlot mixArgs[] = {static_cast<JavaSlot>(-1), 10, 0, floatSlot(0.5f), doubleSlot(0.25), 0};
+        auto result = entry.invoke(nullptr, klass.get(), mixArgs);
+        jdouble value;
+        memcpy(&value, &result, sizeof(value));
+        ASSERT_EQ(-1 + 20 + 2 + 2, value);
+
+        JavaSlot longArg[] = {static_cast<JavaSlot>(-5), 0};
+        ASSERT_EQ(0, linker.link(*addNative("isPositive", "(J)Z")).invoke(nullptr, nullptr, longArg));
+        JavaSlot intArg[] = {0x1FF};
+        ASSERT_EQ(static_cast<uint64_t>(-1), linker.link(*addNative("narrow", "(I)B")).invoke(nullptr, nullptr, intArg));
+
+        // Instance methods take the receiver from slot 0.
+        int object;
+        JavaSlot instanceArgs[] = {reinterpret_cast<uintptr_t>(&object), floatSlot(1.0f)};
+        auto instance = linker.link(*addNative("receiver", "(F)Ljava/lang/Object;", false));
+        ASSERT_EQ(reinterpret_cast<uintptr_t>(&object), instance.invoke(nullptr, nullptr, instanceArgs));
+
+        jint target = 0;
+        JavaSlot storeArgs[] = {reinterpret_cast<uintptr_t>(&target), 42};
+        linker.link(*addNative("store", "([II)V")).invoke(nullptr, nullptr, storeArgs);
+        ASSERT_EQ(42, target);
+    }
+
+    TEST_F(TestNativeLinker, TestDlsym) {
+        NativeLinker linker;
+        JavaSlot args[] = {7, 0};
+        ASSERT_EQ(21, linker.link(*addNative("triple", "(I)I")).invoke(nullptr, nullptr, args));
+        ASSERT_EQ(8, linker.link(*addNative("pick", "(I[Ljava/lang/String;)I")).invoke(nullptr, nullptr, args));
+
+        ASSERT_THROW(linker.link(*addNative("missing", "()V")), UnsatisfiedLinkError);
+        ASSERT_THROW(linker.loadLibrary("libtula-does-not-exist.so"), UnsatisfiedLinkError);
+    }
+
+    TEST_F(TestNativeLinker, TestWideNatives) {
+        NativeLinker linker;
+        NativeMethod natives[] = {
+            {"wide", "(IFJDIFDIFDIFDIFD[I)D", reinterpret_cast<void *>(wide)},
+            {"wideNarrow", "(IIIIIII)S", reinterpret_cast<void *>(wideNarrow)},
+            {"wideFloat", "(FFFFFFFFFF)F", reinterpret_cast<void *>(wideFloat)},
+            {"many", "(IIIIIIIIIIIIIIIIIIII)J", reinterpret_cast<void *>(many)},
+        };
+        linker.registerNatives("com/tula_native/Natives", natives, 4);
+        auto floatSlot = [](jfloat f) {
+            uint32_t bits;
+            memcpy(&bits, &f, sizeof(bits));
+            return static_cast<JavaSlot>(bits);
+        };
+        auto doubleSlot = [](jdouble d) {
+            JavaSlot bits;
+            memcpy(&bits, &d, sizeof(bits));
+            return bits;
+        };
+        jint q = 9;
+        JavaSlot wideArgs[] = {1, floatSlot(2), 3, 0, doubleSlot(4), 0, 5, floatSlot(6), doubleSlot(7), 0, 8,
+                               floatSlot(9), doubleSlot(1), 0, 2, floatSlot(3), doubleSlot(4), 0, 5, floatSlot(6),
+                               doubleSlot(7), 0, reinterpret_cast<uintptr_t>(&q)};
+        auto &entry = linker.link(*addNative("wide", "(IFJDIFDIFDIFDIFD[I)D"));
+        auto result = entry.invoke(nullptr, klass.get(), wideArgs);
+        jdouble value;
+        memcpy(&value, &result, sizeof(value));
+        ASSERT_EQ(0.5, value);
+        jdouble expected[] = {1, 1, 2, 3, 4, 5, 6, 7, 8, 9, 1, 2, 3, 4, 5, 6, 7, 9};
+        for (int i = 0; i < 18; ++i) {
+            ASSERT_EQ(expected[i], wideArguments[i]) << i;
+        }
+
+        JavaSlot narrowArgs[] = {10000, 10000, 10000, 10000, 10000, 10000, static_cast<JavaSlot>(-2)};
+        ASSERT_EQ(static_cast<uint64_t>(static_cast<int16_t>(59998)),
+                  linker.link(*addNative("wideNarrow", "(IIIIIII)S")).invoke(nullptr, nullptr, narrowArgs));
+
+        JavaSlot floatArgs[10];
+        for (int i = 0; i < 10; ++i) {
+            floatArgs[i] = floatSlot(static_cast<jfloat>(i * i));
+        }
+        auto floatResult = linker.link(*addNative("wideFloat", "(FFFFFFFFFF)F")).invoke(nullptr, nullptr, floatArgs);
+        jfloat floatValue;
+        auto floatBits = static_cast<uint32_t>(floatResult);
+        memcpy(&floatValue, &floatBits, sizeof(floatValue));
+        ASSERT_EQ(-45.0f, floatValue);
+
+        JavaSlot manyArgs[20];
+        for (int i = 0; i < 20; ++i) {
+            manyArgs[i] = static_cast<JavaSlot>(i % 2 == 0 ? i : -i);
+        }
+        ASSERT_EQ(static_cast<uint64_t>(-200),
+                  linker.link(*addNative("many", "(IIIIIIIIIIIIIIIIIIII)J")).invoke(nullptr, nullptr, manyArgs));
+    }
+}
@@ -0,0 +1,223 @@
+#include "../BaseTest.hpp"
+#include <gtest/gtest.h>
+
+#include <ClassGenerator.hpp>
+#include <JarReader.hpp>
+#include <JarWriter.hpp>
+#include <Klass.hpp>
+#include <classfile/ClassFileParser.hpp>
+
+#include <fstream>
+#include <iterator>
+#include <stdexcept>
+#include <zlib.h>
+
+namespace CCW::Tula {
+
+    class TestClassGenerator : public VMTest {
+    };
+
+    static void put(std::vector<uint8_t> &out, uint64_t value, size_t bytes) {
+        for (size_t i = 0; i < bytes; ++i) {
+            out.push_back(static_cast<uint8_t>(value >> (8 * i)));
+        }
+    }
+
+    // A zip holding `text` deflated as "a.txt", whose central directory entry claims `size` and
+    // `localHeaderOffset` and carries `extra`.
+    static std::vector<uint8_t> deflatedZip(const std::string &text, uint32_t size,
+                                            const std::vector<uint8_t> &extra = {}, uint32_t localHeaderOffset = 0) {
+        z_stream stream{};
+        deflateInit2(&stream, Z_BEST_COMPRESSION, Z_DEFLATED, -MAX_WBITS, 8, Z_DEFAULT_STRATEGY);
+        std::vector<uint8_t> deflated(deflateBound(&stream, text.size()));
+        stream.next_in = reinterpret_cast<Bytef *>(const_cast<char *>(text.data()));
+        stream.avail_in = static_cast<uInt>(text.size());
+        stream.next_out = deflated.data();
+        stream.avail_out = static_cast<uInt>(deflated.size());
+        deflate(&stream, Z_FINISH);
+        deflated.resize(stream.total_out);
+        deflateEnd(&stream);
+
+        std::string name = "a.txt";
+        std::vector<uint8_t> zip;
+        put(zip, 0x04034b50, 4);
+        put(zip, 20, 2);                // version needed
+        put(zip, 0, 2);                 // flags
+        put(zip, Z_DEFLATED, 2);
+        put(zip, 0, 8);                 // time, date, CRC (not checked)
+        put(zip, deflated.size(), 4);
+        put(zip, size, 4);
+        put(zip, name.size(), 2);
+        put(zip, 0, 2);
+        zip.insert(zip.end(), name.begin(), name.end());
+        zip.insert(zip.end(), deflated.begin(), deflated.end());
+
+        auto directory = zip.size();
+        put(zip, 0x02014b50, 4);
+        put(zip, 20, 2);                // version made by
+        put(zip, 20, 2);
+        put(zip, 0, 2);
+        put(zip, Z_DEFLATED, 2);
+        put(zip, 0, 8);
+        put(zip, deflated.size(), 4);
+        put(zip, size, 4);
+        put(zip, name.size(), 2);
+        put(zip, extra.size(), 2);
+        put(zip, 0, 2);                 // comment
+        put(zip, 0, 8);                 // disk, attributes
+        put(zip, localHeaderOffset, 4);
+        zip.insert(zip.end(), name.begin(), name.end());
+        zip.insert(zip.end(), extra.begin(), extra.end());
+
+        auto directorySize = zip.size() - directory;
+        put(zip, 0x06054b50, 4);
+        put(zip, 0, 4);                 // disks
+        put(zip, 1, 2);
+        put(zip, 1, 2);
+        put(zip, directorySize, 4);
+        put(zip, directory, 4);
+        put(zip, 0, 2);
+        return zip;
+    }
+
+    // Moves the central directory location of `zip` into zip64 records, as `offset` and `size`.
+    static std::vector<uint8_t> withZip64End(std::vector<uint8_t> zip, uint64_t offset, uint64_t size) {
+        zip.resize(zip.size() - 22);
+        auto record = zip.size();
+        put(zip, 0x06064b50, 4);
+        put(zip, 44, 8);                // size of the rest of the record
+        put(zip, 45, 2);
+        put(zip, 45, 2);
+        put(zip, 0, 8);                 // disks
+        put(zip, 1, 8);
+        put(zip, 1, 8);
+        put(zip, size, 8);
+        put(zip, offset, 8);
+        put(zip, 0x07064b50, 4);
+        put(zip, 0, 4);
+        put(zip, record, 8);
+        put(zip, 1, 4);
+        put(zip, 0x06054b50, 4);
+        put(zip, 0, 4);
+        put(zip, 0xFFFF, 2);
+        put(zip, 0xFFFF, 2);
+        put(zip, 0xFFFFFFFFu, 4);
+        put(zip, 0xFFFFFFFFu, 4);
+        put(zip, 0, 2);
+        return zip;
+    }
+
+    static std::string writeZip(const std::string &name, const std::vector<uint8_t> &bytes) {
+        auto path = ::testing::TempDir() + name;
+        std::ofstream(path, std::ios::binary).write(reinterpret_cast<const char *>(bytes.data()), bytes.size());
+        return path;
+    }
+
+    TEST_F(TestClassGenerator, TestClassesParse) {
+        CorpusSpec spec;
+        spec.classes = 20;
+        spec.annotations = 1.5;
+        spec.nameLength = 200;
+        spec.hierarchyDepth = 4;
+        ClassGenerator generator(spec);
+        for (size_t i = 0; i < spec.classes; ++i) {
+            auto bytes = generator.generate(i);
+            ASSERT_EQ(bytes, generator.generate(i));
+            auto klass = std::static_pointer_cast<InstanceKlass>(ClassFileParser::parse(bytes.data(), bytes.size()));
+            ASSERT_TRUE(klass->name()->equals(generator.className(i).c_str()));
+            ASSERT_GE(klass->name()->getLength(), 200u);
+            ASSERT_GE(klass->getFields().size(), spec.fields / 2);
+            ASSERT_LE(klass->getMethods().size(), spec.methods * 3 / 2);
+        }
+        ASSERT_NE(generator.className(1), generator.className(2));
+        ASSERT_THROW(ClassGenerator(CorpusSpec{1, 20000}), std::invalid_argument);
+
+        CorpusSpec options;
+        ASSERT_TRUE(options.set("depth", "3"));
+        ASSERT_EQ(3u, options.hierarchyDepth);
+        ASSERT_FALSE(options.set("colour", "blue"));
+    }
+
+    TEST_F(TestClassGenerator, TestJar) {
+        ASSERT_EQ(0xCBF43926u, JarWriter::crc32(reinterpret_cast<const uint8_t *>("123456789"), 9));
+
+        CorpusSpec spec;
+        spec.classes = 3;
+        auto path = ::testing::TempDir() + "generated.jar";
+        ClassGenerator(spec).writeJar(path);
+        std::ifstream in(path, std::ios::binary);
+        std::vector<uint8_t> jar((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+        ASSERT_GT(jar.size(), 22u);
+        ASSERT_EQ((std::vector<uint8_t>{'P', 'K', 3, 4}), std::vector<uint8_t>(jar.begin(), jar.begin() + 4));
+        // The end of central directory record counts the manifest and the classes.
+        auto end = jar.end() - 22;
+        ASSERT_EQ((std::vector<uint8_t>{'P', 'K', 5, 6}), std::vector<uint8_t>(end, end + 4));
+        ASSERT_EQ(4, end[10] | end[11] << 8u);
+
+        ClassGenerator generator(spec);
+        JarReader reader(path);
+        ASSERT_EQ(4u, reader.getEntries().size());
+        ASSERT_EQ("META-INF/MANIFEST.MF", reader.getEntries()[0].name);
+        std::vector<uint8_t> bytes;
+        for (size_t i = 0; i < spec.classes; ++i) {
+            const auto &entry = reader.getEntries()[i + 1];
+            ASSERT_EQ(generator.className(i) + ".class", entry.name);
+            reader.read(entry, bytes);
+            ASSERT_EQ(generator.generate(i), bytes);
+        }
+        ASSERT_THROW(JarReader(::testing::TempDir() + "missing.jar"), std::runtime_error);
+    }
+
+    TEST_F(TestClassGenerator, TestZip64Jar) {
+        CorpusSpec spec;
+        spec.classes = 0x10000;
+        spec.fields = 0;
+        spec.methods = 0;
+        spec.constants = 0;
+        spec.annotations = 0;
+        auto path = ::testing::TempDir() + "zip64.jar";
+        ClassGenerator(spec).writeJar(path);
+        JarReader reader(path);
+        ASSERT_EQ(spec.classes + 1, reader.getEntries().size());
+        std::vector<uint8_t> bytes;
+        reader.read(reader.getEntries().back(), bytes);
+        ASSERT_EQ(ClassGenerator(spec).generate(spec.classes - 1), bytes);
+    }
+
+    TEST(TestJarReader, TestMalformed) {
+        std::string text = "hello, hello, hello, hello";
+        std::vector<uint8_t> bytes;
+        JarReader reader(writeZip("deflated.zip", deflatedZip(text, text.size())));
+        reader.read(reader.getEntries()[0], bytes);
+        ASSERT_EQ(text, std::string(bytes.begin(), bytes.end()));
+
+        // Sizes are the archive's word only: inflating stops where the data or the claimed size ends.
+        JarReader huge(writeZip("huge.zip", deflatedZip(text, 0xFFFFFFF0u)));
+        ASSERT_THROW(huge.read(huge.getEntries()[0], bytes), std::runtime_error);
+        JarReader small(writeZip("small.zip", deflatedZip(text, 5)));
+        ASSERT_THROW(small.read(small.getEntries()[0], bytes), std::runtime_error);
+
+        // A zip64 field longer than the extra area is cut at its end.
+        std::vector<uint8_t> extra;
+        put(extra, 0x0001, 2);
+        put(extra, 0xFFFF, 2);
+        put(extra, text.size(), 8);
+        JarReader overlong(writeZip("overlong.zip", deflatedZip(text, 0xFFFFFFFFu, extra)));
+        ASSERT_EQ(text.size(), overlong.getEntries()[0].size);
+        overlong.read(overlong.getEntries()[0], bytes);
+        ASSERT_EQ(text, std::string(bytes.begin(), bytes.end()));
+
+        // Offsets near 2^64 do not wrap around the bounds checks.
+        extra.clear();
+        put(extra, 0x0001, 2);
+        put(extra, 8, 2);
+        put(extra, ~uint64_t(0) - 10, 8);
+        JarReader wrapped(writeZip("wrapped.zip", deflatedZip(text, text.size(), extra, 0xFFFFFFFFu)));
+        ASSERT_THROW(wrapped.read(wrapped.getEntries()[0], bytes), std::runtime_error);
+        auto zip = deflatedZip(text, text.size());
+        auto directory = zip.size() - 22 - 46 - 5;
+        ASSERT_NO_THROW(JarReader(writeZip("zip64-end.zip", withZip64End(zip, directory, 46 + 5))));
+        ASSERT_THROW(JarReader(writeZip("wrapped-end.zip", withZip64End(zip, ~uint64_t(0) - 10, 46 + 5 + 20))),
+                     std::runtime_error);
+    }
+}
@@ -0,0 +1,273 @@
+#include "../BaseTest.hpp"
+#include "../ClassFileBuilder.hpp"
+#include <gtest/gtest.h>
+
+#include <classfile/ClassFileParser.hpp>
+#include <ClazzLoader.hpp>
+#include <SymbolTable.hpp>
+#include <verifier/Verifier.hpp>
+#include <Error.hpp>
+
+#include <cstdio>
+
+namespace CCW::Tula {
+
+    class TestVerifier : public VMTest {
+    };
+
+    static ClassFileBuilder::MethodSpec staticMethod(const std::string &name, const std::string &descriptor,
+                                                     uint16_t maxStack, uint16_t maxLocals,
+                                                     std::vector<uint8_t> code,
+                                                     std::vector<uint8_t> stackMapTable = {}) {
+        ClassFileBuilder::MethodSpec method;
+        method.accessFlags = 0x0009;
+        method.name = name;
+        method.descriptor = descriptor;
+        method.maxStack = maxStack;
+        method.maxLocals = maxLocals;
+        method.code = std::move(code);
+        method.stackMapTable = std::move(stackMapTable);
+        return method;
+    }
+
+    static ClassFileBuilder::MethodSpec countDown() {
+        // int countDown(int n) { int i = 0; while (n > 0) { i++; n--; } return i; }
+        return staticMethod("countDown", "(I)I", 1, 2,
+                            {0x03, 0x3c,                // iconst_0, istore_1
+                             0x1a, 0x9e, 0x00, 0x0c,    // 2: iload_0, ifle 15
+                             0x84, 0x01, 0x01,          // iinc 1 1
+                             0x84, 0x00, 0xff,          // iinc 0 -1
+                             0xa7, 0xff, 0xf6,          // goto 2
+                             0x1b, 0xac},               // 15: iload_1, ireturn
+                            {0x00, 0x02,
+                             252, 0x00, 0x02, 0x01,     // 2: append int
+                             12});                      // 15: same
+    }
+
+    static ClassFileBuilder::MethodSpec constructor(ClassFileBuilder &builder) {
+        ClassFileBuilder::MethodSpec init;
+        init.name = "<init>";
+        init.descriptor = "()V";
+        init.maxStack = 1;
+        init.maxLocals = 1;
+        auto objectInit = builder.methodRef("java/lang/Object", "<init>", "()V");
+        // aload_0, invokespecial Object.<init>, return
+        init.code = {0x2a, 0xb7, (uint8_t) (objectInit >> 8u), (uint8_t) objectInit, 0xb1};
+        return init;
+    }
+
+    static InstanceKlass::Ptr parse(const std::vector<uint8_t> &bytes) {
+        return std::static_pointer_cast<InstanceKlass>(ClassFileParser::parse(bytes.data(), bytes.size()));
+    }
+
+    static std::string verifySingle(ClassFileBuilder &builder) {
+        auto klass = parse(builder.build());
+        Verifier verifier;
+        auto results = verifier.verifyMethods(*klass);
+        return results.back();
+    }
+
+    TEST_F(TestVerifier, TestValidMethods) {
+        ClassFileBuilder builder("com/tula/Valid");
+        builder.addMethod(constructor(builder));
+        builder.addMethod(countDown());
+        // try { } catch (Throwable t) { } with the handler frame holding the exception.
+        auto throwable = builder.classRef("java/lang/Throwable");
+        auto handler = staticMethod("handler", "()V", 1, 0,
+                                    {0x00, 0xb1, 0x57, 0xb1},   // nop, return, 2: pop, return
+                                    {0x00, 0x01, 66, 0x07, (uint8_t) (throwable >> 8u), (uint8_t) throwable});
+        handler.exceptionTable = {{0, 1, 2, 0}};
+        builder.addMethod(handler);
+
+        auto bytes = builder.build();
+        auto klass = parse(bytes);
+        Verifier verifier;
+        for (const auto &result : verifier.verifyMethods(*klass)) {
+            ASSERT_EQ("", result);
+        }
+        ASSERT_NO_THROW(verifier.verify(*klass));
+    }
+
+    TEST_F(TestVerifier, TestInvalidMethods) {
+        {
+            ClassFileBuilder builder("com/tula/Underflow");
+            builder.addMethod(staticMethod("add", "()V", 2, 0, {0x60, 0xb1}));    // iadd, return
+            ASSERT_NE(std::string::npos, verifySingle(builder).find("Operand stack underflow"));
+        }
+        {
+            ClassFileBuilder builder("com/tula/Mismatch");
+            builder.addMethod(staticMethod("get", "()I", 1, 0, {0x0b, 0xac}));    // fconst_0, ireturn
+            ASSERT_NE(std::string::npos, verifySingle(builder).find("Bad type on operand stack"));
+        }
+        {
+            ClassFileBuilder builder("com/tula/Overflow");
+            builder.addMethod(staticMethod("push", "()V", 1, 0, {0x03, 0x03, 0xb1}));
+            ASSERT_NE(std::string::npos, verifySingle(builder).find("Operand stack overflow"));
+        }
+        {
+            ClassFileBuilder builder("com/tula/MissingFrame");
+            // goto 4, nop, 4: return with a frame only at the branch target.
+            builder.addMethod(staticMethod("jump", "()V", 0, 0, {0xa7, 0x00, 0x04, 0x00, 0xb1}, {0x00, 0x01, 4}));
+            ASSERT_NE(std::string::npos, verifySingle(builder).find("Expecting a stackmap frame"));
+        }
+        {
+            ClassFileBuilder builder("com/tula/NoFrameAtTarget");
+            builder.addMethod(staticMethod("jump", "()V", 0, 0, {0xa7, 0x00, 0x03, 0xb1}));
+            ASSERT_NE(std::string::npos, verifySingle(builder).find("branch target"));
+        }
+        {
+            ClassFileBuilder builder("com/tula/NoSuper");
+            auto init = constructor(builder);
+            init.code = {0xb1};
+            builder.addMethod(init);
+            ASSERT_NE(std::string::npos, verifySingle(builder).find("Constructor must call super()"));
+        }
+        {
+            ClassFileBuilder builder("com/tula/Split");
+            // lconst_0, swap splits the long.
+            builder.addMethod(staticMethod("split", "()V", 3, 0, {0x09, 0x5f, 0xb1}));
+            ASSERT_NE(std::string::npos, verifySingle(builder).find("Splitting a category 2 value"));
+        }
+        {
+            ClassFileBuilder builder("com/tula/FallOff");
+            builder.addMethod(staticMethod("fall", "()V", 0, 0, {0x00}));
+            ASSERT_NE(std::string::npos, verifySingle(builder).find("Falling off the end of the code"));
+        }
+    }
+
+    TEST_F(TestVerifier, TestVerifyThrows) {
+        ClassFileBuilder builder("com/tula/Invalid");
+        builder.addMethod(countDown());
+        builder.addMethod(staticMethod("add", "()V", 2, 0, {0x60, 0xb1}));
+        auto klass = parse(builder.build());
+        Verifier verifier;
+        ASSERT_THROW(verifier.verify(*klass), VerifyError);
+    }
+
+    TEST_F(TestVerifier, TestOldClassFilesAreRejected) {
+        ClassFileBuilder builder("com/tula/Old");
+        builder.version(49);
+        builder.addMethod(staticMethod("get", "()I", 1, 0, {0x03, 0xac}));    // iconst_0, ireturn
+        ASSERT_NE(std::string::npos, verifySingle(builder).find("type inference verifier"));
+        ASSERT_THROW(Verifier().verify(*parse(builder.build())), VerifyError);
+    }
+
+    // static Base convert(Source s) { return s; }
+    static ClassFileBuilder::MethodSpec convert(const std::string &source, const std::string &base) {
+        return staticMethod("convert", "(L" + source + ";)L" + base + ";", 1, 1, {0x2a, 0xb0});   // aload_0, areturn
+    }
+
+    TEST_F(TestVerifier, TestAssignability) {
+        // Without a check only identity, java/lang/Object and the array rules make class types assignable.
+        {
+            ClassFileBuilder builder("com/tula/Widen");
+            builder.addMethod(convert("com/tula/Derived", "com/tula/Base"));
+            ASSERT_NE(std::string::npos, verifySingle(builder).find("Bad type on operand stack"));
+        }
+        {
+            ClassFileBuilder builder("com/tula/ToObject");
+            builder.addMethod(convert("com/tula/Derived", "java/lang/Object"));
+            ASSERT_EQ("", verifySingle(builder));
+        }
+
+        auto dir = emptyTempDir("verifier-hierarchy");
+        ClassFileBuilder("com/tula/Base").writeTo(dir);
+        ClassFileBuilder("com/tula/Derived", "com/tula/Base").writeTo(dir);
+        ClassFileBuilder("com/tula/Other").writeTo(dir);
+        ClassFileBuilder("com/tula/Marker").accessFlags(0x0601).writeTo(dir);     // public abstract interface
+        ClassFileBuilder("com/tula/Widen").addMethod(convert("com/tula/Derived", "com/tula/Base")).writeTo(dir);
+        ClassFileBuilder("com/tula/ToInterface").addMethod(convert("com/tula/Other", "com/tula/Marker")).writeTo(dir);
+        ClassFileBuilder("com/tula/Unrelated").addMethod(convert("com/tula/Other", "com/tula/Base")).writeTo(dir);
+        ClassFileBuilder("com/tula/Missing").addMethod(convert("com/tula/Nowhere", "com/tula/Base")).writeTo(dir);
+
+        // The class loader walks the hierarchy of its class path.
+        BootstrapClassLoader loader(vm.get(), dir);
+        loader.setVerifier(std::make_shared<Verifier>());
+        ASSERT_NE(nullptr, loader.loadClass(SymbolTable::intern("com/tula/Widen")));
+        ASSERT_NE(nullptr, loader.loadClass(SymbolTable::intern("com/tula/ToInterface")));
+        ASSERT_THROW(loader.loadClass(SymbolTable::intern("com/tula/Unrelated")), VerifyError);
+        ASSERT_THROW(loader.loadClass(SymbolTable::intern("com/tula/Missing")), VerifyError);
+    }
+
+    TEST_F(TestVerifier, TestParallel) {
+        ClassFileBuilder builder("com/tula/Parallel");
+        for (int i = 0; i < 16; ++i) {
+            auto method = countDown();
+            method.name += std::to_string(i);
+            builder.addMethod(method);
+        }
+        builder.addMethod(staticMethod("add", "()V", 2, 0, {0x60, 0xb1}));
+        auto klass = parse(builder.build());
+
+        ThreadPool pool(4);
+        Verifier verifier(&pool);
+        auto results = verifier.verifyMethods(*klass);
+        ASSERT_EQ(17, results.size());
+        for (int i = 0; i < 16; ++i) {
+            ASSERT_EQ("", results[i]);
+        }
+        ASSERT_NE("", results[16]);
+    }
+
+    TEST_F(TestVerifier, TestCache) {
+        ClassFileBuilder builder("com/tula/Cached");
+        builder.addMethod(countDown());
+        auto bytes = builder.build();
+        auto klass = parse(bytes);
+
+        auto cache = std::make_shared<VerificationCache>();
+        Verifier verifier(nullptr, cache);
+        verifier.verify(*klass, bytes.data(), bytes.size());
+        ASSERT_EQ(1, cache->size());
+        ASSERT_TRUE(cache->contains(VerificationCache::digest(bytes.data(), bytes.size())));
+
+        // A class that fails is never added.
+        ClassFileBuilder invalid("com/tula/NotCached");
+        invalid.addMethod(staticMethod("add", "()V", 2, 0, {0x60, 0xb1}));
+        auto invalidBytes = invalid.build();
+        ASSERT_THROW(verifier.verify(*parse(invalidBytes), invalidBytes.data(), invalidBytes.size()), VerifyError);
+        ASSERT_EQ(1, cache->size());
+
+        auto path = ::testing::TempDir() + "TestVerifierCache.bin";
+        ASSERT_TRUE(cache->save(path));
+        VerificationCache loaded;
+        ASSERT_TRUE(loaded.load(path));
+        ASSERT_TRUE(loaded.contains(VerificationCache::digest(bytes.data(), bytes.size())));
+        std::remove(path.c_str());
+        ASSERT_FALSE(loaded.load(path));
+    }
+
+    TEST_F(TestVerifier, TestCacheFollowsHierarchy) {
+        auto dir = emptyTempDir("verifier-cache-hierarchy");
+        ClassFileBuilder("com/tula/Base").writeTo(dir);
+        ClassFileBuilder("com/tula/Derived", "com/tula/Base").writeTo(dir);
+        ClassFileBuilder widen("com/tula/Widen");
+        widen.addMethod(convert("com/tula/Derived", "com/tula/Base"));
+        widen.writeTo(dir);
+        auto bytes = widen.build();
+        auto digest = VerificationCache::digest(bytes.data(), bytes.size());
+        auto path = ::testing::TempDir() + "TestVerifierCacheHierarchy.bin";
+
+        {
+            auto cache = std::make_shared<VerificationCache>();
+            BootstrapClassLoader loader(vm.get(), dir);
+            loader.setVerifier(std::make_shared<Verifier>(nullptr, cache));
+            ASSERT_NE(nullptr, loader.loadClass(SymbolTable::intern("com/tula/Widen")));
+            std::vector<VerificationCache::Assumption> assumptions;
+            ASSERT_TRUE(cache->find(digest, assumptions));
+            std::vector<VerificationCache::Assumption> expected{{"com/tula/Base", "com/tula/Derived", true}};
+            ASSERT_EQ(expected, assumptions);
+            ASSERT_TRUE(cache->save(path));
+        }
+
+        // Widen is unchanged, but Derived no longer extends Base: the cached verification does not apply.
+        ClassFileBuilder("com/tula/Derived").writeTo(dir);
+        auto cache = std::make_shared<VerificationCache>();
+        ASSERT_TRUE(cache->load(path));
+        ASSERT_TRUE(cache->contains(digest));
+        BootstrapClassLoader loader(vm.get(), dir);
+        loader.setVerifier(std::make_shared<Verifier>(nullptr, cache));
+        ASSERT_THROW(loader.loadClass(SymbolTable::intern("com/tula/Widen")), VerifyError);
+        std::remove(path.c_str());
+    }
+}
@@ -0,0 +1,202 @@
+#include "ClassGenerator.hpp"
+#include "ClassFileBuilder.hpp"
+#include "JarWriter.hpp"
+
+#include <cmath>
+#include <filesystem>
+#include <fstream>
+#include <stdexcept>
+
+namespace CCW::Tula {
+
+    static const char *const FieldDescriptors[] = {
+            "I", "J", "Z", "D", "[B", "Ljava/lang/String;", "[Ljava/lang/Object;", "Ljava/util/List;"
+    };
+
+    static const char *const MethodDescriptors[] = {
+            "()V", "(I)I", "(J)J", "(Ljava/lang/String;)Z", "(IJLjava/lang/String;)V",
+            "([BII)I", "(Ljava/lang/Object;Ljava/lang/Object;)Ljava/lang/Object;", "(DD)D"
+    };
+
+    static constexpr size_t AnnotationTypes = 8;
+
+    // splitmix64: a reproducible stream per class, whatever order classes are generated in.
+    class Random {
+    public:
+        Random(uint64_t seed, uint64_t stream) : state(seed ^ (stream * 0x9E3779B97F4A7C15ull)) {}
+
+        uint64_t next() {
+            auto z = (state += 0x9E3779B97F4A7C15ull);
+            z = (z ^ (z >> 30u)) * 0xBF58476D1CE4E5B9ull;
+            z = (z ^ (z >> 27u)) * 0x94D049BB133111EBull;
+            return z ^ (z >> 31u);
+        }
+
+        // Between half and one and a half times `n`.
+        size_t around(size_t n) {
+            return n == 0 ? 0 : n / 2 + next() % (n + 1);
+        }
+
+        // `mean` on average: its integer part, plus one with the probability of its fraction.
+        size_t count(double mean) {
+            auto whole = std::floor(mean);
+            auto fraction = mean - whole;
+            return static_cast<size_t>(whole) + (static_cast<double>(next() % 1000000) < fraction * 1e6 ? 1 : 0);
+        }
+
+    private:
+        uint64_t state;
+    };
+
+    bool CorpusSpec::set(const std::string &name, const std::string &value) {
+        if (name == "classes") {
+            classes = std::stoull(value);
+        } else if (name == "constants") {
+            constants = std::stoull(value);
+        } else if (name == "fields") {
+            fields = std::stoull(value);
+        } else if (name == "methods") {
+            methods = std::stoull(value);
+        } else if (name == "code") {
+            codeLength = std::stoull(value);
+        } else if (name == "annotations") {
+            annotations = std::stod(value);
+        } else if (name == "name-length") {
+            nameLength = std::stoull(value);
+        } else if (name == "depth") {
+            hierarchyDepth = std::stoull(value);
+        } else if (name == "package") {
+            package = value;
+        } else if (name == "seed") {
+            seed = std::stoull(value);
+        } else {
+            return false;
+        }
+        return true;
+    }
+
+    const char *CorpusSpec::usage() {
+        return "  --classes N        classes to generate (1000)\n"
+               "  --constants N      extra constants per class (32)\n"
+               "  --fields N         fields per class (8)\n"
+               "  --methods N        methods per class (8)\n"
+               "  --code N           bytecode bytes per method (32)\n"
+               "  --annotations F    annotations per class, field and method (0.25)\n"
+               "  --name-length N    minimum class and member name length (short names)\n"
+               "  --depth N          classes per superclass chain (1)\n"
+               "  --package NAME     root package (gen)\n"
+               "  --seed N           random seed (1)\n";
+    }
+
+    ClassGenerator::ClassGenerator(CorpusSpec spec) : spec(std::move(spec)) {
+        const auto &s = this->spec;
+        if (s.hierarchyDepth == 0 || s.annotations < 0 || s.codeLength > 60000) {
+            throw std::invalid_argument("Invalid corpus shape");
+        }
+        // Worst case pool entries: a method ref takes up to 6, a member 2 plus its annotations' constants.
+        auto annotationEntries = static_cast<size_t>(std::ceil(s.annotations)) * 3;
+        auto entries = 3 * (s.constants * 6 + (s.fields + s.methods) * (2 + annotationEntries)) / 2 + 128;
+        if (entries > 0xFFFF) {
+            throw std::invalid_argument("Classes of this shape overflow the constant pool");
+        }
+    }
+
+    std::string ClassGenerator::padded(std::string name, uint64_t salt) const {
+        if (name.size() >= spec.nameLength) {
+            return name;
+        }
+        Random random(spec.seed, salt);
+        name += '_';
+        while (name.size() < spec.nameLength) {
+            name += static_cast<char>('a' + random.next() % 26);
+        }
+        return name;
+    }
+
+    std::string ClassGenerator::className(size_t index) const {
+        return spec.package + "/p" + std::to_string(index / 256) + "/" + padded("C" + std::to_string(index), index);
+    }
+
+    std::vector<uint8_t> ClassGenerator::generate(size_t index) const {
+        Random random(spec.seed, index);
+        auto name = className(index);
+        auto superClass = spec.hierarchyDepth > 1 && index % spec.hierarchyDepth != 0
+                          ? className(index - 1) : std::string("java/lang/Object");
+        ClassFileBuilder builder(name, superClass);
+        builder.sourceFile("C" + std::to_string(index) + ".java");
+
+        auto annotations = [&] {
+            std::vector<ClassFileBuilder::Annotation> result;
+            for (size_t i = random.count(spec.annotations); i > 0; --i) {
+                auto type = random.next() % AnnotationTypes;
+                result.push_back({"L" + spec.package + "/annotations/A" + std::to_string(type) + ";",
+                                  {{"value", static_cast<int32_t>(random.next())}}});
+            }
+            return result;
+        };
+        for (auto &annotation : annotations()) {
+            builder.addAnnotation(annotation);
+        }
+
+        // Member names repeat across classes, as they do in real code, so interning finds most of them.
+        auto memberSalt = [](char kind, size_t member) {
+            return (static_cast<uint64_t>(kind) << 56u) ^ member;
+        };
+        for (size_t i = 0, count = random.around(spec.fields); i < count; ++i) {
+            auto flags = static_cast<uint16_t>(i % 4 == 0 ? 0x000A : 0x0002);     // private [static]
+            builder.addField(flags, padded("f" + std::to_string(i), memberSalt('f', i)),
+                             FieldDescriptors[random.next() % std::size(FieldDescriptors)], annotations());
+        }
+        for (size_t i = 0, count = random.around(spec.methods); i < count; ++i) {
+            ClassFileBuilder::MethodSpec method;
+            method.accessFlags = 0x0001;
+            method.name = padded("m" + std::to_string(i), memberSalt('m', i));
+            method.descriptor = MethodDescriptors[random.next() % std::size(MethodDescriptors)];
+            method.maxStack = 1;
+            method.maxLocals = 8;
+            method.code.assign(std::max<size_t>(random.around(spec.codeLength), 1) - 1, 0x00);    // nop ...
+            method.code.push_back(0xB1);    // return
+            method.annotations = annotations();
+            builder.addMethod(method);
+        }
+        for (size_t i = 0, count = random.around(spec.constants); i < count; ++i) {
+            switch (i % 3) {
+                case 0:
+                    builder.string("constant " + std::to_string(random.next() % 4096));
+                    break;
+                case 1:
+                    builder.integer(static_cast<int32_t>(random.next()));
+                    break;
+                default:
+                    builder.methodRef(className(random.next() % spec.classes),
+                                      padded("m" + std::to_string(i % 16), memberSalt('m', i % 16)),
+                                      MethodDescriptors[i % std::size(MethodDescriptors)]);
+            }
+        }
+        return builder.build();
+    }
+
+    void ClassGenerator::writeDirectory(const std::string &dir) const {
+        for (size_t i = 0; i < spec.classes; ++i) {
+            auto path = std::filesystem::path(dir) / (className(i) + ".class");
+            std::filesystem::create_directories(path.parent_path());
+            auto bytes = generate(i);
+            std::ofstream out(path, std::ios::binary | std::ios::trunc);
+            out.write(reinterpret_cast<const char *>(bytes.data()), static_cast<std::streamsize>(bytes.size()));
+            if (!out) {
+                throw std::runtime_error("Can't write " + path.string());
+            }
+        }
+    }
+
+    void ClassGenerator::writeJar(const std::string &path) const {
+        JarWriter jar(path);
+        static const char manifest[] = "Manifest-Version: 1.0\r\nCreated-By: tula-gen\r\n\r\n";
+        jar.add("META-INF/MANIFEST.MF", reinterpret_cast<const uint8_t *>(manifest), sizeof(manifest) - 1);
+        for (size_t i = 0; i < spec.classes; ++i) {
+            auto bytes = generate(i);
+            jar.add(className(i) + ".class", bytes.data(), bytes.size());
+        }
+        jar.finish();
+    }
+}
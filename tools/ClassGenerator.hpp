@@ -0,0 +1,58 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace CCW::Tula {
+
+    // The shape of a generated corpus. Per-class counts vary by up to half around the given value,
+    // deterministically for a seed.
+    struct CorpusSpec {
+        size_t classes = 1000;
+        size_t constants = 32;          // extra strings, ints and method refs per class
+        size_t fields = 8;
+        size_t methods = 8;
+        size_t codeLength = 32;         // bytes per method body
+        double annotations = 0.25;      // annotations per class, field and method, on average
+        size_t nameLength = 0;          // minimum length of class and member names; 0 for short names
+        size_t hierarchyDepth = 1;      // classes per superclass chain
+        std::string package = "gen";
+        uint64_t seed = 1;
+
+        // Sets the option `--<name>` from `value`; false when there is no such option. Throws
+        // std::invalid_argument for a malformed value.
+        bool set(const std::string &name, const std::string &value);
+
+        static const char *usage();
+    };
+
+    // Generates valid class files (major version 52) shaped by a CorpusSpec.
+    class ClassGenerator {
+    public:
+        explicit ClassGenerator(CorpusSpec spec);
+
+        // Internal form, e.g. "gen/p3/C1234".
+        [[nodiscard]] std::string className(size_t index) const;
+
+        [[nodiscard]] std::vector<uint8_t> generate(size_t index) const;
+
+        // Writes every class to `dir`/<class name>.class, creating packages as needed.
+        void writeDirectory(const std::string &dir) const;
+
+        // Writes every class to a jar with a manifest. Throws std::runtime_error when `path` can't be
+        // written.
+        void writeJar(const std::string &path) const;
+
+        [[nodiscard]] inline const CorpusSpec &getSpec() const {
+            return spec;
+        }
+
+    private:
+        [[nodiscard]] std::string padded(std::string name, uint64_t salt) const;
+
+    private:
+        CorpusSpec spec;
+    };
+}
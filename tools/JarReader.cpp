@@ -0,0 +1,194 @@
+#include "JarReader.hpp"
+
+#include <algorithm>
+#include <cstring>
+#include <limits>
+#include <stdexcept>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <zlib.h>
+
+namespace CCW::Tula {
+
+    static constexpr uint32_t LocalHeader = 0x04034b50;
+    static constexpr uint32_t CentralHeader = 0x02014b50;
+    static constexpr uint32_t EndOfDirectory = 0x06054b50;
+    static constexpr uint32_t Zip64EndOfDirectory = 0x06064b50;
+    static constexpr uint32_t Zip64Locator = 0x07064b50;
+    static constexpr uint16_t Zip64Extra = 0x0001;
+
+    // Deflated entries are inflated this much at a time, so memory follows the data rather than the
+    // size the archive claims.
+    static constexpr size_t InflateChunk = 64 * 1024;
+
+    template<typename T>
+    static T get(const uint8_t *p) {
+        uint64_t value = 0;
+        for (size_t i = 0; i < sizeof(T); ++i) {
+            value |= static_cast<uint64_t>(p[i]) << (8 * i);
+        }
+        return static_cast<T>(value);
+    }
+
+    JarReader::JarReader(const std::string &path) : path(path) {
+        auto fd = open(path.c_str(), O_RDONLY | O_CLOEXEC);
+        if (fd < 0) {
+            throw std::runtime_error("Can't open " + path);
+        }
+        struct stat st{};
+        if (fstat(fd, &st) != 0 || st.st_size == 0) {
+            close(fd);
+            fail("empty or unreadable");
+        }
+        size = static_cast<size_t>(st.st_size);
+        auto mapped = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+        close(fd);
+        if (mapped == MAP_FAILED) {
+            fail("can't be mapped");
+        }
+        data = static_cast<const uint8_t *>(mapped);
+        try {
+            readCentralDirectory();
+        } catch (...) {
+            munmap(const_cast<uint8_t *>(data), size);
+            throw;
+        }
+    }
+
+    JarReader::~JarReader() {
+        munmap(const_cast<uint8_t *>(data), size);
+    }
+
+    void JarReader::fail(const std::string &message) const {
+        throw std::runtime_error("Jar " + path + ": " + message);
+    }
+
+    void JarReader::readCentralDirectory() {
+        // The end record is the last 22 bytes plus a comment of up to 64KiB.
+        if (size < 22) {
+            fail("too short");
+        }
+        const uint8_t *end = nullptr;
+        for (auto p = data + size - 22;; --p) {
+            if (get<uint32_t>(p) == EndOfDirectory) {
+                end = p;
+                break;
+            }
+            if (p == data || data + size - p > 22 + 0xFFFF) {
+                fail("no end of central directory");
+            }
+        }
+        uint64_t count = get<uint16_t>(end + 10);
+        uint64_t directorySize = get<uint32_t>(end + 12);
+        uint64_t directoryOffset = get<uint32_t>(end + 16);
+        if ((count == 0xFFFF || directoryOffset == 0xFFFFFFFFu) && end - data >= 20
+            && get<uint32_t>(end - 20) == Zip64Locator) {
+            auto recordOffset = get<uint64_t>(end - 20 + 8);
+            if (size < 56 || recordOffset > size - 56 || get<uint32_t>(data + recordOffset) != Zip64EndOfDirectory) {
+                fail("bad zip64 end of central directory");
+            }
+            count = get<uint64_t>(data + recordOffset + 32);
+            directorySize = get<uint64_t>(data + recordOffset + 40);
+            directoryOffset = get<uint64_t>(data + recordOffset + 48);
+        }
+        // Checked without sums, which archive values near 2^64 would wrap.
+        if (directoryOffset > size || directorySize > size - directoryOffset) {
+            fail("central directory out of bounds");
+        }
+        if (count > directorySize / 46) {
+            fail("more entries than the central directory holds");
+        }
+        entries.reserve(count);
+        auto p = data + directoryOffset;
+        auto directoryEnd = p + directorySize;
+        for (uint64_t i = 0; i < count; ++i) {
+            if (directoryEnd - p < 46 || get<uint32_t>(p) != CentralHeader) {
+                fail("bad central directory entry " + std::to_string(i));
+            }
+            auto nameLength = get<uint16_t>(p + 28);
+            auto extraLength = get<uint16_t>(p + 30);
+            auto commentLength = get<uint16_t>(p + 32);
+            if (directoryEnd - p < 46 + nameLength + extraLength + commentLength) {
+                fail("truncated central directory entry " + std::to_string(i));
+            }
+            Entry entry{std::string(reinterpret_cast<const char *>(p + 46), nameLength), get<uint16_t>(p + 10),
+                        get<uint32_t>(p + 20), get<uint32_t>(p + 24), get<uint32_t>(p + 42)};
+            // Values saturated in the entry are in the zip64 extra field, in this order. Fields are cut at
+            // the end of the extra area, whatever length they claim.
+            auto extras = p + 46 + nameLength;
+            for (size_t offset = 0; offset + 4 <= extraLength;) {
+                auto id = get<uint16_t>(extras + offset);
+                size_t length = std::min<size_t>(get<uint16_t>(extras + offset + 2), extraLength - offset - 4);
+                if (id == Zip64Extra) {
+                    size_t field = 0;
+                    for (auto value : {&entry.size, &entry.compressedSize, &entry.localHeaderOffset}) {
+                        if (*value == 0xFFFFFFFFu && field + 8 <= length) {
+                            *value = get<uint64_t>(extras + offset + 4 + field);
+                            field += 8;
+                        }
+                    }
+                }
+                offset += 4 + length;
+            }
+            entries.push_back(std::move(entry));
+            p += 46 + nameLength + extraLength + commentLength;
+        }
+    }
+
+    void JarReader::read(const Entry &entry, std::vector<uint8_t> &out) const {
+        if (size < 30 || entry.localHeaderOffset > size - 30
+            || get<uint32_t>(data + entry.localHeaderOffset) != LocalHeader) {
+            fail("bad local header of " + entry.name);
+        }
+        auto header = data + entry.localHeaderOffset;
+        auto start = entry.localHeaderOffset + 30 + get<uint16_t>(header + 26) + get<uint16_t>(header + 28);
+        if (start > size || entry.compressedSize > size - start) {
+            fail(entry.name + " out of bounds");
+        }
+        if (entry.method == 0) {
+            if (entry.compressedSize != entry.size) {
+                fail("bad size of stored " + entry.name);
+            }
+            // Within the mapped file, as checked above.
+            out.assign(data + start, data + start + entry.size);
+            return;
+        }
+        if (entry.method != Z_DEFLATED) {
+            fail("unsupported compression method " + std::to_string(entry.method) + " of " + entry.name);
+        }
+        z_stream stream{};
+        if (inflateInit2(&stream, -MAX_WBITS) != Z_OK) {
+            fail("can't start inflating " + entry.name);
+        }
+        // zlib takes 32-bit lengths, so the input is fed in pieces too.
+        auto in = data + start;
+        auto inLeft = entry.compressedSize;
+        out.clear();
+        int status = Z_OK;
+        while (status == Z_OK && out.size() <= entry.size) {
+            if (stream.avail_in == 0) {
+                auto piece = std::min<uint64_t>(inLeft, std::numeric_limits<uInt>::max());
+                stream.next_in = const_cast<Bytef *>(in);
+                stream.avail_in = static_cast<uInt>(piece);
+                in += piece;
+                inLeft -= piece;
+            }
+            // Room for one byte more than the entry claims tells an entry that inflates to more.
+            auto left = entry.size - out.size();
+            auto room = left < InflateChunk ? static_cast<size_t>(left) + 1 : InflateChunk;
+            auto used = out.size();
+            out.resize(used + room);
+            stream.next_out = out.data() + used;
+            stream.avail_out = static_cast<uInt>(room);
+            status = inflate(&stream, Z_NO_FLUSH);
+            out.resize(used + room - stream.avail_out);
+        }
+        inflateEnd(&stream);
+        if (status != Z_STREAM_END || out.size() != entry.size) {
+            fail("corrupt deflated data in " + entry.name);
+        }
+    }
+}
@@ -0,0 +1,49 @@
+#pragma once
+
+#include <CCW/Base.hpp>
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace CCW::Tula {
+
+    // Reads entries of a zip archive mapped into memory. Stored and deflated entries are supported, as
+    // are zip64 archives. Reading is thread-safe. Throws std::runtime_error on malformed archives.
+    class JarReader : public Noncopyable {
+    public:
+        struct Entry {
+            std::string name;
+            uint16_t method;
+            uint64_t compressedSize;
+            uint64_t size;
+            uint64_t localHeaderOffset;
+        };
+
+        explicit JarReader(const std::string &path);
+
+        ~JarReader();
+
+        [[nodiscard]] inline const std::vector<Entry> &getEntries() const {
+            return entries;
+        }
+
+        [[nodiscard]] inline const std::string &getPath() const {
+            return path;
+        }
+
+        // Replaces the contents of `out` with the uncompressed bytes of `entry`.
+        void read(const Entry &entry, std::vector<uint8_t> &out) const;
+
+    private:
+        void readCentralDirectory();
+
+        [[noreturn]] void fail(const std::string &message) const;
+
+    private:
+        std::string path;
+        const uint8_t *data = nullptr;
+        size_t size = 0;
+        std::vector<Entry> entries;
+    };
+}
@@ -0,0 +1,123 @@
+#include "JarWriter.hpp"
+
+#include <limits>
+#include <stdexcept>
+
+namespace CCW::Tula {
+
+    static constexpr uint16_t DosDate1980 = 0x21;     // 1980-01-01, for reproducible archives
+    static constexpr uint16_t Utf8Names = 0x0800;
+
+    template<typename T>
+    static void put(std::ofstream &out, T value) {
+        for (size_t i = 0; i < sizeof(T); ++i) {
+            out.put(static_cast<char>((static_cast<uint64_t>(value) >> (8 * i)) & 0xFFu));
+        }
+    }
+
+    JarWriter::JarWriter(const std::string &path) : path(path), out(path, std::ios::binary | std::ios::trunc) {
+        check();
+    }
+
+    void JarWriter::check() {
+        if (!out) {
+            throw std::runtime_error("Can't write " + path);
+        }
+    }
+
+    uint32_t JarWriter::crc32(const uint8_t *data, size_t size) {
+        static const auto table = [] {
+            std::vector<uint32_t> table(256);
+            for (uint32_t n = 0; n < 256; ++n) {
+                auto c = n;
+                for (int k = 0; k < 8; ++k) {
+                    c = (c & 1u) != 0 ? 0xEDB88320u ^ (c >> 1u) : c >> 1u;
+                }
+                table[n] = c;
+            }
+            return table;
+        }();
+        uint32_t crc = 0xFFFFFFFFu;
+        for (size_t i = 0; i < size; ++i) {
+            crc = table[(crc ^ data[i]) & 0xFFu] ^ (crc >> 8u);
+        }
+        return crc ^ 0xFFFFFFFFu;
+    }
+
+    void JarWriter::add(const std::string &name, const uint8_t *data, size_t size) {
+        if (size > std::numeric_limits<uint32_t>::max() || offset > std::numeric_limits<uint32_t>::max()) {
+            throw std::runtime_error("Jar " + path + " exceeds 4GiB");
+        }
+        Entry entry{name, crc32(data, size), static_cast<uint32_t>(size), static_cast<uint32_t>(offset)};
+        put<uint32_t>(out, 0x04034b50);
+        put<uint16_t>(out, 20);
+        put<uint16_t>(out, Utf8Names);
+        put<uint16_t>(out, 0);              // stored
+        put<uint16_t>(out, 0);
+        put<uint16_t>(out, DosDate1980);
+        put<uint32_t>(out, entry.crc);
+        put<uint32_t>(out, entry.size);
+        put<uint32_t>(out, entry.size);
+        put<uint16_t>(out, static_cast<uint16_t>(name.size()));
+        put<uint16_t>(out, 0);
+        out.write(name.data(), static_cast<std::streamsize>(name.size()));
+        out.write(reinterpret_cast<const char *>(data), static_cast<std::streamsize>(size));
+        check();
+        offset += 30 + name.size() + size;
+        entries.push_back(std::move(entry));
+    }
+
+    void JarWriter::finish() {
+        auto directoryOffset = offset;
+        for (const auto &entry : entries) {
+            put<uint32_t>(out, 0x02014b50);
+            put<uint16_t>(out, 45);
+            put<uint16_t>(out, 20);
+            put<uint16_t>(out, Utf8Names);
+            put<uint16_t>(out, 0);
+            put<uint16_t>(out, 0);
+            put<uint16_t>(out, DosDate1980);
+            put<uint32_t>(out, entry.crc);
+            put<uint32_t>(out, entry.size);
+            put<uint32_t>(out, entry.size);
+            put<uint16_t>(out, static_cast<uint16_t>(entry.name.size()));
+            put<uint16_t>(out, 0);          // extra
+            put<uint16_t>(out, 0);          // comment
+            put<uint16_t>(out, 0);          // disk
+            put<uint16_t>(out, 0);          // internal attributes
+            put<uint32_t>(out, 0);          // external attributes
+            put<uint32_t>(out, entry.offset);
+            out.write(entry.name.data(), static_cast<std::streamsize>(entry.name.size()));
+            offset += 46 + entry.name.size();
+        }
+        auto directorySize = offset - directoryOffset;
+        auto zip64 = entries.size() > 0xFFFF || directoryOffset > 0xFFFFFFFFu;
+        if (zip64) {
+            auto recordOffset = offset;
+            put<uint32_t>(out, 0x06064b50);
+            put<uint64_t>(out, 44);
+            put<uint16_t>(out, 45);
+            put<uint16_t>(out, 45);
+            put<uint32_t>(out, 0);
+            put<uint32_t>(out, 0);
+            put<uint64_t>(out, entries.size());
+            put<uint64_t>(out, entries.size());
+            put<uint64_t>(out, directorySize);
+            put<uint64_t>(out, directoryOffset);
+            put<uint32_t>(out, 0x07064b50);
+            put<uint32_t>(out, 0);
+            put<uint64_t>(out, recordOffset);
+            put<uint32_t>(out, 1);
+        }
+        put<uint32_t>(out, 0x06054b50);
+        put<uint16_t>(out, 0);
+        put<uint16_t>(out, 0);
+        put<uint16_t>(out, zip64 ? 0xFFFF : static_cast<uint16_t>(entries.size()));
+        put<uint16_t>(out, zip64 ? 0xFFFF : static_cast<uint16_t>(entries.size()));
+        put<uint32_t>(out, static_cast<uint32_t>(directorySize));
+        put<uint32_t>(out, zip64 ? 0xFFFFFFFFu : static_cast<uint32_t>(directoryOffset));
+        put<uint16_t>(out, 0);
+        out.flush();
+        check();
+    }
+}
@@ -0,0 +1,39 @@
+#pragma once
+
+#include <cstdint>
+#include <fstream>
+#include <string>
+#include <vector>
+
+namespace CCW::Tula {
+
+    // Writes a zip archive with stored (uncompressed) entries, switching to zip64 records past 65535
+    // entries. Throws std::runtime_error on write errors.
+    class JarWriter {
+    public:
+        explicit JarWriter(const std::string &path);
+
+        void add(const std::string &name, const uint8_t *data, size_t size);
+
+        // Writes the central directory; the archive is unreadable without it.
+        void finish();
+
+        static uint32_t crc32(const uint8_t *data, size_t size);
+
+    private:
+        struct Entry {
+            std::string name;
+            uint32_t crc;
+            uint32_t size;
+            uint32_t offset;
+        };
+
+        void check();
+
+    private:
+        std::string path;
+        std::ofstream out;
+        uint64_t offset = 0;
+        std::vector<Entry> entries;
+    };
+}
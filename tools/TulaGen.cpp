@@ -0,0 +1,57 @@
+// tula-gen: writes a synthetic corpus of valid class files, for load-time measurements.
+//
+//   tula-gen [options] <output dir>          (loose class files under the directory)
+//   tula-gen [options] --jar <output.jar>    (one jar)
+
+#include "ClassGenerator.hpp"
+
+#include <cstdio>
+#include <cstring>
+#include <stdexcept>
+#include <string>
+
+using namespace CCW::Tula;
+
+static int usage() {
+    fprintf(stderr, "usage: tula-gen [options] <output dir>\n"
+                    "       tula-gen [options] --jar <output.jar>\n%s", CorpusSpec::usage());
+    return 2;
+}
+
+int main(int argc, char **argv) {
+    CorpusSpec spec;
+    std::string output;
+    bool jar = false;
+    try {
+        for (int i = 1; i < argc; ++i) {
+            if (strcmp(argv[i], "--jar") == 0) {
+                jar = true;
+            } else if (strncmp(argv[i], "--", 2) == 0 && i + 1 < argc) {
+                if (!spec.set(argv[i] + 2, argv[i + 1])) {
+                    return usage();
+                }
+                ++i;
+            } else if (output.empty()) {
+                output = argv[i];
+            } else {
+                return usage();
+            }
+        }
+        if (output.empty()) {
+            return usage();
+        }
+        ClassGenerator generator(spec);
+        if (jar) {
+            generator.writeJar(output);
+        } else {
+            generator.writeDirectory(output);
+        }
+    } catch (const std::invalid_argument &e) {
+        fprintf(stderr, "tula-gen: %s\n", e.what());
+        return 2;
+    } catch (const std::exception &e) {
+        fprintf(stderr, "tula-gen: %s\n", e.what());
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,401 @@
+// tula-inspect: parses class files in parallel and prints one line of JSON per class, for audits of
+// large code bases (versions, annotations, references to forbidden packages).
+//
+//   tula-inspect [--fields f,f,...|all] [--forbid <prefix>]... [--threads N] <class, dir or jar>...
+//
+// Fields: path name version access super interfaces source fields methods annotations references size.
+// With --forbid, a "forbidden" field lists referenced classes under the given internal-form prefixes
+// and the exit status is 3 when there are any. Classes that fail to parse get "error" and "offset"
+// fields and exit status 1. Throughput goes to stderr.
+
+#include "JarReader.hpp"
+
+#include "classfile/ClassFileParser.hpp"
+#include "utils/ThreadPool.hpp"
+#include <tula/VM.hpp>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <memory>
+#include <set>
+#include <string>
+#include <vector>
+
+using namespace CCW::Tula;
+
+#define TULA_INSPECT_FIELDS(do_field) \
+    do_field(Path, "path")             \
+    do_field(Name, "name")             \
+    do_field(Version, "version")       \
+    do_field(Access, "access")         \
+    do_field(Super, "super")           \
+    do_field(Interfaces, "interfaces") \
+    do_field(Source, "source")         \
+    do_field(Fields, "fields")         \
+    do_field(Methods, "methods")       \
+    do_field(Annotations, "annotations") \
+    do_field(References, "references") \
+    do_field(Size, "size")
+
+enum InspectField : uint32_t {
+#define TULA_INSPECT_FIELD_ID(id, name) id,
+    TULA_INSPECT_FIELDS(TULA_INSPECT_FIELD_ID)
+#undef TULA_INSPECT_FIELD_ID
+    FieldCount
+};
+
+static const char *const FieldNames[] = {
+#define TULA_INSPECT_FIELD_NAME(id, name) name,
+        TULA_INSPECT_FIELDS(TULA_INSPECT_FIELD_NAME)
+#undef TULA_INSPECT_FIELD_NAME
+};
+
+static constexpr uint32_t DefaultFields = 1u << Path | 1u << Name | 1u << Version | 1u << Access | 1u << Super;
+
+// A class file: on disk when `jar` is null, else an entry of the jar.
+struct Input {
+    const JarReader *jar;
+    size_t index;       // into the jar's entries, or into the list of loose files
+};
+
+struct Options {
+    uint32_t fields = DefaultFields;
+    std::vector<std::string> forbidden;
+};
+
+static void appendJsonString(std::string &out, const char *value, size_t length) {
+    out += '"';
+    for (size_t i = 0; i < length; ++i) {
+        auto c = static_cast<unsigned char>(value[i]);
+        if (c == '"' || c == '\\') {
+            out += '\\';
+            out += static_cast<char>(c);
+        } else if (c < 0x20) {
+            char escaped[8];
+            snprintf(escaped, sizeof(escaped), "\\u%04x", c);
+            out += escaped;
+        } else {
+            out += static_cast<char>(c);
+        }
+    }
+    out += '"';
+}
+
+static void appendJsonString(std::string &out, const std::string &value) {
+    appendJsonString(out, value.data(), value.size());
+}
+
+static void appendJsonString(std::string &out, const SymbolPtr &value) {
+    if (value == nullptr) {
+        out += "null";
+    } else {
+        appendJsonString(out, reinterpret_cast<const char *>(value->getBytes()), value->getLength());
+    }
+}
+
+static void appendJsonArray(std::string &out, const std::vector<SymbolPtr> &values) {
+    out += '[';
+    for (size_t i = 0; i < values.size(); ++i) {
+        if (i != 0) {
+            out += ',';
+        }
+        appendJsonString(out, values[i]);
+    }
+    out += ']';
+}
+
+// Distinct symbols by content, in first-seen order.
+static std::vector<SymbolPtr> distinct(const std::vector<SymbolPtr> &symbols) {
+    std::vector<SymbolPtr> result;
+    std::set<const Symbol *> seen;
+    for (const auto &symbol : symbols) {
+        if (seen.insert(symbol.get()).second) {
+            result.push_back(symbol);
+        }
+    }
+    return result;
+}
+
+static std::vector<SymbolPtr> referencedClasses(ConstantPool &cp, const SymbolPtr &self) {
+    std::vector<SymbolPtr> references;
+    for (uint16_t index = 1; index < cp.getSize(); ++index) {
+        if (cp.getTagAt(index).isClassOrUnresolvedClass()) {
+            SymbolPtr name = cp.getClassAt(index).getUnresolvedClassName();
+            if (name != self) {
+                references.push_back(std::move(name));
+            }
+        }
+    }
+    return distinct(references);
+}
+
+static bool isForbidden(const SymbolPtr &name, const std::vector<std::string> &prefixes) {
+    return std::any_of(prefixes.begin(), prefixes.end(), [&name](const std::string &prefix) {
+        return name->getLength() >= prefix.size() && memcmp(name->getBytes(), prefix.data(), prefix.size()) == 0;
+    });
+}
+
+// Appends the line of one class; returns 0, 1 for a parse error or 3 for forbidden references.
+static int inspect(const std::string &path, const std::vector<uint8_t> &bytes, const Options &options,
+                   std::string &out) {
+    auto fields = options.fields;
+    out += '{';
+    bool first = true;
+    auto key = [&](const char *name) {
+        out += first ? "\"" : ",\"";
+        out += name;
+        out += "\":";
+        first = false;
+    };
+    if (fields & 1u << Path) {
+        key("path");
+        appendJsonString(out, path);
+    }
+    int status = 0;
+    try {
+        // Malformed classes are common in audited jars; they are reported without an exception.
+        ClassFileParser parser(bytes.data(), static_cast<uint32_t>(bytes.size()));
+        auto klass = std::static_pointer_cast<InstanceKlass>(parser.tryParse());
+        if (klass == nullptr) {
+            key("error");
+            appendJsonString(out, parser.getError().message());
+            key("offset");
+            out += std::to_string(parser.getError().getOffset());
+            status = 1;
+        } else {
+            auto &cp = *klass->getConstantPool();
+            if (fields & 1u << Name) {
+                key("name");
+                appendJsonString(out, klass->getName());
+            }
+            if (fields & 1u << Version) {
+                key("version");
+                out += std::to_string(klass->getMajorVersion());
+            }
+            if (fields & 1u << Access) {
+                key("access");
+                out += std::to_string(static_cast<uint32_t>(klass->getAccessFlags()));
+            }
+            if (fields & 1u << Super) {
+                key("super");
+                appendJsonString(out, klass->getSuperClassName());
+            }
+            if (fields & 1u << Interfaces) {
+                std::vector<SymbolPtr> interfaces;
+                for (auto index : parser.getInterfaceIndexes()) {
+                    interfaces.push_back(cp.getClassAt(index).getUnresolvedClassName());
+                }
+                key("interfaces");
+                appendJsonArray(out, interfaces);
+            }
+            if (fields & 1u << Source) {
+                key("source");
+                appendJsonString(out, klass->getSourceFile());
+            }
+            if (fields & 1u << Fields) {
+                key("fields");
+                out += std::to_string(klass->getFields().size());
+            }
+            if (fields & 1u << Methods) {
+                key("methods");
+                out += std::to_string(klass->getMethods().size());
+            }
+            if (fields & 1u << Annotations) {
+                key("annotations");
+                appendJsonArray(out, distinct(parser.getAnnotationTypes()));
+            }
+            if (fields & (1u << References) || !options.forbidden.empty()) {
+                auto references = referencedClasses(cp, klass->getName());
+                if (fields & 1u << References) {
+                    key("references");
+                    appendJsonArray(out, references);
+                }
+                if (!options.forbidden.empty()) {
+                    std::vector<SymbolPtr> forbidden;
+                    std::copy_if(references.begin(), references.end(), std::back_inserter(forbidden),
+                                 [&options](const SymbolPtr &name) { return isForbidden(name, options.forbidden); });
+                    key("forbidden");
+                    appendJsonArray(out, forbidden);
+                    status = forbidden.empty() ? 0 : 3;
+                }
+            }
+        }
+    } catch (const std::exception &e) {
+        key("error");
+        appendJsonString(out, e.what());
+        status = 1;
+    }
+    if (fields & 1u << Size) {
+        key("size");
+        out += std::to_string(bytes.size());
+    }
+    out += "}\n";
+    return status;
+}
+
+static bool readFile(const std::string &path, std::vector<uint8_t> &out) {
+    std::ifstream in(path, std::ios::binary | std::ios::ate);
+    if (!in) {
+        return false;
+    }
+    out.resize(static_cast<size_t>(in.tellg()));
+    in.seekg(0);
+    return static_cast<bool>(in.read(reinterpret_cast<char *>(out.data()), static_cast<std::streamsize>(out.size())));
+}
+
+static bool endsWith(const std::string &value, const char *suffix) {
+    auto length = strlen(suffix);
+    return value.size() >= length && value.compare(value.size() - length, length, suffix) == 0;
+}
+
+static int usage() {
+    fprintf(stderr, "usage: tula-inspect [--fields f,f,...|all] [--forbid <prefix>]... [--threads N] "
+                    "<class, dir or jar>...\nfields:");
+    for (auto name : FieldNames) {
+        fprintf(stderr, " %s", name);
+    }
+    fprintf(stderr, "\n");
+    return 2;
+}
+
+static bool parseFields(const std::string &list, uint32_t &fields) {
+    if (list == "all") {
+        fields = (1u << FieldCount) - 1;
+        return true;
+    }
+    fields = 0;
+    for (size_t start = 0; start <= list.size();) {
+        auto end = std::min(list.find(',', start), list.size());
+        auto name = list.substr(start, end - start);
+        auto found = std::find_if(std::begin(FieldNames), std::end(FieldNames),
+                                  [&name](const char *field) { return name == field; });
+        if (found == std::end(FieldNames)) {
+            return false;
+        }
+        fields |= 1u << static_cast<uint32_t>(found - std::begin(FieldNames));
+        start = end + 1;
+    }
+    return true;
+}
+
+int main(int argc, char **argv) {
+    Options options;
+    size_t threads = 0;
+    std::vector<std::string> arguments;
+    for (int i = 1; i < argc; ++i) {
+        std::string argument = argv[i];
+        if (argument == "--fields" && i + 1 < argc) {
+            if (!parseFields(argv[++i], options.fields)) {
+                return usage();
+            }
+        } else if (argument == "--forbid" && i + 1 < argc) {
+            options.forbidden.emplace_back(argv[++i]);
+        } else if (argument == "--threads" && i + 1 < argc) {
+            threads = std::strtoul(argv[++i], nullptr, 10);
+        } else if (argument.compare(0, 2, "--") == 0) {
+            return usage();
+        } else {
+            arguments.push_back(std::move(argument));
+        }
+    }
+    if (arguments.empty()) {
+        return usage();
+    }
+
+    std::vector<std::string> files;
+    std::vector<std::unique_ptr<JarReader>> jars;
+    std::vector<Input> inputs;
+    try {
+        for (const auto &argument : arguments) {
+            if (std::filesystem::is_directory(argument)) {
+                for (const auto &entry : std::filesystem::recursive_directory_iterator(argument)) {
+                    if (entry.is_regular_file() && endsWith(entry.path().string(), ".class")) {
+                        files.push_back(entry.path().string());
+                    }
+                }
+            } else if (endsWith(argument, ".jar") || endsWith(argument, ".zip")) {
+                jars.push_back(std::make_unique<JarReader>(argument));
+            } else {
+                files.push_back(argument);
+            }
+        }
+    } catch (const std::exception &e) {
+        fprintf(stderr, "tula-inspect: %s\n", e.what());
+        return 1;
+    }
+    std::sort(files.begin(), files.end());
+    for (size_t i = 0; i < files.size(); ++i) {
+        inputs.push_back({nullptr, i});
+    }
+    for (const auto &jar : jars) {
+        const auto &entries = jar->getEntries();
+        for (size_t i = 0; i < entries.size(); ++i) {
+            if (endsWith(entries[i].name, ".class")) {
+                inputs.push_back({jar.get(), i});
+            }
+        }
+    }
+
+    // Symbols live in the tables of a VM. The symbol table is sharded, so the parsing threads scale.
+    VM vm("", "");
+    ThreadPool pool(threads);
+    // Chunks keep the output in input order; a window of them is printed before the next is parsed.
+    constexpr size_t ChunkSize = 64;
+    auto chunkCount = (inputs.size() + ChunkSize - 1) / ChunkSize;
+    auto window = std::max<size_t>(pool.getThreadCount() * 8, 8);
+    std::atomic<bool> errors{false};
+    std::atomic<bool> forbidden{false};
+    auto start = std::chrono::steady_clock::now();
+    for (size_t first = 0; first < chunkCount; first += window) {
+        auto count = std::min(window, chunkCount - first);
+        std::vector<std::string> output(count);
+        pool.parallelFor(count, [&](size_t chunk) {
+            std::vector<uint8_t> bytes;
+            auto &out = output[chunk];
+            auto begin = (first + chunk) * ChunkSize;
+            for (auto i = begin; i < std::min(begin + ChunkSize, inputs.size()); ++i) {
+                const auto &input = inputs[i];
+                std::string path;
+                int result;
+                if (input.jar == nullptr) {
+                    path = files[input.index];
+                    result = readFile(path, bytes) ? inspect(path, bytes, options, out) : -1;
+                } else {
+                    const auto &entry = input.jar->getEntries()[input.index];
+                    path = input.jar->getPath() + "!/" + entry.name;
+                    try {
+                        input.jar->read(entry, bytes);
+                        result = inspect(path, bytes, options, out);
+                    } catch (const std::exception &e) {
+                        result = -1;
+                    }
+                }
+                if (result == -1) {
+                    out += "{\"path\":";
+                    appendJsonString(out, path);
+                    out += ",\"error\":\"unreadable\"}\n";
+                    result = 1;
+                }
+                if (result == 1) {
+                    errors.store(true, std::memory_order_relaxed);
+                } else if (result == 3) {
+                    forbidden.store(true, std::memory_order_relaxed);
+                }
+            }
+        });
+        for (const auto &out : output) {
+            fwrite(out.data(), 1, out.size(), stdout);
+        }
+    }
+    fflush(stdout);
+    auto seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    fprintf(stderr, "tula-inspect: %zu classes in %.3f s (%.0f classes/s, %zu threads)\n", inputs.size(), seconds,
+            seconds > 0 ? static_cast<double>(inputs.size()) / seconds : 0.0, pool.getThreadCount());
+    // A parse error outranks forbidden references.
+    return errors.load() ? 1 : forbidden.load() ? 3 : 0;
+}
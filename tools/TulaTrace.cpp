@@ -0,0 +1,71 @@
+// tula-trace: converts an event file written by VM::stopRecording() to Chrome trace JSON, which
+// chrome://tracing and ui.perfetto.dev open.
+//
+//   tula-trace <events file> [<trace.json>]      (stdout without an output file)
+//   tula-trace --summary <events file>           (count and total time per event type)
+
+#include "Error.hpp"
+#include "events/EventRecorder.hpp"
+
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+
+using namespace CCW::Tula;
+
+static int usage() {
+    fprintf(stderr, "usage: tula-trace <events file> [<trace.json>]\n"
+                    "       tula-trace --summary <events file>\n");
+    return 2;
+}
+
+static void printSummary(const EventLog &log) {
+    uint64_t counts[static_cast<size_t>(EventType::Count)] = {};
+    uint64_t ticks[static_cast<size_t>(EventType::Count)] = {};
+    for (const auto &event : log.events) {
+        counts[static_cast<size_t>(event.type)]++;
+        ticks[static_cast<size_t>(event.type)] += event.duration;
+    }
+    printf("%-20s %10s %14s\n", "event", "count", "total (us)");
+    for (size_t type = 0; type < static_cast<size_t>(EventType::Count); ++type) {
+        if (counts[type] != 0) {
+            printf("%-20s %10llu %14.1f\n", EventLog::typeName(static_cast<EventType>(type)),
+                   static_cast<unsigned long long>(counts[type]), ticks[type] * 1e6 / log.ticksPerSecond);
+        }
+    }
+    if (log.dropped != 0) {
+        printf("%llu events dropped\n", static_cast<unsigned long long>(log.dropped));
+    }
+}
+
+int main(int argc, char **argv) {
+    bool summary = argc > 1 && strcmp(argv[1], "--summary") == 0;
+    if (summary ? argc != 3 : argc < 2 || argc > 3) {
+        return usage();
+    }
+    std::ifstream in(argv[summary ? 2 : 1], std::ios::binary);
+    if (!in) {
+        fprintf(stderr, "tula-trace: can't open %s\n", argv[summary ? 2 : 1]);
+        return 1;
+    }
+    try {
+        auto log = EventLog::read(in);
+        if (summary) {
+            printSummary(log);
+        } else if (argc == 3) {
+            std::ofstream out(argv[2]);
+            log.writeChromeTrace(out);
+            if (!out) {
+                fprintf(stderr, "tula-trace: can't write %s\n", argv[2]);
+                return 1;
+            }
+        } else {
+            log.writeChromeTrace(std::cout);
+        }
+    } catch (const Error &e) {
+        fprintf(stderr, "tula-trace: %s\n", e.what());
+        return 1;
+    }
+    return 0;
+}